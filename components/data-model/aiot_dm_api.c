@@ -109,10 +109,10 @@ static int32_t _dm_setup_topic_mapping(void *mqtt_handle, void *dm_handle)
     return res;
 }
 
-static int32_t _dm_prepare_send_topic(dm_handle_t *dm_handle, const aiot_dm_msg_t *msg, char **topic)
+static int32_t _dm_prepare_send_topic(dm_handle_t *dm_handle, const aiot_dm_msg_t *msg, char *buffer,
+                                      uint32_t buffer_len, char **topic)
 {
-    char *src[4];
-    uint8_t src_count = 0;
+    void *src[1];
     char *dn = NULL;
 
     if (NULL == msg->device_name && NULL == core_mqtt_get_device_name(dm_handle->mqtt_handle)) {
@@ -122,18 +122,85 @@ static int32_t _dm_prepare_send_topic(dm_handle_t *dm_handle, const aiot_dm_msg_
     dn = (msg->device_name != NULL) ? msg->device_name : core_mqtt_get_device_name(dm_handle->mqtt_handle);
 
     src[0] = dn;
-    src_count = 1;
 
-    return core_sprintf(dm_handle->sysdep, topic, g_dm_send_topic_mapping[msg->type].topic, src, src_count,
-                        DATA_MODEL_MODULE_NAME);
+    return core_sprintf_buf(dm_handle->sysdep, buffer, buffer_len, topic, g_dm_send_topic_mapping[msg->type].topic,
+                            src, 1, DATA_MODEL_MODULE_NAME);
 }
 
-static int32_t _dm_send_reg_req(dm_handle_t *handle, const char *topic, const aiot_dm_msg_t *msg)
+static int32_t _dm_publish_fmt(dm_handle_t *handle, const char *topic, char *fmt, void *src[], uint8_t count)
 {
+    char buffer[DM_PAYLOAD_BUFFER_LEN];
     char *payload = NULL;
+    int32_t payload_len = 0, res = STATE_SUCCESS;
+
+    payload_len = core_sprintf_buf(handle->sysdep, buffer, sizeof(buffer), &payload, fmt, src, count,
+                                   DATA_MODEL_MODULE_NAME);
+    if (payload_len < 0) {
+        return payload_len;
+    }
+
+    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, (uint32_t)payload_len, 0);
+    if (payload != buffer) {
+        handle->sysdep->core_sysdep_free(payload);
+    }
+
+    return res;
+}
+
+static uint32_t _dm_strlen(char *value)
+{
+    return (value == NULL) ? 0 : (uint32_t)strlen(value);
+}
+
+/* 在payload之前预留MQTT报文头的位置, 边构造边写入发送缓冲区 */
+static int32_t _dm_writer_begin(dm_handle_t *handle, core_json_writer_t *writer, int32_t id, uint32_t params_len)
+{
+    int32_t res = STATE_SUCCESS;
+    char id_string[DM_ID_STRING_LEN] = {0};
+
+    res = core_json_writer_init(writer, handle->sysdep, CORE_MQTT_PUB_HEADROOM, DM_JSON_HEADER_LEN + params_len,
+                                DATA_MODEL_MODULE_NAME);
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+
+    core_int2str(id, id_string, NULL);
+    core_json_writer_object_begin(writer);
+    core_json_writer_key(writer, "id");
+    core_json_writer_string(writer, id_string);
+
+    return STATE_SUCCESS;
+}
+
+/* 用户传入的JSON字符串原样写入, NULL按null输出 */
+static void _dm_writer_raw(core_json_writer_t *writer, char *value)
+{
+    if (value == NULL) {
+        core_json_writer_string(writer, NULL);
+        return;
+    }
+    core_json_writer_raw(writer, value, (uint32_t)strlen(value));
+}
+
+static int32_t _dm_publish_writer(dm_handle_t *handle, const char *topic, core_json_writer_t *writer)
+{
+    int32_t res = STATE_SUCCESS;
+
+    core_json_writer_object_end(writer);
+    res = writer->error;
+    if (res >= STATE_SUCCESS) {
+        res = core_mqtt_pub_inplace(handle->mqtt_handle, (char *)topic, writer->buffer + writer->headroom, writer->len,
+                                    0);
+    }
+    core_json_writer_deinit(writer);
+
+    return res;
+}
+
+static int32_t _dm_send_reg_req(dm_handle_t *handle, const char *topic, const aiot_dm_msg_t *msg)
+{
     int32_t id = 0;
-    char id_string[11] = { 0 };
-    char *src[2] = { NULL };
+    void *src[2] = { NULL };
     int32_t res = STATE_SUCCESS;
 
     if (NULL == msg) {
@@ -141,22 +208,13 @@ static int32_t _dm_send_reg_req(dm_handle_t *handle, const char *topic, const ai
     }
 
     core_global_alink_id_next(handle->sysdep, &id);
-    core_int2str(id, id_string, NULL);
 
     _append_diag_data(handle, DM_DIAG_MSG_TYPE_REQ, id);
 
-    src[0] = id_string;
+    src[0] = &id;
     src[1] = msg->data.get_reg_post.time;
 
-
-    res = core_sprintf(handle->sysdep, &payload, XJT_GET_DEVICE, src, sizeof(src) / sizeof(char *),
-                       DATA_MODEL_MODULE_NAME);
-    if (res < 0) {
-        return res;
-    }
-
-    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, strlen(payload), 0);
-    handle->sysdep->core_sysdep_free(payload);
+    res = _dm_publish_fmt(handle, topic, XJT_GET_DEVICE, src, sizeof(src) / sizeof(void *));
 
     if (STATE_SUCCESS == res) {
         return id;
@@ -166,10 +224,8 @@ static int32_t _dm_send_reg_req(dm_handle_t *handle, const char *topic, const ai
 
 static int32_t _dm_send_prop_req(dm_handle_t *handle, const char *topic, const aiot_dm_msg_t *msg)
 {
-    char *payload = NULL;
     int32_t id = 0;
-    char id_string[11] = { 0 };
-    char *src[2] = { NULL };
+    core_json_writer_t writer;
     int32_t res = STATE_SUCCESS;
 
     if (NULL == msg) {
@@ -177,22 +233,21 @@ static int32_t _dm_send_prop_req(dm_handle_t *handle, const char *topic, const a
     }
 
     core_global_alink_id_next(handle->sysdep, &id);
-    core_int2str(id, id_string, NULL);
 
     _append_diag_data(handle, DM_DIAG_MSG_TYPE_REQ, id);
 
-    src[0] = id_string;
-    src[1] = msg->data.property_post.params;
-
-
-    res = core_sprintf(handle->sysdep, &payload, XJT_PROP_POST, src, sizeof(src) / sizeof(char *),
-                       DATA_MODEL_MODULE_NAME);
-    if (res < 0) {
+    res = _dm_writer_begin(handle, &writer, id, _dm_strlen(msg->data.property_post.params));
+    if (res < STATE_SUCCESS) {
         return res;
     }
+    core_json_writer_key(&writer, "devices");
+    core_json_writer_array_begin(&writer);
+    if (msg->data.property_post.params != NULL) {
+        _dm_writer_raw(&writer, msg->data.property_post.params);
+    }
+    core_json_writer_array_end(&writer);
 
-    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, strlen(payload), 0);
-    handle->sysdep->core_sysdep_free(payload);
+    res = _dm_publish_writer(handle, topic, &writer);
 
     if (STATE_SUCCESS == res) {
         return id;
@@ -201,10 +256,8 @@ static int32_t _dm_send_prop_req(dm_handle_t *handle, const char *topic, const a
 }
 static int32_t _dm_send_event_req(dm_handle_t *handle, const char *topic,const aiot_dm_msg_t *msg)
 {
-    char *payload = NULL;
     int32_t id = 0;
-    char id_string[11] = { 0 };
-    char *src[4] = { NULL };
+    core_json_writer_t writer;
     int32_t res = STATE_SUCCESS;
 
     if (NULL == msg) {
@@ -212,23 +265,21 @@ static int32_t _dm_send_event_req(dm_handle_t *handle, const char *topic,const a
     }
 
     core_global_alink_id_next(handle->sysdep, &id);
-    core_int2str(id, id_string, NULL);
 
     _append_diag_data(handle, DM_DIAG_MSG_TYPE_REQ, id);
 
-    src[0] = id_string;
-    src[1] = msg->data.xjt_event_post.time;
-    src[2] = msg->data.xjt_event_post.event_id;
-    src[3] = msg->data.xjt_event_post.params;
-
-    res = core_sprintf(handle->sysdep, &payload, XJT_EVENT_POST, src, sizeof(src) / sizeof(char *),
-                       DATA_MODEL_MODULE_NAME);
-    if (res < 0) {
+    res = _dm_writer_begin(handle, &writer, id, _dm_strlen(msg->data.xjt_event_post.params));
+    if (res < STATE_SUCCESS) {
         return res;
     }
+    core_json_writer_key(&writer, "time");
+    core_json_writer_string(&writer, msg->data.xjt_event_post.time);
+    core_json_writer_key(&writer, "identifier");
+    core_json_writer_string(&writer, msg->data.xjt_event_post.event_id);
+    core_json_writer_key(&writer, "data");
+    _dm_writer_raw(&writer, msg->data.xjt_event_post.params);
 
-    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, strlen(payload), 0);
-    handle->sysdep->core_sysdep_free(payload);
+    res = _dm_publish_writer(handle, topic, &writer);
 
     if (STATE_SUCCESS == res) {
         return id;
@@ -237,10 +288,8 @@ static int32_t _dm_send_event_req(dm_handle_t *handle, const char *topic,const a
 }
 static int32_t _dm_send_service_req(dm_handle_t *handle, const char *topic,const aiot_dm_msg_t *msg)
 {
-    char *payload = NULL;
     int32_t id = 0;
-    char id_string[11] = { 0 };
-    char *src[3] = { NULL };
+    core_json_writer_t writer;
     int32_t res = STATE_SUCCESS;
 
     if (NULL == msg) {
@@ -248,22 +297,19 @@ static int32_t _dm_send_service_req(dm_handle_t *handle, const char *topic,const
     }
 
     core_global_alink_id_next(handle->sysdep, &id);
-    core_int2str(id, id_string, NULL);
 
     _append_diag_data(handle, DM_DIAG_MSG_TYPE_REQ, id);
 
-    src[0] = id_string;
-    src[1] = msg->data.xjt_service_rep.code;
-    src[2] = msg->data.xjt_service_rep.params;
-
-    res = core_sprintf(handle->sysdep, &payload, XJT_SERVICE_REPLY, src, sizeof(src) / sizeof(char *),
-                       DATA_MODEL_MODULE_NAME);
-    if (res < 0) {
+    res = _dm_writer_begin(handle, &writer, id, _dm_strlen(msg->data.xjt_service_rep.params));
+    if (res < STATE_SUCCESS) {
         return res;
     }
+    core_json_writer_key(&writer, "code");
+    core_json_writer_string(&writer, msg->data.xjt_service_rep.code);
+    core_json_writer_key(&writer, "message");
+    core_json_writer_string(&writer, msg->data.xjt_service_rep.params);
 
-    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, strlen(payload), 0);
-    handle->sysdep->core_sysdep_free(payload);
+    res = _dm_publish_writer(handle, topic, &writer);
 
     if (STATE_SUCCESS == res) {
         return id;
@@ -274,33 +320,17 @@ static int32_t _dm_send_service_req(dm_handle_t *handle, const char *topic,const
 static int32_t _dm_send_alink_rsp(dm_handle_t *handle, const char *topic, uint64_t msg_id, uint32_t code,
                                   char *data)
 {
-    char *payload = NULL;
-    char id_string[21] = { 0 };
-    char code_string[11] = { 0 };
-    char *src[3] = { NULL };
-    int32_t res = STATE_SUCCESS;
+    void *src[3] = { NULL };
 
     if (NULL == data) {
         return STATE_DM_MSG_DATA_IS_NULL;
     }
 
-    core_uint642str(msg_id, id_string, NULL);
-    core_uint2str(code, code_string, NULL);
-
-    src[0] = id_string;
-    src[1] = code_string;
+    src[0] = &msg_id;
+    src[1] = &code;
     src[2] = data;
 
-    res = core_sprintf(handle->sysdep, &payload, ALINK_RESPONSE_FMT, src, sizeof(src) / sizeof(char *),
-                       DATA_MODEL_MODULE_NAME);
-    if (res < 0) {
-        return res;
-    }
-
-    res = aiot_mqtt_pub(handle->mqtt_handle, (char *)topic, (uint8_t *)payload, strlen(payload), 0);
-    handle->sysdep->core_sysdep_free(payload);
-
-    return res;
+    return _dm_publish_fmt(handle, topic, ALINK_RESPONSE_FMT, src, sizeof(src) / sizeof(void *));
 }
 
 /*** dm send function start ***/
@@ -387,29 +417,33 @@ static int32_t _dm_get_topic_level(aiot_sysdep_portfile_t *sysdep, char *topic,
 static int32_t _dm_parse_xjt_prop_request(const char *payload, uint32_t payload_len, uint64_t *msg_id,char **se_id,char ** eid, char **params,
                                        uint32_t *params_len)
 {
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
     char *value = NULL;
     uint32_t value_len = 0;
     int32_t res = STATE_SUCCESS;
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID),
+    core_json_index(&index, payload, payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID),
                                &value, &value_len)) < 0 ||
         ((res = core_str2uint64(value, value_len, msg_id)) < 0)) {
         return res;
     }
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_SERVICE_ID, strlen(XJT_JSON_KEY_SERVICE_ID),
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_SERVICE_ID, strlen(XJT_JSON_KEY_SERVICE_ID),
                                &value, &value_len)) < 0) {
         return res;
     }
     *se_id = value;
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_EID, strlen(XJT_JSON_KEY_EID),
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_EID, strlen(XJT_JSON_KEY_EID),
                                &value, &value_len)) < 0) {
         return res;
     }
     *eid = value;
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_PARAMS, strlen(XJT_JSON_KEY_PARAMS),
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_PARAMS, strlen(XJT_JSON_KEY_PARAMS),
                                &value, &value_len)) < 0) {
         return res;
     }
@@ -423,23 +457,27 @@ static int32_t _dm_parse_xjt_prop_request(const char *payload, uint32_t payload_
 static int32_t _dm_parse_xjt_service_request(const char *payload, uint32_t payload_len, uint64_t *msg_id,char **ident, char **params,
                                        uint32_t *params_len)
 {
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
     char *value = NULL;
     uint32_t value_len = 0;
     int32_t res = STATE_SUCCESS;
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID),
+    core_json_index(&index, payload, payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID),
                                &value, &value_len)) < 0 ||
         ((res = core_str2uint64(value, value_len, msg_id)) < 0)) {
         return res;
     }
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_IDENTIFIER, strlen(XJT_JSON_KEY_IDENTIFIER),
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_IDENTIFIER, strlen(XJT_JSON_KEY_IDENTIFIER),
                                &value, &value_len)) < 0) {
         return res;
     }
     *ident = value;
 
-    if ((res = core_json_value((char *)payload, payload_len, XJT_JSON_KEY_DATA, strlen(XJT_JSON_KEY_DATA),
+    if ((res = core_json_index_value(&index, XJT_JSON_KEY_DATA, strlen(XJT_JSON_KEY_DATA),
                                &value, &value_len)) < 0) {
         return res;
     }
@@ -454,6 +492,8 @@ static void _dm_recv_register_handler(void *handle, const aiot_mqtt_recv_t *msg,
 {
     dm_handle_t *dm_handle = (dm_handle_t *)userdata;
     aiot_dm_recv_t recv;
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
     char *value = NULL;
     uint32_t value_len = 0;
     int32_t res = STATE_SUCCESS;
@@ -468,23 +508,23 @@ static void _dm_recv_register_handler(void *handle, const aiot_mqtt_recv_t *msg,
 
     core_log(dm_handle->sysdep, STATE_DM_LOG_RECV, "DM recv generic reply\r\n");
 
+    core_json_index(&index, (char *)msg->data.pub.payload, msg->data.pub.payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+
     do {
         if (_dm_get_topic_level(dm_handle->sysdep, msg->data.pub.topic, msg->data.pub.topic_len, 5, &recv.device_name) < 0) {
             break;  /* must be malloc failed */
         }
 
-        if ((core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID), &value, &value_len)) < 0 ||
+        if ((core_json_index_value(&index, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID), &value, &value_len)) < 0 ||
             (core_str2uint(value, value_len, &recv.data.register_info.msg_id)) < 0) {
 
             core_log(dm_handle->sysdep, SATAE_DM_LOG_PARSE_RECV_MSG_FAILED, "DM parse generic reply failed\r\n");
             break;
         }
 
-        res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                        XJT_JSON_KEY_DEV_INFO, strlen(XJT_JSON_KEY_DEV_INFO),
-                        &recv.data.register_info.params,
-                        &recv.data.register_info.params_len);
+        res = core_json_index_value(&index, XJT_JSON_KEY_DEV_INFO, strlen(XJT_JSON_KEY_DEV_INFO),
+                                    &recv.data.register_info.params,
+                                    &recv.data.register_info.params_len);
         if(res != STATE_SUCCESS) {
             recv.data.register_info.params = NULL;
             recv.data.register_info.params_len = 0;
@@ -501,6 +541,8 @@ static void _dm_recv_generic_reply_handler(void *handle, const aiot_mqtt_recv_t
 {
     dm_handle_t *dm_handle = (dm_handle_t *)userdata;
     aiot_dm_recv_t recv;
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
     char *value = NULL;
     uint32_t value_len = 0;
     int32_t res = STATE_SUCCESS;
@@ -515,26 +557,25 @@ static void _dm_recv_generic_reply_handler(void *handle, const aiot_mqtt_recv_t
 
     core_log(dm_handle->sysdep, STATE_DM_LOG_RECV, "DM recv generic reply\r\n");
 
+    core_json_index(&index, (char *)msg->data.pub.payload, msg->data.pub.payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+
     do {
         if (_dm_get_topic_level(dm_handle->sysdep, msg->data.pub.topic, msg->data.pub.topic_len, 5, &recv.device_name) < 0) {
             break;  /* must be malloc failed */
         }
 
-        if ((core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID), &value, &value_len)) < 0 ||
+        if ((core_json_index_value(&index, XJT_JSON_KEY_ID, strlen(XJT_JSON_KEY_ID), &value, &value_len)) < 0 ||
             (core_str2uint(value, value_len, &recv.data.generic_reply.msg_id)) < 0 ||
-            (core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   XJT_JSON_KEY_CODE, strlen(XJT_JSON_KEY_CODE), &value, &value_len)) < 0 ||
+            (core_json_index_value(&index, XJT_JSON_KEY_CODE, strlen(XJT_JSON_KEY_CODE), &value, &value_len)) < 0 ||
             (core_str2uint(value, value_len, &recv.data.generic_reply.code)) < 0) {
 
             core_log(dm_handle->sysdep, SATAE_DM_LOG_PARSE_RECV_MSG_FAILED, "DM parse generic reply failed\r\n");
             break;
         }
 
-        res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                        ALINK_JSON_KEY_MESSAGE, strlen(ALINK_JSON_KEY_MESSAGE),
-                        &recv.data.generic_reply.message,
-                        &recv.data.generic_reply.message_len);
+        res = core_json_index_value(&index, ALINK_JSON_KEY_MESSAGE, strlen(ALINK_JSON_KEY_MESSAGE),
+                                    &recv.data.generic_reply.message,
+                                    &recv.data.generic_reply.message_len);
         if(res != STATE_SUCCESS) {
             recv.data.generic_reply.message = NULL;
             recv.data.generic_reply.message_len = 0;
@@ -720,6 +761,7 @@ int32_t aiot_dm_setopt(void *handle, aiot_dm_option_t option, void *data)
 int32_t aiot_dm_send(void *handle, const aiot_dm_msg_t *msg)
 {
     dm_handle_t *dm_handle = NULL;
+    char buffer[DM_TOPIC_BUFFER_LEN];
     char *topic = NULL;
     int32_t res = STATE_SUCCESS;
 
@@ -736,13 +778,15 @@ int32_t aiot_dm_send(void *handle, const aiot_dm_msg_t *msg)
         return STATE_DM_MQTT_HANDLE_IS_NULL;
     }
 
-    res = _dm_prepare_send_topic(dm_handle, msg, &topic);
+    res = _dm_prepare_send_topic(dm_handle, msg, buffer, sizeof(buffer), &topic);
     if (res < 0) {
         return res;
     }
 
     res = g_dm_send_topic_mapping[msg->type].func(dm_handle, topic, msg);
-    dm_handle->sysdep->core_sysdep_free(topic);
+    if (topic != buffer) {
+        dm_handle->sysdep->core_sysdep_free(topic);
+    }
     return res;
 }
 
@@ -33,14 +33,19 @@ extern "C" {
 /* ALINK请求的JSON格式 */
 #define ALINK_REQUEST_FMT               "{\"id\":\"%s\",\"version\":\"1.0\",\"params\":%s,\"sys\":{\"ack\":%s}}"
 
-/*XJT请求的格式*/
-#define XJT_GET_DEVICE                  "{\"id\":\"%s\",\"eventTime\":,\"%s\"}"
-#define XJT_PROP_POST                   "{\"id\":\"%s\",\"devices\":[%s]}"
-#define XJT_EVENT_POST                  "{\"id\":\"%s\",\"time\":\"%s\",\"identifier\":\"%s\",\"data\":%s}"
-#define XJT_SERVICE_REPLY                 "{\"id\":\"%s\",\"code\":\"%s\",\"message\":\"%s\"}"
-
-/* ALINK应答的JSON格式 */
-#define ALINK_RESPONSE_FMT              "{\"id\":\"%s\",\"code\":%s,\"data\":%s}"
+/* 拼装topic和payload时优先使用的栈上缓冲区长度, 放不下时再从堆上分配 */
+#define DM_TOPIC_BUFFER_LEN             (128)
+#define DM_PAYLOAD_BUFFER_LEN           (256)
+
+/*XJT请求的格式, 按core_snprintf的转换符传参, id为int32_t*/
+#define XJT_GET_DEVICE                  "{\"id\":\"%d\",\"eventTime\":,\"%s\"}"
+
+/* 属性、事件上报和服务应答由core_json_writer直接写入发送缓冲区, 预留给id等固定字段的长度 */
+#define DM_JSON_HEADER_LEN              (128)
+#define DM_ID_STRING_LEN                (12)
+
+/* ALINK应答的JSON格式, id为uint64_t, code为uint32_t */
+#define ALINK_RESPONSE_FMT              "{\"id\":\"%llu\",\"code\":%u,\"data\":%s}"
 #define ALINK_JSON_KEY_ID               "id"
 #define ALINK_JSON_KEY_CODE             "code"
 #define ALINK_JSON_KEY_PARAMS           "params"
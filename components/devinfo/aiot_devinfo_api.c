@@ -81,6 +81,8 @@ static void _devinfo_mqtt_recv_handler(void *handle, const aiot_mqtt_recv_t *pac
     char *code_key = "code", *id_key = "id", *data_key = "data", *message_key = "message";
     char *code_value = NULL, *id_value = NULL, *data_value = NULL, *message_value = NULL;
     uint32_t code_value_len = 0, id_value_len = 0, data_value_len = 0, message_value_len = 0;
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
 
     if (devinfo_handle->recv_handler == NULL) {
         return;
@@ -96,14 +98,16 @@ static void _devinfo_mqtt_recv_handler(void *handle, const aiot_mqtt_recv_t *pac
         return;
     }
 
-    if (core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len,
-                        code_key, (uint32_t)strlen(code_key), &code_value, &code_value_len) == STATE_SUCCESS &&
-        core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len,
-                        id_key, (uint32_t)strlen(id_key), &id_value, &id_value_len) == STATE_SUCCESS &&
-        core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len,
-                        data_key, (uint32_t)strlen(data_key), &data_value, &data_value_len) == STATE_SUCCESS &&
-        core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len,
-                        message_key, (uint32_t)strlen(message_key), &message_value, &message_value_len) == STATE_SUCCESS) {
+    core_json_index(&index, (char *)packet->data.pub.payload, packet->data.pub.payload_len, tokens,
+                    CORE_JSON_INDEX_TOKENS);
+    if (core_json_index_value(&index,
+                              code_key, (uint32_t)strlen(code_key), &code_value, &code_value_len) == STATE_SUCCESS &&
+        core_json_index_value(&index,
+                              id_key, (uint32_t)strlen(id_key), &id_value, &id_value_len) == STATE_SUCCESS &&
+        core_json_index_value(&index,
+                              data_key, (uint32_t)strlen(data_key), &data_value, &data_value_len) == STATE_SUCCESS &&
+        core_json_index_value(&index,
+                              message_key, (uint32_t)strlen(message_key), &message_value, &message_value_len) == STATE_SUCCESS) {
         uint32_t code = 0, id = 0;
         if (core_str2uint(code_value, code_value_len, &code) == STATE_SUCCESS &&
             core_str2uint(id_value, id_value_len, &id) == STATE_SUCCESS) {
@@ -147,10 +147,12 @@ int32_t _logpost_send_nwkstats_conn(logpost_handle_t *handle)
     char *content_fmt = NULL;
     char success_time[22] = {0};
     char conn_time_str[22] = {0};
+    char prep_time_str[22] = {0};
+    char connack_time_str[22] = {0};
     char failed_time[22] = {0};
     char conn_code[12] = {0};
     char *content = NULL;
-    char *content_src[] = {success_time, NULL, conn_time_str, failed_time, NULL, conn_code};
+    char *content_src[] = {success_time, NULL, conn_time_str, prep_time_str, connack_time_str, failed_time, NULL, conn_code};
     uint8_t content_src_cnt = 0;
 
     core_mqtt_get_nwkstats(handle->mqtt_handle, &nwkstats_info);
@@ -159,8 +161,10 @@ int32_t _logpost_send_nwkstats_conn(logpost_handle_t *handle)
     }
     core_uint642str(nwkstats_info.connect_timestamp, success_time, NULL);
     content_src[1] = (nwkstats_info.network_type == 0) ? "TCP" : "TLS";
-    content_src[4] = (nwkstats_info.network_type == 0) ? "TCP" : "TLS";
+    content_src[6] = (nwkstats_info.network_type == 0) ? "TCP" : "TLS";
     core_uint642str(nwkstats_info.connect_time_used, conn_time_str, NULL);
+    core_uint642str(nwkstats_info.prepare_time_used, prep_time_str, NULL);
+    core_uint642str(nwkstats_info.connack_time_used, connack_time_str, NULL);
     core_uint642str(nwkstats_info.failed_timestamp, failed_time, NULL);
     core_int2str(nwkstats_info.failed_error_code, conn_code, NULL);
 
@@ -170,7 +174,7 @@ int32_t _logpost_send_nwkstats_conn(logpost_handle_t *handle)
         content_src_cnt = sizeof(content_src) / sizeof(content_src[0]);
     } else {
         content_fmt = NWKSTAT_CONN_INFO_FMT;
-        content_src_cnt = 3;
+        content_src_cnt = 5;
     }
 
     res = core_sprintf(handle->sysdep, &content, content_fmt, content_src, content_src_cnt, LOGPOST_MODULE_NAME);
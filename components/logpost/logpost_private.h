@@ -51,8 +51,8 @@ typedef struct {
 #define LOGPOST_CONFIG_GET_REPLY_TOPIC          "/sys/+/+/thing/config/log/get_reply"
 
 #define NWKSTAT_RTT_INFO_FMT        "time=%s^rtt=%s"
-#define NWKSTAT_CONN_INFO_FMT       "time=%s^conn_type=%s^conn_cost=%s^conn_ret=0"
-#define NWKSTAT_CONN_INFO_FMT2      "time=%s^conn_type=%s^conn_cost=%s^conn_ret=0,time=%s^conn_type=%s^conn_cost=0^conn_ret=%s"
+#define NWKSTAT_CONN_INFO_FMT       "time=%s^conn_type=%s^conn_cost=%s^prep_cost=%s^connack_cost=%s^conn_ret=0"
+#define NWKSTAT_CONN_INFO_FMT2      "time=%s^conn_type=%s^conn_cost=%s^prep_cost=%s^connack_cost=%s^conn_ret=0,time=%s^conn_type=%s^conn_cost=0^conn_ret=%s"
 
 #define NWKSTAT_NET_RT              "net_rt"
 #define NWKSTAT_NET_CONN            "net_conn"
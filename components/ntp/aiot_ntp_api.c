@@ -39,12 +39,16 @@ static void _ntp_recv_handler(void *handle, const aiot_mqtt_recv_t *packet, void
             char *dst_value = NULL, *srt_value = NULL, *sst_value = NULL;
             uint32_t dst_value_len = 0, srt_value_len = 0, sst_value_len = 0;
             uint64_t dst = 0, srt = 0, sst = 0, utc = 0;
+            core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+            core_json_index_t index;
 
-            if (core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len, dst_key, (uint32_t)strlen(dst_key),
+            core_json_index(&index, (char *)packet->data.pub.payload, packet->data.pub.payload_len, tokens,
+                            CORE_JSON_INDEX_TOKENS);
+            if (core_json_index_value(&index, dst_key, (uint32_t)strlen(dst_key),
                                 &dst_value, &dst_value_len) == STATE_SUCCESS &&
-                core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len, srt_key, (uint32_t)strlen(srt_key),
+                core_json_index_value(&index, srt_key, (uint32_t)strlen(srt_key),
                                 &srt_value, &srt_value_len) == STATE_SUCCESS &&
-                core_json_value((char *)packet->data.pub.payload, packet->data.pub.payload_len, sst_key, (uint32_t)strlen(sst_key),
+                core_json_index_value(&index, sst_key, (uint32_t)strlen(sst_key),
                                 &sst_value, &sst_value_len) == STATE_SUCCESS) {
                 if (core_str2uint64(dst_value, (uint8_t)dst_value_len, &dst) == STATE_SUCCESS &&
                     core_str2uint64(srt_value, (uint8_t)srt_value_len, &srt) == STATE_SUCCESS &&
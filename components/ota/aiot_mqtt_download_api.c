@@ -7,11 +7,14 @@
  *
  */
 
+#include <stdio.h>
+
 #include "aiot_ota_api.h"
 #include "core_mqtt.h"
 #include "core_string.h"
 #include "core_sha256.h"
-#include "ota_md5.h"
+#include "core_md5.h"
+#include "core_crc16.h"
 #include "core_log.h"
 #include "core_global.h"
 #include "mqtt_download_private.h"
@@ -19,62 +22,10 @@
 #include "ota_private.h"
 #include "core_string.h"
 
-static int32_t _md_send_request(void *handle);
+static int32_t _md_send_request(mqtt_download_handle_t *md_handle, uint32_t offset, uint32_t size);
+static void _md_free_blocks(mqtt_download_handle_t *md_handle);
 static void _md_recv_data_reply_handler(void *handle, const aiot_mqtt_recv_t *msg, void *userdata);
 
-/*
- * CRC lookup table for bytes, generating polynomial is 0x8005
- * input: reflexed (LSB first)
- * output: reflexed also...
- */
-
-const uint16_t crc_ibm_table[256] = {
-    0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
-    0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
-    0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
-    0x0a00, 0xcac1, 0xcb81, 0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841,
-    0xd801, 0x18c0, 0x1980, 0xd941, 0x1b00, 0xdbc1, 0xda81, 0x1a40,
-    0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01, 0x1dc0, 0x1c80, 0xdc41,
-    0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0, 0x1680, 0xd641,
-    0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081, 0x1040,
-    0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
-    0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441,
-    0x3c00, 0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41,
-    0xfa01, 0x3ac0, 0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840,
-    0x2800, 0xe8c1, 0xe981, 0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41,
-    0xee01, 0x2ec0, 0x2f80, 0xef41, 0x2d00, 0xedc1, 0xec81, 0x2c40,
-    0xe401, 0x24c0, 0x2580, 0xe541, 0x2700, 0xe7c1, 0xe681, 0x2640,
-    0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0, 0x2080, 0xe041,
-    0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281, 0x6240,
-    0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
-    0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41,
-    0xaa01, 0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840,
-    0x7800, 0xb8c1, 0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41,
-    0xbe01, 0x7ec0, 0x7f80, 0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40,
-    0xb401, 0x74c0, 0x7580, 0xb541, 0x7700, 0xb7c1, 0xb681, 0x7640,
-    0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101, 0x71c0, 0x7080, 0xb041,
-    0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0, 0x5280, 0x9241,
-    0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481, 0x5440,
-    0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
-    0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841,
-    0x8801, 0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40,
-    0x4e00, 0x8ec1, 0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41,
-    0x4400, 0x84c1, 0x8581, 0x4540, 0x8701, 0x47c0, 0x4680, 0x8641,
-    0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040,
-};
-
-uint16_t crc_ibm(uint8_t const *buffer, size_t len)
-{
-    uint16_t crc = 0x0000;
-    uint8_t lut;
-
-    while (len--) {
-        lut = (crc ^ (*buffer++)) & 0xFF;
-        crc = (crc >> 8) ^ crc_ibm_table[lut];
-    }
-    return crc;
-}
-
 int32_t _md_sub_response_topic(void *handle)
 {
     char topic[128];
@@ -122,7 +73,9 @@ void *aiot_mqtt_download_init(void)
     md_handle->status = STATE_MQTT_DOWNLOAD_INIT;
     md_handle->sysdep = sysdep;
     md_handle->request_size = MQTT_DOWNLOAD_DEFAULT_REQUEST_SIZE;
-    md_handle->last_request_time = 0;
+    md_handle->window_size = MQTT_DOWNLOAD_DEFAULT_WINDOW_SIZE;
+    md_handle->block_timeout_ms = MQTT_DOWNLOAD_DEFAULT_RECV_TIMEOUT;
+    md_handle->max_request_size = MQTT_DOWNLOAD_DEFAULT_MAX_REQUEST_SIZE;
     md_handle->data_mutex = sysdep->core_sysdep_mutex_init();
     md_handle->recv_mutex = sysdep->core_sysdep_mutex_init();
 
@@ -158,7 +111,7 @@ int32_t aiot_mqtt_download_deinit(void **handle)
     if (NULL != md_handle->task_desc) {
         if (AIOT_OTA_DIGEST_MD5 == md_handle->task_desc->digest_method) {
             if (NULL != md_handle->digest_ctx) {
-                utils_md5_free(md_handle->digest_ctx);
+                core_md5_free(md_handle->digest_ctx);
                 md_handle->sysdep->core_sysdep_free(md_handle->digest_ctx);
                 md_handle->digest_ctx = NULL;
             }
@@ -175,6 +128,7 @@ int32_t aiot_mqtt_download_deinit(void **handle)
         md_handle->sysdep->core_sysdep_free(md_handle->task_desc);
         md_handle->task_desc = NULL;
     }
+    _md_free_blocks(md_handle);
 
     md_handle->sysdep->core_sysdep_mutex_deinit(&md_handle->data_mutex);
     md_handle->sysdep->core_sysdep_mutex_deinit(&md_handle->recv_mutex);
@@ -192,7 +146,7 @@ static int32_t _download_digest_update(mqtt_download_handle_t *download_handle,
     if (AIOT_OTA_DIGEST_SHA256 == download_handle->task_desc->digest_method) {
         core_sha256_update(download_handle->digest_ctx, buffer, buffer_len);
     } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
-        res = utils_md5_update(download_handle->digest_ctx, buffer, buffer_len);
+        core_md5_update(download_handle->digest_ctx, buffer, buffer_len);
     }
     return res;
 }
@@ -211,7 +165,7 @@ static int32_t _download_digest_verify(mqtt_download_handle_t *download_handle)
         }
     } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
         core_str2hex(download_handle->task_desc->expect_digest, OTA_MD5_LEN, expected_digest);
-        utils_md5_finish(download_handle->digest_ctx, output);
+        core_md5_finish(download_handle->digest_ctx, output);
         if (memcmp(output, expected_digest, 16) == 0) {
             return STATE_SUCCESS;
         }
@@ -265,18 +219,19 @@ static int32_t _parse_json_header(void *handle, char *data, uint32_t data_len, a
     uint32_t header_len = data_len, file_info_len = 0, value_len = 0;
     uint32_t code = 0;
     uint32_t size = 0, offset = 0, fileLenth = 0;
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
     int32_t res = STATE_SUCCESS;
 
-    if ((res = core_json_value((char *)header, header_len, "code", strlen("code"),
-                               &value, &value_len)) < 0 ||
+    core_json_index(&index, header, header_len, tokens, CORE_JSON_INDEX_TOKENS);
+    if ((res = core_json_index_value(&index, "code", strlen("code"), &value, &value_len)) < 0 ||
             ((res = core_str2uint(value, value_len, &code)) < 0) ||
             code != 200 ) {
         core_log1(md_handle->sysdep, 0, "recv handle parse err code %d\r\n", &code);
-        return res;
+        return (res < STATE_SUCCESS) ? res : STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
     }
 
-    if ((res = core_json_value((char *)header, header_len, "data", strlen("data"),
-                               &value, &value_len)) < 0 ) {
+    if ((res = core_json_index_value(&index, "data", strlen("data"), &value, &value_len)) < 0 ) {
         core_log(md_handle->sysdep, 0, "json parse error data\r\n");
         return res;
     }
@@ -284,26 +239,30 @@ static int32_t _parse_json_header(void *handle, char *data, uint32_t data_len, a
     /* 解析文件的描述信息 */
     file_info = value;
     file_info_len = value_len;
-    if ((res = core_json_value((char *)file_info, file_info_len, "bSize", strlen("bSize"),
-                               &value, &value_len)) < 0  ||
+    if ((res = core_json_index_scope_value(&index, file_info, file_info_len, "bSize", strlen("bSize"),
+                                           &value, &value_len)) < 0  ||
             ((res = core_str2uint(value, value_len, &size)) < 0)) {
         core_log(md_handle->sysdep, 0, "json parse error bSize\r\n");
         return res;
     }
-    if ((res = core_json_value((char *)file_info, file_info_len, "bOffset", strlen("bOffset"),
-                               &value, &value_len)) < 0  ||
+    if ((res = core_json_index_scope_value(&index, file_info, file_info_len, "bOffset", strlen("bOffset"),
+                                           &value, &value_len)) < 0  ||
             ((res = core_str2uint(value, value_len, &offset)) < 0)) {
         core_log(md_handle->sysdep, 0, "json parse error bOffset\r\n");
         return res;
     }
-    if ((res = core_json_value((char *)file_info, file_info_len, "fileLength", strlen("fileLength"),
-                               &value, &value_len)) < 0  ||
+    if ((res = core_json_index_scope_value(&index, file_info, file_info_len, "fileLength", strlen("fileLength"),
+                                           &value, &value_len)) < 0  ||
             ((res = core_str2uint(value, value_len, &fileLenth)) < 0)) {
         core_log(md_handle->sysdep, 0, "json parse error bOffset\r\n");
         return res;
     }
-    if ((res = core_json_value((char *)file_info, file_info_len, "fileToken", strlen("fileToken"),
-                               &value, &value_len)) == 0 ) {
+    if ((res = core_json_index_scope_value(&index, file_info, file_info_len, "fileToken", strlen("fileToken"),
+                                           &value, &value_len)) == 0 ) {
+        /* filename指向长度为MQTT_DOWNLOAD_TOKEN_MAXLEN的缓冲区, 保留结尾的'\0' */
+        if (value_len > MQTT_DOWNLOAD_TOKEN_MAXLEN - 1) {
+            value_len = MQTT_DOWNLOAD_TOKEN_MAXLEN - 1;
+        }
         memcpy(pakcet->data.data_resp.filename, value, value_len);
     }
 
@@ -314,31 +273,227 @@ static int32_t _parse_json_header(void *handle, char *data, uint32_t data_len, a
     return res;
 }
 
-static void _md_resend_request(mqtt_download_handle_t *md_handle)
+static uint32_t _md_read_u32(uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] << 24 | (uint32_t)buffer[1] << 16 | (uint32_t)buffer[2] << 8 | buffer[3];
+}
+
+static int32_t _parse_binary_header(mqtt_download_handle_t *md_handle, uint8_t *header,
+                                    aiot_mqtt_download_recv_t *packet, uint16_t *crc16)
+{
+    uint32_t code = header[2] << 8 | header[3];
+
+    if (code != 200) {
+        core_log1(md_handle->sysdep, 0, "recv handle parse err code %d\r\n", &code);
+        return STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
+    }
+
+    packet->data.data_resp.offset = _md_read_u32(header + 4);
+    packet->data.data_resp.data_size = _md_read_u32(header + 8);
+    packet->data.data_resp.file_lenth = _md_read_u32(header + 12);
+    *crc16 = header[16] << 8 | header[17];
+    memcpy(packet->data.data_resp.filename, header + 20, MQTT_DOWNLOAD_BINARY_TOKEN_LEN);
+
+    return STATE_SUCCESS;
+}
+
+/* 解析一个数据回复, 得到回复头中的信息、文件数据的位置和实际长度, 以及回复中携带的CRC */
+static int32_t _md_parse_reply(mqtt_download_handle_t *md_handle, uint8_t *payload, uint32_t payload_len,
+                               aiot_mqtt_download_recv_t *packet, uint8_t **data, uint32_t *data_len, uint16_t *crc16)
+{
+    uint32_t header_len = 0;
+    uint8_t *crc_ptr = NULL;
+    int32_t res = STATE_SUCCESS;
+
+    if (payload_len < sizeof(uint16_t)) {
+        return STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
+    }
+    header_len = payload[0] << 8 | payload[1];
+
+    if (md_handle->binary_header != 0 && header_len == MQTT_DOWNLOAD_BINARY_MAGIC) {
+        if (payload_len < MQTT_DOWNLOAD_BINARY_HEADER_LEN) {
+            return STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
+        }
+        *data = payload + MQTT_DOWNLOAD_BINARY_HEADER_LEN;
+        *data_len = payload_len - MQTT_DOWNLOAD_BINARY_HEADER_LEN;
+        return _parse_binary_header(md_handle, payload, packet, crc16);
+    }
+
+    /* JSON格式: 头长度(2) JSON头 文件数据 crc16(2, 小端) */
+    if (payload_len < sizeof(uint16_t) + header_len + sizeof(uint16_t)) {
+        return STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
+    }
+    res = _parse_json_header(md_handle, (char *)payload + sizeof(uint16_t), header_len, packet);
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+    *data = payload + sizeof(uint16_t) + header_len;
+    *data_len = payload_len - sizeof(uint16_t) - header_len - sizeof(uint16_t);
+    crc_ptr = payload + payload_len - sizeof(uint16_t);
+    *crc16 = *crc_ptr | *(crc_ptr + 1) << 8;
+
+    return STATE_SUCCESS;
+}
+
+/* 找到offset对应的指定状态的块, 重复或过期的回复找不到等待中的块 */
+static mqtt_download_block_t *_md_find_block(mqtt_download_handle_t *md_handle, uint32_t offset, uint8_t status)
 {
-    md_handle->failed_counter++;
-    if(md_handle->failed_counter > 3) {
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < md_handle->window_size; idx++) {
+        if (md_handle->blocks[idx].status == status && md_handle->blocks[idx].offset == offset) {
+            return &md_handle->blocks[idx];
+        }
+    }
+
+    return NULL;
+}
+
+static mqtt_download_block_t *_md_idle_block(mqtt_download_handle_t *md_handle)
+{
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < md_handle->window_size; idx++) {
+        if (md_handle->blocks[idx].status == MQTT_DOWNLOAD_BLOCK_IDLE) {
+            return &md_handle->blocks[idx];
+        }
+    }
+
+    return NULL;
+}
+
+/* 按时收到回复, 每收到一个窗口的回复就把窗口加1, 窗口达到上限后改为增大块长度 */
+static void _md_adaptive_increase(mqtt_download_handle_t *md_handle, mqtt_download_block_t *block)
+{
+    uint32_t rtt = 0;
+
+    /* 重新请求过的块分不清是哪次请求的回复, 不计入往返时延 */
+    if (block->retry != 0) {
+        return;
+    }
+    rtt = (uint32_t)(md_handle->sysdep->core_sysdep_time() - block->request_time);
+    md_handle->srtt = (md_handle->srtt == 0) ? rtt : (md_handle->srtt * 7 + rtt) / 8;
+
+    if (md_handle->adaptive == 0 || ++md_handle->ack_count < md_handle->window) {
+        return;
+    }
+    md_handle->ack_count = 0;
+    if (md_handle->window < md_handle->window_size) {
+        md_handle->window++;
+    } else if (md_handle->block_size < md_handle->max_request_size) {
+        md_handle->block_size += MQTT_DOWNLOAD_ADAPTIVE_STEP;
+        if (md_handle->block_size > md_handle->max_request_size) {
+            md_handle->block_size = md_handle->max_request_size;
+        }
+    }
+}
+
+/*
+ * 超时说明链路拥塞, 窗口减半; 校验失败或窗口已经为1时块长度减半.
+ * 同一轮请求中丢失的多个块只减小一次
+ */
+static void _md_adaptive_decrease(mqtt_download_handle_t *md_handle, mqtt_download_block_t *block, uint8_t timeout)
+{
+    if (md_handle->adaptive == 0 || block->request_time < md_handle->last_decrease_time) {
+        return;
+    }
+    md_handle->last_decrease_time = md_handle->sysdep->core_sysdep_time();
+    md_handle->ack_count = 0;
+    if (timeout != 0 && md_handle->window > 1) {
+        md_handle->window /= 2;
+    } else {
+        md_handle->block_size /= 2;
+        if (md_handle->block_size < MQTT_DOWNLOAD_REQUEST_SIZE_MIN) {
+            md_handle->block_size = MQTT_DOWNLOAD_REQUEST_SIZE_MIN;
+        }
+    }
+}
+
+static void _md_request_block(mqtt_download_handle_t *md_handle, mqtt_download_block_t *block)
+{
+    block->status = MQTT_DOWNLOAD_BLOCK_WAIT;
+    block->request_time = md_handle->sysdep->core_sysdep_time();
+    md_handle->request_count++;
+    _md_send_request(md_handle, block->offset, block->size);
+}
+
+/* 只重新请求出错或超时的块, 同一个块重试次数过多时认为下载失败 */
+static void _md_retry_block(mqtt_download_handle_t *md_handle, mqtt_download_block_t *block, uint8_t timeout)
+{
+    _md_adaptive_decrease(md_handle, block, timeout);
+    block->retry++;
+    if (block->retry > MQTT_DOWNLOAD_BLOCK_RETRY_MAX) {
         md_handle->status = STATE_MQTT_DOWNLOAD_FAILED_TIMEOUT;
         return;
     }
 
-    _md_send_request(md_handle);
+    md_handle->retry_count++;
+    _md_request_block(md_handle, block);
+}
+
+/* 在窗口内还有空闲位置时继续请求后面的块 */
+static void _md_fill_window(mqtt_download_handle_t *md_handle)
+{
+    mqtt_download_block_t *block = NULL;
+    uint32_t size = 0;
+
+    while (md_handle->request_offset < md_handle->range_size && md_handle->inflight < md_handle->window) {
+        block = _md_idle_block(md_handle);
+        if (block == NULL) {
+            break;
+        }
+        size = md_handle->range_size - md_handle->request_offset;
+        size = (size < md_handle->block_size) ? size : md_handle->block_size;
+
+        block->offset = md_handle->request_offset;
+        block->size = size;
+        block->retry = 0;
+        md_handle->request_offset += size;
+        md_handle->inflight++;
+        _md_request_block(md_handle, block);
+    }
+}
+
+/* 在recv_mutex内调用, 把size_fetched处的块标记为交付中并填写回调参数 */
+static void _md_take_block(mqtt_download_handle_t *md_handle, mqtt_download_block_t *block,
+                           aiot_mqtt_download_recv_t *packet, uint8_t *data)
+{
+    block->status = MQTT_DOWNLOAD_BLOCK_DELIVER;
+    md_handle->inflight--;
+
+    packet->data.data_resp.offset = md_handle->size_fetched + md_handle->range_start;
+    packet->data.data_resp.data_size = block->size;
+    packet->data.data_resp.data = (char *)data;
+    md_handle->size_fetched += block->size;
+    packet->data.data_resp.percent = (int32_t)((uint64_t)md_handle->size_fetched * 100 / md_handle->range_size);
+}
+
+/* 在recv_mutex外调用, 同一时刻只有一个线程交付, 保证digest和回调按文件顺序进行 */
+static void _md_deliver(mqtt_download_handle_t *md_handle, aiot_mqtt_download_recv_t *packet)
+{
+    /* 计算digest, 如果下载完成, 还要看看是否与云端计算出来的一致 */
+    if (md_handle->md5_enabled) {
+        _download_digest_update(md_handle, (uint8_t *)packet->data.data_resp.data, packet->data.data_resp.data_size);
+    }
+
+    /* 回调用户接口, 通知存储数据 */
+    if (md_handle->recv_handler != NULL) {
+        md_handle->recv_handler(md_handle, packet, md_handle->userdata);
+    }
 }
 
 static void _md_recv_data_reply_handler(void *handle, const aiot_mqtt_recv_t *msg, void *userdata)
 {
     mqtt_download_handle_t *md_handle = (mqtt_download_handle_t *)userdata;
+    mqtt_download_block_t *block = NULL;
     /*有效文件数据*/
     uint8_t *data = NULL;
     uint32_t data_len = 0;
-    /*json头解析变量定义*/
-    char *header = NULL;
-    uint16_t header_len = 0;
     char file_token[MQTT_DOWNLOAD_TOKEN_MAXLEN];
     uint16_t crc16 = 0, cal_crc16 = 0;
-    uint8_t *crc_ptr = NULL;
     aiot_mqtt_download_recv_t packet;
     memset(file_token, 0, sizeof(file_token));
+    memset(&packet, 0, sizeof(aiot_mqtt_download_recv_t));
     packet.type = AIOT_MDRECV_DATA_RESP;
     packet.data.data_resp.filename = file_token;
 
@@ -346,67 +501,92 @@ static void _md_recv_data_reply_handler(void *handle, const aiot_mqtt_recv_t *ms
         return;
     }
 
-    /*获取并解析json头*/
-    header = (char *)(msg->data.pub.payload + 2);
-    header_len = *msg->data.pub.payload << 8 | *(msg->data.pub.payload + 1);
-    if(_parse_json_header(md_handle, header, header_len, &packet) < 0) {
-        _md_resend_request(md_handle);
+    /* 解析不出偏移时无法确定是哪个块, 等该块超时后重新请求 */
+    if (_md_parse_reply(md_handle, msg->data.pub.payload, msg->data.pub.payload_len, &packet, &data, &data_len,
+                        &crc16) < STATE_SUCCESS) {
+        return;
+    }
+
+    md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+    /* 重复请求可能收到同一块的多个回复, 已经收到的块直接丢弃 */
+    if (md_handle->status == STATE_MQTT_DOWNLOAD_ING) {
+        block = _md_find_block(md_handle, packet.data.data_resp.offset - md_handle->range_start, MQTT_DOWNLOAD_BLOCK_WAIT);
+    }
+    if (block == NULL) {
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
         return;
     }
 
     /* 校验数据长度 */
-    if(msg->data.pub.payload_len != sizeof(header_len) + header_len + packet.data.data_resp.data_size + sizeof(crc16)) {
+    if(data_len != packet.data.data_resp.data_size || data_len != block->size) {
         core_log(md_handle->sysdep, 0, "payload lenth dismatch data lenth\r\n");
-        _md_resend_request(md_handle);
+        _md_retry_block(md_handle, block, 0);
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
         return;
     }
 
-    /* 有效的文件数据 */
-    data = msg->data.pub.payload + sizeof(header_len) + header_len;
-    data_len = packet.data.data_resp.data_size;
-
     /* CRC校验 */
-    crc_ptr = msg->data.pub.payload + msg->data.pub.payload_len - sizeof(crc16);
-    crc16 = *crc_ptr | *(crc_ptr + 1) << 8;
-    cal_crc16 = crc_ibm(data, data_len);
+    cal_crc16 = core_crc16(data, data_len);
     if(cal_crc16 != crc16) {
-        _md_resend_request(md_handle);
+        _md_retry_block(md_handle, block, 0);
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
         return;
     }
 
-    /* 判断接收的数据偏移是否为请求的偏移,可能存在重复请求，这里校验失败，不主动重发请求，等超时 */
-    if(packet.data.data_resp.offset != md_handle->size_fetched + md_handle->range_start) {
-        return;
-    }
-
-    /* 生成回调packet包回调用户接口 */
-    md_handle->size_fetched += data_len;
-    packet.data.data_resp.data = (char *)data;
-    packet.data.data_resp.percent = md_handle->size_fetched * 100 / md_handle->range_size;
-
-    /* 计算digest, 如果下载完成, 还要看看是否与云端计算出来的一致 */
-    if(md_handle->md5_enabled) {
-        _download_digest_update(md_handle, (uint8_t *)packet.data.data_resp.data, packet.data.data_resp.data_size);
-    }
-
-    /* 数据接收成功，失败统计复位 */
-    md_handle->failed_counter = 0;
+    _md_adaptive_increase(md_handle, block);
 
-    /* 回调用户接口, 通知存储数据 */
-    if(md_handle->recv_handler != NULL) {
-        md_handle->recv_handler(md_handle, &packet, md_handle->userdata);
+    if (block->offset != md_handle->size_fetched || md_handle->delivering != 0) {
+        /* 前面还有块没有到达或者正在回调用户, 先暂存, 块长度可能变化, 缓冲区不够时重新申请 */
+        if (block->buffer != NULL && block->buffer_len < data_len) {
+            md_handle->sysdep->core_sysdep_free(block->buffer);
+            block->buffer = NULL;
+        }
+        if (block->buffer == NULL) {
+            block->buffer = md_handle->sysdep->core_sysdep_malloc(data_len, MQTT_DOWNLOAD_MODULE_NAME);
+            block->buffer_len = (block->buffer == NULL) ? 0 : data_len;
+        }
+        if (block->buffer != NULL) {
+            memcpy(block->buffer, data, data_len);
+            block->status = MQTT_DOWNLOAD_BLOCK_DONE;
+        }
+        /* 内存不足时保持等待状态, 超时后重新请求 */
+    } else {
+        /* 用户回调可能耗时较长, 也可能调用aiot_mqtt_download_get_stats, 回调时不持有recv_mutex */
+        md_handle->delivering = 1;
+        _md_take_block(md_handle, block, &packet, data);
+        while (block != NULL) {
+            /* 回调期间后续的块继续下载 */
+            _md_fill_window(md_handle);
+            md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
+            _md_deliver(md_handle, &packet);
+            md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+            block->status = MQTT_DOWNLOAD_BLOCK_IDLE;
+
+            /* 接着交付已经暂存的后续块, 包括回调期间到达的块 */
+            block = NULL;
+            if (md_handle->status == STATE_MQTT_DOWNLOAD_ING) {
+                block = _md_find_block(md_handle, md_handle->size_fetched, MQTT_DOWNLOAD_BLOCK_DONE);
+            }
+            if (block != NULL) {
+                _md_take_block(md_handle, block, &packet, block->buffer);
+            }
+        }
+        md_handle->delivering = 0;
     }
 
-    if(md_handle->size_fetched < md_handle->range_size) {
-        /*请求下一包*/
-        _md_send_request(md_handle);
+    if (md_handle->status != STATE_MQTT_DOWNLOAD_ING || md_handle->delivering != 0) {
+        /* 下载已经失败, 或者由正在交付的线程判断是否完成 */
     } else if(md_handle->size_fetched == md_handle->range_size) {
         /*下载完成, 如果有md5还需要做整个文件的校验*/
+        md_handle->stats_end_time = md_handle->sysdep->core_sysdep_time();
+        md_handle->stats_fetched = md_handle->size_fetched;
         md_handle->percent = 100;
         md_handle->status = STATE_MQTT_DOWNLOAD_FINISHED;
     } else {
-        md_handle->status = STATE_MQTT_DOWNLOAD_FAILED_RECVERROR;
+        /*请求后续的块*/
+        _md_fill_window(md_handle);
     }
+    md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
 }
 
 int32_t aiot_mqtt_download_setopt(void *handle, aiot_mqtt_download_option_t option, void *data) {
@@ -451,9 +631,46 @@ int32_t aiot_mqtt_download_setopt(void *handle, aiot_mqtt_download_option_t opti
     }
     break;
     case  AIOT_MDOPT_DATA_REQUEST_SIZE: {
+        if (*(uint32_t *)data == 0 || md_handle->blocks != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
         md_handle->request_size = *(uint32_t *)data;
     }
     break;
+    case AIOT_MDOPT_WINDOW_SIZE: {
+        if (*(uint32_t *)data == 0 || *(uint32_t *)data > MQTT_DOWNLOAD_WINDOW_SIZE_MAX || md_handle->blocks != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        md_handle->window_size = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_MDOPT_BLOCK_TIMEOUT_MS: {
+        md_handle->block_timeout_ms = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_MDOPT_ADAPTIVE: {
+        if (md_handle->blocks != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        md_handle->adaptive = *(uint8_t *)data;
+    }
+    break;
+    case AIOT_MDOPT_BINARY_HEADER: {
+        md_handle->binary_header = *(uint8_t *)data;
+    }
+    break;
+    case AIOT_MDOPT_MAX_REQUEST_SIZE: {
+        if (*(uint32_t *)data < MQTT_DOWNLOAD_REQUEST_SIZE_MIN || *(uint32_t *)data > MQTT_DOWNLOAD_REQUEST_SIZE_MAX ||
+                md_handle->blocks != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        md_handle->max_request_size = *(uint32_t *)data;
+    }
+    break;
     default: {
         res = STATE_USER_INPUT_OUT_RANGE;
     }
@@ -463,26 +680,22 @@ int32_t aiot_mqtt_download_setopt(void *handle, aiot_mqtt_download_option_t opti
     return res;
 }
 
-static int32_t _md_send_request(void *handle)
+/* 请求从相对range_start偏移offset开始, 长度为size的块 */
+static int32_t _md_send_request(mqtt_download_handle_t *md_handle, uint32_t offset, uint32_t size)
 {
-    mqtt_download_handle_t *md_handle = (mqtt_download_handle_t *)handle;
 
     char *payload_fmt = "{\"id\":\"%s\",\"version\":\"1.0\",\"params\":%s}";
-    char *params_fmt = "{\"fileToken\":\"%s\",\"fileInfo\":{\"streamId\":%s,\"fileId\":%s,},\"fileBlock\":{\"size\":%s,\"offset\":%s}}";
+    char *params_fmt = "{\"fileToken\":\"%s\",\"fileInfo\":{\"streamId\":%s,\"fileId\":%s,},\"fileBlock\":{\"size\":%s,\"offset\":%s}%s}";
     char *params = NULL, *payload = NULL, *topic = NULL;
     char stream_id_string[21], file_id_string[21], request_size_string[21], offset_string[21];
-    char *params_src[] = {"default", stream_id_string, file_id_string, request_size_string, offset_string };
+    char *params_src[] = {"default", stream_id_string, file_id_string, request_size_string, offset_string, "" };
     char id_string[21];
     char *payload_src[2] = { id_string };
     char *topic_src[2] = { id_string };
     uint32_t res = STATE_SUCCESS;
-    uint32_t offset = md_handle->size_fetched + md_handle->range_start;
+
     /* 生成params */
-    int32_t size = md_handle->request_size;
-    if(md_handle->request_size + md_handle->size_fetched > md_handle->range_size)
-    {
-        size = md_handle->range_size - md_handle->size_fetched;
-    }
+    offset += md_handle->range_start;
     memset(stream_id_string, 0, sizeof(stream_id_string));
     core_uint2str(md_handle->task_desc->stream_id, stream_id_string, NULL);
 
@@ -495,6 +708,10 @@ static int32_t _md_send_request(void *handle)
     memset(offset_string, 0, sizeof(offset_string));
     core_uint2str(offset, offset_string, NULL);
 
+    if (md_handle->binary_header != 0) {
+        params_src[5] = ",\"headerFormat\":\"binary\"";
+    }
+
     core_sprintf(md_handle->sysdep, &params, params_fmt, params_src, sizeof(params_src) / sizeof(char *),
                  MQTT_DOWNLOAD_MODULE_NAME);
 
@@ -514,7 +731,6 @@ static int32_t _md_send_request(void *handle)
     if( payload != NULL && topic != NULL) {
         res = aiot_mqtt_pub(md_handle->task_desc->mqtt_handle, topic, (uint8_t *)payload, strlen(payload), 0);
     }
-    md_handle->last_request_time = md_handle->sysdep->core_sysdep_time();
 
     if(topic != NULL) {
         md_handle->sysdep->core_sysdep_free(topic);
@@ -528,19 +744,39 @@ static int32_t _md_send_request(void *handle)
 
     return res;
 }
+
+static void _md_free_blocks(mqtt_download_handle_t *md_handle)
+{
+    uint32_t idx = 0;
+
+    if (md_handle->blocks == NULL) {
+        return;
+    }
+    for (idx = 0; idx < md_handle->window_size; idx++) {
+        if (md_handle->blocks[idx].buffer != NULL) {
+            md_handle->sysdep->core_sysdep_free(md_handle->blocks[idx].buffer);
+        }
+    }
+    md_handle->sysdep->core_sysdep_free(md_handle->blocks);
+    md_handle->blocks = NULL;
+}
+
 static int32_t _md_reset_handle(mqtt_download_handle_t *md_handle)
 {
     if(md_handle == NULL) {
         return STATE_MQTT_DOWNLOAD_MQTT_HANDLE_NULL;
     }
 
+    md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+    _md_free_blocks(md_handle);
     md_handle->msg_id = 0;
     md_handle->size_fetched = 0;
+    md_handle->request_offset = 0;
+    md_handle->inflight = 0;
     md_handle->percent = 0;
-    md_handle->last_request_time = 0;
-    md_handle->failed_counter = 0;
     md_handle->last_percent = 0;
     md_handle->range_size = 0;
+    md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
 
     return STATE_SUCCESS;
 }
@@ -550,6 +786,7 @@ int32_t aiot_mqtt_download_process(void *handle)
     mqtt_download_handle_t *md_handle = (mqtt_download_handle_t *)handle;
     int32_t percent = 0;
     int32_t res = 0;
+    uint32_t idx = 0;
     if(md_handle == NULL) {
         return STATE_MQTT_DOWNLOAD_MQTT_HANDLE_NULL;
     }
@@ -571,36 +808,70 @@ int32_t aiot_mqtt_download_process(void *handle)
             return STATE_MQTT_DOWNLOAD_FILESIZE_ERROR;
         }
 
-        /* 订阅数据返回的topic */
-        _md_sub_response_topic(md_handle);
+        /* 先申请全部内存再订阅, 申请失败后再次调用process不会重复订阅, 也不会泄漏已申请的内存 */
+        md_handle->blocks = md_handle->sysdep->core_sysdep_malloc(md_handle->window_size * sizeof(mqtt_download_block_t),
+                            MQTT_DOWNLOAD_MODULE_NAME);
+        if (NULL == md_handle->blocks) {
+            res = STATE_PORT_MALLOC_FAILED;
+            break;
+        }
+        memset(md_handle->blocks, 0, md_handle->window_size * sizeof(mqtt_download_block_t));
+
         /* 完整的文件下载做md5校验 */
         if(md_handle->range_size == md_handle->task_desc->size_total
                 && AIOT_OTA_DIGEST_MD5 == md_handle->task_desc->digest_method
                 && NULL != md_handle->task_desc->expect_digest) {
-            utils_md5_context_t *ctx = md_handle->sysdep->core_sysdep_malloc(sizeof(utils_md5_context_t), MQTT_DOWNLOAD_MODULE_NAME);
+            core_md5_context_t *ctx = md_handle->sysdep->core_sysdep_malloc(sizeof(core_md5_context_t), MQTT_DOWNLOAD_MODULE_NAME);
             if (NULL == ctx) {
+                md_handle->sysdep->core_sysdep_free(md_handle->blocks);
+                md_handle->blocks = NULL;
                 res = STATE_DOWNLOAD_SETOPT_MALLOC_MD5_CTX_FAILED;
                 break;
             }
             md_handle->md5_enabled = 1;
-            utils_md5_init(ctx);
-            utils_md5_starts(ctx);
+            core_md5_init(ctx);
+            core_md5_starts(ctx);
             md_handle->digest_ctx = (void *) ctx;
         }
 
-        _md_send_request(handle);
-        md_handle->last_request_time = md_handle->sysdep->core_sysdep_time();
+        /* 订阅数据返回的topic */
+        _md_sub_response_topic(md_handle);
+
+        /* 自适应时窗口从1开始增长, 块长度不超过上限 */
+        md_handle->window = (md_handle->adaptive != 0) ? 1 : md_handle->window_size;
+        md_handle->block_size = md_handle->request_size;
+        if (md_handle->adaptive != 0 && md_handle->block_size > md_handle->max_request_size) {
+            md_handle->block_size = md_handle->max_request_size;
+        }
+        md_handle->ack_count = 0;
+        md_handle->last_decrease_time = 0;
+        md_handle->srtt = 0;
+        md_handle->request_count = 0;
+        md_handle->retry_count = 0;
+        md_handle->stats_start_time = md_handle->sysdep->core_sysdep_time();
+        md_handle->stats_end_time = 0;
+
+        /* 先切换状态再发请求, 回复可能在其他线程中立即到达 */
+        md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
         md_handle->status = STATE_MQTT_DOWNLOAD_ING;
+        _md_fill_window(md_handle);
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
         res = STATE_MQTT_DOWNLOAD_ING;
     }
     break;
     case STATE_MQTT_DOWNLOAD_ING: {
+        /* 每个块单独计时, 超时只重新请求该块 */
         now = md_handle->sysdep->core_sysdep_time();
-        if(now - md_handle->last_request_time > MQTT_DOWNLOAD_DEFAULT_RECV_TIMEOUT) {
-            _md_resend_request(md_handle);
+        md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+        for (idx = 0; idx < md_handle->window_size && md_handle->status == STATE_MQTT_DOWNLOAD_ING; idx++) {
+            mqtt_download_block_t *block = &md_handle->blocks[idx];
+            if (block->status == MQTT_DOWNLOAD_BLOCK_WAIT && now - block->request_time > md_handle->block_timeout_ms) {
+                _md_retry_block(md_handle, block, 1);
+            }
         }
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
 
-        percent = md_handle->size_fetched * 100 / md_handle->range_size;
+        percent = (int32_t)((uint64_t)md_handle->size_fetched * 100 / md_handle->range_size);
         if(percent - md_handle->last_percent >= MQTT_DOWNLOAD_REPORT_INTERNEL) {
             md_handle->last_percent = percent;
             _download_report_progress(md_handle, percent);
@@ -618,7 +889,7 @@ int32_t aiot_mqtt_download_process(void *handle)
                 core_log(md_handle->sysdep, STATE_OTA_DIGEST_MATCH, "digest matched\r\n");
             }
             if (NULL != md_handle->digest_ctx) {
-                utils_md5_free(md_handle->digest_ctx);
+                core_md5_free(md_handle->digest_ctx);
                 md_handle->sysdep->core_sysdep_free(md_handle->digest_ctx);
                 md_handle->digest_ctx = NULL;
             }
@@ -628,6 +899,9 @@ int32_t aiot_mqtt_download_process(void *handle)
     }
     break;
     case STATE_MQTT_DOWNLOAD_SUCCESS: {
+        aiot_mqtt_download_stats_t stats;
+        aiot_mqtt_download_get_stats(md_handle, &stats);
+        core_log1(md_handle->sysdep, STATE_MQTT_DOWNLOAD_SUCCESS, "goodput %d Bytes/s\r\n", &stats.goodput);
         _download_report_progress(md_handle, 100);
         _md_reset_handle(md_handle);
         md_handle->status = STATE_MQTT_DOWNLOAD_INIT;
@@ -642,6 +916,13 @@ int32_t aiot_mqtt_download_process(void *handle)
 
     case STATE_MQTT_DOWNLOAD_FAILED_RECVERROR:
     case STATE_MQTT_DOWNLOAD_FAILED_TIMEOUT: {
+        /* 接收线程还在回调用户时不能释放块缓冲区, 等下次process再处理 */
+        md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+        idx = md_handle->delivering;
+        md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
+        if (idx != 0) {
+            break;
+        }
         _download_report_progress(md_handle, AIOT_OTAERR_BURN_FAILED);
         _md_reset_handle(md_handle);
         md_handle->status = STATE_MQTT_DOWNLOAD_INIT;
@@ -649,4 +930,34 @@ int32_t aiot_mqtt_download_process(void *handle)
     break;
     }
     return res;
-}
\ No newline at end of file
+}
+
+int32_t aiot_mqtt_download_get_stats(void *handle, aiot_mqtt_download_stats_t *stats)
+{
+    mqtt_download_handle_t *md_handle = (mqtt_download_handle_t *)handle;
+    uint64_t end_time = 0;
+
+    if (md_handle == NULL || stats == NULL) {
+        return STATE_MQTT_DOWNLOAD_MQTT_HANDLE_NULL;
+    }
+
+    memset(stats, 0, sizeof(aiot_mqtt_download_stats_t));
+    md_handle->sysdep->core_sysdep_mutex_lock(md_handle->recv_mutex);
+    if (md_handle->stats_start_time != 0) {
+        end_time = (md_handle->stats_end_time != 0) ? md_handle->stats_end_time : md_handle->sysdep->core_sysdep_time();
+        stats->elapsed_ms = end_time - md_handle->stats_start_time;
+    }
+    /* 下载完成后句柄会被复位, 使用完成时记录的长度 */
+    stats->fetched_bytes = (md_handle->stats_end_time != 0) ? md_handle->stats_fetched : md_handle->size_fetched;
+    stats->request_count = md_handle->request_count;
+    stats->retry_count = md_handle->retry_count;
+    stats->block_size = md_handle->block_size;
+    stats->window = md_handle->window;
+    stats->rtt_ms = md_handle->srtt;
+    md_handle->sysdep->core_sysdep_mutex_unlock(md_handle->recv_mutex);
+    if (stats->elapsed_ms != 0) {
+        stats->goodput = (uint32_t)((uint64_t)stats->fetched_bytes * 1000 / stats->elapsed_ms);
+    }
+
+    return STATE_SUCCESS;
+}
@@ -139,6 +139,34 @@ typedef struct {
 typedef void (* aiot_mqtt_download_recv_handler_t)(void *handle,
         const aiot_mqtt_download_recv_t *packet, void *userdata);
 
+/**
+ * @brief 下载过程的统计信息, 通过@ref aiot_mqtt_download_get_stats 获取
+ */
+typedef struct {
+    /**
+     * @brief 从开始请求到下载完成(或当前)经过的时间, 单位ms
+     */
+    uint64_t elapsed_ms;
+    /**
+     * @brief 按顺序交给用户的字节数, 以及对应的有效吞吐量, 单位Bytes/s
+     */
+    uint32_t fetched_bytes;
+    uint32_t goodput;
+    /**
+     * @brief 发出的块请求数, 其中因超时或校验失败重新请求的次数
+     */
+    uint32_t request_count;
+    uint32_t retry_count;
+    /**
+     * @brief 当前的块长度和窗口
+     */
+    uint32_t block_size;
+    uint32_t window;
+    /**
+     * @brief 平滑后的往返时延, 单位ms
+     */
+    uint32_t rtt_ms;
+} aiot_mqtt_download_stats_t;
 
 /**
  * @brief @ref aiot_mqtt_download_setopt 接口的option参数可选值.
@@ -151,6 +179,9 @@ typedef enum {
      *
      * @details
      *
+     * 回调在MQTT接收线程中按文件顺序调用, 调用时不持有模块内部的锁, 可以在回调中调用@ref aiot_mqtt_download_get_stats ,
+     * 但不能在回调中调用@ref aiot_mqtt_download_deinit
+     *
      * 数据类型: (aiot_mqtt_download_recv_handler_t)
      */
     AIOT_MDOPT_RECV_HANDLE,
@@ -223,6 +254,66 @@ typedef enum {
     */
     AIOT_MDOPT_DATA_REQUEST_SIZE,
 
+    /**
+    * @brief 同时等待回复的请求数
+    *
+    * @details
+    *
+    * 取值为1时, 收到一块数据的回复后才请求下一块, 下载速度约为 请求长度 / 往返时延.
+    * 取值大于1时, 连续发出多个块的请求, 先到达的靠后的块暂存起来, 仍按文件顺序交给用户.
+    * 某个块超时未收到回复时只重新请求该块, 同一个块重试3次仍失败时下载失败
+    *
+    * 额外占用的内存最多为 窗口大小 * @ref AIOT_MDOPT_DATA_REQUEST_SIZE
+    *
+    * 数据类型: (uint32_t *) 默认值: 1, 取值范围: 1~16
+    */
+    AIOT_MDOPT_WINDOW_SIZE,
+
+    /**
+    * @brief 单个块请求等待回复的超时时间
+    *
+    * @details
+    *
+    * 数据类型: (uint32_t *) 默认值: (10 * 1000) ms
+    */
+    AIOT_MDOPT_BLOCK_TIMEOUT_MS,
+
+    /**
+    * @brief 是否根据回复情况自动调整块长度和窗口
+    *
+    * @details
+    *
+    * 开启后窗口从1开始, 每按时收到一个窗口的回复就把窗口加1, 窗口达到 @ref AIOT_MDOPT_WINDOW_SIZE 后改为把块长度增加1KB,
+    * 块长度不超过 @ref AIOT_MDOPT_MAX_REQUEST_SIZE. 块超时时窗口减半, 窗口已经为1时块长度减半, 长度或CRC校验失败时块长度减半.
+    * @ref AIOT_MDOPT_DATA_REQUEST_SIZE 为初始的块长度
+    *
+    * 额外占用的内存最多为 @ref AIOT_MDOPT_WINDOW_SIZE * @ref AIOT_MDOPT_MAX_REQUEST_SIZE
+    *
+    * 数据类型: (uint8_t *) 默认值: 0, 不调整
+    */
+    AIOT_MDOPT_ADAPTIVE,
+
+    /**
+    * @brief 自适应调整时块长度的上限, 应不超过云端对单个分块的限制
+    *
+    * @details
+    *
+    * 数据类型: (uint32_t *) 默认值: (32 * 1024), 取值范围: 256~(128 * 1024)
+    */
+    AIOT_MDOPT_MAX_REQUEST_SIZE,
+
+    /**
+    * @brief 请求云端使用紧凑的二进制格式回复数据
+    *
+    * @details
+    *
+    * 开启后请求中会带上"headerFormat":"binary", 云端支持时回复头为固定格式的二进制字段, 不需要解析JSON.
+    * 云端不支持时仍按JSON格式回复, 两种格式都可以正常接收
+    *
+    * 数据类型: (uint8_t *) 默认值: 0, 使用JSON格式
+    */
+    AIOT_MDOPT_BINARY_HEADER,
+
     AIOT_MDOPT_MAX,
 } aiot_mqtt_download_option_t;
 
@@ -279,6 +370,18 @@ int32_t aiot_mqtt_download_deinit(void **handle);
  */
 int32_t aiot_mqtt_download_process(void *handle);
 
+/**
+ * @brief 获取下载的有效吞吐量和当前的块长度、窗口
+ *
+ * @param[in] handle mqtt_download句柄
+ * @param[out] stats 统计信息, 更多信息请参考@ref aiot_mqtt_download_stats_t
+ *
+ * @return int32_t
+ * @retval STATE_SUCCESS 获取成功
+ * @retval STATE_MQTT_DOWNLOAD_MQTT_HANDLE_NULL handle或stats为空
+ */
+int32_t aiot_mqtt_download_get_stats(void *handle, aiot_mqtt_download_stats_t *stats);
+
 
 
 #if defined(__cplusplus)
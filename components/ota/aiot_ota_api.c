@@ -11,21 +11,35 @@
 #include "core_mqtt.h"
 #include "core_string.h"
 #include "core_sha256.h"
-#include "ota_md5.h"
+#include "core_md5.h"
 #include "ota_private.h"
 #include "core_log.h"
 #include "core_global.h"
 
 static int32_t _ota_subscribe(void *mqtt_handle, void *ota_handle);
 static void    _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void *userdata);
-static int32_t _ota_parse_json(aiot_sysdep_portfile_t *sysdep, void *in, uint32_t in_len, char *key_word, char **out);
+static int32_t _ota_parse_json(aiot_sysdep_portfile_t *sysdep, const core_json_index_t *index, void *in,
+                               uint32_t in_len, char *key_word, char **out);
 static void    _http_recv_handler(void *handle, const aiot_http_recv_t *recv_data, void *userdata);
 static int32_t _ota_parse_list_array(char *str, int32_t str_len, ota_list_json *array);
-static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, char *data, uint32_t data_len,
-                                    int type, aiot_download_task_desc_t *task_desc, ota_handle_t *ota_handle);
+static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, const core_json_index_t *index, char *data,
+                                    uint32_t data_len, int type, aiot_download_task_desc_t *task_desc,
+                                    ota_handle_t *ota_handle);
 static int32_t _download_parse_url(aiot_sysdep_portfile_t *sysdep, const char *url, char **host, char **path);
 static int32_t _download_digest_update(download_handle_t *download_handle, uint8_t *buffer, uint32_t buffer_len);
 static int32_t _download_digest_verify(download_handle_t *download_handle);
+static void    _download_digest_flush(download_handle_t *download_handle);
+static download_digest_buffer_t *_download_digest_take(download_handle_t *download_handle);
+static int32_t _download_digest_hash(download_handle_t *download_handle, download_digest_buffer_t *digest_buffer);
+static void    _download_digest_free(download_handle_t *download_handle);
+static void    _download_buffer_adapt(download_handle_t *download_handle, void *http_handle, int32_t res);
+static int32_t _download_checkpoint_restore(download_handle_t *download_handle,
+        const aiot_download_checkpoint_t *checkpoint);
+static int32_t _download_range_header(aiot_sysdep_portfile_t *sysdep, uint32_t start, uint32_t end, char **header);
+static void    _download_segment_free(download_handle_t *download_handle);
+static void    _download_stats_add(download_handle_t *download_handle, uint64_t *field, uint64_t value);
+static int32_t _download_segment_start(download_handle_t *download_handle);
+static int32_t _download_segment_recv(download_handle_t *download_handle);
 static void   *_download_deep_copy_base(aiot_sysdep_portfile_t *sysdep, char *in);
 
 static aiot_mqtt_topic_map_t g_ota_topic_map[OTA_TOPIC_NUM];
@@ -176,8 +190,12 @@ void *aiot_download_init(void)
     }
     memset(download_handle, 0, sizeof(download_handle_t));
     download_handle->sysdep = sysdep;
+    download_handle->segment_num = OTA_DEFAULT_SEGMENT_NUM;
+    download_handle->segment_size = OTA_DEFAULT_SEGMENT_SIZE;
+    download_handle->checkpoint_interval = OTA_DEFAULT_CHECKPOINT_INTERVAL;
     download_handle->data_mutex = sysdep->core_sysdep_mutex_init();
     download_handle->recv_mutex = sysdep->core_sysdep_mutex_init();
+    download_handle->digest_mutex = sysdep->core_sysdep_mutex_init();
 
     http_handle = core_http_init();
     if (NULL == http_handle) {
@@ -206,6 +224,8 @@ int32_t aiot_download_deinit(void **handle)
 
     download_handle_t *download_handle = *(download_handle_t **)(handle);
     aiot_sysdep_portfile_t *sysdep = download_handle->sysdep;
+    _download_segment_free(download_handle);
+    _download_digest_free(download_handle);
     core_http_deinit(&(download_handle->http_handle));
 
     if (NULL != download_handle->task_desc) {
@@ -216,7 +236,7 @@ int32_t aiot_download_deinit(void **handle)
             }
         } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
             if (NULL != download_handle->digest_ctx) {
-                utils_md5_free(download_handle->digest_ctx);
+                core_md5_free(download_handle->digest_ctx);
                 sysdep->core_sysdep_free(download_handle->digest_ctx);
             }
         }
@@ -226,6 +246,7 @@ int32_t aiot_download_deinit(void **handle)
 
     sysdep->core_sysdep_mutex_deinit(&(download_handle->data_mutex));
     sysdep->core_sysdep_mutex_deinit(&(download_handle->recv_mutex));
+    sysdep->core_sysdep_mutex_deinit(&(download_handle->digest_mutex));
     sysdep->core_sysdep_free(download_handle);
     *handle = NULL;
     return res;
@@ -266,7 +287,11 @@ int32_t aiot_download_setopt(void *handle, aiot_download_option_t option, void *
     }
     break;
     case AIOT_DLOPT_TASK_DESC: {
-        void *new_task_desc = _download_deep_copy_task_desc(sysdep, data);
+        void *new_task_desc = NULL;
+
+        /* 上一个任务还在排队的内容要计算到旧的digest上下文中 */
+        _download_digest_flush(download_handle);
+        new_task_desc = _download_deep_copy_task_desc(sysdep, data);
         if (NULL == new_task_desc) {
             res = STATE_DOWNLOAD_SETOPT_COPIED_DATA_IS_NULL;
             break;
@@ -283,16 +308,24 @@ int32_t aiot_download_setopt(void *handle, aiot_download_option_t option, void *
             core_sha256_starts(ctx);
             download_handle->digest_ctx = (void *) ctx;
         } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
-            utils_md5_context_t *ctx = sysdep->core_sysdep_malloc(sizeof(utils_md5_context_t), OTA_MODULE_NAME);
+            core_md5_context_t *ctx = sysdep->core_sysdep_malloc(sizeof(core_md5_context_t), OTA_MODULE_NAME);
             if (NULL == ctx) {
                 res = STATE_DOWNLOAD_SETOPT_MALLOC_MD5_CTX_FAILED;
                 break;
             }
-            utils_md5_init(ctx);
-            utils_md5_starts(ctx);
+            core_md5_init(ctx);
+            core_md5_starts(ctx);
             download_handle->digest_ctx = (void *) ctx;
         }
         download_handle->download_status = DOWNLOAD_STATUS_START;
+        download_handle->segment_checked = 0;
+        download_handle->segment_disabled = 0;
+        sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+        memset(&download_handle->stats, 0, sizeof(aiot_download_stats_t));
+        download_handle->stats_start_time = sysdep->core_sysdep_time();
+        sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+        download_handle->deliver_stage_ms = 0;
+        download_handle->checkpoint_offset = 0;
     }
     break;
     case  AIOT_DLOPT_RANGE_START: {
@@ -313,6 +346,54 @@ int32_t aiot_download_setopt(void *handle, aiot_download_option_t option, void *
         res = core_http_setopt(download_handle->http_handle, CORE_HTTPOPT_BODY_BUFFER_MAX_LEN, data);
     }
     break;
+    case AIOT_DLOPT_SEGMENT_NUM: {
+        if (*(uint32_t *)data == 0 || *(uint32_t *)data > OTA_SEGMENT_NUM_MAX || download_handle->segments != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        download_handle->segment_num = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_DLOPT_SEGMENT_SIZE: {
+        if (*(uint32_t *)data == 0 || download_handle->segments != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        download_handle->segment_size = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_DLOPT_BODY_BUFFER_ADAPTIVE_MAX_LEN: {
+        if (*(uint32_t *)data > OTA_ADAPTIVE_BUFLEN_MAX) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        download_handle->adaptive_max_len = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_DLOPT_DIGEST_ASYNC: {
+        if (*(uint8_t *)data > 1 || download_handle->digest_buffer[0].buffer != NULL) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        download_handle->digest_async = *(uint8_t *)data;
+    }
+    break;
+    case AIOT_DLOPT_CHECKPOINT_HANDLER: {
+        download_handle->checkpoint_handler = (aiot_download_checkpoint_handler_t)data;
+    }
+    break;
+    case AIOT_DLOPT_CHECKPOINT_INTERVAL: {
+        if (*(uint32_t *)data == 0) {
+            res = STATE_USER_INPUT_OUT_RANGE;
+            break;
+        }
+        download_handle->checkpoint_interval = *(uint32_t *)data;
+    }
+    break;
+    case AIOT_DLOPT_CHECKPOINT_RESUME: {
+        res = _download_checkpoint_restore(download_handle, (aiot_download_checkpoint_t *)data);
+    }
+    break;
     default: {
         res = STATE_USER_INPUT_OUT_RANGE;
     }
@@ -477,6 +558,7 @@ int32_t aiot_download_recv(void *handle)
     download_handle_t *download_handle = (download_handle_t *)handle;
     aiot_sysdep_portfile_t *sysdep = NULL;
     void *http_handle = NULL;
+    uint64_t timestart = 0, stage_ms = 0;
 
     if (NULL == download_handle) {
         return STATE_DOWNLOAD_RECV_HANDLE_IS_NULL;
@@ -485,6 +567,8 @@ int32_t aiot_download_recv(void *handle)
     sysdep = download_handle->sysdep;
 
     sysdep->core_sysdep_mutex_lock(download_handle->recv_mutex);
+    timestart = sysdep->core_sysdep_time();
+    stage_ms = download_handle->deliver_stage_ms;
     switch (download_handle->download_status) {
     case DOWNLOAD_STATUS_RENEWAL: {
         /* 下载中断, 发起断点续传 */
@@ -495,8 +579,14 @@ int32_t aiot_download_recv(void *handle)
     }
     break;
     case DOWNLOAD_STATUS_FETCH: {
+        if (download_handle->segments != NULL) {
+            res = _download_segment_recv(download_handle);
+            break;
+        }
+
         /* 去网络收取报文, 并将各种状态值反馈给用户 */
         res = core_http_recv(http_handle);
+        _download_buffer_adapt(download_handle, http_handle, res);
 
         /* 全部固件下载完成 */
         if (download_handle->size_fetched == download_handle->task_desc->size_total) {
@@ -543,10 +633,51 @@ int32_t aiot_download_recv(void *handle)
     default:
         break;
     }
+    /* 交付阶段的耗时单独统计, 剩下的是在协议栈中接收和解密的时间 */
+    _download_stats_add(download_handle, &download_handle->stats.recv_time_ms,
+                        (sysdep->core_sysdep_time() - timestart) - (download_handle->deliver_stage_ms - stage_ms));
     sysdep->core_sysdep_mutex_unlock(download_handle->recv_mutex);
     return res;
 }
 
+int32_t aiot_download_digest_process(void *handle)
+{
+    download_handle_t *download_handle = (download_handle_t *)handle;
+    download_digest_buffer_t *digest_buffer = NULL;
+
+    if (NULL == download_handle) {
+        return STATE_DOWNLOAD_DIGEST_HANDLE_IS_NULL;
+    }
+
+    digest_buffer = _download_digest_take(download_handle);
+    if (digest_buffer == NULL) {
+        return STATE_SUCCESS;
+    }
+
+    return _download_digest_hash(download_handle, digest_buffer);
+}
+
+int32_t aiot_download_get_stats(void *handle, aiot_download_stats_t *stats)
+{
+    download_handle_t *download_handle = (download_handle_t *)handle;
+    aiot_sysdep_portfile_t *sysdep = NULL;
+
+    if (NULL == download_handle || NULL == stats) {
+        return STATE_DOWNLOAD_DIGEST_HANDLE_IS_NULL;
+    }
+    sysdep = download_handle->sysdep;
+
+    /* 接收线程和计算digest的用户线程都会更新统计, 统一在digest_mutex内读写 */
+    sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    memcpy(stats, &download_handle->stats, sizeof(aiot_download_stats_t));
+    stats->elapsed_ms = (download_handle->stats_start_time == 0) ? 0 :
+                        sysdep->core_sysdep_time() - download_handle->stats_start_time;
+    sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+    stats->buffer_len = ((core_http_handle_t *)download_handle->http_handle)->body_buffer_max_len;
+
+    return STATE_SUCCESS;
+}
+
 
 /* 对aiot_download_task_desc_t结构体里面的指针所指向的内容进行深度释放 */
 int32_t _download_deep_free_task_desc(aiot_sysdep_portfile_t *sysdep, void *data)
@@ -674,6 +805,8 @@ void _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void
     uint32_t files_len = 0;
     ota_type_t type;
     aiot_download_task_desc_t task_desc = {0};
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
 
     if (AIOT_MQTTRECV_PUB != packet->type) {
         return;
@@ -701,34 +834,36 @@ void _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void
     if (OTA_TYPE_CONFIG_PUSH == type) {
         key = "params";
     }
-    res = core_json_value((const char *)(packet->data.pub.payload), packet->data.pub.payload_len,
-                          key, strlen(key), &data, &data_len);
+    /* 报文只扫描一次, 后续各字段都在索引上查找 */
+    core_json_index(&index, (const char *)(packet->data.pub.payload), packet->data.pub.payload_len, tokens,
+                    CORE_JSON_INDEX_TOKENS);
+    res = core_json_index_value(&index, key, strlen(key), &data, &data_len);
     if (res != STATE_SUCCESS) {
         goto exit;
     }
 
     if (OTA_TYPE_FOTA == type) {
         /* 对于FOTA来说, 版本有关的关键字是version */
-        if ((STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, "version", &(task_desc.version)))) {
+        if ((STATE_SUCCESS != _ota_parse_json(sysdep, &index, data, data_len, "version", &(task_desc.version)))) {
             goto exit;
         }
     } else {
         /* 对于COTA来说, 版本有关的关键字是configId */
-        if (STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, "configId", &(task_desc.version))) {
+        if (STATE_SUCCESS != _ota_parse_json(sysdep, &index, data, data_len, "configId", &(task_desc.version))) {
             goto exit;
         }
     }
 
-    if ((STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, "signMethod", &(digest_method_string)))) {
+    if ((STATE_SUCCESS != _ota_parse_json(sysdep, &index, data, data_len, "signMethod", &(digest_method_string)))) {
         goto exit;
     }
 
     task_desc.protocol_type = AIOT_OTA_PROTOCOL_HTTPS;
-    if ((STATE_SUCCESS == _ota_parse_json(sysdep, data, data_len, "dProtocol", &(protocol_type_string)))) {
+    if ((STATE_SUCCESS == _ota_parse_json(sysdep, &index, data, data_len, "dProtocol", &(protocol_type_string)))) {
         if (strcmp(protocol_type_string, "mqtt") == 0) {
             task_desc.protocol_type = AIOT_OTA_PROTOCOL_MQTT;
         }
-        if(STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, "streamId", &(protocol_streamid_string))) {
+        if(STATE_SUCCESS != _ota_parse_json(sysdep, &index, data, data_len, "streamId", &(protocol_streamid_string))) {
             res = STATE_OTA_PARSE_JSON_ERROR;
             goto exit;
         }
@@ -745,13 +880,13 @@ void _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void
     }
 
     /* module字段, 并非必选(用户可能没有在云端设置过, 因此如果没有解析出来, 也不能算解析失败 */
-    _ota_parse_json(sysdep, data, data_len, "module", &(task_desc.module));
-    _ota_parse_json(sysdep, data, data_len, "extData", &(task_desc.extra_data));
+    _ota_parse_json(sysdep, &index, data, data_len, "module", &(task_desc.module));
+    _ota_parse_json(sysdep, &index, data, data_len, "extData", &(task_desc.extra_data));
 
 
     /* 多文件下载的情况 */
-    if (STATE_SUCCESS == core_json_value((const char *)(data), data_len,
-                                         "files", strlen("files"), &files, &files_len)) {
+    if (STATE_SUCCESS == core_json_index_scope_value(&index, data, data_len, "files", strlen("files"), &files,
+            &files_len)) {
 
         uint32_t offset = files - data;
         uint32_t files_len = data_len - offset;
@@ -762,7 +897,8 @@ void _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void
         for (cnt = 0; cnt < num; cnt++) {
             task_desc.file_id = cnt;
             task_desc.file_num = num;
-            int32_t ret = _process_single_file(sysdep, array[cnt].pos, array[cnt].len, type, &task_desc, ota_handle);
+            int32_t ret = _process_single_file(sysdep, &index, array[cnt].pos, array[cnt].len, type, &task_desc,
+                                               ota_handle);
             if (ret != STATE_SUCCESS) {
                 break;
             }
@@ -773,7 +909,7 @@ void _ota_mqtt_process(void *handle, const aiot_mqtt_recv_t *const packet, void
     /* 单文件下载的情况 */
     task_desc.file_id = 0;
     task_desc.file_num = 1;
-    _process_single_file(sysdep, data, data_len, type, &task_desc, ota_handle);
+    _process_single_file(sysdep, &index, data, data_len, type, &task_desc, ota_handle);
 
 exit:
     if (NULL != digest_method_string) {
@@ -788,8 +924,9 @@ exit:
     _download_deep_free_task_desc(sysdep, (void *)(&task_desc));
 }
 
-static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, char *data, uint32_t data_len,
-                                    int type, aiot_download_task_desc_t *task_desc, ota_handle_t *ota_handle)
+static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, const core_json_index_t *index, char *data,
+                                    uint32_t data_len, int type, aiot_download_task_desc_t *task_desc,
+                                    ota_handle_t *ota_handle)
 {
     char *size_string = NULL, *fileid_string = NULL;
     uint32_t size = 0;
@@ -814,20 +951,20 @@ static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, char *data,
         sign_key = "sign";
     }
 
-    if ((STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, size_key, &size_string))
-            || (STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, sign_key, &(task_desc->expect_digest)))) {
+    if ((STATE_SUCCESS != _ota_parse_json(sysdep, index, data, data_len, size_key, &size_string))
+            || (STATE_SUCCESS != _ota_parse_json(sysdep, index, data, data_len, sign_key, &(task_desc->expect_digest)))) {
         ret = STATE_OTA_PARSE_JSON_ERROR;
         goto exit;
     }
 
     /* 解析文件下载信息 */
     if(task_desc->protocol_type == AIOT_OTA_PROTOCOL_HTTPS) {
-        if(STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, url_key, &(task_desc->url))) {
+        if(STATE_SUCCESS != _ota_parse_json(sysdep, index, data, data_len, url_key, &(task_desc->url))) {
             ret = STATE_OTA_PARSE_JSON_ERROR;
             goto exit;
         }
     } else if(task_desc->protocol_type == AIOT_OTA_PROTOCOL_MQTT) {
-        if(STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, stream_file_id, &(fileid_string))) {
+        if(STATE_SUCCESS != _ota_parse_json(sysdep, index, data, data_len, stream_file_id, &(fileid_string))) {
             ret = STATE_OTA_PARSE_JSON_ERROR;
             goto exit;
         }
@@ -837,7 +974,7 @@ static int32_t _process_single_file(aiot_sysdep_portfile_t *sysdep, char *data,
     }
 
     /* 对于多文件下载的情况, 即有指定fileName这个字段的情况, 则要求解析出来,否则为非法格式 */
-    if (NULL != name_key && STATE_SUCCESS != _ota_parse_json(sysdep, data, data_len, name_key, &(task_desc->file_name))) {
+    if (NULL != name_key && STATE_SUCCESS != _ota_parse_json(sysdep, index, data, data_len, name_key, &(task_desc->file_name))) {
         ret = STATE_OTA_PARSE_JSON_ERROR;
         goto exit;
     }
@@ -925,6 +1062,22 @@ static int32_t _download_parse_url(aiot_sysdep_portfile_t *sysdep, const char *u
     return STATE_SUCCESS;
 }
 
+/* 生成请求[start, end]字节范围的header */
+static int32_t _download_range_header(aiot_sysdep_portfile_t *sysdep, uint32_t start, uint32_t end, char **header)
+{
+    uint8_t start_string_len = 0, end_string_len = 0;
+    char start_string[OTA_MAX_DIGIT_NUM_OF_UINT32] = {0};
+    char end_string[OTA_MAX_DIGIT_NUM_OF_UINT32] = {0};
+    char *src[] = { "Accept: text/html, application/xhtml+xml, application/xml;q=0.9, */*;q=0.8\r\nRange: bytes=",
+                    start_string, "-", end_string
+                  };
+
+    core_int2str(start, start_string, &start_string_len);
+    core_int2str(end, end_string, &end_string_len);
+
+    return core_sprintf(sysdep, header, "%s%s%s%s\r\n", src, sizeof(src) / sizeof(char *), OTA_MODULE_NAME);
+}
+
 int32_t _download_generate_header_string(download_handle_t *download_handle, char **header)
 {
     uint32_t range_start = download_handle->range_start;
@@ -991,6 +1144,19 @@ int32_t aiot_download_send_request(void *handle)
     if (NULL == download_handle->task_desc->url) {
         return STATE_DOWNLOAD_REQUEST_URL_IS_NULL;
     }
+
+    /* 分段并行下载, 服务端不支持Range时退回单连接下载 */
+    if (download_handle->segment_num > 1 && download_handle->segment_disabled == 0) {
+        res = _download_segment_start(download_handle);
+        if (res == STATE_SUCCESS) {
+            download_handle->download_status = DOWNLOAD_STATUS_FETCH;
+            aiot_download_report_progress(download_handle, download_handle->percent);
+        } else {
+            download_handle->download_status = DOWNLOAD_STATUS_START;
+        }
+        return res;
+    }
+
     res = _download_parse_url(download_handle->sysdep, download_handle->task_desc->url, &host, &path);
     if (res != STATE_SUCCESS) {
         goto exit;
@@ -1037,16 +1203,283 @@ exit:
     return res;
 }
 
+static void _download_stats_add(download_handle_t *download_handle, uint64_t *field, uint64_t value)
+{
+    download_handle->sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    *field += value;
+    download_handle->sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+}
+
 /* 根据下载到的固件的内容, 计算其digest值 */
-static int32_t _download_digest_update(download_handle_t *download_handle, uint8_t *buffer, uint32_t buffer_len)
+static void _download_digest_compute(download_handle_t *download_handle, uint8_t *buffer, uint32_t buffer_len)
 {
-    int32_t res = STATE_SUCCESS;
+    aiot_sysdep_portfile_t *sysdep = download_handle->sysdep;
+    uint64_t timestart = sysdep->core_sysdep_time();
+
     if (AIOT_OTA_DIGEST_SHA256 == download_handle->task_desc->digest_method) {
         core_sha256_update(download_handle->digest_ctx, buffer, buffer_len);
     } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
-        res = utils_md5_update(download_handle->digest_ctx, buffer, buffer_len);
+        core_md5_update(download_handle->digest_ctx, buffer, buffer_len);
     }
-    return res;
+
+    sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    download_handle->stats.digest_bytes += buffer_len;
+    download_handle->stats.digest_time_ms += sysdep->core_sysdep_time() - timestart;
+    sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+}
+
+/* 取出下一个待计算的缓冲区, 有缓冲区正在计算时返回NULL, 以保证按固件顺序计算 */
+static download_digest_buffer_t *_download_digest_take(download_handle_t *download_handle)
+{
+    download_digest_buffer_t *digest_buffer = NULL;
+
+    download_handle->sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    if (download_handle->digest_buffer[download_handle->digest_next].status == DOWNLOAD_DIGEST_BUFFER_READY) {
+        digest_buffer = &download_handle->digest_buffer[download_handle->digest_next];
+        digest_buffer->status = DOWNLOAD_DIGEST_BUFFER_BUSY;
+    }
+    download_handle->sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+
+    return digest_buffer;
+}
+
+static int32_t _download_digest_hash(download_handle_t *download_handle, download_digest_buffer_t *digest_buffer)
+{
+    int32_t len = (int32_t)digest_buffer->len;
+
+    _download_digest_compute(download_handle, digest_buffer->buffer, digest_buffer->len);
+
+    download_handle->sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    digest_buffer->len = 0;
+    digest_buffer->status = DOWNLOAD_DIGEST_BUFFER_FREE;
+    download_handle->digest_next = (download_handle->digest_next + 1) % OTA_DIGEST_BUFFER_NUM;
+    download_handle->sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+
+    return len;
+}
+
+/* 等待指定的缓冲区空闲, 用户线程没有及时取走时由接收线程自行计算 */
+static void _download_digest_wait(download_handle_t *download_handle, download_digest_buffer_t *digest_buffer)
+{
+    download_digest_buffer_t *ready = NULL;
+    uint8_t status = DOWNLOAD_DIGEST_BUFFER_FREE;
+
+    while (1) {
+        download_handle->sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+        status = digest_buffer->status;
+        download_handle->sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+        if (status == DOWNLOAD_DIGEST_BUFFER_FREE) {
+            break;
+        }
+        ready = _download_digest_take(download_handle);
+        if (ready != NULL) {
+            _download_digest_hash(download_handle, ready);
+        } else {
+            download_handle->sysdep->core_sysdep_sleep(1);
+        }
+    }
+}
+
+static void _download_digest_submit(download_handle_t *download_handle)
+{
+    download_handle->sysdep->core_sysdep_mutex_lock(download_handle->digest_mutex);
+    download_handle->digest_buffer[download_handle->digest_fill].status = DOWNLOAD_DIGEST_BUFFER_READY;
+    download_handle->digest_fill = (download_handle->digest_fill + 1) % OTA_DIGEST_BUFFER_NUM;
+    download_handle->sysdep->core_sysdep_mutex_unlock(download_handle->digest_mutex);
+}
+
+static int32_t _download_digest_alloc(download_handle_t *download_handle)
+{
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < OTA_DIGEST_BUFFER_NUM; idx++) {
+        download_handle->digest_buffer[idx].buffer = download_handle->sysdep->core_sysdep_malloc(OTA_DIGEST_BUFFER_LEN,
+                DOWNLOAD_MODULE_NAME);
+        if (download_handle->digest_buffer[idx].buffer == NULL) {
+            _download_digest_free(download_handle);
+            return STATE_SYS_DEPEND_MALLOC_FAILED;
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+static void _download_digest_free(download_handle_t *download_handle)
+{
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < OTA_DIGEST_BUFFER_NUM; idx++) {
+        if (download_handle->digest_buffer[idx].buffer != NULL) {
+            download_handle->sysdep->core_sysdep_free(download_handle->digest_buffer[idx].buffer);
+        }
+    }
+    memset(download_handle->digest_buffer, 0, sizeof(download_handle->digest_buffer));
+    download_handle->digest_fill = 0;
+    download_handle->digest_next = 0;
+}
+
+/* 异步计算时先把内容拷贝到正在填充的缓冲区, 填满后交给用户线程 */
+static int32_t _download_digest_update(download_handle_t *download_handle, uint8_t *buffer, uint32_t buffer_len)
+{
+    download_digest_buffer_t *digest_buffer = NULL;
+    uint32_t len = 0;
+
+    /* 分配不到缓冲区时退回到直接计算, 此时队列为空, 不影响计算顺序 */
+    if (download_handle->digest_async == 1 && download_handle->digest_buffer[0].buffer == NULL &&
+            _download_digest_alloc(download_handle) != STATE_SUCCESS) {
+        download_handle->digest_async = 0;
+    }
+    if (download_handle->digest_async == 0) {
+        _download_digest_compute(download_handle, buffer, buffer_len);
+        return STATE_SUCCESS;
+    }
+
+    while (buffer_len > 0) {
+        digest_buffer = &download_handle->digest_buffer[download_handle->digest_fill];
+        _download_digest_wait(download_handle, digest_buffer);
+
+        len = OTA_DIGEST_BUFFER_LEN - digest_buffer->len;
+        len = (buffer_len < len) ? buffer_len : len;
+        memcpy(digest_buffer->buffer + digest_buffer->len, buffer, len);
+        digest_buffer->len += len;
+        buffer += len;
+        buffer_len -= len;
+
+        if (digest_buffer->len == OTA_DIGEST_BUFFER_LEN) {
+            _download_digest_submit(download_handle);
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+/* 校验前提交未填满的缓冲区, 并等待所有缓冲区计算完成 */
+static void _download_digest_flush(download_handle_t *download_handle)
+{
+    uint32_t idx = 0;
+
+    if (download_handle->digest_buffer[0].buffer == NULL) {
+        return;
+    }
+    if (download_handle->digest_buffer[download_handle->digest_fill].len > 0) {
+        _download_digest_submit(download_handle);
+    }
+    for (idx = 0; idx < OTA_DIGEST_BUFFER_NUM; idx++) {
+        _download_digest_wait(download_handle, &download_handle->digest_buffer[idx]);
+    }
+}
+
+/* 是否在下载整个固件, 按range下载部分固件时不记录断点 */
+static uint8_t _download_is_whole(download_handle_t *download_handle)
+{
+    return (0 == download_handle->range_start && (0 == download_handle->range_end ||
+            download_handle->range_end == download_handle->task_desc->size_total - 1)) ? 1 : 0;
+}
+
+/* url中?之后的签名参数每次下发都可能不同, 只对之前的部分和云端下发的digest计算 */
+static void _download_checkpoint_hash(download_handle_t *download_handle, uint8_t output[32])
+{
+    core_sha256_context_t ctx;
+    char *url = download_handle->task_desc->url;
+    char *query = strchr(url, '?');
+    char *digest = download_handle->task_desc->expect_digest;
+
+    core_sha256_init(&ctx);
+    core_sha256_starts(&ctx);
+    core_sha256_update(&ctx, (uint8_t *)url, (query == NULL) ? (uint32_t)strlen(url) : (uint32_t)(query - url));
+    core_sha256_update(&ctx, (uint8_t *)"\n", 1);
+    if (digest != NULL) {
+        core_sha256_update(&ctx, (uint8_t *)digest, (uint32_t)strlen(digest));
+    }
+    core_sha256_finish(&ctx, output);
+    core_sha256_free(&ctx);
+}
+
+/* 每下载checkpoint_interval字节, 把覆盖已交付内容的digest中间状态交给用户保存 */
+static void _download_checkpoint_save(download_handle_t *download_handle)
+{
+    aiot_download_checkpoint_t checkpoint;
+
+    if (download_handle->checkpoint_handler == NULL || download_handle->digest_ctx == NULL ||
+            download_handle->size_fetched >= download_handle->task_desc->size_total ||
+            download_handle->size_fetched - download_handle->checkpoint_offset < download_handle->checkpoint_interval ||
+            _download_is_whole(download_handle) == 0) {
+        return;
+    }
+
+    /* 记录的digest状态必须恰好覆盖前offset个字节 */
+    _download_digest_flush(download_handle);
+
+    memset(&checkpoint, 0, sizeof(aiot_download_checkpoint_t));
+    _download_checkpoint_hash(download_handle, checkpoint.task_hash);
+    checkpoint.size_total = download_handle->task_desc->size_total;
+    checkpoint.offset = download_handle->size_fetched;
+    checkpoint.digest_method = download_handle->task_desc->digest_method;
+    if (AIOT_OTA_DIGEST_SHA256 == download_handle->task_desc->digest_method) {
+        core_sha256_context_t *ctx = (core_sha256_context_t *)download_handle->digest_ctx;
+        memcpy(checkpoint.digest_total, ctx->total, sizeof(ctx->total));
+        memcpy(checkpoint.digest_state, ctx->state, sizeof(ctx->state));
+        memcpy(checkpoint.digest_buffer, ctx->buffer, sizeof(ctx->buffer));
+    } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
+        core_md5_context_t *ctx = (core_md5_context_t *)download_handle->digest_ctx;
+        memcpy(checkpoint.digest_total, ctx->total, sizeof(ctx->total));
+        memcpy(checkpoint.digest_state, ctx->state, sizeof(ctx->state));
+        memcpy(checkpoint.digest_buffer, ctx->buffer, sizeof(ctx->buffer));
+    }
+    download_handle->checkpoint_offset = download_handle->size_fetched;
+
+    download_handle->checkpoint_handler(download_handle, &checkpoint, download_handle->userdata);
+}
+
+/* 校验断点记录属于当前任务后, 恢复已下载的字节数和digest中间状态 */
+static int32_t _download_checkpoint_restore(download_handle_t *download_handle,
+        const aiot_download_checkpoint_t *checkpoint)
+{
+    aiot_download_task_desc_t *task_desc = download_handle->task_desc;
+    uint8_t task_hash[32];
+
+    if (task_desc == NULL || task_desc->url == NULL || download_handle->digest_ctx == NULL ||
+            download_handle->segments != NULL ||
+            download_handle->download_status != DOWNLOAD_STATUS_START || download_handle->size_fetched != 0 ||
+            _download_is_whole(download_handle) == 0) {
+        return STATE_DOWNLOAD_CHECKPOINT_MISMATCH;
+    }
+    _download_checkpoint_hash(download_handle, task_hash);
+    if (memcmp(task_hash, checkpoint->task_hash, sizeof(task_hash)) != 0 ||
+            checkpoint->size_total != task_desc->size_total || checkpoint->digest_method != task_desc->digest_method ||
+            checkpoint->offset >= task_desc->size_total) {
+        return STATE_DOWNLOAD_CHECKPOINT_MISMATCH;
+    }
+
+    if (AIOT_OTA_DIGEST_SHA256 == task_desc->digest_method) {
+        core_sha256_context_t *ctx = (core_sha256_context_t *)download_handle->digest_ctx;
+        memcpy(ctx->total, checkpoint->digest_total, sizeof(ctx->total));
+        memcpy(ctx->state, checkpoint->digest_state, sizeof(ctx->state));
+        memcpy(ctx->buffer, checkpoint->digest_buffer, sizeof(ctx->buffer));
+    } else if (AIOT_OTA_DIGEST_MD5 == task_desc->digest_method) {
+        core_md5_context_t *ctx = (core_md5_context_t *)download_handle->digest_ctx;
+        memcpy(ctx->total, checkpoint->digest_total, sizeof(ctx->total));
+        memcpy(ctx->state, checkpoint->digest_state, sizeof(ctx->state));
+        memcpy(ctx->buffer, checkpoint->digest_buffer, sizeof(ctx->buffer));
+    }
+    download_handle->size_fetched = checkpoint->offset;
+    download_handle->checkpoint_offset = checkpoint->offset;
+    download_handle->percent = (int32_t)((uint64_t)checkpoint->offset * 100 / task_desc->size_total);
+
+    return STATE_SUCCESS;
+}
+
+/* 每次接收都填满了缓冲区时说明数据到达得很快, 将缓冲区加倍以减少回调和协议栈调用的次数 */
+static void _download_buffer_adapt(download_handle_t *download_handle, void *http_handle, int32_t res)
+{
+    uint32_t body_max_len = ((core_http_handle_t *)http_handle)->body_buffer_max_len;
+
+    if (res <= 0 || (uint32_t)res != body_max_len || body_max_len >= download_handle->adaptive_max_len) {
+        return;
+    }
+    body_max_len = (body_max_len * 2 < download_handle->adaptive_max_len) ? body_max_len * 2 :
+                   download_handle->adaptive_max_len;
+    core_http_setopt(http_handle, CORE_HTTPOPT_BODY_BUFFER_MAX_LEN, &body_max_len);
 }
 
 /* 对计算出来的digest值, 与云端下发的digest值进行比较 */
@@ -1063,7 +1496,7 @@ static int32_t _download_digest_verify(download_handle_t *download_handle)
         }
     } else if (AIOT_OTA_DIGEST_MD5 == download_handle->task_desc->digest_method) {
         core_str2hex(download_handle->task_desc->expect_digest, OTA_MD5_LEN, expected_digest);
-        utils_md5_finish(download_handle->digest_ctx, output);
+        core_md5_finish(download_handle->digest_ctx, output);
         if (memcmp(output, expected_digest, 16) == 0) {
             return STATE_SUCCESS;
         }
@@ -1071,6 +1504,479 @@ static int32_t _download_digest_verify(download_handle_t *download_handle)
     return STATE_OTA_DIGEST_MISMATCH;
 }
 
+/* 按固件顺序把一段内容交给用户, 同时累计下载进度并计算digest */
+static void _download_deliver(download_handle_t *download_handle, uint8_t *buffer, uint32_t buffer_len)
+{
+    int32_t percent = 0;
+    uint64_t tmp_size_fetched = 0;
+    uint64_t timestart = 0, callstart = 0;
+
+    /* 在按照多个range分片下载的情况下, 判断用户下载到的固件的累计大小是否超过了整体的值 */
+    if (download_handle->size_fetched > download_handle->task_desc->size_total) {
+        core_log(download_handle->sysdep, STATE_DOWNLOAD_FETCH_TOO_MANY, "downloaded exceeds expected\r\n");
+        return;
+    }
+    timestart = download_handle->sysdep->core_sysdep_time();
+
+    /* 该字段表示累计下载了多少字节, 不区分range */
+    download_handle->size_fetched += buffer_len;
+    /* 该字段表示在这个range内总共下载了多少字节 */
+    download_handle->range_size_fetched += buffer_len;
+
+    /* 当size_fetched*100超过uint32_t能表达的范围时, 比如239395702, 会导致percent计算错误, 因此需要一个更大的临时变量 */
+    tmp_size_fetched = download_handle->size_fetched;
+    percent = (100 * tmp_size_fetched) / download_handle->task_desc->size_total;
+
+    /* 计算digest, 如果下载完成, 还要看看是否与云端计算出来的一致 */
+    _download_digest_update(download_handle, buffer, buffer_len);
+    if (download_handle->size_fetched == download_handle->task_desc->size_total) {
+        int32_t ret = STATE_SUCCESS;
+
+        _download_digest_flush(download_handle);
+        ret = _download_digest_verify(download_handle);
+        if (ret != STATE_SUCCESS) {
+            percent = AIOT_OTAERR_CHECKSUM_MISMATCH;
+            core_log(download_handle->sysdep, ret, "digest mismatch\r\n");
+            aiot_download_report_progress(download_handle, AIOT_OTAERR_CHECKSUM_MISMATCH);
+        } else {
+            core_log(download_handle->sysdep, STATE_OTA_DIGEST_MATCH, "digest matched\r\n");
+        }
+    }
+    download_handle->percent = percent;
+
+    /* 调用用户的回调函数, 将报文传给用户 */
+    if (NULL != download_handle->recv_handler) {
+        aiot_download_recv_t recv_data = {
+            .type = AIOT_DLRECV_HTTPBODY,
+            .data = {
+                .buffer = buffer,
+                .len = buffer_len,
+                .percent = percent
+            }
+        };
+        callstart = download_handle->sysdep->core_sysdep_time();
+        download_handle->recv_handler(download_handle, &recv_data, download_handle->userdata);
+        _download_stats_add(download_handle, &download_handle->stats.deliver_time_ms,
+                            download_handle->sysdep->core_sysdep_time() - callstart);
+    }
+    _download_stats_add(download_handle, &download_handle->stats.deliver_bytes, buffer_len);
+    _download_checkpoint_save(download_handle);
+    download_handle->deliver_stage_ms += download_handle->sysdep->core_sysdep_time() - timestart;
+}
+
+/* 分段下载时各连接的收包回调, 轮到交付的块直接交给用户, 其余的块先暂存 */
+static void _download_segment_recv_handler(void *handle, const aiot_http_recv_t *packet, void *userdata)
+{
+    download_segment_t *segment = (download_segment_t *)userdata;
+    download_handle_t *download_handle = (download_handle_t *)segment->download_handle;
+    uint32_t len = 0;
+
+    switch (packet->type) {
+    case AIOT_HTTPRECV_STATUS_CODE: {
+        segment->http_rsp_status_code = packet->data.status_code.code;
+    }
+    break;
+    case AIOT_HTTPRECV_HEADER: {
+        if (core_strcase_equal(packet->data.header.key, (uint32_t)strlen(packet->data.header.key),
+                               "Content-Length") == 1) {
+            core_str2uint(packet->data.header.value, (uint8_t)strlen(packet->data.header.value), &segment->content_len);
+        }
+    }
+    break;
+    case AIOT_HTTPRECV_BODY: {
+        /* 应答与请求的范围不符时不能使用, 由aiot_download_recv对该块断点续传 */
+        if (OTA_RESPONSE_PARTIAL != segment->http_rsp_status_code || segment->content_len != segment->request_len) {
+            break;
+        }
+        len = segment->block_len - segment->received;
+        len = (packet->data.body.len < len) ? packet->data.body.len : len;
+        _download_stats_add(download_handle, &download_handle->stats.recv_bytes, len);
+        segment->renewal_count = (len > 0) ? 0 : segment->renewal_count;
+
+        if (segment->block_start + segment->received == download_handle->deliver_offset) {
+            _download_deliver(download_handle, packet->data.body.buffer, len);
+            download_handle->deliver_offset += len;
+        } else {
+            memcpy(segment->buffer + segment->received, packet->data.body.buffer, len);
+        }
+        segment->received += len;
+    }
+    break;
+    default:
+        break;
+    }
+}
+
+/* 在连接上发出[start, start + len)范围的请求 */
+static int32_t _download_segment_send(download_handle_t *download_handle, download_segment_t *segment,
+                                      uint32_t start, uint32_t len)
+{
+    int32_t res = STATE_SUCCESS;
+    char *header_string = NULL;
+    core_http_request_t request = {
+        .method = "GET",
+        .content = NULL,
+        .content_len = 0
+    };
+
+    res = _download_range_header(download_handle->sysdep, start, start + len - 1, &header_string);
+    if (res != STATE_SUCCESS) {
+        return res;
+    }
+
+    request.path = download_handle->segment_path;
+    request.header = header_string;
+    res = core_http_send(segment->http_handle, &request);
+    download_handle->sysdep->core_sysdep_free(header_string);
+
+    return (res < STATE_SUCCESS) ? STATE_DOWNLOAD_SEND_REQUEST_FAILED : STATE_SUCCESS;
+}
+
+/* 重新建连并请求当前块中尚未收到的部分, 已经提前请求的下一个块也一并重新请求 */
+static int32_t _download_segment_request(download_handle_t *download_handle, download_segment_t *segment)
+{
+    int32_t res = STATE_SUCCESS;
+
+    segment->http_rsp_status_code = 0;
+    segment->content_len = 0;
+    segment->request_len = segment->block_len - segment->received;
+    segment->status = DOWNLOAD_SEGMENT_RENEWAL;
+
+    res = core_http_connect(segment->http_handle);
+    if (res == STATE_SUCCESS) {
+        res = _download_segment_send(download_handle, segment, segment->block_start + segment->received,
+                                     segment->request_len);
+    }
+    if (res == STATE_SUCCESS && segment->next_len > 0) {
+        res = _download_segment_send(download_handle, segment, segment->next_start, segment->next_len);
+    }
+    if (res != STATE_SUCCESS) {
+        return (res == STATE_DOWNLOAD_SEND_REQUEST_FAILED) ? res : STATE_DOWNLOAD_SEND_REQUEST_FAILED;
+    }
+
+    segment->status = DOWNLOAD_SEGMENT_FETCH;
+    segment->request_time = download_handle->sysdep->core_sysdep_time();
+    segment->next_request_time = segment->request_time;
+    return STATE_SUCCESS;
+}
+
+/* 在同一连接上提前请求下一个块, 当前块读完后不必再等待一个往返时延 */
+static void _download_segment_pipeline(download_handle_t *download_handle, download_segment_t *segment)
+{
+    uint32_t remaining = download_handle->segment_end - download_handle->segment_next;
+
+    if (segment->status != DOWNLOAD_SEGMENT_FETCH || segment->next_len > 0 || remaining == 0) {
+        return;
+    }
+
+    segment->next_start = download_handle->segment_next;
+    segment->next_len = (remaining < download_handle->segment_size) ? remaining : download_handle->segment_size;
+    segment->next_request_time = download_handle->sysdep->core_sysdep_time();
+    download_handle->segment_next += segment->next_len;
+
+    /* 发送失败时连接已不可用, 两个块都在续传时重新请求 */
+    if (_download_segment_send(download_handle, segment, segment->next_start, segment->next_len) != STATE_SUCCESS) {
+        segment->status = DOWNLOAD_SEGMENT_RENEWAL;
+    }
+}
+
+/* 给交付完的连接分配下一个块, 优先使用已经提前请求的块 */
+static int32_t _download_segment_assign(download_handle_t *download_handle, download_segment_t *segment)
+{
+    uint32_t remaining = download_handle->segment_end - download_handle->segment_next;
+
+    segment->received = 0;
+    segment->renewal_count = 0;
+    if (segment->next_len > 0) {
+        segment->block_start = segment->next_start;
+        segment->block_len = segment->next_len;
+        segment->next_len = 0;
+        segment->request_len = segment->block_len;
+        segment->http_rsp_status_code = 0;
+        segment->content_len = 0;
+        segment->request_time = segment->next_request_time;
+        segment->status = DOWNLOAD_SEGMENT_FETCH;
+        return STATE_SUCCESS;
+    }
+
+    segment->status = DOWNLOAD_SEGMENT_IDLE;
+    if (remaining == 0) {
+        return STATE_SUCCESS;
+    }
+
+    segment->block_start = download_handle->segment_next;
+    segment->block_len = (remaining < download_handle->segment_size) ? remaining : download_handle->segment_size;
+    download_handle->segment_next += segment->block_len;
+
+    return _download_segment_request(download_handle, segment);
+}
+
+/* 依次交付已经轮到的暂存内容, 并让交付完的连接去请求新的块 */
+static void _download_segment_flush(download_handle_t *download_handle)
+{
+    uint32_t idx = 0, offset = 0, len = 0, body_max_len = 0;
+    uint8_t progress = 1;
+    download_segment_t *segment = NULL;
+
+    body_max_len = ((core_http_handle_t *)download_handle->http_handle)->body_buffer_max_len;
+
+    while (progress == 1) {
+        progress = 0;
+        for (idx = 0; idx < download_handle->segment_num; idx++) {
+            segment = &download_handle->segments[idx];
+            if (segment->status == DOWNLOAD_SEGMENT_IDLE || segment->block_start > download_handle->deliver_offset) {
+                continue;
+            }
+            /* 按body缓冲区的长度分次交给用户, 与单连接下载时每次回调的最大长度一致 */
+            offset = download_handle->deliver_offset - segment->block_start;
+            while (offset < segment->received) {
+                len = segment->received - offset;
+                len = (len < body_max_len) ? len : body_max_len;
+                _download_deliver(download_handle, segment->buffer + offset, len);
+                download_handle->deliver_offset += len;
+                offset += len;
+                progress = 1;
+            }
+            if (segment->status == DOWNLOAD_SEGMENT_DONE) {
+                _download_segment_assign(download_handle, segment);
+                _download_segment_pipeline(download_handle, segment);
+                progress = 1;
+            }
+        }
+    }
+}
+
+static void _download_segment_free(download_handle_t *download_handle)
+{
+    uint32_t idx = 0;
+    aiot_sysdep_portfile_t *sysdep = download_handle->sysdep;
+
+    if (download_handle->segments != NULL) {
+        for (idx = 0; idx < download_handle->segment_num; idx++) {
+            if (download_handle->segments[idx].http_handle != NULL) {
+                core_http_deinit(&download_handle->segments[idx].http_handle);
+            }
+            if (download_handle->segments[idx].buffer != NULL) {
+                sysdep->core_sysdep_free(download_handle->segments[idx].buffer);
+            }
+        }
+        sysdep->core_sysdep_free(download_handle->segments);
+        download_handle->segments = NULL;
+    }
+    if (download_handle->segment_path != NULL) {
+        sysdep->core_sysdep_free(download_handle->segment_path);
+        download_handle->segment_path = NULL;
+    }
+}
+
+/* 释放各连接, 由aiot_download_recv用单连接从下一个待交付的位置续传 */
+static void _download_segment_fallback(download_handle_t *download_handle)
+{
+    _download_segment_free(download_handle);
+    download_handle->segment_disabled = 1;
+    download_handle->download_status = DOWNLOAD_STATUS_RENEWAL;
+}
+
+/* 创建各连接的HTTP实例, 网络参数沿用单连接下载时的配置 */
+static int32_t _download_segment_alloc(download_handle_t *download_handle, char *host)
+{
+    uint32_t idx = 0;
+    int32_t res = STATE_SUCCESS;
+    aiot_sysdep_portfile_t *sysdep = download_handle->sysdep;
+    core_http_handle_t *main_http = (core_http_handle_t *)download_handle->http_handle;
+    download_segment_t *segment = NULL;
+
+    download_handle->segments = sysdep->core_sysdep_malloc(sizeof(download_segment_t) * download_handle->segment_num,
+                                DOWNLOAD_MODULE_NAME);
+    if (download_handle->segments == NULL) {
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+    memset(download_handle->segments, 0, sizeof(download_segment_t) * download_handle->segment_num);
+
+    for (idx = 0; idx < download_handle->segment_num; idx++) {
+        segment = &download_handle->segments[idx];
+        segment->download_handle = download_handle;
+        segment->buffer = sysdep->core_sysdep_malloc(download_handle->segment_size, DOWNLOAD_MODULE_NAME);
+        segment->http_handle = core_http_init();
+        if (segment->buffer == NULL || segment->http_handle == NULL) {
+            return STATE_SYS_DEPEND_MALLOC_FAILED;
+        }
+        if ((res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_RECV_HANDLER,
+                                    (void *)_download_segment_recv_handler)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_USERDATA, (void *)segment)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_HOST, host)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_PORT, &main_http->port)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_CONNECT_TIMEOUT_MS,
+                                        &main_http->connect_timeout_ms)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_SEND_TIMEOUT_MS,
+                                        &main_http->send_timeout_ms)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_RECV_TIMEOUT_MS,
+                                        &main_http->recv_timeout_ms)) != STATE_SUCCESS ||
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_BODY_BUFFER_MAX_LEN,
+                                        &main_http->body_buffer_max_len)) != STATE_SUCCESS) {
+            return res;
+        }
+        if (main_http->cred != NULL &&
+                (res = core_http_setopt(segment->http_handle, CORE_HTTPOPT_NETWORK_CRED, main_http->cred)) != STATE_SUCCESS) {
+            return res;
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+/* 切分待下载区间, 在每个连接上请求一个块 */
+static int32_t _download_segment_start(download_handle_t *download_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint32_t idx = 0, start = 0, sent = 0;
+    char *host = NULL;
+    uint32_t range_start = download_handle->range_start;
+    uint32_t range_end = download_handle->range_end;
+    uint32_t size_total = download_handle->task_desc->size_total;
+
+    /* 重新开始时丢弃各连接上尚未读完的应答与暂存的内容 */
+    _download_segment_free(download_handle);
+
+    res = _download_parse_url(download_handle->sysdep, download_handle->task_desc->url, &host,
+                              &download_handle->segment_path);
+    if (res != STATE_SUCCESS) {
+        return res;
+    }
+    res = _download_segment_alloc(download_handle, host);
+    download_handle->sysdep->core_sysdep_free(host);
+    if (res != STATE_SUCCESS) {
+        _download_segment_free(download_handle);
+        return res;
+    }
+
+    /* 与单连接下载相同, 下载整个固件时从已下载的字节数处续传, 否则从range内已下载的位置续传 */
+    if (0 == range_start && (0 == range_end || range_end == size_total - 1)) {
+        start = download_handle->size_fetched;
+    } else {
+        start = range_start + download_handle->range_size_fetched;
+    }
+    download_handle->segment_next = start;
+    download_handle->deliver_offset = start;
+    download_handle->segment_end = (0 == range_end) ? size_total : range_end + 1;
+    download_handle->segment_cursor = 0;
+
+    /* 先让每个连接各请求一个块, 再在各连接上提前请求下一个块 */
+    for (idx = 0; idx < download_handle->segment_num; idx++) {
+        if (_download_segment_assign(download_handle, &download_handle->segments[idx]) == STATE_SUCCESS) {
+            sent++;
+        }
+    }
+    for (idx = 0; idx < download_handle->segment_num; idx++) {
+        _download_segment_pipeline(download_handle, &download_handle->segments[idx]);
+    }
+
+    /* 只要有一个连接发出了请求就开始接收, 其余连接在aiot_download_recv中重试 */
+    return (sent > 0) ? STATE_SUCCESS : STATE_DOWNLOAD_SEND_REQUEST_FAILED;
+}
+
+/* 分段下载时每次aiot_download_recv轮流处理一个连接 */
+static int32_t _download_segment_recv(download_handle_t *download_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint32_t idx = 0, pos = 0, waiting_pos = 0;
+    download_segment_t *segment = NULL, *waiting = NULL;
+
+    /*
+     * 读取应答header时会一直阻塞到header到达, 所以优先处理正在接收body的连接,
+     * 没有这样的连接时才等待请求发出最早的那个. 暂不读取的连接上, 数据仍然在协议栈的接收窗口内持续到达
+     */
+    for (idx = 0; idx < download_handle->segment_num; idx++) {
+        pos = (download_handle->segment_cursor + idx) % download_handle->segment_num;
+        segment = &download_handle->segments[pos];
+        if (segment->status == DOWNLOAD_SEGMENT_RENEWAL ||
+                (segment->status == DOWNLOAD_SEGMENT_FETCH &&
+                 ((core_http_handle_t *)segment->http_handle)->session.sm == CORE_HTTP_SM_READ_BODY)) {
+            break;
+        }
+        if (segment->status == DOWNLOAD_SEGMENT_FETCH && (waiting == NULL || segment->request_time < waiting->request_time)) {
+            waiting = segment;
+            waiting_pos = pos;
+        }
+        segment = NULL;
+    }
+    if (segment == NULL && waiting != NULL) {
+        segment = waiting;
+        pos = waiting_pos;
+    }
+    download_handle->segment_cursor = (pos + 1) % download_handle->segment_num;
+
+    if (segment == NULL) {
+        /* 所有块都已交付 */
+        if (download_handle->size_fetched == download_handle->task_desc->size_total) {
+            return STATE_DOWNLOAD_FINISHED;
+        }
+        return STATE_DOWNLOAD_RANGE_FINISHED;
+    }
+
+    /* 只重新请求出错的块, 不影响其他连接. 同一位置多次续传仍然失败时改用单连接下载 */
+    if (segment->status == DOWNLOAD_SEGMENT_RENEWAL) {
+        if (segment->renewal_count >= OTA_SEGMENT_RENEWAL_MAX) {
+            core_log(download_handle->sysdep, STATE_DOWNLOAD_RECV_ERROR,
+                     "segment renewal exceeds limit, fall back to single connection\r\n");
+            _download_segment_fallback(download_handle);
+            return STATE_DOWNLOAD_RECV_ERROR;
+        }
+        segment->renewal_count++;
+        res = _download_segment_request(download_handle, segment);
+        return (res == STATE_SUCCESS) ? STATE_DOWNLOAD_RENEWAL_REQUEST_SENT : res;
+    }
+
+    res = core_http_recv(segment->http_handle);
+    _download_buffer_adapt(download_handle, segment->http_handle, res);
+    /* 第一个应答不是与请求范围一致的206时, 认为服务端不支持Range */
+    if (0 != segment->http_rsp_status_code && download_handle->segment_checked == 0) {
+        if (OTA_RESPONSE_PARTIAL != segment->http_rsp_status_code || segment->content_len != segment->request_len) {
+            res = (OTA_RESPONSE_OK == segment->http_rsp_status_code ||
+                   OTA_RESPONSE_PARTIAL == segment->http_rsp_status_code) ?
+                  STATE_DOWNLOAD_HTTPRSP_HEADER_ERROR : STATE_DOWNLOAD_HTTPRSP_CODE_ERROR;
+            core_log(download_handle->sysdep, res, "range not supported, fall back to single connection\r\n");
+            _download_segment_fallback(download_handle);
+            return res;
+        }
+        download_handle->segment_checked = 1;
+    }
+    if (OTA_RESPONSE_PARTIAL != segment->http_rsp_status_code && 0 != segment->http_rsp_status_code) {
+        segment->status = DOWNLOAD_SEGMENT_RENEWAL;
+        return STATE_DOWNLOAD_HTTPRSP_CODE_ERROR;
+    }
+    if (0 != segment->http_rsp_status_code && segment->content_len != segment->request_len) {
+        segment->status = DOWNLOAD_SEGMENT_RENEWAL;
+        return STATE_DOWNLOAD_HTTPRSP_HEADER_ERROR;
+    }
+
+    /* 上一个应答读完后, 再调用一次core_http_recv才会开始读取流水线中的下一个应答 */
+    if (res == STATE_HTTP_READ_BODY_FINISHED) {
+        res = 0;
+    } else if (segment->received == segment->block_len) {
+        segment->status = DOWNLOAD_SEGMENT_DONE;
+    } else if (res <= 0) {
+        uint8_t res_string_len = 0;
+        char res_string[OTA_MAX_DIGIT_NUM_OF_UINT32] = {0};
+        core_int2str(res, res_string, &res_string_len);
+        core_log1(download_handle->sysdep, STATE_DOWNLOAD_RECV_ERROR, "segment recv got %s, renewal\r\n", &res_string);
+        segment->status = DOWNLOAD_SEGMENT_RENEWAL;
+    }
+    _download_segment_flush(download_handle);
+
+    if (download_handle->size_fetched == download_handle->task_desc->size_total) {
+        return STATE_DOWNLOAD_FINISHED;
+    }
+    if (download_handle->size_fetched > download_handle->task_desc->size_total) {
+        return STATE_DOWNLOAD_FETCH_TOO_MANY;
+    }
+    if (download_handle->deliver_offset == download_handle->segment_end) {
+        return STATE_DOWNLOAD_RANGE_FINISHED;
+    }
+
+    return res;
+}
+
 /* 对于收到的http报文进行处理的回调函数, 内部处理完后再调用用户的回调函数 */
 void _http_recv_handler(void *handle, const aiot_http_recv_t *packet, void *userdata)
 {
@@ -1084,8 +1990,8 @@ void _http_recv_handler(void *handle, const aiot_http_recv_t *packet, void *user
     }
     break;
     case AIOT_HTTPRECV_HEADER: {
-        if ((strlen(packet->data.header.key) == strlen("Content-Length")) &&
-                (memcmp(packet->data.header.key, "Content-Length", strlen(packet->data.header.key)) == 0)) {
+        if (core_strcase_equal(packet->data.header.key, (uint32_t)strlen(packet->data.header.key),
+                               "Content-Length") == 1) {
             uint32_t size = 0;
 
             /* 在用户指定的range并非全部固件的情况下, content_len < size_total, 所以不能简单替换 */
@@ -1097,60 +2003,17 @@ void _http_recv_handler(void *handle, const aiot_http_recv_t *packet, void *user
     }
     break;
     case AIOT_HTTPRECV_BODY: {
-        int32_t percent = 0;
         if (OTA_RESPONSE_OK != download_handle->http_rsp_status_code
                 /* HTTP回复报文的code应该是200或者206, 否则这个下载链接不可用 */
                 && OTA_RESPONSE_PARTIAL != download_handle->http_rsp_status_code) {
-            percent = AIOT_OTAERR_FETCH_FAILED;
             core_log(download_handle->sysdep, STATE_DOWNLOAD_HTTPRSP_CODE_ERROR, "wrong http respond code\r\n");
         } else if (0 == download_handle->content_len) {
             /* HTTP回复报文的header里面应该有Content-Length, 否则这个下载链接为trunked编码, 不可用 */
-            percent = AIOT_OTAERR_FETCH_FAILED;
             core_log(download_handle->sysdep, STATE_DOWNLOAD_HTTPRSP_HEADER_ERROR, "wrong http respond header\r\n");
         } else {
             /* 正常的固件的报文 */
-            /* 在按照多个range分片下载的情况下, 判断用户下载到的固件的累计大小是否超过了整体的值 */
-            if (download_handle->size_fetched > download_handle->task_desc->size_total) {
-                core_log(download_handle->sysdep, STATE_DOWNLOAD_FETCH_TOO_MANY, "downloaded exceeds expected\r\n");
-                break;
-            }
-
-            /* 该字段表示累计下载了多少字节, 不区分range */
-            download_handle->size_fetched += packet->data.body.len;
-            /* 该字段表示在这个range内总共下载了多少字节 */
-            download_handle->range_size_fetched += packet->data.body.len;
-
-            /* 当size_fetched*100超过uint32_t能表达的范围时, 比如239395702, 会导致percent计算错误, 因此需要一个更大的临时变量 */
-            uint64_t tmp_size_fetched = 0;
-            tmp_size_fetched = download_handle->size_fetched;
-            percent = (100 * tmp_size_fetched) / download_handle->task_desc->size_total;
-
-            /* 计算digest, 如果下载完成, 还要看看是否与云端计算出来的一致 */
-            _download_digest_update(download_handle, packet->data.body.buffer, packet->data.body.len);
-            if (download_handle->size_fetched == download_handle->task_desc->size_total) {
-                int32_t ret = _download_digest_verify(download_handle);
-                if (ret != STATE_SUCCESS) {
-                    percent = AIOT_OTAERR_CHECKSUM_MISMATCH;
-                    core_log(download_handle->sysdep, ret, "digest mismatch\r\n");
-                    aiot_download_report_progress(download_handle, AIOT_OTAERR_CHECKSUM_MISMATCH);
-                } else {
-                    core_log(download_handle->sysdep, STATE_OTA_DIGEST_MATCH, "digest matched\r\n");
-                }
-            }
-            download_handle->percent = percent;
-
-            /* 调用用户的回调函数, 将报文传给用户 */
-            if (NULL != download_handle->recv_handler) {
-                aiot_download_recv_t recv_data = {
-                    .type = AIOT_DLRECV_HTTPBODY,
-                    .data = {
-                        .buffer = packet->data.body.buffer,
-                        .len = packet->data.body.len,
-                        .percent = percent
-                    }
-                };
-                download_handle->recv_handler(download_handle, &recv_data, download_handle->userdata);
-            }
+            _download_stats_add(download_handle, &download_handle->stats.recv_bytes, packet->data.body.len);
+            _download_deliver(download_handle, packet->data.body.buffer, packet->data.body.len);
         }
     }
     break;
@@ -1314,15 +2177,16 @@ static int32_t _ota_subscribe(void *mqtt_handle, void *ota_handle)
     return res;
 }
 
-/* 解析json报文, 并且将解析出来的内容, 填充到malloc出来的一片内存中 */
-static int32_t _ota_parse_json(aiot_sysdep_portfile_t *sysdep, void *input, uint32_t input_len, char *key_word,
-                               char **out)
+/* 在index中input范围内查找key_word, 并且将解析出来的内容, 填充到malloc出来的一片内存中 */
+static int32_t _ota_parse_json(aiot_sysdep_portfile_t *sysdep, const core_json_index_t *index, void *input,
+                               uint32_t input_len, char *key_word, char **out)
 {
     int32_t res = STATE_SUCCESS;
     char *value = NULL, *buffer = NULL;
     uint32_t value_len = 0, buffer_len = 0;
 
-    res = core_json_value((const char *)input, input_len, key_word, strlen(key_word), &value, &value_len);
+    res = core_json_index_scope_value(index, (const char *)input, input_len, key_word, strlen(key_word), &value,
+                                      &value_len);
     if (res != STATE_SUCCESS) {
         return STATE_OTA_PARSE_JSON_ERROR;
     }
@@ -265,6 +265,40 @@ typedef struct {
 } aiot_download_recv_t;
 
 
+/**
+* @brief 下载过程中各个阶段的累计字节数和耗时, 某阶段的吞吐量(Bytes/s)为 bytes * 1000 / time_ms
+*
+*/
+typedef struct {
+    /**
+    * @brief 从设置 @ref AIOT_DLOPT_TASK_DESC 开始经过的时间, 单位ms
+    */
+    uint64_t elapsed_ms;
+
+    /**
+    * @brief 从网络接收(含TLS解密)的固件字节数, 以及在协议栈中花费的时间
+    */
+    uint64_t recv_bytes;
+    uint64_t recv_time_ms;
+
+    /**
+    * @brief 计算digest的字节数和耗时, 开启 @ref AIOT_DLOPT_DIGEST_ASYNC 时包含在用户线程中的计算
+    */
+    uint64_t digest_bytes;
+    uint64_t digest_time_ms;
+
+    /**
+    * @brief 交给用户回调的字节数, 以及在 @ref aiot_download_recv_handler_t 中花费的时间
+    */
+    uint64_t deliver_bytes;
+    uint64_t deliver_time_ms;
+
+    /**
+    * @brief 当前的接收缓冲区长度
+    */
+    uint32_t buffer_len;
+} aiot_download_stats_t;
+
 /**
  * @brief 升级开始后, 设备收到分成一段段的固件内容时的收包回调函数.当前默认是通过https报文下推分段后的固件内容.
 
@@ -277,6 +311,58 @@ typedef struct {
 typedef void (* aiot_download_recv_handler_t)(void *handle, const aiot_download_recv_t *packet,
         void *userdata);
 
+/**
+* @brief 下载断点记录, 用户保存到非易失存储中, 设备重启后通过 @ref AIOT_DLOPT_CHECKPOINT_RESUME 从断点继续下载
+*
+* @details
+* 记录中只包含定长的字段, 可以按字节直接保存. digest的中间状态一并保存, 恢复后无需重新读取已经写入的固件
+*
+*/
+typedef struct {
+    /**
+    * @brief 对url(不含?之后的签名参数)和云端下发的digest计算的SHA256, 用于判断记录是否属于当前下载任务
+    */
+    uint8_t  task_hash[32];
+
+    /**
+    * @brief 固件的总大小
+    */
+    uint32_t size_total;
+
+    /**
+    * @brief 已经交给 @ref aiot_download_recv_handler_t 的字节数, 从该位置继续下载
+    */
+    uint32_t offset;
+
+    /**
+    * @brief digest方法, 取值见 @ref aiot_ota_digest_type_t
+    */
+    uint32_t digest_method;
+
+    /**
+    * @brief 覆盖了前offset个字节的digest中间状态, MD5只使用digest_state的前4个字
+    */
+    uint32_t digest_total[2];
+    uint32_t digest_state[8];
+    uint8_t  digest_buffer[64];
+} aiot_download_checkpoint_t;
+
+/**
+ * @brief 需要保存下载断点时的回调函数
+ *
+ * @details
+ * 回调时, offset之前的固件内容都已经通过 @ref aiot_download_recv_handler_t 交给用户, 用户应在这些内容写入flash后再保存记录.
+ * 整个固件下载完成后, 用户需要自行删除保存的记录
+ *
+ * @param[in] handle download实例句柄
+ * @param[in] checkpoint 当前的断点记录
+ * @param[in] userdata 用户上下文
+ *
+ * @return void
+ */
+typedef void (* aiot_download_checkpoint_handler_t)(void *handle, const aiot_download_checkpoint_t *checkpoint,
+        void *userdata);
+
 /**
  * @brief 与云端约定的OTA过程中的错误码, 云端据此知道升级过程中出错在哪个环节
  *
@@ -478,6 +564,88 @@ typedef enum {
     * 数据类型: (uint32_t *) 默认值: (2 *1024) Bytes
     */
     AIOT_DLOPT_BODY_BUFFER_MAX_LEN,
+
+    /**
+    * @brief 分段并行下载时同时使用的HTTP连接数
+    *
+    * @details
+    * 取值大于1时, @ref aiot_download_send_request 将待下载的区间切分为长度为 @ref AIOT_DLOPT_SEGMENT_SIZE 的块,
+    * 在多个HTTP连接上同时请求不同的块, 在时延较大的链路上可以成倍提高下载速度.
+    *
+    * 排在后面的块先到达时暂存在各连接的缓冲区中, 固件内容仍然按顺序从 @ref aiot_download_recv_handler_t 交给用户.
+    * 某个连接出错时, 只对该连接上未完成的块进行断点续传, 不影响其他连接.
+    * 第一个应答不是与请求范围一致的206, 或者同一个块连续续传3次仍然没有收到内容时, 本次下载任务改用单连接继续下载.
+    *
+    * 额外占用的内存约为 连接数 * @ref AIOT_DLOPT_SEGMENT_SIZE
+    *
+    * 数据类型: (uint32_t *) 默认值: 1, 即只使用一个连接, 取值范围: 1~8
+    */
+    AIOT_DLOPT_SEGMENT_NUM,
+
+    /**
+    * @brief 分段并行下载时每次请求的块大小
+    *
+    * @details
+    * 块越大, 每个块的请求往返时延占比越小, 但每个连接暂存块内容所需的内存越多
+    *
+    * 数据类型: (uint32_t *) 默认值: (64 * 1024) Bytes
+    */
+    AIOT_DLOPT_SEGMENT_SIZE,
+
+    /**
+    * @brief 接收缓冲区自适应增长的上限
+    *
+    * @details
+    * 取值大于 @ref AIOT_DLOPT_BODY_BUFFER_MAX_LEN 时, 每当一次接收填满了缓冲区, SDK就将缓冲区长度加倍, 直到该上限,
+    * 每次从 @ref aiot_download_recv_handler_t 给出的body长度也随之变大. 链路较快时可以减少回调和协议栈调用的次数
+    *
+    * 数据类型: (uint32_t *) 默认值: 0, 即不增长, 取值上限: (64 * 1024) Bytes
+    */
+    AIOT_DLOPT_BODY_BUFFER_ADAPTIVE_MAX_LEN,
+
+    /**
+    * @brief 是否在用户线程中计算固件的digest
+    *
+    * @details
+    * 取值为1时, 收到的固件内容先拷贝到两个交替使用的缓冲区中, 由用户在另一个线程中循环调用 @ref aiot_download_digest_process
+    * 计算digest, 网络接收, 解密, digest计算和用户写入flash可以同时进行.
+    *
+    * 没有线程调用 @ref aiot_download_digest_process 时, 接收线程在缓冲区用完时自行计算, 结果不受影响.
+    * 额外占用的内存为 2 * (64 * 1024) Bytes
+    *
+    * 数据类型: (uint8_t *) 默认值: 0, 即在接收线程中直接计算
+    */
+    AIOT_DLOPT_DIGEST_ASYNC,
+
+    /**
+    * @brief 保存下载断点的回调函数
+    *
+    * @details
+    * 下载整个固件时, 每下载 @ref AIOT_DLOPT_CHECKPOINT_INTERVAL 字节, SDK通过该回调给出一次断点记录.
+    * 按range下载部分固件时不会给出断点记录
+    *
+    * 数据类型: (aiot_download_checkpoint_handler_t)
+    */
+    AIOT_DLOPT_CHECKPOINT_HANDLER,
+
+    /**
+    * @brief 给出断点记录的间隔
+    *
+    * @details
+    * 数据类型: (uint32_t *) 默认值: (256 * 1024) Bytes
+    */
+    AIOT_DLOPT_CHECKPOINT_INTERVAL,
+
+    /**
+    * @brief 从保存的断点记录继续下载
+    *
+    * @details
+    * 需要在 @ref AIOT_DLOPT_TASK_DESC 之后, @ref aiot_download_send_request 之前设置. 记录与当前下载任务不符时返回
+    * @ref STATE_DOWNLOAD_CHECKPOINT_MISMATCH , 此时用户应删除该记录, 从头开始下载
+    *
+    * 数据类型: (aiot_download_checkpoint_t *)
+    */
+    AIOT_DLOPT_CHECKPOINT_RESUME,
     AIOT_DLOPT_MAX
 } aiot_download_option_t;
 
@@ -709,6 +877,35 @@ int32_t aiot_download_report_progress(void *handle, int32_t percent);
  */
 int32_t aiot_download_send_request(void *handle);
 
+/**
+ * @brief 在用户线程中计算一块固件内容的digest
+ *
+ * @details
+ *
+ * 开启 @ref AIOT_DLOPT_DIGEST_ASYNC 后, 用户可以单独开一个线程循环调用该接口, 与 @ref aiot_download_recv 并行计算digest.
+ * 返回0时表示当前没有待计算的内容, 可以短暂休眠后再调用. 释放download实例前需要先停止该线程
+ *
+ * @param[in] handle download句柄
+ *
+ * @return int32_t
+ * @retval >STATE_SUCCESS 本次计算的字节数
+ * @retval STATE_SUCCESS 没有待计算的内容
+ * @retval STATE_DOWNLOAD_DIGEST_HANDLE_IS_NULL download句柄为空
+ */
+int32_t aiot_download_digest_process(void *handle);
+
+/**
+ * @brief 获取下载过程中各个阶段的吞吐量统计
+ *
+ * @param[in] handle download句柄
+ * @param[out] stats 统计信息, 更多信息请参考@ref aiot_download_stats_t
+ *
+ * @return int32_t
+ * @retval STATE_SUCCESS 获取成功
+ * @retval STATE_DOWNLOAD_DIGEST_HANDLE_IS_NULL download句柄或stats为空
+ */
+int32_t aiot_download_get_stats(void *handle, aiot_download_stats_t *stats);
+
 /**
  * @brief -0x0900~-0x09FF表达SDK在OTA模块内的状态码, 也包含下载时使用的`STATE_DOWNLOAD_XXX`
  *
@@ -992,6 +1189,20 @@ int32_t aiot_download_send_request(void *handle);
  */
 #define STATE_OTA_PATH_STRING_OVERFLOW                              (-0x092A)
 
+/**
+ * @brief 计算digest或者获取统计信息时download句柄为空
+ *
+ */
+#define STATE_DOWNLOAD_DIGEST_HANDLE_IS_NULL                        (-0x092B)
+
+/**
+ * @brief 设置的断点记录与当前下载任务不符
+ *
+ * @details 固件url, digest, 大小或者digest方法与记录中的不一致, 或者还没有设置下载任务, 或者已经开始下载
+ *
+ */
+#define STATE_DOWNLOAD_CHECKPOINT_MISMATCH                          (-0x092C)
+
 #if defined(__cplusplus)
 }
 #endif
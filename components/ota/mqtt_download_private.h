@@ -18,6 +18,24 @@ extern "C" {
 #include "aiot_ota_api.h"
 #include "aiot_mqtt_download_api.h"      /* 内部头文件是用户可见头文件的超集 */
 
+/* 请求窗口中的一个块 */
+typedef enum {
+    MQTT_DOWNLOAD_BLOCK_IDLE,       /* 空闲, 或者块已经交给用户 */
+    MQTT_DOWNLOAD_BLOCK_WAIT,       /* 已发出请求, 等待回复 */
+    MQTT_DOWNLOAD_BLOCK_DONE,       /* 先于前面的块到达, 暂存等待按顺序交给用户 */
+    MQTT_DOWNLOAD_BLOCK_DELIVER,    /* 正在回调用户, 回调返回前不能复用 */
+} mqtt_download_block_status_t;
+
+typedef struct {
+    uint32_t        offset;         /* 块相对range_start的偏移 */
+    uint32_t        size;
+    uint8_t         status;
+    uint8_t         retry;          /* 该块已经重新请求的次数 */
+    uint64_t        request_time;
+    uint8_t         *buffer;        /* 暂存乱序到达的块 */
+    uint32_t        buffer_len;
+} mqtt_download_block_t;
+
 /* 定义mqtt_download模块内部的会话句柄结构体, SDK用户不可见, 只能得到void *handle类型的指针 */
 typedef struct {
     aiot_sysdep_portfile_t               *sysdep;       /* 底层依赖回调合集的引用指针 */
@@ -27,12 +45,29 @@ typedef struct {
     uint32_t                             range_start;
     uint32_t                             range_end;
     uint32_t                             request_size;  /* 每次请求的size */
+    uint32_t                             window_size;   /* 同时等待回复的请求数, 自适应时为上限 */
+    uint32_t                             block_timeout_ms;
+    uint8_t                              adaptive;      /* 是否根据回复情况调整块长度和窗口 */
+    uint32_t                             max_request_size;
+    uint8_t                              binary_header; /* 请求云端使用二进制格式的回复头 */
     /*---- 以上都是用户在API可配 ----*/
     uint32_t        msg_id;
-    uint32_t        size_fetched;
+    uint32_t        size_fetched;   /* 已经按顺序交给用户的长度 */
+    uint32_t        request_offset; /* 下一个待请求的块相对range_start的偏移 */
+    mqtt_download_block_t *blocks;  /* window_size个请求槽位 */
+    uint32_t        inflight;       /* 已请求但还没交给用户的块数 */
+    uint8_t         delivering;     /* 有线程正在回调用户, 此时到达的块都先暂存 */
+    uint32_t        window;         /* 当前允许的inflight上限 */
+    uint32_t        block_size;     /* 当前新请求的块长度 */
+    uint32_t        ack_count;      /* 上次增大后按时收到的回复数 */
+    uint64_t        last_decrease_time;
+    uint32_t        srtt;           /* 平滑后的往返时延, 单位ms */
+    uint64_t        stats_start_time;
+    uint64_t        stats_end_time;
+    uint32_t        stats_fetched;
+    uint32_t        request_count;
+    uint32_t        retry_count;
     int32_t         percent;
-    uint64_t        last_request_time;
-    uint64_t        failed_counter;
     int32_t         status;
     int32_t         last_percent;
     uint32_t        range_size;
@@ -50,6 +85,17 @@ typedef struct {
 #define MQTT_DOWNLOAD_DEFAULT_RECV_TIMEOUT           (10 * 1000)
 /* 默认的单次请求长度 */
 #define MQTT_DOWNLOAD_DEFAULT_REQUEST_SIZE           (5 * 1024)
+/* 默认只有一个请求等待回复, 即收到回复后再请求下一块 */
+#define MQTT_DOWNLOAD_DEFAULT_WINDOW_SIZE            (1)
+#define MQTT_DOWNLOAD_WINDOW_SIZE_MAX                (16)
+/* 单次请求长度的范围, 由云端对单个分块的限制决定 */
+#define MQTT_DOWNLOAD_REQUEST_SIZE_MIN               (256)
+#define MQTT_DOWNLOAD_REQUEST_SIZE_MAX               (128 * 1024)
+/* 自适应时默认的块长度上限, 以及每次增大的步长 */
+#define MQTT_DOWNLOAD_DEFAULT_MAX_REQUEST_SIZE       (32 * 1024)
+#define MQTT_DOWNLOAD_ADAPTIVE_STEP                  (1024)
+/* 单个块超时后重新请求的最大次数, 超过后下载失败 */
+#define MQTT_DOWNLOAD_BLOCK_RETRY_MAX                (3)
 
 /* 请求及回复的topic定义 */
 #define MQTT_DOWNLOAD_REQUEST_TOPIC                  "/sys/%s/%s/thing/file/download"
@@ -60,6 +106,15 @@ typedef struct {
 /* 上报进度的间隔，单位：%  */
 #define MQTT_DOWNLOAD_REPORT_INTERNEL                (5)
 
+/*
+ * 二进制格式的回复头, 多字节字段均为大端, 后面紧跟文件数据:
+ * magic(2) code(2) bOffset(4) bSize(4) fileLength(4) crc16(2) reserved(2) fileToken(16)
+ * magic与JSON格式中头长度字段的位置相同, JSON头不会达到该长度, 以此区分两种格式
+ */
+#define MQTT_DOWNLOAD_BINARY_MAGIC                   (0xFFFF)
+#define MQTT_DOWNLOAD_BINARY_TOKEN_LEN               (16)
+#define MQTT_DOWNLOAD_BINARY_HEADER_LEN              (20 + MQTT_DOWNLOAD_BINARY_TOKEN_LEN)
+
 
 #if defined(__cplusplus)
 }
@@ -18,6 +18,14 @@ extern "C" {
 
 #define OTA_DEFAULT_DOWNLOAD_BUFLEN          (2 * 1024)
 #define OTA_DEFAULT_DOWNLOAD_TIMEOUT_MS      (5 * 1000)
+#define OTA_DEFAULT_SEGMENT_NUM              (1)
+#define OTA_DEFAULT_SEGMENT_SIZE             (64 * 1024)
+#define OTA_SEGMENT_NUM_MAX                  (8)
+#define OTA_SEGMENT_RENEWAL_MAX              (3)
+#define OTA_ADAPTIVE_BUFLEN_MAX              (64 * 1024)
+#define OTA_DIGEST_BUFFER_NUM                (2)
+#define OTA_DIGEST_BUFFER_LEN                (64 * 1024)
+#define OTA_DEFAULT_CHECKPOINT_INTERVAL      (256 * 1024)
 
 #define OTA_FOTA_TOPIC                       "/ota/device/upgrade/+/+"
 #define OTA_FOTA_TOPIC_PREFIX                "/ota/device/upgrade"
@@ -44,6 +52,19 @@ typedef enum {
     DOWNLOAD_STATUS_RENEWAL,
 } download_status_t;
 
+typedef enum {
+    DOWNLOAD_SEGMENT_IDLE,          /* 没有分配块, 或者块已经全部交给用户 */
+    DOWNLOAD_SEGMENT_FETCH,         /* 正在接收块的内容 */
+    DOWNLOAD_SEGMENT_DONE,          /* 块已经接收完整, 等待前面的块交给用户 */
+    DOWNLOAD_SEGMENT_RENEWAL,       /* 接收出错, 需要从中断处重新请求 */
+} download_segment_status_t;
+
+typedef enum {
+    DOWNLOAD_DIGEST_BUFFER_FREE,    /* 空闲或者正在填充 */
+    DOWNLOAD_DIGEST_BUFFER_READY,   /* 已经填满, 等待计算 */
+    DOWNLOAD_DIGEST_BUFFER_BUSY,    /* 正在计算 */
+} download_digest_buffer_status_t;
+
 typedef enum {
     OTA_TYPE_FOTA,
     OTA_TYPE_CONFIG_PUSH,
@@ -67,6 +88,38 @@ typedef struct {
     void            *data_mutex;
 } ota_handle_t;
 
+/**
+ * @brief 分段并行下载时的单个连接, 每次请求固件中的一个块
+ *
+ */
+typedef struct {
+    void            *download_handle;
+    void            *http_handle;
+    uint8_t         status;
+    uint32_t        block_start;        /* 块在固件中的起始位置 */
+    uint32_t        block_len;
+    uint32_t        received;           /* 块内已经收到的字节数 */
+    uint32_t        request_len;        /* 当前请求期望收到的字节数, 用于校验应答的Content-Length */
+    uint8_t         renewal_count;      /* 没有收到新内容的连续续传次数 */
+    uint64_t        request_time;       /* 当前请求的发送时间 */
+    uint32_t        next_start;         /* 在同一连接上提前请求的下一个块, next_len为0时表示没有 */
+    uint32_t        next_len;
+    uint64_t        next_request_time;
+    uint8_t         *buffer;            /* 暂存尚未轮到交给用户的块内容 */
+    int32_t         http_rsp_status_code;
+    uint32_t        content_len;
+} download_segment_t;
+
+/**
+ * @brief 异步计算digest时交替使用的缓冲区
+ *
+ */
+typedef struct {
+    uint8_t         *buffer;
+    uint32_t        len;
+    uint8_t         status;
+} download_digest_buffer_t;
+
 /**
  * @brief 处理下载任务的句柄, 该句柄主要用于通过http协议从指定的url下载固件
  *
@@ -79,6 +132,12 @@ typedef struct {
     aiot_sysdep_portfile_t             *sysdep;
     uint32_t                           range_start;
     uint32_t                           range_end;
+    uint32_t                           segment_num;
+    uint32_t                           segment_size;
+    uint32_t                           adaptive_max_len;
+    uint8_t                            digest_async;
+    aiot_download_checkpoint_handler_t checkpoint_handler;
+    uint32_t                           checkpoint_interval;
 
     /*---- 以上都是用户在API可配 ----*/
     /*---- 以下都是downloader内部使用, 用户无感知 ----*/
@@ -93,6 +152,22 @@ typedef struct {
     void            *digest_ctx;
     void            *data_mutex;
     void            *recv_mutex;
+    download_segment_t *segments;
+    char            *segment_path;
+    uint32_t        segment_cursor;     /* 下一次aiot_download_recv处理的连接 */
+    uint32_t        segment_next;       /* 下一个待分配的块在固件中的起始位置 */
+    uint32_t        segment_end;        /* 分段下载区间的结束位置(不含) */
+    uint8_t         segment_checked;    /* 已经收到过与请求范围一致的206应答 */
+    uint8_t         segment_disabled;   /* 服务端不支持Range或者续传次数过多, 改用单连接下载 */
+    uint32_t        deliver_offset;     /* 下一个交给用户的字节在固件中的位置 */
+    download_digest_buffer_t digest_buffer[OTA_DIGEST_BUFFER_NUM];
+    uint8_t         digest_fill;        /* 正在填充的缓冲区 */
+    uint8_t         digest_next;        /* 下一个要计算的缓冲区, 保证按固件顺序计算 */
+    void            *digest_mutex;
+    aiot_download_stats_t stats;        /* 所有字段都在digest_mutex内更新 */
+    uint64_t        stats_start_time;
+    uint64_t        deliver_stage_ms;   /* 交付阶段(digest和用户回调)的累计耗时, 用于从接收耗时中扣除 */
+    uint32_t        checkpoint_offset;  /* 上一次给出断点记录时的位置 */
 } download_handle_t;
 
 typedef struct {
@@ -95,6 +95,8 @@ static void _shadow_recv_message_handler(void *handle, const aiot_mqtt_recv_t *m
     char status[10] = { 0 };
     char *version_str = NULL;
     uint32_t version_strlen = 0;
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
 
     if (NULL == shadow_handle->recv_handler) {
         return;
@@ -111,18 +113,19 @@ static void _shadow_recv_message_handler(void *handle, const aiot_mqtt_recv_t *m
         recv.device_name = dn;
 
         /* parse the message */
-        if ((res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   SHADOW_JSON_KEY_METHOD, strlen(SHADOW_JSON_KEY_METHOD), &method, &method_len) < 0) ||
-            (res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   SHADOW_JSON_KEY_TIMESTAMP, strlen(SHADOW_JSON_KEY_TIMESTAMP), &value, &value_len) < 0) ||
+        core_json_index(&index, (char *)msg->data.pub.payload, msg->data.pub.payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+        if ((res = core_json_index_value(&index,
+                                         SHADOW_JSON_KEY_METHOD, strlen(SHADOW_JSON_KEY_METHOD), &method, &method_len) < 0) ||
+            (res = core_json_index_value(&index,
+                                         SHADOW_JSON_KEY_TIMESTAMP, strlen(SHADOW_JSON_KEY_TIMESTAMP), &value, &value_len) < 0) ||
             (res = core_str2uint64(value, value_len, &timestamp) < 0) ||
-            (res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                   SHADOW_JSON_KEY_PAYLOAD, strlen(SHADOW_JSON_KEY_PAYLOAD), &payload, &payload_len) < 0)) {
+            (res = core_json_index_value(&index,
+                                         SHADOW_JSON_KEY_PAYLOAD, strlen(SHADOW_JSON_KEY_PAYLOAD), &payload, &payload_len) < 0)) {
             break;
         }
 
-        if (core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                            SHADOW_JSON_KEY_VERSION, strlen(SHADOW_JSON_KEY_VERSION), &version_str, &version_strlen) == STATE_SUCCESS) {
+        if (core_json_index_value(&index,
+                                  SHADOW_JSON_KEY_VERSION, strlen(SHADOW_JSON_KEY_VERSION), &version_str, &version_strlen) == STATE_SUCCESS) {
             core_str2uint64(version_str, version_strlen, &version);
         }
 
@@ -141,11 +144,11 @@ static void _shadow_recv_message_handler(void *handle, const aiot_mqtt_recv_t *m
         } /* reply message */
         else if (method_len == strlen("reply") && !memcmp(method, "reply", method_len)) {
             /* get_reply */
-            if (core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                SHADOW_JSON_KEY_STATE, strlen(SHADOW_JSON_KEY_STATE), &value, &value_len) < 0) {
+            if (core_json_index_value(&index,
+                                      SHADOW_JSON_KEY_STATE, strlen(SHADOW_JSON_KEY_STATE), &value, &value_len) < 0) {
 
-                if ((res = core_json_value((char *)msg->data.pub.payload, msg->data.pub.payload_len,
-                                           SHADOW_JSON_KEY_STATUS, strlen(SHADOW_JSON_KEY_STATUS), &value, &value_len) < 0) ||
+                if ((res = core_json_index_value(&index,
+                                                 SHADOW_JSON_KEY_STATUS, strlen(SHADOW_JSON_KEY_STATUS), &value, &value_len) < 0) ||
                     (value_len >= sizeof(status))) {
                     break;
                 }
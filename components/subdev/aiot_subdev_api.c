@@ -14,7 +14,6 @@
 #include "core_log.h"
 #include "core_sha256.h"
 #include "core_mqtt.h"
-#include "cJSON.h"
 
 static void _subdev_topo_generic_reply_recv_handler(void *handle, const aiot_mqtt_recv_t *packet, void *userdata, aiot_subdev_recv_type_t type, uint8_t pk_pos)
 {
@@ -29,11 +28,15 @@ static void _subdev_topo_generic_reply_recv_handler(void *handle, const aiot_mqt
             char *id = NULL, *code = NULL, *data = NULL, *data_str = NULL, *message = NULL, *message_str = NULL;
             uint32_t id_len = 0, code_len = 0, data_len = 0, message_len = 0, id_num = 0, code_num = 0;
             aiot_subdev_recv_t recv;
-
-            if (core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "id", strlen("id"), &id, &id_len) < STATE_SUCCESS ||
-                core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "code", strlen("code"), &code, &code_len) < STATE_SUCCESS ||
-                core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "data", strlen("data"), &data, &data_len) < STATE_SUCCESS ||
-                core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "message", strlen("message"), &message, &message_len) < STATE_SUCCESS) {
+            core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+            core_json_index_t index;
+
+            core_json_index(&index, (char *)packet->data.pub.payload, packet->data.pub.payload_len, tokens,
+                            CORE_JSON_INDEX_TOKENS);
+            if (core_json_index_value(&index, "id", strlen("id"), &id, &id_len) < STATE_SUCCESS ||
+                core_json_index_value(&index, "code", strlen("code"), &code, &code_len) < STATE_SUCCESS ||
+                core_json_index_value(&index, "data", strlen("data"), &data, &data_len) < STATE_SUCCESS ||
+                core_json_index_value(&index, "message", strlen("message"), &message, &message_len) < STATE_SUCCESS) {
                 aiot_subdev_event_t event;
 
                 memset(&event, 0, sizeof(aiot_subdev_event_t));
@@ -122,9 +125,13 @@ static void _subdev_topo_generic_notify_recv_handler(void *handle, const aiot_mq
             char *id = NULL, *params = NULL, *params_str = NULL;
             uint32_t id_len = 0, params_len = 0, id_num = 0;
             aiot_subdev_recv_t recv;
+            core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+            core_json_index_t index;
 
-            if (core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "id", strlen("id"), &id, &id_len) < STATE_SUCCESS ||
-                core_json_value((const char *)packet->data.pub.payload, packet->data.pub.payload_len, "params", strlen("params"), &params, &params_len) < STATE_SUCCESS) {
+            core_json_index(&index, (char *)packet->data.pub.payload, packet->data.pub.payload_len, tokens,
+                            CORE_JSON_INDEX_TOKENS);
+            if (core_json_index_value(&index, "id", strlen("id"), &id, &id_len) < STATE_SUCCESS ||
+                core_json_index_value(&index, "params", strlen("params"), &params, &params_len) < STATE_SUCCESS) {
                 aiot_subdev_event_t event;
 
                 memset(&event, 0, sizeof(aiot_subdev_event_t));
@@ -254,219 +261,233 @@ static int32_t _subdev_operate_topic_map(subdev_handle_t *subdev_handle, aiot_mq
     return res;
 }
 
-static int32_t _subdev_send_message(subdev_handle_t *subdev_handle, char *topic_fmt, cJSON *root)
+/* 按alink请求格式写入{"id":"...","version":"1.0","params":, params的内容由调用者继续写入 */
+static int32_t _subdev_writer_begin(subdev_handle_t *subdev_handle, core_json_writer_t *writer, char *id_string,
+                                    uint32_t params_len)
 {
     int32_t res = STATE_SUCCESS;
-    char *topic = NULL, *payload = NULL;
-    char *topic_src[] = { core_mqtt_get_product_key(subdev_handle->mqtt_handle), core_mqtt_get_device_name(subdev_handle->mqtt_handle) };
 
-    res = core_sprintf(subdev_handle->sysdep, &topic, topic_fmt, topic_src, sizeof(topic_src)/sizeof(char *), SUBDEV_MODULE_NAME);
+    res = core_json_writer_init(writer, subdev_handle->sysdep, CORE_MQTT_PUB_HEADROOM,
+                                SUBDEV_JSON_HEADER_LEN + params_len, SUBDEV_MODULE_NAME);
     if (res < STATE_SUCCESS) {
         return res;
     }
 
-    payload = cJSON_PrintUnformatted(root);
-    if (payload == NULL) {
-        subdev_handle->sysdep->core_sysdep_free(topic);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
+    core_json_writer_object_begin(writer);
+    core_json_writer_key(writer, "id");
+    core_json_writer_string(writer, id_string);
+    core_json_writer_key(writer, "version");
+    core_json_writer_string(writer, "1.0");
+    core_json_writer_key(writer, "params");
 
-    res = aiot_mqtt_pub(subdev_handle->mqtt_handle, topic, (uint8_t *)payload, (uint32_t)strlen(payload), 0);
-    subdev_handle->sysdep->core_sysdep_free(topic);
-    subdev_handle->sysdep->core_sysdep_free(payload);
+    return STATE_SUCCESS;
+}
 
-    return res;
+static void _subdev_writer_string(core_json_writer_t *writer, char *key, char *value)
+{
+    core_json_writer_key(writer, key);
+    core_json_writer_string(writer, value);
 }
 
-static int32_t _subdev_calculate_sign(subdev_handle_t *subdev_handle, aiot_subdev_dev_t *dev, char *clientid, char *timestamp, char sign_str[65])
+/* payload直接在writer的缓冲区中发送, 报文头写入预留的headroom */
+static int32_t _subdev_send_message(subdev_handle_t *subdev_handle, char *topic_fmt, core_json_writer_t *writer)
 {
     int32_t res = STATE_SUCCESS;
-    uint8_t sign[32] = {0};
-    char *plain_text = NULL;
-    char *plain_text_src[] = { clientid, dev->device_name, dev->product_key, timestamp };
-    char *plain_text_fmt = "clientId%sdeviceName%sproductKey%stimestamp%s";
+    char topic_buf[SUBDEV_STACK_BUFFER_LEN];
+    char *topic = NULL;
+    void *topic_src[] = { core_mqtt_get_product_key(subdev_handle->mqtt_handle), core_mqtt_get_device_name(subdev_handle->mqtt_handle) };
+
+    core_json_writer_object_end(writer);
+    if (writer->error < STATE_SUCCESS) {
+        return writer->error;
+    }
 
-    res = core_sprintf(subdev_handle->sysdep, &plain_text, plain_text_fmt, plain_text_src, sizeof(plain_text_src)/sizeof(char *), SUBDEV_MODULE_NAME);
+    res = core_sprintf_buf(subdev_handle->sysdep, topic_buf, sizeof(topic_buf), &topic, topic_fmt, topic_src,
+                           sizeof(topic_src)/sizeof(void *), SUBDEV_MODULE_NAME);
     if (res < STATE_SUCCESS) {
         return res;
     }
 
-    core_hmac_sha256((uint8_t *)plain_text, (uint32_t)strlen(plain_text), (uint8_t *)dev->device_secret, (uint32_t)strlen(dev->device_secret), sign);
-    core_hex2str(sign, 32, sign_str, 0);
+    res = core_mqtt_pub_inplace(subdev_handle->mqtt_handle, topic, writer->buffer + writer->headroom, writer->len, 0);
+    if (topic != topic_buf) {
+        subdev_handle->sysdep->core_sysdep_free(topic);
+    }
 
-    subdev_handle->sysdep->core_sysdep_free(plain_text);
+    return res;
+}
 
-    return STATE_SUCCESS;
+/* 为一组子设备生成clientId和签名原文, 再用多路HMAC-SHA256一次算出整组签名 */
+static void _subdev_sign_batch(subdev_handle_t *subdev_handle, aiot_subdev_dev_t dev[], uint32_t num, char *ext_client_id,
+                               char *timestamp, subdev_sign_slot_t slot[])
+{
+    uint32_t idx = 0, count = 0;
+    const uint8_t *msg[SUBDEV_SIGN_BATCH_NUM], *key[SUBDEV_SIGN_BATCH_NUM];
+    uint32_t msg_len[SUBDEV_SIGN_BATCH_NUM], key_len[SUBDEV_SIGN_BATCH_NUM];
+    uint8_t sign[SUBDEV_SIGN_BATCH_NUM][32];
+    char *plain_text_fmt = "clientId%sdeviceName%sproductKey%stimestamp%s";
+
+    for (idx = 0; idx < num; idx++) {
+        void *client_id_src[] = { dev[idx].product_key, dev[idx].device_name, ext_client_id };
+
+        slot[idx].client_id = NULL;
+        slot[idx].plain_text = NULL;
+        slot[idx].res = core_sprintf_buf(subdev_handle->sysdep, slot[idx].client_id_buf, sizeof(slot[idx].client_id_buf),
+                                         &slot[idx].client_id, "%s.%s%s", client_id_src, sizeof(client_id_src)/sizeof(void *),
+                                         SUBDEV_MODULE_NAME);
+        if (slot[idx].res < STATE_SUCCESS) {
+            continue;
+        }
+        {
+            void *plain_text_src[] = { slot[idx].client_id, dev[idx].device_name, dev[idx].product_key, timestamp };
+            slot[idx].res = core_sprintf_buf(subdev_handle->sysdep, slot[idx].plain_text_buf, sizeof(slot[idx].plain_text_buf),
+                                             &slot[idx].plain_text, plain_text_fmt, plain_text_src,
+                                             sizeof(plain_text_src)/sizeof(void *), SUBDEV_MODULE_NAME);
+        }
+        if (slot[idx].res < STATE_SUCCESS) {
+            continue;
+        }
+
+        msg[count] = (const uint8_t *)slot[idx].plain_text;
+        msg_len[count] = (uint32_t)slot[idx].res;
+        key[count] = (const uint8_t *)dev[idx].device_secret;
+        key_len[count] = (uint32_t)strlen(dev[idx].device_secret);
+        count++;
+    }
+
+    core_hmac_sha256_multi(msg, msg_len, key, key_len, sign, count);
+
+    for (idx = 0, count = 0; idx < num; idx++) {
+        if (slot[idx].res < STATE_SUCCESS) {
+            continue;
+        }
+        core_hex2str(sign[count++], 32, slot[idx].sign_str, 0);
+        slot[idx].sign_str[64] = 0;
+    }
+}
+
+static void _subdev_sign_batch_release(subdev_handle_t *subdev_handle, uint32_t num, subdev_sign_slot_t slot[])
+{
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < num; idx++) {
+        if (slot[idx].client_id != NULL && slot[idx].client_id != slot[idx].client_id_buf) {
+            subdev_handle->sysdep->core_sysdep_free(slot[idx].client_id);
+        }
+        if (slot[idx].plain_text != NULL && slot[idx].plain_text != slot[idx].plain_text_buf) {
+            subdev_handle->sysdep->core_sysdep_free(slot[idx].plain_text);
+        }
+    }
 }
 
 static int32_t _subdev_calculate_product_register_sign(subdev_handle_t *subdev_handle, aiot_subdev_dev_t *dev, char *random, char sign_str[65])
 {
     int32_t res = STATE_SUCCESS;
     uint8_t sign[32] = {0};
+    char plain_text_buf[SUBDEV_STACK_BUFFER_LEN];
     char *plain_text = NULL;
-    char *plain_text_src[] = { dev->device_name, dev->product_key, random };
+    void *plain_text_src[] = { dev->device_name, dev->product_key, random };
     char *plain_text_fmt = "deviceName%sproductKey%srandom%s";
 
-    res = core_sprintf(subdev_handle->sysdep, &plain_text, plain_text_fmt, plain_text_src, sizeof(plain_text_src)/sizeof(char *), SUBDEV_MODULE_NAME);
+    res = core_sprintf_buf(subdev_handle->sysdep, plain_text_buf, sizeof(plain_text_buf), &plain_text, plain_text_fmt,
+                           plain_text_src, sizeof(plain_text_src)/sizeof(void *), SUBDEV_MODULE_NAME);
     if (res < STATE_SUCCESS) {
         return res;
     }
 
-    core_hmac_sha256((uint8_t *)plain_text, (uint32_t)strlen(plain_text), (uint8_t *)dev->product_secret, (uint32_t)strlen(dev->product_secret), sign);
+    core_hmac_sha256((uint8_t *)plain_text, (uint32_t)res, (uint8_t *)dev->product_secret, (uint32_t)strlen(dev->product_secret), sign);
     core_hex2str(sign, 32, sign_str, 0);
 
-    subdev_handle->sysdep->core_sysdep_free(plain_text);
+    if (plain_text != plain_text_buf) {
+        subdev_handle->sysdep->core_sysdep_free(plain_text);
+    }
 
     return STATE_SUCCESS;
 }
 
-static int32_t _subdev_topo_add_append_params(subdev_handle_t *subdev_handle, cJSON *params, aiot_subdev_dev_t *dev, char *timestamp)
+static int32_t _subdev_topo_add_append_params(core_json_writer_t *writer, aiot_subdev_dev_t *dev, char *timestamp,
+        subdev_sign_slot_t *slot)
 {
-    int32_t res = STATE_SUCCESS;
-    cJSON *param = NULL;
-    char *client_id = NULL, sign_str[65] = {0};
-
-    param = cJSON_CreateObject();
-    if (param == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    if (slot->res < STATE_SUCCESS) {
+        return slot->res;
     }
 
-    client_id = subdev_handle->sysdep->core_sysdep_malloc(strlen(dev->product_key) + strlen(dev->device_name) + 2, SUBDEV_MODULE_NAME);
-    if (client_id == NULL) {
-        cJSON_Delete(param);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-    memset(client_id, 0, strlen(dev->product_key) + strlen(dev->device_name) + 2);
-    memcpy(client_id, dev->product_key, strlen(dev->product_key));
-    memcpy(client_id + strlen(client_id), ".", strlen("."));
-    memcpy(client_id + strlen(client_id), dev->device_name, strlen(dev->device_name));
-
-    cJSON_AddStringToObject(param, "productKey", dev->product_key);
-    cJSON_AddStringToObject(param, "deviceName", dev->device_name);
-    cJSON_AddStringToObject(param, "clientId", client_id);
-    cJSON_AddStringToObject(param, "timestamp", timestamp);
-    cJSON_AddStringToObject(param, "signmethod", "hmacSha256");
-
-    res = _subdev_calculate_sign(subdev_handle, dev, client_id, timestamp, sign_str);
-    subdev_handle->sysdep->core_sysdep_free(client_id);
-    if (res < STATE_SUCCESS) {
-        cJSON_Delete(param);
-        return res;
-    }
-
-    cJSON_AddStringToObject(param, "sign", sign_str);
-
-    cJSON_AddItemToArray(params, param);
+    core_json_writer_object_begin(writer);
+    _subdev_writer_string(writer, "productKey", dev->product_key);
+    _subdev_writer_string(writer, "deviceName", dev->device_name);
+    _subdev_writer_string(writer, "clientId", slot->client_id);
+    _subdev_writer_string(writer, "timestamp", timestamp);
+    _subdev_writer_string(writer, "signmethod", "hmacSha256");
+    _subdev_writer_string(writer, "sign", slot->sign_str);
+    core_json_writer_object_end(writer);
 
     return STATE_SUCCESS;
 }
 
-static int32_t _subdev_append_pk_dn_to_params(subdev_handle_t *subdev_handle, cJSON *params, aiot_subdev_dev_t *dev)
+static int32_t _subdev_append_pk_dn_to_params(subdev_handle_t *subdev_handle, core_json_writer_t *writer, aiot_subdev_dev_t *dev)
 {
-    cJSON *param = NULL;
-
-    param = cJSON_CreateObject();
-    if (param == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    cJSON_AddStringToObject(param, "productKey", dev->product_key);
-    cJSON_AddStringToObject(param, "deviceName", dev->device_name);
-
-    cJSON_AddItemToArray(params, param);
+    core_json_writer_object_begin(writer);
+    _subdev_writer_string(writer, "productKey", dev->product_key);
+    _subdev_writer_string(writer, "deviceName", dev->device_name);
+    core_json_writer_object_end(writer);
 
     return STATE_SUCCESS;
 }
 
-static int32_t _subdev_topo_delete_append_params(subdev_handle_t *subdev_handle, cJSON *params, aiot_subdev_dev_t *dev)
+static int32_t _subdev_topo_delete_append_params(subdev_handle_t *subdev_handle, core_json_writer_t *writer, aiot_subdev_dev_t *dev)
 {
-    return _subdev_append_pk_dn_to_params(subdev_handle, params, dev);
+    return _subdev_append_pk_dn_to_params(subdev_handle, writer, dev);
 }
 
-static int32_t _subdev_batch_login_append_device_list(subdev_handle_t *subdev_handle, cJSON *device_list, aiot_subdev_dev_t *dev, char *timestamp)
+static int32_t _subdev_batch_login_append_device_list(core_json_writer_t *writer, aiot_subdev_dev_t *dev, char *timestamp,
+        subdev_sign_slot_t *slot)
 {
-    int32_t res = STATE_SUCCESS;
-    cJSON *param = NULL;
-    char *client_id = NULL, sign_str[65] = {0};
-    char *ext_client_id = "|_ss=1,_v=sdk-c-4.1.0|";
-
-    param = cJSON_CreateObject();
-    if (param == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    uint32_t client_id_len = strlen(dev->product_key) + strlen(dev->device_name) + 2 + strlen(ext_client_id);
-    client_id = subdev_handle->sysdep->core_sysdep_malloc(client_id_len, SUBDEV_MODULE_NAME);
-    if (client_id == NULL) {
-        cJSON_Delete(param);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-    memset(client_id, 0, client_id_len);
-    memcpy(client_id, dev->product_key, strlen(dev->product_key));
-    memcpy(client_id + strlen(client_id), ".", strlen("."));
-    memcpy(client_id + strlen(client_id), dev->device_name, strlen(dev->device_name));
-    memcpy(client_id + strlen(client_id), ext_client_id, strlen(ext_client_id));
-
-    cJSON_AddStringToObject(param, "productKey", dev->product_key);
-    cJSON_AddStringToObject(param, "deviceName", dev->device_name);
-    cJSON_AddStringToObject(param, "clientId", client_id);
-    cJSON_AddStringToObject(param, "timestamp", timestamp);
-    cJSON_AddStringToObject(param, "cleanSession", "false");
-
-    res = _subdev_calculate_sign(subdev_handle, dev, client_id, timestamp, sign_str);
-    subdev_handle->sysdep->core_sysdep_free(client_id);
-    if (res < STATE_SUCCESS) {
-        cJSON_Delete(param);
-        return res;
+    if (slot->res < STATE_SUCCESS) {
+        return slot->res;
     }
 
-    cJSON_AddStringToObject(param, "sign", sign_str);
-
-    cJSON_AddItemToArray(device_list, param);
+    core_json_writer_object_begin(writer);
+    _subdev_writer_string(writer, "productKey", dev->product_key);
+    _subdev_writer_string(writer, "deviceName", dev->device_name);
+    _subdev_writer_string(writer, "clientId", slot->client_id);
+    _subdev_writer_string(writer, "timestamp", timestamp);
+    _subdev_writer_string(writer, "cleanSession", "false");
+    _subdev_writer_string(writer, "sign", slot->sign_str);
+    core_json_writer_object_end(writer);
 
     return STATE_SUCCESS;
 }
 
-static int32_t _subdev_batch_logout_append_params(subdev_handle_t *subdev_handle, cJSON *params, aiot_subdev_dev_t *dev)
+static int32_t _subdev_batch_logout_append_params(subdev_handle_t *subdev_handle, core_json_writer_t *writer, aiot_subdev_dev_t *dev)
 {
-    return _subdev_append_pk_dn_to_params(subdev_handle, params, dev);
+    return _subdev_append_pk_dn_to_params(subdev_handle, writer, dev);
 }
 
-static int32_t _subdev_sub_register_append_params(subdev_handle_t *subdev_handle, cJSON *params, aiot_subdev_dev_t *dev)
+static int32_t _subdev_sub_register_append_params(subdev_handle_t *subdev_handle, core_json_writer_t *writer, aiot_subdev_dev_t *dev)
 {
-    return _subdev_append_pk_dn_to_params(subdev_handle, params, dev);
+    return _subdev_append_pk_dn_to_params(subdev_handle, writer, dev);
 }
 
-static int32_t _subdev_product_register_append_params(subdev_handle_t *subdev_handle, cJSON *proxieds, aiot_subdev_dev_t *dev)
+static int32_t _subdev_product_register_append_params(subdev_handle_t *subdev_handle, core_json_writer_t *writer, aiot_subdev_dev_t *dev)
 {
     int32_t res = STATE_SUCCESS;
-    cJSON *param = NULL;
     uint8_t random[10] = {0};
     char random_str[21] = {0}, sign_str[65] = {0};
 
-    param = cJSON_CreateObject();
-    if (param == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
     subdev_handle->sysdep->core_sysdep_rand(random, 10);
     core_hex2str(random, 10, random_str, 0);
 
-    cJSON_AddStringToObject(param, "productKey", dev->product_key);
-    cJSON_AddStringToObject(param, "deviceName", dev->device_name);
-    cJSON_AddStringToObject(param, "random", random_str);
-    cJSON_AddStringToObject(param, "signMethod", "hmacSha256");
-
-
     res = _subdev_calculate_product_register_sign(subdev_handle, dev, random_str, sign_str);
     if (res < STATE_SUCCESS) {
-        cJSON_Delete(param);
         return res;
     }
 
-    cJSON_AddStringToObject(param, "sign", sign_str);
-
-    cJSON_AddItemToArray(proxieds, param);
+    core_json_writer_object_begin(writer);
+    _subdev_writer_string(writer, "productKey", dev->product_key);
+    _subdev_writer_string(writer, "deviceName", dev->device_name);
+    _subdev_writer_string(writer, "random", random_str);
+    _subdev_writer_string(writer, "signMethod", "hmacSha256");
+    _subdev_writer_string(writer, "sign", sign_str);
+    core_json_writer_object_end(writer);
 
     return STATE_SUCCESS;
 }
@@ -564,9 +585,10 @@ int32_t aiot_subdev_deinit(void **handle)
 int32_t aiot_subdev_send_topo_add(void *handle, aiot_subdev_dev_t dev[], uint32_t dev_num)
 {
     int32_t res = STATE_SUCCESS;
-    uint32_t idx = 0;
+    uint32_t idx = 0, batch_idx = 0, batch_num = 0;
+    subdev_sign_slot_t slot[SUBDEV_SIGN_BATCH_NUM];
     char timestamp[21] = {0};
-    cJSON *root = NULL, *params = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -602,28 +624,24 @@ int32_t aiot_subdev_send_topo_add(void *handle, aiot_subdev_dev_t dev[], uint32_
     /* timestamp */
     core_uint642str(subdev_handle->sysdep->core_sysdep_time(), timestamp, NULL);
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateArray();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_SIGN_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
-    for (idx = 0;idx < dev_num;idx++) {
-        _subdev_topo_add_append_params(subdev_handle, params, &dev[idx], timestamp);
+    core_json_writer_array_begin(&writer);
+    for (idx = 0;idx < dev_num;idx += batch_num) {
+        batch_num = (dev_num - idx < SUBDEV_SIGN_BATCH_NUM) ? (dev_num - idx) : SUBDEV_SIGN_BATCH_NUM;
+        _subdev_sign_batch(subdev_handle, &dev[idx], batch_num, "", timestamp, slot);
+        for (batch_idx = 0;batch_idx < batch_num;batch_idx++) {
+            _subdev_topo_add_append_params(&writer, &dev[idx + batch_idx], timestamp, &slot[batch_idx]);
+        }
+        _subdev_sign_batch_release(subdev_handle, batch_num, slot);
     }
+    core_json_writer_array_end(&writer);
 
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/add", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/add", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -635,7 +653,7 @@ int32_t aiot_subdev_send_topo_delete(void *handle, aiot_subdev_dev_t dev[], uint
 {
     int32_t res = STATE_SUCCESS;
     uint32_t idx = 0;
-    cJSON *root = NULL, *params = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -665,28 +683,19 @@ int32_t aiot_subdev_send_topo_delete(void *handle, aiot_subdev_dev_t dev[], uint
         return res;
     }
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateArray();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
+    core_json_writer_array_begin(&writer);
     for (idx = 0;idx < dev_num;idx++) {
-        _subdev_topo_delete_append_params(subdev_handle, params, &dev[idx]);
+        _subdev_topo_delete_append_params(subdev_handle, &writer, &dev[idx]);
     }
+    core_json_writer_array_end(&writer);
 
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/delete", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/delete", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -697,7 +706,7 @@ int32_t aiot_subdev_send_topo_delete(void *handle, aiot_subdev_dev_t dev[], uint
 int32_t aiot_subdev_send_topo_get(void *handle)
 {
     int32_t res = STATE_SUCCESS;
-    cJSON *root = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -706,11 +715,6 @@ int32_t aiot_subdev_send_topo_get(void *handle)
         return STATE_USER_INPUT_NULL_POINTER;
     }
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
     /* alink id */
     memset(id_string, 0, SUBDEV_ALINK_ID_MAX_LEN);
     core_global_alink_id_next(subdev_handle->sysdep, &id);
@@ -719,12 +723,15 @@ int32_t aiot_subdev_send_topo_get(void *handle)
         return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-    cJSON_AddStringToObject(root, "params", "{}");
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, 0);
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+
+    core_json_writer_string(&writer, "{}");
 
-    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/get", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/topo/get", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -735,9 +742,10 @@ int32_t aiot_subdev_send_topo_get(void *handle)
 int32_t aiot_subdev_send_batch_login(void *handle, aiot_subdev_dev_t dev[], uint32_t dev_num)
 {
     int32_t res = STATE_SUCCESS;
-    uint32_t idx = 0;
+    uint32_t idx = 0, batch_idx = 0, batch_num = 0;
+    subdev_sign_slot_t slot[SUBDEV_SIGN_BATCH_NUM];
     char timestamp[21] = {0};
-    cJSON *root = NULL, *params = NULL, *device_list = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -773,38 +781,28 @@ int32_t aiot_subdev_send_batch_login(void *handle, aiot_subdev_dev_t dev[], uint
     /* timestamp */
     core_uint642str(subdev_handle->sysdep->core_sysdep_time(), timestamp, NULL);
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateObject();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    device_list = cJSON_CreateArray();
-    if (device_list == NULL) {
-        cJSON_Delete(params);
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_SIGN_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
-    cJSON_AddStringToObject(params, "signMethod", "hmacSha256");
-
-    for (idx = 0;idx < dev_num;idx++) {
-        _subdev_batch_login_append_device_list(subdev_handle, device_list, &dev[idx], timestamp);
+    core_json_writer_object_begin(&writer);
+    _subdev_writer_string(&writer, "signMethod", "hmacSha256");
+    core_json_writer_key(&writer, "deviceList");
+    core_json_writer_array_begin(&writer);
+    for (idx = 0;idx < dev_num;idx += batch_num) {
+        batch_num = (dev_num - idx < SUBDEV_SIGN_BATCH_NUM) ? (dev_num - idx) : SUBDEV_SIGN_BATCH_NUM;
+        _subdev_sign_batch(subdev_handle, &dev[idx], batch_num, SUBDEV_EXT_CLIENT_ID, timestamp, slot);
+        for (batch_idx = 0;batch_idx < batch_num;batch_idx++) {
+            _subdev_batch_login_append_device_list(&writer, &dev[idx + batch_idx], timestamp, &slot[batch_idx]);
+        }
+        _subdev_sign_batch_release(subdev_handle, batch_num, slot);
     }
+    core_json_writer_array_end(&writer);
+    core_json_writer_object_end(&writer);
 
-    cJSON_AddItemToObject(params, "deviceList", device_list);
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/ext/session/%s/%s/combine/batch_login", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/ext/session/%s/%s/combine/batch_login", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -816,7 +814,7 @@ int32_t aiot_subdev_send_batch_logout(void *handle, aiot_subdev_dev_t dev[], uin
 {
     int32_t res = STATE_SUCCESS;
     uint32_t idx = 0;
-    cJSON *root = NULL, *params = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -846,28 +844,19 @@ int32_t aiot_subdev_send_batch_logout(void *handle, aiot_subdev_dev_t dev[], uin
         return res;
     }
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateArray();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
+    core_json_writer_array_begin(&writer);
     for (idx = 0;idx < dev_num;idx++) {
-        _subdev_batch_logout_append_params(subdev_handle, params, &dev[idx]);
+        _subdev_batch_logout_append_params(subdev_handle, &writer, &dev[idx]);
     }
+    core_json_writer_array_end(&writer);
 
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/ext/session/%s/%s/combine/batch_logout", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/ext/session/%s/%s/combine/batch_logout", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -879,7 +868,7 @@ int32_t aiot_subdev_send_sub_register(void *handle, aiot_subdev_dev_t dev[], uin
 {
     int32_t res = STATE_SUCCESS;
     uint32_t idx = 0;
-    cJSON *root = NULL, *params = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -909,28 +898,19 @@ int32_t aiot_subdev_send_sub_register(void *handle, aiot_subdev_dev_t dev[], uin
         return res;
     }
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateArray();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
+    core_json_writer_array_begin(&writer);
     for (idx = 0;idx < dev_num;idx++) {
-        _subdev_sub_register_append_params(subdev_handle, params, &dev[idx]);
+        _subdev_sub_register_append_params(subdev_handle, &writer, &dev[idx]);
     }
+    core_json_writer_array_end(&writer);
 
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/sub/register", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/sub/register", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
@@ -942,7 +922,7 @@ int32_t aiot_subdev_send_product_register(void *handle, aiot_subdev_dev_t dev[],
 {
     int32_t res = STATE_SUCCESS;
     uint32_t idx = 0;
-    cJSON *root = NULL, *params = NULL, *proxieds = NULL;
+    core_json_writer_t writer;
     int32_t id = 0;
     char id_string[SUBDEV_ALINK_ID_MAX_LEN] = { 0 };
     subdev_handle_t *subdev_handle = (subdev_handle_t *)handle;
@@ -975,40 +955,25 @@ int32_t aiot_subdev_send_product_register(void *handle, aiot_subdev_dev_t dev[],
         return res;
     }
 
-    root = cJSON_CreateObject();
-    if (root == NULL) {
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    params = cJSON_CreateObject();
-    if (params == NULL) {
-        cJSON_Delete(root);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-
-    proxieds = cJSON_CreateArray();
-    if (proxieds == NULL) {
-        cJSON_Delete(root);
-        cJSON_Delete(params);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    res = _subdev_writer_begin(subdev_handle, &writer, id_string, dev_num * SUBDEV_JSON_DEV_SIGN_LEN);
+    if (res < STATE_SUCCESS) {
+        return res;
     }
 
-    cJSON_AddStringToObject(root, "id", id_string);
-    cJSON_AddStringToObject(root, "version", "1.0");
-
+    core_json_writer_object_begin(&writer);
+    core_json_writer_key(&writer, "proxieds");
+    core_json_writer_array_begin(&writer);
     for (idx = 0;idx < dev_num;idx++) {
-        _subdev_product_register_append_params(subdev_handle, proxieds, &dev[idx]);
+        _subdev_product_register_append_params(subdev_handle, &writer, &dev[idx]);
     }
+    core_json_writer_array_end(&writer);
+    core_json_writer_object_end(&writer);
 
-    cJSON_AddItemToObject(params, "proxieds", proxieds);
-    cJSON_AddItemToObject(root, "params", params);
-
-    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/proxy/provisioning/product_register", root);
-    cJSON_Delete(root);
+    res = _subdev_send_message(subdev_handle, "/sys/%s/%s/thing/proxy/provisioning/product_register", &writer);
+    core_json_writer_deinit(&writer);
     if(res == STATE_SUCCESS) {
         return id;
     }
 
     return res;
 }
-
@@ -21,9 +21,20 @@ extern "C" {
 #include "aiot_sysdep_api.h"
 #include "aiot_subdev_api.h"      /* 内部头文件是用户可见头文件的超集 */
 #include "aiot_mqtt_api.h"
+#include "core_sha256.h"
 
 #define SUBDEV_ALINK_ID_MAX_LEN               (11)
 
+/* 预估的报文长度, 用于一次分配好JSON输出缓冲区: 报文头部分, 每个带签名的子设备, 每个只含pk/dn的子设备 */
+#define SUBDEV_JSON_HEADER_LEN                (96)
+#define SUBDEV_JSON_DEV_SIGN_LEN              (320)
+#define SUBDEV_JSON_DEV_LEN                   (96)
+/* 拼装topic、clientId和签名原文时优先使用的栈上缓冲区长度, 放不下时再从堆上分配 */
+#define SUBDEV_STACK_BUFFER_LEN               (256)
+/* 每组同时计算签名的子设备数量, 与SHA-256多路计算的路数一致 */
+#define SUBDEV_SIGN_BATCH_NUM                 (CORE_SHA256_LANES)
+#define SUBDEV_EXT_CLIENT_ID                  "|_ss=1,_v=sdk-c-4.1.0|"
+
 /* TODO: 定义subdev模块内部的会话句柄结构体, SDK用户不可见, 只能得到void *handle类型的指针 */
 typedef struct {
     aiot_sysdep_portfile_t     *sysdep;             /* 底层依赖回调合集的引用指针 */
@@ -40,6 +51,16 @@ typedef struct {
     void       *data_mutex;     /* 保护本地的数据结构 */
 } subdev_handle_t;
 
+/* 一个子设备的签名计算现场, clientId和签名原文优先放在栈上 */
+typedef struct {
+    char client_id_buf[SUBDEV_STACK_BUFFER_LEN];
+    char *client_id;
+    char plain_text_buf[SUBDEV_STACK_BUFFER_LEN];
+    char *plain_text;
+    char sign_str[65];
+    int32_t res;
+} subdev_sign_slot_t;
+
 #define SUBDEV_MODULE_NAME                    "subdev"  /* 用于内存统计的模块名字符串 */
 
 #define SUBDEV_TOPIC_TOPO_ADD_REPLY           "/sys/+/+/thing/topo/add_reply"
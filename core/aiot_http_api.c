@@ -0,0 +1,602 @@
+/**
+ * @file aiot_http_api.c
+ * @brief HTTP模块实现, 其中包含了向物联网平台认证和上报数据的API接口
+ * @date 2019-12-27
+ *
+ * @copyright Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ *
+ */
+
+#include "core_http.h"
+
+/* 读取一个完整应答时的上下文, body拼接后一次性交给用户 */
+typedef struct {
+    core_http_response_t response;
+    uint8_t notify_user;        /* 是否将状态码和header转交给用户的数据回调 */
+    int32_t error;              /* 接收回调中发生的错误, 应答读完后作为读取结果返回 */
+} http_recv_context_t;
+
+static void _http_exec_inc(core_http_handle_t *http_handle)
+{
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+    http_handle->exec_count++;
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+}
+
+static void _http_exec_dec(core_http_handle_t *http_handle)
+{
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+    http_handle->exec_count--;
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+}
+
+static void _http_token_clear(core_http_handle_t *http_handle)
+{
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+    if (http_handle->token != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->token);
+        http_handle->token = NULL;
+    }
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+}
+
+static void _http_event_notify(core_http_handle_t *http_handle, aiot_http_event_type_t type)
+{
+    aiot_http_event_t event;
+
+    if (http_handle->event_handler == NULL) {
+        return;
+    }
+
+    memset(&event, 0, sizeof(aiot_http_event_t));
+    event.type = type;
+    http_handle->event_handler(http_handle, &event, http_handle->userdata);
+}
+
+static void _http_recv_handler(void *handle, const aiot_http_recv_t *packet, void *userdata)
+{
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+    http_recv_context_t *context = (http_recv_context_t *)userdata;
+    core_http_response_t *response = &context->response;
+
+    switch (packet->type) {
+        case AIOT_HTTPRECV_STATUS_CODE: {
+            response->code = packet->data.status_code.code;
+        }
+        break;
+        case AIOT_HTTPRECV_HEADER: {
+            if (core_strcase_equal(packet->data.header.key, (uint32_t)strlen(packet->data.header.key),
+                                   "Content-Length") == 1) {
+                core_str2uint(packet->data.header.value, (uint32_t)strlen(packet->data.header.value),
+                              &response->content_total_len);
+            }
+        }
+        break;
+        case AIOT_HTTPRECV_BODY: {
+            uint8_t *content = NULL;
+            uint32_t capacity = response->content_total_len;
+
+            /* 之前的数据已经丢失, 后续的body不再拼接, 但仍要读完整个应答 */
+            if (context->error < STATE_SUCCESS) {
+                break;
+            }
+
+            /* 已知Content-Length时一次分配到位, chunked编码时按倍数扩大 */
+            if (response->content_len + packet->data.body.len > capacity) {
+                capacity = (capacity * 2 > response->content_len + packet->data.body.len) ?
+                           (capacity * 2) : (response->content_len + packet->data.body.len);
+            }
+            if (response->content == NULL || response->content_len + packet->data.body.len > response->content_total_len) {
+                content = http_handle->sysdep->core_sysdep_malloc(capacity + 1, CORE_HTTP_MODULE_NAME);
+                if (content == NULL) {
+                    context->error = STATE_PORT_MALLOC_FAILED;
+                    break;
+                }
+                if (response->content != NULL) {
+                    memcpy(content, response->content, response->content_len);
+                    http_handle->sysdep->core_sysdep_free(response->content);
+                }
+                response->content = content;
+                response->content_total_len = capacity;
+            }
+            memcpy(response->content + response->content_len, packet->data.body.buffer, packet->data.body.len);
+            response->content_len += packet->data.body.len;
+            response->content[response->content_len] = '\0';
+        }
+        break;
+        default: {
+        }
+        break;
+    }
+
+    if (context->notify_user == 1 && packet->type != AIOT_HTTPRECV_BODY && http_handle->recv_handler != NULL) {
+        http_handle->recv_handler(http_handle, packet, http_handle->userdata);
+    }
+}
+
+/* 读取一个完整的应答, 成功时response中为状态码和完整的body */
+static int32_t _http_recv_response(core_http_handle_t *http_handle, http_recv_context_t *context, uint32_t timeout_ms)
+{
+    int32_t res = STATE_SUCCESS;
+    uint64_t timenow_ms = http_handle->sysdep->core_sysdep_time();
+
+    memset(&context->response, 0, sizeof(core_http_response_t));
+    context->error = STATE_SUCCESS;
+    core_http_setopt(http_handle, CORE_HTTPOPT_RECV_HANDLER, (void *)_http_recv_handler);
+    core_http_setopt(http_handle, CORE_HTTPOPT_USERDATA, context);
+
+    while (1) {
+        if (timenow_ms > http_handle->sysdep->core_sysdep_time()) {
+            timenow_ms = http_handle->sysdep->core_sysdep_time();
+        }
+        if (http_handle->sysdep->core_sysdep_time() - timenow_ms >= timeout_ms) {
+            res = STATE_HTTP_RECV_NOT_FINISHED;
+            break;
+        }
+        res = core_http_recv(http_handle);
+        if (res == STATE_HTTP_READ_BODY_FINISHED || res == STATE_HTTP_READ_BODY_EMPTY) {
+            res = STATE_SUCCESS;
+            break;
+        } else if (res < STATE_SUCCESS) {
+            break;
+        }
+    }
+
+    /* 应答已经完整读出, 连接仍然可用, 只是body无法交给用户 */
+    if (res >= STATE_SUCCESS && context->error < STATE_SUCCESS) {
+        res = context->error;
+    }
+
+    /* 不使用长连接时, 每个应答读完后就断开 */
+    if (http_handle->long_connection == 0 && http_handle->network_handle != NULL) {
+        http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
+        http_handle->conn_idle = 0;
+    }
+
+    if (res < STATE_SUCCESS && context->response.content != NULL) {
+        http_handle->sysdep->core_sysdep_free(context->response.content);
+        context->response.content = NULL;
+        context->response.content_len = 0;
+    }
+
+    return res;
+}
+
+/* 解析上报应答中的业务码, token失效时清除缓存的token并通知用户 */
+static int32_t _http_rsp_code(core_http_handle_t *http_handle, core_http_response_t *response)
+{
+    char *value = NULL;
+    uint32_t value_len = 0, code = 0;
+
+    if (response->content == NULL ||
+        core_json_value((char *)response->content, response->content_len, "code", strlen("code"), &value,
+                        &value_len) < STATE_SUCCESS ||
+        core_str2uint(value, value_len, &code) < STATE_SUCCESS) {
+        return AIOT_HTTP_RSPCODE_COMMON_ERROR;
+    }
+
+    if (code == AIOT_HTTP_RSPCODE_TOKEN_EXPIRED || code == AIOT_HTTP_RSPCODE_TOKEN_NULL ||
+        code == AIOT_HTTP_RSPCODE_TOKEN_CHECK_ERROR) {
+        _http_token_clear(http_handle);
+        _http_event_notify(http_handle, AIOT_HTTPEVT_TOKEN_INVALID);
+    }
+
+    return (int32_t)code;
+}
+
+static void _http_recv_notify_body(core_http_handle_t *http_handle, core_http_response_t *response)
+{
+    aiot_http_recv_t packet;
+
+    if (http_handle->recv_handler == NULL) {
+        return;
+    }
+
+    memset(&packet, 0, sizeof(aiot_http_recv_t));
+    packet.type = AIOT_HTTPRECV_BODY;
+    packet.data.body.buffer = response->content;
+    packet.data.body.len = response->content_len;
+    http_handle->recv_handler(http_handle, &packet, http_handle->userdata);
+}
+
+/* 上报请求的header中携带缓存的token, 无需每条消息重新认证 */
+static int32_t _http_send_message(core_http_handle_t *http_handle, char *topic, uint8_t *payload, uint32_t payload_len)
+{
+    int32_t res = STATE_SUCCESS;
+    char header_buf[256], path_buf[128];
+    char *header = NULL, *path = NULL;
+    void *header_src[] = { NULL };
+    void *path_src[] = { topic };
+    core_http_request_t request;
+
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+    if (http_handle->token == NULL) {
+        http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+        return STATE_HTTP_NEED_AUTH;
+    }
+    header_src[0] = http_handle->token;
+    res = core_sprintf_buf(http_handle->sysdep, header_buf, sizeof(header_buf), &header,
+                           "Content-Type: application/octet-stream\r\nPassword: %s\r\n", header_src, 1, CORE_HTTP_MODULE_NAME);
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+    res = core_sprintf_buf(http_handle->sysdep, path_buf, sizeof(path_buf), &path, "/topic%s", path_src, 1,
+                           CORE_HTTP_MODULE_NAME);
+    if (res < STATE_SUCCESS) {
+        if (header != header_buf) {
+            http_handle->sysdep->core_sysdep_free(header);
+        }
+        return res;
+    }
+
+    memset(&request, 0, sizeof(core_http_request_t));
+    request.method = "POST";
+    request.path = path;
+    request.header = header;
+    request.content = payload;
+    request.content_len = payload_len;
+    res = core_http_send(http_handle, &request);
+
+    if (header != header_buf) {
+        http_handle->sysdep->core_sysdep_free(header);
+    }
+    if (path != path_buf) {
+        http_handle->sysdep->core_sysdep_free(path);
+    }
+
+    return res;
+}
+
+void *aiot_http_init(void)
+{
+    core_http_handle_t *http_handle = NULL;
+
+    http_handle = core_http_init();
+    if (http_handle == NULL) {
+        return NULL;
+    }
+
+    http_handle->port = 443;
+    http_handle->auth_timeout_ms = CORE_HTTP_DEFAULT_AUTH_TIMEOUT_MS;
+    http_handle->long_connection = 1;
+    http_handle->pipeline_window = CORE_HTTP_DEFAULT_PIPELINE_WINDOW;
+    http_handle->exec_enabled = 1;
+
+    return http_handle;
+}
+
+int32_t aiot_http_setopt(void *handle, aiot_http_option_t option, void *data)
+{
+    int32_t res = STATE_SUCCESS;
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+
+    if (http_handle == NULL || data == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+
+    if (option >= AIOT_HTTPOPT_MAX) {
+        return STATE_USER_INPUT_OUT_RANGE;
+    }
+
+    if (http_handle->exec_enabled == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    /* 以上选项配置的数据与 CORE_HTTPOPT_XXX 共用 */
+    if (option <= AIOT_HTTPOPT_EVENT_HANDLER) {
+        if (option == AIOT_HTTPOPT_HOST || option == AIOT_HTTPOPT_PORT) {
+            _http_token_clear(http_handle);
+        }
+        return core_http_setopt(handle, (core_http_option_t)option, data);
+    }
+
+    _http_exec_inc(http_handle);
+
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+    switch (option) {
+        case AIOT_HTTPOPT_USERDATA: {
+            http_handle->userdata = data;
+        }
+        break;
+        case AIOT_HTTPOPT_RECV_HANDLER: {
+            http_handle->recv_handler = (aiot_http_recv_handler_t)data;
+        }
+        break;
+        case AIOT_HTTPOPT_PRODUCT_KEY: {
+            res = core_strdup(http_handle->sysdep, &http_handle->product_key, (char *)data, CORE_HTTP_MODULE_NAME);
+        }
+        break;
+        case AIOT_HTTPOPT_DEVICE_NAME: {
+            res = core_strdup(http_handle->sysdep, &http_handle->device_name, (char *)data, CORE_HTTP_MODULE_NAME);
+        }
+        break;
+        case AIOT_HTTPOPT_DEVICE_SECRET: {
+            res = core_strdup(http_handle->sysdep, &http_handle->device_secret, (char *)data, CORE_HTTP_MODULE_NAME);
+        }
+        break;
+        case AIOT_HTTPOPT_EXTEND_DEVINFO: {
+            res = core_strdup(http_handle->sysdep, &http_handle->extend_devinfo, (char *)data, CORE_HTTP_MODULE_NAME);
+        }
+        break;
+        case AIOT_HTTPOPT_AUTH_TIMEOUT_MS: {
+            http_handle->auth_timeout_ms = *(uint32_t *)data;
+        }
+        break;
+        case AIOT_HTTPOPT_LONG_CONNECTION: {
+            http_handle->long_connection = *(uint8_t *)data;
+        }
+        break;
+        case AIOT_HTTPOPT_PIPELINE_WINDOW: {
+            if (*(uint32_t *)data == 0 || *(uint32_t *)data > CORE_HTTP_PIPELINE_WINDOW_MAX) {
+                res = STATE_USER_INPUT_OUT_RANGE;
+                break;
+            }
+            http_handle->pipeline_window = *(uint32_t *)data;
+        }
+        break;
+        default: {
+            res = STATE_USER_INPUT_UNKNOWN_OPTION;
+        }
+        break;
+    }
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+
+    /* 设备身份变化后原有的token不再有效 */
+    if (option == AIOT_HTTPOPT_PRODUCT_KEY || option == AIOT_HTTPOPT_DEVICE_NAME ||
+        option == AIOT_HTTPOPT_DEVICE_SECRET) {
+        _http_token_clear(http_handle);
+    }
+
+    _http_exec_dec(http_handle);
+
+    return res;
+}
+
+int32_t aiot_http_auth(void *handle)
+{
+    int32_t res = STATE_SUCCESS;
+    char *content = NULL, *token = NULL;
+    uint32_t token_len = 0, code = 0;
+    char *value = NULL;
+    uint32_t value_len = 0;
+    core_http_request_t request;
+    http_recv_context_t context;
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+
+    if (http_handle == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (http_handle->product_key == NULL) {
+        return STATE_USER_INPUT_MISSING_PRODUCT_KEY;
+    }
+    if (http_handle->device_name == NULL) {
+        return STATE_USER_INPUT_MISSING_DEVICE_NAME;
+    }
+    if (http_handle->device_secret == NULL) {
+        return STATE_USER_INPUT_MISSING_DEVICE_SECRET;
+    }
+    if (http_handle->exec_enabled == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    _http_exec_inc(http_handle);
+
+    res = core_auth_http_body(http_handle->sysdep, &content, http_handle->product_key, http_handle->device_name,
+                              http_handle->device_secret, CORE_HTTP_MODULE_NAME);
+    if (res < STATE_SUCCESS) {
+        _http_exec_dec(http_handle);
+        return res;
+    }
+
+    memset(&request, 0, sizeof(core_http_request_t));
+    request.method = "POST";
+    request.path = "/auth";
+    request.header = "Content-Type: application/json\r\n";
+    request.content = (uint8_t *)content;
+    request.content_len = (uint32_t)strlen(content);
+
+    res = core_http_connect(http_handle);
+    if (res == STATE_SUCCESS) {
+        res = core_http_send(http_handle, &request);
+    }
+    http_handle->sysdep->core_sysdep_free(content);
+    if (res < STATE_SUCCESS) {
+        _http_exec_dec(http_handle);
+        return res;
+    }
+
+    memset(&context, 0, sizeof(http_recv_context_t));
+    res = _http_recv_response(http_handle, &context, http_handle->auth_timeout_ms);
+    if (res < STATE_SUCCESS) {
+        _http_exec_dec(http_handle);
+        return (res == STATE_HTTP_RECV_NOT_FINISHED) ? STATE_HTTP_AUTH_NOT_FINISHED : res;
+    }
+
+    core_log1(http_handle->sysdep, STATE_HTTP_LOG_AUTH, "auth response code: %d\r\n", &context.response.code);
+    if (context.response.code != 200) {
+        res = STATE_HTTP_AUTH_CODE_FAILED;
+    } else if (context.response.content == NULL ||
+               core_json_value((char *)context.response.content, context.response.content_len, "code", strlen("code"),
+                               &value, &value_len) < STATE_SUCCESS ||
+               core_str2uint(value, value_len, &code) < STATE_SUCCESS || code != AIOT_HTTP_RSPCODE_SUCCESS) {
+        res = STATE_HTTP_AUTH_NOT_EXPECTED;
+    } else if (core_json_value((char *)context.response.content, context.response.content_len, "token",
+                               strlen("token"), &value, &value_len) < STATE_SUCCESS) {
+        res = STATE_HTTP_AUTH_TOKEN_FAILED;
+    } else {
+        token_len = value_len;
+        token = http_handle->sysdep->core_sysdep_malloc(token_len + 1, CORE_HTTP_MODULE_NAME);
+        if (token == NULL) {
+            res = STATE_SYS_DEPEND_MALLOC_FAILED;
+        } else {
+            memcpy(token, value, token_len);
+            token[token_len] = '\0';
+
+            _http_token_clear(http_handle);
+            http_handle->sysdep->core_sysdep_mutex_lock(http_handle->data_mutex);
+            http_handle->token = token;
+            http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->data_mutex);
+        }
+    }
+
+    if (context.response.content != NULL) {
+        http_handle->sysdep->core_sysdep_free(context.response.content);
+    }
+
+    _http_exec_dec(http_handle);
+
+    return res;
+}
+
+int32_t aiot_http_send(void *handle, char *topic, uint8_t *payload, uint32_t payload_len)
+{
+    int32_t res = STATE_SUCCESS;
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+
+    if (http_handle == NULL || topic == NULL || payload == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (payload_len == 0) {
+        return STATE_USER_INPUT_OUT_RANGE;
+    }
+    if (http_handle->exec_enabled == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    _http_exec_inc(http_handle);
+
+    /* 长连接时复用上一次的连接, 连接空闲且仍然可用时不会重新建连 */
+    res = core_http_connect(http_handle);
+    if (res == STATE_SUCCESS) {
+        res = _http_send_message(http_handle, topic, payload, payload_len);
+    }
+
+    _http_exec_dec(http_handle);
+
+    return res;
+}
+
+int32_t aiot_http_recv(void *handle)
+{
+    int32_t res = STATE_SUCCESS;
+    http_recv_context_t context;
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+
+    if (http_handle == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (http_handle->exec_enabled == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    _http_exec_inc(http_handle);
+
+    memset(&context, 0, sizeof(http_recv_context_t));
+    context.notify_user = 1;
+    res = _http_recv_response(http_handle, &context, http_handle->recv_timeout_ms);
+    if (res >= STATE_SUCCESS) {
+        _http_rsp_code(http_handle, &context.response);
+        _http_recv_notify_body(http_handle, &context.response);
+        res = (int32_t)context.response.content_len;
+    }
+
+    if (context.response.content != NULL) {
+        http_handle->sysdep->core_sysdep_free(context.response.content);
+    }
+
+    _http_exec_dec(http_handle);
+
+    return res;
+}
+
+int32_t aiot_http_send_batch(void *handle, aiot_http_msg_t *msgs, uint32_t msg_num)
+{
+    int32_t res = STATE_SUCCESS, send_res = STATE_SUCCESS;
+    uint32_t idx = 0, sent = 0, acked = 0, success = 0, window = 0;
+    http_recv_context_t context;
+    core_http_handle_t *http_handle = (core_http_handle_t *)handle;
+
+    if (http_handle == NULL || msgs == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (msg_num == 0) {
+        return STATE_USER_INPUT_OUT_RANGE;
+    }
+    for (idx = 0; idx < msg_num; idx++) {
+        if (msgs[idx].topic == NULL || msgs[idx].payload == NULL || msgs[idx].payload_len == 0) {
+            return STATE_USER_INPUT_OUT_RANGE;
+        }
+        msgs[idx].code = -1;
+        msgs[idx].state = AIOT_HTTP_MSG_STATE_NOT_SENT;
+    }
+    if (http_handle->exec_enabled == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    _http_exec_inc(http_handle);
+
+    res = core_http_connect(http_handle);
+    if (res < STATE_SUCCESS) {
+        _http_exec_dec(http_handle);
+        return res;
+    }
+
+    /*
+     * 默认收到应答后再发下一条; 用户开启流水线时同一连接上连续发出多个上报请求, 之后按顺序读取应答,
+     * 一个往返时延内可以完成一个窗口的上报. 不使用长连接时无法流水线发送, 窗口退化为1
+     */
+    window = (http_handle->long_connection == 0) ? 1 : http_handle->pipeline_window;
+    memset(&context, 0, sizeof(http_recv_context_t));
+    context.notify_user = 1;
+    while (acked < msg_num) {
+        while (send_res >= STATE_SUCCESS && sent < msg_num && sent - acked < window) {
+            if (http_handle->network_handle == NULL &&
+                (send_res = core_http_connect(http_handle)) < STATE_SUCCESS) {
+                break;
+            }
+            /* 发送失败时可能已经写出了部分数据, 同样无法确认平台是否收到 */
+            msgs[sent].state = AIOT_HTTP_MSG_STATE_SENT;
+            send_res = _http_send_message(http_handle, msgs[sent].topic, msgs[sent].payload, msgs[sent].payload_len);
+            if (send_res < STATE_SUCCESS) {
+                break;
+            }
+            sent++;
+        }
+        /* 发送失败后不再发送, 只读取已经发出的请求的应答 */
+        if (sent == acked) {
+            res = send_res;
+            break;
+        }
+
+        res = _http_recv_response(http_handle, &context, http_handle->recv_timeout_ms);
+        if (res < STATE_SUCCESS) {
+            break;
+        }
+        msgs[acked].state = AIOT_HTTP_MSG_STATE_ACKED;
+        msgs[acked].code = _http_rsp_code(http_handle, &context.response);
+        if (msgs[acked].code == AIOT_HTTP_RSPCODE_SUCCESS) {
+            success++;
+        }
+        _http_recv_notify_body(http_handle, &context.response);
+        if (context.response.content != NULL) {
+            http_handle->sysdep->core_sysdep_free(context.response.content);
+            context.response.content = NULL;
+        }
+        acked++;
+    }
+
+    _http_exec_dec(http_handle);
+
+    /* 中途失败时返回错误码, 由用户根据每条消息的state决定重新上报哪些消息 */
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+
+    return (int32_t)success;
+}
+
+int32_t aiot_http_deinit(void **p_handle)
+{
+    return core_http_deinit(p_handle);
+}
@@ -251,6 +251,19 @@ typedef enum {
      * 数据类型: (uint8_t *) 默认值: (5 * 1000) ms
      */
     AIOT_HTTPOPT_LONG_CONNECTION,
+    /**
+     * @brief @ref aiot_http_send_batch 在同一连接上最多连续发出而未收到应答的请求数
+     *
+     * @details
+     *
+     * 默认值为1, 即收到上一条消息的应答后再发送下一条. 配置为大于1时开启流水线发送, 一次往返时延内可以上报多条消息.
+     *
+     * 注意: 上报请求不是幂等的, 流水线发送时若连接在读取应答前断开, 已经发出的多条消息都无法确认平台是否收到,
+     * 这些消息的状态为 @ref AIOT_HTTP_MSG_STATE_SENT, 用户重新上报时平台可能收到重复的消息
+     *
+     * 数据类型: (uint32_t *) 取值范围: 1~8, 默认值: 1
+     */
+    AIOT_HTTPOPT_PIPELINE_WINDOW,
 
     AIOT_HTTPOPT_MAX
 } aiot_http_option_t;
@@ -361,6 +374,50 @@ typedef struct {
  */
 typedef void (* aiot_http_event_handler_t)(void *handle, const aiot_http_event_t *event, void *userdata);
 
+/**
+ * @brief 批量上报时单条消息的上报状态
+ */
+typedef enum {
+    /**
+     * @brief 消息没有发出, 可以放心地重新上报
+     */
+    AIOT_HTTP_MSG_STATE_NOT_SENT,
+    /**
+     * @brief 消息已经发出, 但没有读到完整的应答, 无法确认平台是否收到, 重新上报时平台可能收到重复的消息
+     */
+    AIOT_HTTP_MSG_STATE_SENT,
+    /**
+     * @brief 已经收到平台的应答, 业务状态码见 code 成员
+     */
+    AIOT_HTTP_MSG_STATE_ACKED
+} aiot_http_msg_state_t;
+
+/**
+ * @brief 批量上报时的单条消息, 用于 @ref aiot_http_send_batch
+ */
+typedef struct {
+    /**
+     * @brief 上报的目标topic
+     */
+    char *topic;
+    /**
+     * @brief 指向上报数据的指针
+     */
+    uint8_t *payload;
+    /**
+     * @brief 上报数据的长度
+     */
+    uint32_t payload_len;
+    /**
+     * @brief 服务器应答中的业务状态码, 参考 @ref aiot_http_response_code_t, state不是 @ref AIOT_HTTP_MSG_STATE_ACKED 时为-1
+     */
+    int32_t code;
+    /**
+     * @brief 消息的上报状态, 参考 @ref aiot_http_msg_state_t
+     */
+    aiot_http_msg_state_t state;
+} aiot_http_msg_t;
+
 /**
  * @brief 创建一个HTTP上云实例
  *
@@ -449,9 +506,38 @@ int32_t aiot_http_send(void *handle, char *topic, uint8_t *payload, uint32_t pay
  * @retval STATE_HTTP_RECV_LINE_TOO_LONG, HTTP单行数据过长, 内部无法解析
  * @retval STATE_HTTP_PARSE_STATUS_LINE_FAILED, 无法解析状态码
  * @retval STATE_HTTP_GET_CONTENT_LEN_FAILED, 获取Content-Length失败
+ * @retval STATE_PORT_MALLOC_FAILED, 内存不足, 应答已经读完但无法保存body
  */
 int32_t aiot_http_recv(void *handle);
 
+/**
+ * @brief 批量上报多条消息到物联网平台, 并读取每条消息的应答
+ *
+ * @details
+ *
+ * 在同一个长连接上依次上报多条消息, 默认收到上一条消息的应答后再发送下一条. 通过 @ref AIOT_HTTPOPT_PIPELINE_WINDOW
+ * 可以开启流水线发送, 连续发出多个上报请求后再按顺序读取应答, 此时连接异常可能导致消息被重复上报, 详见该选项的说明.
+ *
+ * 每条消息的上报状态写入对应的 state 成员, 业务状态码写入 code 成员,
+ * 应答的状态码, header和body也会从用户设置的 @ref aiot_http_recv_handler_t 回调函数输出
+ *
+ * 当 @ref AIOT_HTTPOPT_LONG_CONNECTION 配置为0时, 始终逐条发送并读取应答
+ *
+ * @param[in] handle HTTP句柄
+ * @param[in,out] msgs 待上报的消息数组
+ * @param[in] msg_num 消息数量
+ *
+ * @return int32_t
+ *
+ * @retval >= 0, 全部消息都收到了应答, 返回值为业务状态码为 @ref AIOT_HTTP_RSPCODE_SUCCESS 的消息数量
+ * @retval STATE_USER_INPUT_NULL_POINTER, 用户输入参数为NULL
+ * @retval STATE_USER_INPUT_OUT_RANGE, msg_num为0或消息参数无效
+ * @retval STATE_HTTP_NEED_AUTH, 设备未认证
+ * @retval STATE_PORT_MALLOC_FAILED, 内存不足, 无法保存应答内容
+ * @retval 其他小于0的值, 上报中途失败, 需要根据每条消息的 state 判断哪些消息需要重新上报
+ */
+int32_t aiot_http_send_batch(void *handle, aiot_http_msg_t *msgs, uint32_t msg_num);
+
 /**
  * @brief 销毁参数p_handle所指定的HTTP实例
  *
@@ -57,6 +57,17 @@ static void _core_mqtt_connect_event_notify(core_mqtt_handle_t *mqtt_handle)
     }
 }
 
+/* 断线时调用, 首次重连在[0, interval)内随机延迟, 避免大量设备同时重连 */
+static void _core_mqtt_reconnect_reset(core_mqtt_handle_t *mqtt_handle)
+{
+    core_mqtt_reconnect_t *params = &mqtt_handle->reconnect_params;
+
+    if (params->backoff == AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL) {
+        params->last_retry_time = mqtt_handle->sysdep->core_sysdep_time();
+        params->next_interval_ms = core_rand_range(mqtt_handle->sysdep, params->interval_ms);
+    }
+}
+
 static void _core_mqtt_disconnect_event_notify(core_mqtt_handle_t *mqtt_handle,
         aiot_mqtt_disconnect_event_type_t disconnect)
 {
@@ -64,6 +75,7 @@ static void _core_mqtt_disconnect_event_notify(core_mqtt_handle_t *mqtt_handle,
         aiot_mqtt_event_t event;
 
         mqtt_handle->disconnected = 1;
+        _core_mqtt_reconnect_reset(mqtt_handle);
 
         memset(&event, 0, sizeof(aiot_mqtt_event_t));
         event.type = AIOT_MQTTEVT_DISCONNECT;
@@ -81,20 +93,26 @@ static void _core_mqtt_disconnect_event_notify(core_mqtt_handle_t *mqtt_handle,
 
 static void _core_mqtt_exec_inc(core_mqtt_handle_t *mqtt_handle)
 {
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->data_mutex);
-    mqtt_handle->exec_count++;
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->data_mutex);
+    core_atomic_add_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->exec_count, 1);
 }
 
 static void _core_mqtt_exec_dec(core_mqtt_handle_t *mqtt_handle)
 {
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->data_mutex);
-    mqtt_handle->exec_count--;
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->data_mutex);
+    core_atomic_sub_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->exec_count, 1);
+}
+
+static void _core_mqtt_conn_pkt_clean(core_mqtt_handle_t *mqtt_handle)
+{
+    if (mqtt_handle->conn_pkt) {
+        mqtt_handle->sysdep->core_sysdep_free(mqtt_handle->conn_pkt);
+        mqtt_handle->conn_pkt = NULL;
+        mqtt_handle->conn_pkt_len = 0;
+    }
 }
 
 static void _core_mqtt_sign_clean(core_mqtt_handle_t *mqtt_handle)
 {
+    _core_mqtt_conn_pkt_clean(mqtt_handle);
     if (mqtt_handle->username) {
         mqtt_handle->sysdep->core_sysdep_free(mqtt_handle->username);
         mqtt_handle->username = NULL;
@@ -290,9 +308,9 @@ static int32_t _core_mqtt_append_topic_map(core_mqtt_handle_t *mqtt_handle, aiot
     topic_buff.buffer = (uint8_t *)map->topic;
     topic_buff.len = strlen(map->topic);
 
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->sub_mutex);
+    core_rwlock_wrlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
     res = _core_mqtt_sublist_insert(mqtt_handle, &topic_buff, map->handler, map->userdata);
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->sub_mutex);
+    core_rwlock_unlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
 
     return res;
 }
@@ -316,9 +334,9 @@ static int32_t _core_mqtt_remove_topic_map(core_mqtt_handle_t *mqtt_handle, aiot
     topic_buff.buffer = (uint8_t *)map->topic;
     topic_buff.len = strlen(map->topic);
 
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->sub_mutex);
+    core_rwlock_wrlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
     _core_mqtt_sublist_remove_handler(mqtt_handle, &topic_buff, map->handler);
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->sub_mutex);
+    core_rwlock_unlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
 
     return STATE_SUCCESS;
 }
@@ -565,10 +583,9 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
     int32_t res = 0;
     core_sysdep_socket_type_t socket_type = CORE_SYSDEP_SOCKET_TCP_CLIENT;
     char backup_ip[16] = {0};
-    uint8_t *conn_pkt = NULL;
     uint8_t connack_fixed_header = 0;
     uint8_t *connack_ptr = NULL;
-    uint32_t conn_pkt_len = 0;
+    uint64_t prepare_timestamp = 0, connack_timestamp = 0;
     char *secure_mode = (mqtt_handle->cred == NULL) ? ("3") : ("2");
     uint32_t remain_len = 0;
 
@@ -586,6 +603,7 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
         secure_mode = "3";
     }
 
+    prepare_timestamp = mqtt_handle->sysdep->core_sysdep_time();
     if (mqtt_handle->username == NULL || mqtt_handle->password == NULL ||
         mqtt_handle->clientid == NULL) {
 
@@ -605,6 +623,8 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
         core_log1(mqtt_handle->sysdep, STATE_MQTT_LOG_USERNAME, "user name: %s\r\n", (void *)mqtt_handle->username);
     }
 
+    mqtt_handle->nwkstats_info.prepare_time_used = (uint32_t)(mqtt_handle->sysdep->core_sysdep_time() - prepare_timestamp);
+
     if (mqtt_handle->network_handle != NULL) {
         mqtt_handle->sysdep->core_sysdep_network_deinit(&mqtt_handle->network_handle);
     }
@@ -680,6 +700,7 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
     mqtt_handle->nwkstats_info.connect_time_used = mqtt_handle->sysdep->core_sysdep_time() \
             - mqtt_handle->nwkstats_info.connect_timestamp;
 
+    prepare_timestamp = mqtt_handle->sysdep->core_sysdep_time();
     if (mqtt_handle->clientid == NULL) {
         char *extend_clientid = NULL;
         _core_mqtt_add_extend_clientid(mqtt_handle, &extend_clientid, mqtt_handle->extend_clientid);
@@ -695,15 +716,18 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
         }
         /* core_log1(mqtt_handle->sysdep, STATE_MQTT_LOG_CLIENTID, "%s\r\n", (void *)mqtt_handle->clientid); */
     }
-    /* Get MQTT Connect Packet */
-    res = _core_mqtt_conn_pkt(mqtt_handle, &conn_pkt, &conn_pkt_len);
-    if (res < STATE_SUCCESS) {
-        return res;
+    /* Get MQTT Connect Packet, 鉴权信息未变化时复用上次编码的报文 */
+    if (mqtt_handle->conn_pkt == NULL) {
+        res = _core_mqtt_conn_pkt(mqtt_handle, &mqtt_handle->conn_pkt, &mqtt_handle->conn_pkt_len);
+        if (res < STATE_SUCCESS) {
+            return res;
+        }
     }
+    mqtt_handle->nwkstats_info.prepare_time_used += (uint32_t)(mqtt_handle->sysdep->core_sysdep_time() - prepare_timestamp);
 
     /* Send MQTT Connect Packet */
-    res = _core_mqtt_write(mqtt_handle, conn_pkt, conn_pkt_len, mqtt_handle->send_timeout_ms);
-    mqtt_handle->sysdep->core_sysdep_free(conn_pkt);
+    connack_timestamp = mqtt_handle->sysdep->core_sysdep_time();
+    res = _core_mqtt_write(mqtt_handle, mqtt_handle->conn_pkt, mqtt_handle->conn_pkt_len, mqtt_handle->send_timeout_ms);
     if (res < STATE_SUCCESS) {
         if (res == STATE_SYS_DEPEND_NWK_WRITE_LESSDATA) {
             core_log1(mqtt_handle->sysdep, STATE_MQTT_LOG_CONNECT_TIMEOUT, "MQTT connect packet send timeout: %d\r\n",
@@ -770,6 +794,7 @@ static int32_t _core_mqtt_connect(core_mqtt_handle_t *mqtt_handle)
 
     res = _core_mqtt_connack_handle(mqtt_handle, connack_ptr, remain_len);
     mqtt_handle->sysdep->core_sysdep_free(connack_ptr);
+    mqtt_handle->nwkstats_info.connack_time_used = (uint32_t)(mqtt_handle->sysdep->core_sysdep_time() - connack_timestamp);
     if (res < STATE_SUCCESS) {
         mqtt_handle->sysdep->core_sysdep_network_deinit(&mqtt_handle->network_handle);
         return res;
@@ -806,16 +831,16 @@ static int32_t _core_mqtt_disconnect(core_mqtt_handle_t *mqtt_handle)
 
 static uint16_t _core_mqtt_packet_id(core_mqtt_handle_t *mqtt_handle)
 {
-    uint16_t packet_id = 0;
+    uint32_t packet_id = core_atomic_load_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->packet_id);
+    uint32_t next = 0;
 
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->data_mutex);
-    if ((uint16_t)(mqtt_handle->packet_id + 1) == 0) {
-        mqtt_handle->packet_id = 0;
-    }
-    packet_id = ++mqtt_handle->packet_id;
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->data_mutex);
+    /* 取值范围1~65535, 0为MQTT协议保留值 */
+    do {
+        next = (packet_id >= 0xFFFF) ? (1) : (packet_id + 1);
+    } while (core_atomic_cas_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->packet_id, &packet_id,
+                                 next) == 0);
 
-    return packet_id;
+    return (uint16_t)next;
 }
 
 static int32_t _core_mqtt_publist_insert(core_mqtt_handle_t *mqtt_handle, uint8_t *packet, uint32_t len,
@@ -1118,15 +1143,46 @@ static void _core_mqtt_process_data_process(core_mqtt_handle_t *mqtt_handle, cor
     mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->process_handler_mutex);
 }
 
+static uint32_t _core_mqtt_reconnect_interval(core_mqtt_handle_t *mqtt_handle)
+{
+    core_mqtt_reconnect_t *params = &mqtt_handle->reconnect_params;
+
+    switch (params->backoff) {
+        case AIOT_MQTT_RECONN_BACKOFF_LINEAR: {
+            return params->interval_ms * (params->reconnect_counter + 1) + params->rand_ms;
+        }
+        case AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL: {
+            return params->next_interval_ms;
+        }
+        default: {
+            return params->interval_ms;
+        }
+    }
+}
+
+/* decorrelated jitter: next = min(max_interval, random_between(interval, next * 3)) */
+static void _core_mqtt_reconnect_backoff_next(core_mqtt_handle_t *mqtt_handle)
+{
+    core_mqtt_reconnect_t *params = &mqtt_handle->reconnect_params;
+    uint64_t upper = (uint64_t)params->next_interval_ms * 3;
+    uint32_t cap = (params->max_interval_ms > params->interval_ms) ? (params->max_interval_ms) : (params->interval_ms);
+
+    if (upper > cap) {
+        upper = cap;
+    }
+    if (upper <= params->interval_ms) {
+        params->next_interval_ms = params->interval_ms;
+        return;
+    }
+    params->next_interval_ms = params->interval_ms + core_rand_range(mqtt_handle->sysdep,
+                               (uint32_t)upper - params->interval_ms);
+}
+
 static int32_t _core_mqtt_reconnect(core_mqtt_handle_t *mqtt_handle)
 {
     int32_t res = STATE_SYS_DEPEND_NWK_CLOSED;
     uint64_t time_now = 0;
-    uint32_t interval_ms = mqtt_handle->reconnect_params.interval_ms;
-    if (mqtt_handle->reconnect_params.backoff_enabled) {
-        interval_ms = mqtt_handle->reconnect_params.interval_ms * (mqtt_handle->reconnect_params.reconnect_counter + 1) +
-                      mqtt_handle->reconnect_params.rand_ms;
-    }
+    uint32_t interval_ms = _core_mqtt_reconnect_interval(mqtt_handle);
 
     if (mqtt_handle->network_handle != NULL) {
         return STATE_SUCCESS;
@@ -1139,16 +1195,19 @@ static int32_t _core_mqtt_reconnect(core_mqtt_handle_t *mqtt_handle)
     if (time_now < mqtt_handle->reconnect_params.last_retry_time) {
         mqtt_handle->reconnect_params.last_retry_time = time_now;
     }
-    if (time_now >= (mqtt_handle->reconnect_params.last_retry_time + interval_ms)) {
+    if (time_now >= (mqtt_handle->reconnect_params.last_retry_time + interval_ms) &&
+        (res = core_global_acquire_connect_token(mqtt_handle->sysdep)) >= STATE_SUCCESS) {
         core_log(mqtt_handle->sysdep, STATE_MQTT_LOG_RECONNECTING, "MQTT network disconnect, try to reconnecting...\r\n");
         res = _core_mqtt_connect(mqtt_handle);
         mqtt_handle->reconnect_params.last_retry_time = mqtt_handle->sysdep->core_sysdep_time();
-        if (mqtt_handle->reconnect_params.backoff_enabled) {
-            if (STATE_MQTT_CONNECT_SUCCESS == res) {
-                mqtt_handle->reconnect_params.reconnect_counter = 0;
-            } else if (mqtt_handle->reconnect_params.reconnect_counter < CORE_MQTT_DEFAULT_RECONN_MAX_COUNTERS) {
+        if (STATE_MQTT_CONNECT_SUCCESS == res) {
+            mqtt_handle->reconnect_params.reconnect_counter = 0;
+            mqtt_handle->reconnect_params.next_interval_ms = mqtt_handle->reconnect_params.interval_ms;
+        } else {
+            if (mqtt_handle->reconnect_params.reconnect_counter < CORE_MQTT_DEFAULT_RECONN_MAX_COUNTERS) {
                 mqtt_handle->reconnect_params.reconnect_counter++;
             }
+            _core_mqtt_reconnect_backoff_next(mqtt_handle);
         }
     }
     mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->recv_mutex);
@@ -1374,14 +1433,14 @@ static void _core_mqtt_call_user_handler(core_mqtt_handle_t *mqtt_handle, core_m
 
     /* Search Packet Handler In sublist */
     CORE_INIT_LIST_HEAD(&handler_list_copy);
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->sub_mutex);
+    core_rwlock_rdlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
     core_list_for_each_entry(sub_node, &mqtt_handle->sub_list, linked_node, core_mqtt_sub_node_t) {
         if (_core_mqtt_topic_compare(sub_node->topic, (uint32_t)(strlen(sub_node->topic)), packet.data.pub.topic,
                                      packet.data.pub.topic_len) == STATE_SUCCESS) {
             _core_mqtt_handlerlist_append(mqtt_handle, &handler_list_copy, &sub_node->handle_list, &sub_found);
         }
     }
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->sub_mutex);
+    core_rwlock_unlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
 
     core_list_for_each_entry(handler_node, &handler_list_copy,
                              linked_node, core_mqtt_sub_handler_node_t) {
@@ -1614,8 +1673,10 @@ void *aiot_mqtt_init(void)
         core_global_deinit(sysdep);
         return NULL;
     }
-    sysdep->core_sysdep_rand((uint8_t *)&rand_value, sizeof(rand_value));
+    rand_value = core_rand_u32(sysdep);
     memset(mqtt_handle, 0, sizeof(core_mqtt_handle_t));
+    core_atomic_init_u32(&mqtt_handle->exec_count, 0);
+    core_atomic_init_u32(&mqtt_handle->packet_id, 0);
 
     mqtt_handle->sysdep = sysdep;
     mqtt_handle->keep_alive_s = CORE_MQTT_DEFAULT_KEEPALIVE_S;
@@ -1625,7 +1686,9 @@ void *aiot_mqtt_init(void)
     mqtt_handle->heartbeat_params.max_lost_times = CORE_MQTT_DEFAULT_HEARTBEAT_MAX_LOST_TIMES;
     mqtt_handle->reconnect_params.enabled = CORE_MQTT_DEFAULT_RECONN_ENABLED;
     mqtt_handle->reconnect_params.interval_ms = CORE_MQTT_DEFAULT_RECONN_INTERVAL_MS;
-    mqtt_handle->reconnect_params.backoff_enabled = 1;
+    mqtt_handle->reconnect_params.backoff = CORE_MQTT_DEFAULT_RECONN_BACKOFF;
+    mqtt_handle->reconnect_params.max_interval_ms = CORE_MQTT_DEFAULT_RECONN_MAX_INTERVAL_MS;
+    mqtt_handle->reconnect_params.next_interval_ms = CORE_MQTT_DEFAULT_RECONN_INTERVAL_MS;
     mqtt_handle->reconnect_params.rand_ms = rand_value % CORE_MQTT_DEFAULT_RECONN_RANDLIMIT_MS -
                                             CORE_MQTT_DEFAULT_RECONN_RANDLIMIT_MS / 2;
     mqtt_handle->reconnect_params.reconnect_counter = 0;
@@ -1638,9 +1701,10 @@ void *aiot_mqtt_init(void)
     mqtt_handle->data_mutex = sysdep->core_sysdep_mutex_init();
     mqtt_handle->send_mutex = sysdep->core_sysdep_mutex_init();
     mqtt_handle->recv_mutex = sysdep->core_sysdep_mutex_init();
-    mqtt_handle->sub_mutex = sysdep->core_sysdep_mutex_init();
+    mqtt_handle->sub_rwlock = core_rwlock_init(sysdep);
     mqtt_handle->pub_mutex = sysdep->core_sysdep_mutex_init();
     mqtt_handle->process_handler_mutex = sysdep->core_sysdep_mutex_init();
+    mqtt_handle->counter_lock = core_spinlock_init(sysdep);
 
     CORE_INIT_LIST_HEAD(&mqtt_handle->sub_list);
     CORE_INIT_LIST_HEAD(&mqtt_handle->pub_list);
@@ -1704,18 +1768,22 @@ int32_t aiot_mqtt_setopt(void *handle, aiot_mqtt_option_t option, void *data)
         break;
         case AIOT_MQTTOPT_USERNAME: {
             res = core_strdup(mqtt_handle->sysdep, &mqtt_handle->username, (char *)data, CORE_MQTT_MODULE_NAME);
+            _core_mqtt_conn_pkt_clean(mqtt_handle);
         }
         break;
         case AIOT_MQTTOPT_PASSWORD: {
             res = core_strdup(mqtt_handle->sysdep, &mqtt_handle->password, (char *)data, CORE_MQTT_MODULE_NAME);
+            _core_mqtt_conn_pkt_clean(mqtt_handle);
         }
         break;
         case AIOT_MQTTOPT_CLIENTID: {
             res = core_strdup(mqtt_handle->sysdep, &mqtt_handle->clientid, (char *)data, CORE_MQTT_MODULE_NAME);
+            _core_mqtt_conn_pkt_clean(mqtt_handle);
         }
         break;
         case AIOT_MQTTOPT_KEEPALIVE_SEC: {
             mqtt_handle->keep_alive_s = *(uint16_t *)data;
+            _core_mqtt_conn_pkt_clean(mqtt_handle);
         }
         break;
         case AIOT_MQTTOPT_CLEAN_SESSION: {
@@ -1723,6 +1791,7 @@ int32_t aiot_mqtt_setopt(void *handle, aiot_mqtt_option_t option, void *data)
                 res = STATE_USER_INPUT_OUT_RANGE;
             }
             mqtt_handle->clean_session = *(uint8_t *)data;
+            _core_mqtt_conn_pkt_clean(mqtt_handle);
         }
         break;
         case AIOT_MQTTOPT_NETWORK_CRED: {
@@ -1760,7 +1829,8 @@ int32_t aiot_mqtt_setopt(void *handle, aiot_mqtt_option_t option, void *data)
         break;
         case AIOT_MQTTOPT_RECONN_INTERVAL_MS: {
             mqtt_handle->reconnect_params.interval_ms = *(uint32_t *)data;
-            mqtt_handle->reconnect_params.backoff_enabled = 0;
+            mqtt_handle->reconnect_params.next_interval_ms = *(uint32_t *)data;
+            mqtt_handle->reconnect_params.backoff = AIOT_MQTT_RECONN_BACKOFF_NONE;
         }
         break;
         case AIOT_MQTTOPT_SEND_TIMEOUT_MS: {
@@ -1819,6 +1889,23 @@ int32_t aiot_mqtt_setopt(void *handle, aiot_mqtt_option_t option, void *data)
             }
         }
         break;
+        case AIOT_MQTTOPT_RECONN_BACKOFF: {
+            if (*(aiot_mqtt_reconn_backoff_t *)data > AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL) {
+                res = STATE_USER_INPUT_OUT_RANGE;
+                break;
+            }
+            mqtt_handle->reconnect_params.backoff = *(aiot_mqtt_reconn_backoff_t *)data;
+        }
+        break;
+        case AIOT_MQTTOPT_RECONN_MAX_INTERVAL_MS: {
+            mqtt_handle->reconnect_params.max_interval_ms = *(uint32_t *)data;
+        }
+        break;
+        case AIOT_MQTTOPT_RECONN_RATE_LIMIT: {
+            aiot_mqtt_reconn_rate_limit_t *limit = (aiot_mqtt_reconn_rate_limit_t *)data;
+            res = core_global_set_connect_rate(mqtt_handle->sysdep, limit->rate, limit->burst);
+        }
+        break;
         
         default: {
             res = STATE_USER_INPUT_UNKNOWN_OPTION;
@@ -1850,13 +1937,13 @@ int32_t aiot_mqtt_deinit(void **handle)
     mqtt_handle->exec_enabled = 0;
     deinit_timestart = mqtt_handle->sysdep->core_sysdep_time();
     do {
-        if (mqtt_handle->exec_count == 0) {
+        if (core_atomic_load_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->exec_count) == 0) {
             break;
         }
         mqtt_handle->sysdep->core_sysdep_sleep(CORE_MQTT_DEINIT_INTERVAL_MS);
     } while ((mqtt_handle->sysdep->core_sysdep_time() - deinit_timestart) < mqtt_handle->deinit_timeout_ms);
 
-    if (mqtt_handle->exec_count != 0) {
+    if (core_atomic_load_u32(mqtt_handle->sysdep, mqtt_handle->counter_lock, &mqtt_handle->exec_count) != 0) {
         return STATE_MQTT_DEINIT_TIMEOUT;
     }
 
@@ -1890,6 +1977,9 @@ int32_t aiot_mqtt_deinit(void **handle)
     if (mqtt_handle->clientid != NULL) {
         mqtt_handle->sysdep->core_sysdep_free(mqtt_handle->clientid);
     }
+    if (mqtt_handle->conn_pkt != NULL) {
+        mqtt_handle->sysdep->core_sysdep_free(mqtt_handle->conn_pkt);
+    }
     if (mqtt_handle->extend_clientid != NULL) {
         mqtt_handle->sysdep->core_sysdep_free(mqtt_handle->extend_clientid);
     }
@@ -1903,9 +1993,10 @@ int32_t aiot_mqtt_deinit(void **handle)
     mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->data_mutex);
     mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->send_mutex);
     mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->recv_mutex);
-    mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->sub_mutex);
+    core_rwlock_deinit(mqtt_handle->sysdep, &mqtt_handle->sub_rwlock);
     mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->pub_mutex);
     mqtt_handle->sysdep->core_sysdep_mutex_deinit(&mqtt_handle->process_handler_mutex);
+    core_spinlock_deinit(mqtt_handle->sysdep, &mqtt_handle->counter_lock);
 
     _core_mqtt_sublist_destroy(mqtt_handle);
     _core_mqtt_publist_destroy(mqtt_handle);
@@ -2049,34 +2140,31 @@ int32_t aiot_mqtt_process(void *handle)
     return res;
 }
 
-static int32_t _core_mqtt_pub(void *handle, core_mqtt_buff_t *topic, core_mqtt_buff_t *payload, uint8_t qos)
+/* payload之前留有CORE_MQTT_PUB_HEADER_MAXLEN(topic->len)字节, 在其中紧贴payload填写报文头后直接发送 */
+static int32_t _core_mqtt_pub_packet(core_mqtt_handle_t *mqtt_handle, core_mqtt_buff_t *topic, uint8_t *payload,
+                                     uint32_t payload_len, uint8_t qos)
 {
     int32_t res = STATE_SUCCESS;
     uint16_t packet_id = 0;
-    uint8_t *pkt = NULL;
-    uint32_t idx = 0, remainlen = 0, pkt_len = 0;
-    core_mqtt_handle_t *mqtt_handle = (core_mqtt_handle_t *)handle;
-
-    _core_mqtt_exec_inc(mqtt_handle);
+    uint8_t *pkt = NULL, remainlen_bytes[CORE_MQTT_REMAINLEN_MAXLEN] = {0};
+    uint32_t idx = 0, remainlen = 0, remainlen_bytes_len = 0, header_len = 0, pkt_len = 0;
 
-    remainlen = topic->len + payload->len + CORE_MQTT_UTF8_STR_EXTRA_LEN;
+    remainlen = topic->len + payload_len + CORE_MQTT_UTF8_STR_EXTRA_LEN;
     if (qos == CORE_MQTT_QOS1) {
         remainlen += CORE_MQTT_PACKETID_LEN;
     }
+    _core_mqtt_remain_len_encode(remainlen, remainlen_bytes, &remainlen_bytes_len);
 
-    pkt_len = CORE_MQTT_FIXED_HEADER_LEN + CORE_MQTT_REMAINLEN_MAXLEN + remainlen;
-    pkt = mqtt_handle->sysdep->core_sysdep_malloc(pkt_len, CORE_MQTT_MODULE_NAME);
-    if (pkt == NULL) {
-        _core_mqtt_exec_dec(mqtt_handle);
-        return STATE_SYS_DEPEND_MALLOC_FAILED;
-    }
-    memset(pkt, 0, pkt_len);
+    header_len = CORE_MQTT_FIXED_HEADER_LEN + remainlen_bytes_len + remainlen - payload_len;
+    pkt = payload - header_len;
+    pkt_len = header_len + payload_len;
 
     /* Publish Packet Type */
     pkt[idx++] = CORE_MQTT_PUBLISH_PKT_TYPE | (qos << 1);
 
     /* Remaining Length */
-    _core_mqtt_remain_len_encode(remainlen, &pkt[idx], &idx);
+    memcpy(&pkt[idx], remainlen_bytes, remainlen_bytes_len);
+    idx += remainlen_bytes_len;
 
     /* Topic */
     _core_mqtt_set_utf8_encoded_str((uint8_t *)topic->buffer, topic->len, &pkt[idx]);
@@ -2084,33 +2172,24 @@ static int32_t _core_mqtt_pub(void *handle, core_mqtt_buff_t *topic, core_mqtt_b
 
     /* Packet Id For QOS 1*/
     if (qos == CORE_MQTT_QOS1) {
-        packet_id = _core_mqtt_packet_id(handle);
+        packet_id = _core_mqtt_packet_id(mqtt_handle);
         pkt[idx++] = (uint8_t)((packet_id >> 8) & 0x00FF);
         pkt[idx++] = (uint8_t)((packet_id) & 0x00FF);
     }
 
-    /* Payload */
-    memcpy(&pkt[idx], payload->buffer, payload->len);
-    idx += payload->len;
-
-    pkt_len = idx;
-
     if (qos == CORE_MQTT_QOS1) {
         mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->pub_mutex);
         res = _core_mqtt_publist_insert(mqtt_handle, pkt, pkt_len, packet_id);
         mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->pub_mutex);
         if (res < STATE_SUCCESS) {
-            mqtt_handle->sysdep->core_sysdep_free(pkt);
-            _core_mqtt_exec_dec(mqtt_handle);
             return res;
         }
     }
 
     mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->send_mutex);
-    res = _core_mqtt_write(handle, pkt, pkt_len, mqtt_handle->send_timeout_ms);
+    res = _core_mqtt_write(mqtt_handle, pkt, pkt_len, mqtt_handle->send_timeout_ms);
     mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->send_mutex);
     if (res < STATE_SUCCESS) {
-        mqtt_handle->sysdep->core_sysdep_free(pkt);
         if (res != STATE_SYS_DEPEND_NWK_WRITE_LESSDATA) {
             mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->send_mutex);
             mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->recv_mutex);
@@ -2120,20 +2199,40 @@ static int32_t _core_mqtt_pub(void *handle, core_mqtt_buff_t *topic, core_mqtt_b
             mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->recv_mutex);
             mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->send_mutex);
         }
-        _core_mqtt_exec_dec(mqtt_handle);
         return res;
     }
 
-    mqtt_handle->sysdep->core_sysdep_free(pkt);
-
     if (qos == CORE_MQTT_QOS1) {
-        _core_mqtt_exec_dec(mqtt_handle);
         return (int32_t)packet_id;
     }
 
+    return STATE_SUCCESS;
+}
+
+static int32_t _core_mqtt_pub(void *handle, core_mqtt_buff_t *topic, core_mqtt_buff_t *payload, uint8_t qos)
+{
+    int32_t res = STATE_SUCCESS;
+    uint8_t *pkt = NULL;
+    uint32_t headroom = CORE_MQTT_PUB_HEADER_MAXLEN(topic->len);
+    core_mqtt_handle_t *mqtt_handle = (core_mqtt_handle_t *)handle;
+
+    _core_mqtt_exec_inc(mqtt_handle);
+
+    pkt = mqtt_handle->sysdep->core_sysdep_malloc(headroom + payload->len, CORE_MQTT_MODULE_NAME);
+    if (pkt == NULL) {
+        _core_mqtt_exec_dec(mqtt_handle);
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+
+    /* Payload */
+    memcpy(&pkt[headroom], payload->buffer, payload->len);
+
+    res = _core_mqtt_pub_packet(mqtt_handle, topic, &pkt[headroom], payload->len, qos);
+    mqtt_handle->sysdep->core_sysdep_free(pkt);
+
     _core_mqtt_exec_dec(mqtt_handle);
 
-    return STATE_SUCCESS;
+    return res;
 }
 
 static int32_t _core_mqtt_pub_params_check(void *handle, char *topic, uint8_t *payload, uint32_t payload_len, uint8_t qos)
@@ -2184,7 +2283,7 @@ int32_t _core_mqtt_append_rid(core_mqtt_handle_t *mqtt_handle, char *topic, char
     memcpy(buffer, topic, strlen(topic));
     memcpy(buffer + strlen(buffer), rid_prefix, strlen(rid_prefix));
     core_uint642str(timestamp, buffer + strlen(buffer), NULL);
-    mqtt_handle->sysdep->core_sysdep_rand((uint8_t *)&rand, sizeof(rand));
+    rand = core_rand_u32(mqtt_handle->sysdep);
     core_uint2str(rand, buffer + strlen(buffer), NULL);
 
     *new_topic = buffer;
@@ -2271,6 +2370,36 @@ int32_t aiot_mqtt_pub(void *handle, char *topic, uint8_t *payload, uint32_t payl
     return res;
 }
 
+int32_t core_mqtt_pub_inplace(void *handle, char *topic, uint8_t *payload, uint32_t payload_len, uint8_t qos)
+{
+    core_mqtt_handle_t *mqtt_handle = (core_mqtt_handle_t *)handle;
+    core_mqtt_buff_t topic_buff;
+    int32_t res = STATE_SUCCESS;
+
+    /* 需要改写topic或payload时, 报文头无法放入预留空间, 按常规流程拷贝发送 */
+    if (mqtt_handle != NULL && (mqtt_handle->append_requestid == 1 || mqtt_handle->compress.handler != NULL)) {
+        return aiot_mqtt_pub(handle, topic, payload, payload_len, qos);
+    }
+
+    res = _core_mqtt_pub_params_check(handle, topic, payload, payload_len, qos);
+    if (res != STATE_SUCCESS) {
+        return res;
+    }
+
+    core_log1(mqtt_handle->sysdep, STATE_MQTT_LOG_TOPIC, "pub: %s\r\n", topic);
+    core_log_hexdump(STATE_MQTT_LOG_HEXDUMP, '>', payload, payload_len);
+
+    memset(&topic_buff, 0, sizeof(topic_buff));
+    topic_buff.buffer = (uint8_t *)topic;
+    topic_buff.len = strlen(topic);
+
+    _core_mqtt_exec_inc(mqtt_handle);
+    res = _core_mqtt_pub_packet(mqtt_handle, &topic_buff, payload, payload_len, qos);
+    _core_mqtt_exec_dec(mqtt_handle);
+
+    return res;
+}
+
 static int32_t _core_mqtt_sub(void *handle, core_mqtt_buff_t *topic, aiot_mqtt_recv_handler_t handler,
                               uint8_t qos, void *userdata)
 {
@@ -2294,9 +2423,9 @@ static int32_t _core_mqtt_sub(void *handle, core_mqtt_buff_t *topic, aiot_mqtt_r
 
     core_log2(mqtt_handle->sysdep, STATE_MQTT_LOG_TOPIC, "sub: %.*s\r\n", &topic->len, topic->buffer);
 
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->sub_mutex);
+    core_rwlock_wrlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
     res = _core_mqtt_sublist_insert(mqtt_handle, topic, handler, userdata);
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->sub_mutex);
+    core_rwlock_unlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
 
     if (res < STATE_SUCCESS) {
         return res;
@@ -2352,9 +2481,9 @@ static int32_t _core_mqtt_unsub(void *handle, core_mqtt_buff_t *topic)
 
     core_log2(mqtt_handle->sysdep, STATE_MQTT_LOG_TOPIC, "unsub: %.*s\r\n", &topic->len, topic->buffer);
 
-    mqtt_handle->sysdep->core_sysdep_mutex_lock(mqtt_handle->sub_mutex);
+    core_rwlock_wrlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
     _core_mqtt_sublist_remove(mqtt_handle, topic);
-    mqtt_handle->sysdep->core_sysdep_mutex_unlock(mqtt_handle->sub_mutex);
+    core_rwlock_unlock(mqtt_handle->sysdep, mqtt_handle->sub_rwlock);
 
     res = _core_mqtt_subunsub(mqtt_handle, (char *)topic->buffer, topic->len, 0, CORE_MQTT_UNSUB_PKT_TYPE);
 
@@ -187,6 +187,43 @@ typedef struct {
  */
 typedef void (*aiot_mqtt_event_handler_t)(void *handle, const aiot_mqtt_event_t *event, void *userdata);
 
+/**
+ * @brief 使用 @ref aiot_mqtt_setopt 配置 @ref AIOT_MQTTOPT_RECONN_BACKOFF 时的数据
+ */
+typedef enum {
+    /**
+     * @brief 按@ref AIOT_MQTTOPT_RECONN_INTERVAL_MS 固定间隔重连
+     */
+    AIOT_MQTT_RECONN_BACKOFF_NONE,
+    /**
+     * @brief 重连间隔随连续失败次数线性增长, 并叠加实例创建时生成的随机偏移, 为默认策略
+     */
+    AIOT_MQTT_RECONN_BACKOFF_LINEAR,
+    /**
+     * @brief 指数退避并叠加去相关抖动(decorrelated jitter), 间隔上限由@ref AIOT_MQTTOPT_RECONN_MAX_INTERVAL_MS 指定
+     *
+     * @details
+     *
+     * 每次失败后的间隔在[基础间隔, 上一次间隔*3]之间随机选取, 断线后的首次重连也会随机延迟,
+     * 避免大量设备在服务端恢复后同时发起连接. 需要通过@ref AIOT_MQTTOPT_RECONN_BACKOFF 显式开启
+     */
+    AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL,
+} aiot_mqtt_reconn_backoff_t;
+
+/**
+ * @brief 使用 @ref aiot_mqtt_setopt 配置 @ref AIOT_MQTTOPT_RECONN_RATE_LIMIT 时的数据
+ */
+typedef struct {
+    /**
+     * @brief 每秒允许发起的重连次数, 为0时不限速
+     */
+    uint32_t rate;
+    /**
+     * @brief 令牌桶容量, 即允许的突发重连次数, 为0时按1处理
+     */
+    uint32_t burst;
+} aiot_mqtt_reconn_rate_limit_t;
+
 /**
  * @brief 使用 @ref aiot_mqtt_setopt 配置 @ref AIOT_MQTTOPT_APPEND_TOPIC_MAP 时的数据
  *
@@ -434,6 +471,9 @@ typedef enum {
      *
      * @details
      *
+     * 配置该选项后重连退避策略会被设置为@ref AIOT_MQTT_RECONN_BACKOFF_NONE, 即按固定间隔重连,
+     * 如需在此基础上使用退避策略, 请在配置该选项之后再配置@ref AIOT_MQTTOPT_RECONN_BACKOFF
+     *
      * 数据类型: (uint32_t *) 默认值: (2 * 1000) ms
      */
     AIOT_MQTTOPT_RECONN_INTERVAL_MS,
@@ -568,6 +608,41 @@ typedef enum {
     */
     AIOT_MQTTOPT_TOPIC_HEADER_CHECK,
 
+    /**
+     * @brief 重连的退避策略
+     *
+     * @details
+     *
+     * 以@ref AIOT_MQTTOPT_RECONN_INTERVAL_MS 为基础间隔, 可选的策略见@ref aiot_mqtt_reconn_backoff_t
+     *
+     * 数据类型: (aiot_mqtt_reconn_backoff_t *) 默认值: @ref AIOT_MQTT_RECONN_BACKOFF_LINEAR
+     */
+    AIOT_MQTTOPT_RECONN_BACKOFF,
+
+    /**
+     * @brief 指数退避时重连间隔的上限
+     *
+     * @details
+     *
+     * 数据类型: (uint32_t *) 默认值: (60 * 1000) ms
+     */
+    AIOT_MQTTOPT_RECONN_MAX_INTERVAL_MS,
+
+    /**
+     * @brief 限制进程内所有MQTT实例的重连速率(令牌桶)
+     *
+     * @details
+     *
+     * 1. 该配置对进程内所有MQTT实例生效, 通过任意一个实例配置即可
+     *
+     * 2. 令牌不足时本次重连会被推迟到下一次调用@ref aiot_mqtt_recv 时, 并返回@ref STATE_MQTT_RECONNECT_RATE_LIMITED
+     *
+     * 3. rate配置为0时关闭限速
+     *
+     * 数据类型: (aiot_mqtt_reconn_rate_limit_t *) 默认值: 不限速
+     */
+    AIOT_MQTTOPT_RECONN_RATE_LIMIT,
+
     AIOT_MQTTOPT_MAX
 } aiot_mqtt_option_t;
 
@@ -9,8 +9,11 @@
 
 #include "core_stdinc.h"
 #include "aiot_state_api.h"
+#include "core_log.h"
 
 aiot_state_logcb_t g_logcb_handler = NULL;
+uint8_t g_logcb_level = AIOT_STATE_LOGLEVEL_DEBUG;
+uint32_t g_logcb_mask = AIOT_STATE_LOGMASK_ALL;
 
 int32_t aiot_state_set_logcb(aiot_state_logcb_t handler)
 {
@@ -18,3 +21,32 @@ int32_t aiot_state_set_logcb(aiot_state_logcb_t handler)
     return 0;
 }
 
+int32_t aiot_state_set_loglevel(aiot_state_loglevel_t level)
+{
+    if (level > AIOT_STATE_LOGLEVEL_DEBUG) {
+        return STATE_USER_INPUT_OUT_RANGE;
+    }
+    g_logcb_level = (uint8_t)level;
+    return STATE_SUCCESS;
+}
+
+int32_t aiot_state_set_logmask(uint32_t mask)
+{
+    g_logcb_mask = mask;
+    return 0;
+}
+
+int32_t aiot_state_set_logbuf(uint32_t size)
+{
+    return core_log_set_buffer(size);
+}
+
+int32_t aiot_state_logbuf_drain(void)
+{
+    return core_log_drain();
+}
+
+uint32_t aiot_state_logbuf_dropped(void)
+{
+    return core_log_dropped();
+}
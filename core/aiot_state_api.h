@@ -30,6 +30,96 @@ typedef int32_t (* aiot_state_logcb_t)(int32_t code, char *message);
  */
 int32_t aiot_state_set_logcb(aiot_state_logcb_t handler);
 
+/**
+ * @brief SDK的日志级别, 高于设定级别的日志在格式化之前即被丢弃
+ */
+typedef enum {
+    AIOT_STATE_LOGLEVEL_NONE,
+    AIOT_STATE_LOGLEVEL_ERROR,
+    AIOT_STATE_LOGLEVEL_WARN,
+    AIOT_STATE_LOGLEVEL_INFO,
+    /**
+     * @brief 报文十六进制内容、topic、鉴权信息等调试日志, 默认级别
+     */
+    AIOT_STATE_LOGLEVEL_DEBUG,
+} aiot_state_loglevel_t;
+
+/**
+ * @brief 由模块状态码基值(如@ref STATE_MQTT_BASE)得到对应的日志模块掩码位
+ */
+#define AIOT_STATE_LOGMASK(base)                                    ((uint32_t)1 << ((((uint32_t)-(base)) >> 8) & 0x1F))
+
+/**
+ * @brief 输出所有模块的日志, 默认值
+ */
+#define AIOT_STATE_LOGMASK_ALL                                      (0xFFFFFFFF)
+
+/**
+ * @brief 设置SDK的日志级别
+ *
+ * @param level 日志级别, 参考@ref aiot_state_loglevel_t
+ *
+ * @return int32_t
+ * @retval STATE_SUCCESS 设置成功
+ * @retval STATE_USER_INPUT_OUT_RANGE 日志级别超出范围
+ */
+int32_t aiot_state_set_loglevel(aiot_state_loglevel_t level);
+
+/**
+ * @brief 设置输出日志的模块, 掩码中未置位的模块日志在格式化之前即被丢弃
+ *
+ * @details
+ *
+ * 例如只输出MQTT和HTTP模块的日志:
+ *
+ * aiot_state_set_logmask(AIOT_STATE_LOGMASK(STATE_MQTT_BASE) | AIOT_STATE_LOGMASK(STATE_HTTP_BASE));
+ *
+ * @param mask 模块掩码, 参考@ref AIOT_STATE_LOGMASK
+ *
+ * @return int32_t 保留
+ */
+int32_t aiot_state_set_logmask(uint32_t mask);
+
+/**
+ * @brief 开启异步日志输出, 设置每个线程的日志缓冲区大小
+ *
+ * @details
+ *
+ * 开启后调用SDK接口的线程只将日志写入本线程的环形缓冲区, 不再同步调用日志回调, 慢速的日志输出(串口、flash等)
+ * 不会拖慢网络收发. 用户需要在一个独立的线程中周期性调用@ref aiot_state_logbuf_drain, 将缓存的日志投递给日志回调
+ *
+ * + 缓冲区在线程首次输出日志时分配, 实际大小为不小于size的2的幂, 最小1024字节
+ * + 缓冲区写满时新的日志被丢弃并计数, 不会阻塞调用线程, 丢弃数量可通过@ref aiot_state_logbuf_dropped 查询
+ * + 缓冲区在进程内一直保留, 不随线程退出释放, 适用于线程数量固定的场景
+ * + 编译器不支持线程局部存储时该设置不生效, 日志始终同步输出
+ *
+ * @param size 每个线程的缓冲区字节数, 为0时恢复同步输出(默认)
+ *
+ * @return int32_t
+ * @retval STATE_SUCCESS 设置成功
+ * @retval STATE_USER_INPUT_NULL_POINTER 未设置portfile
+ * @retval STATE_SYS_DEPEND_MALLOC_FAILED 内存分配失败
+ */
+int32_t aiot_state_set_logbuf(uint32_t size);
+
+/**
+ * @brief 将各线程缓冲区中的日志依次投递给日志回调
+ *
+ * @details
+ *
+ * 同一时刻只有一个线程能执行投递, 其它线程调用时直接返回0
+ *
+ * @return int32_t 本次投递的日志条数
+ */
+int32_t aiot_state_logbuf_drain(void);
+
+/**
+ * @brief 获取因缓冲区已满而被丢弃的日志条数
+ *
+ * @return uint32_t 累计丢弃的日志条数
+ */
+uint32_t aiot_state_logbuf_dropped(void);
+
 /**
  * @brief API执行成功
  *
@@ -372,6 +462,12 @@ int32_t aiot_state_set_logcb(aiot_state_logcb_t handler);
  */
 #define STATE_MQTT_LOG_HOST                                         (-0x032A)
 
+/**
+ * @brief MQTT重连时, 进程内的建连速率超过@ref AIOT_MQTTOPT_RECONN_RATE_LIMIT 配置的限制, 本次不发起连接
+ *
+ */
+#define STATE_MQTT_RECONNECT_RATE_LIMITED                           (-0x032B)
+
 /**
  * @brief -0x0400~-0x04FF表达SDK在HTTP模块内的状态码
  *
@@ -486,6 +582,12 @@ int32_t aiot_state_set_logcb(aiot_state_logcb_t handler);
  */
 #define STATE_HTTP_READ_BODY_EMPTY                                  (-0x0412)
 
+/**
+ * @brief HTTP应答报文的chunked编码格式错误, 无法解析
+ *
+ */
+#define STATE_HTTP_CHUNK_INVALID                                    (-0x0413)
+
 /**
  * @brief -0x0F00~-0x0FFF表达SDK在系统底层依赖模块内的状态码
  *
@@ -133,6 +133,44 @@ typedef struct {
      * @brief 销毁互斥锁
      */
     void (*core_sysdep_mutex_deinit)(void **mutex);
+    /**
+     * @brief 创建读写锁, 可选接口, 置为NULL时SDK使用互斥锁代替
+     */
+    void    *(*core_sysdep_rwlock_init)(void);
+    /**
+     * @brief 申请读锁(共享)
+     */
+    void (*core_sysdep_rwlock_rdlock)(void *rwlock);
+    /**
+     * @brief 申请写锁(独占)
+     */
+    void (*core_sysdep_rwlock_wrlock)(void *rwlock);
+    /**
+     * @brief 释放读锁或写锁
+     */
+    void (*core_sysdep_rwlock_unlock)(void *rwlock);
+    /**
+     * @brief 销毁读写锁
+     */
+    void (*core_sysdep_rwlock_deinit)(void **rwlock);
+    /**
+     * @brief 创建自旋锁, 可选接口, 置为NULL时SDK使用互斥锁代替
+     *
+     * @details SDK只在极短的临界区(计数器自增等)中使用自旋锁, 临界区内不会调用任何阻塞接口
+     */
+    void    *(*core_sysdep_spinlock_init)(void);
+    /**
+     * @brief 申请自旋锁
+     */
+    void (*core_sysdep_spinlock_lock)(void *spinlock);
+    /**
+     * @brief 释放自旋锁
+     */
+    void (*core_sysdep_spinlock_unlock)(void *spinlock);
+    /**
+     * @brief 销毁自旋锁
+     */
+    void (*core_sysdep_spinlock_deinit)(void **spinlock);
 } aiot_sysdep_portfile_t;
 
 void aiot_sysdep_set_portfile(aiot_sysdep_portfile_t *portfile);
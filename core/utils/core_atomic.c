@@ -0,0 +1,84 @@
+#include "core_atomic.h"
+
+void core_atomic_init_u32(core_atomic_u32_t *obj, uint32_t value)
+{
+#if defined(CORE_ATOMIC_C11)
+    atomic_init(obj, value);
+#else
+    *obj = value;
+#endif
+}
+
+uint32_t core_atomic_load_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj)
+{
+#if defined(CORE_ATOMIC_C11)
+    return (uint32_t)atomic_load(obj);
+#elif defined(CORE_ATOMIC_GNUC)
+    return __atomic_load_n(obj, __ATOMIC_SEQ_CST);
+#else
+    uint32_t res = 0;
+    core_spinlock_lock(sysdep, lock);
+    res = *obj;
+    core_spinlock_unlock(sysdep, lock);
+    return res;
+#endif
+}
+
+/* 返回运算后的值 */
+uint32_t core_atomic_add_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t value)
+{
+#if defined(CORE_ATOMIC_C11)
+    return (uint32_t)atomic_fetch_add(obj, value) + value;
+#elif defined(CORE_ATOMIC_GNUC)
+    return __atomic_add_fetch(obj, value, __ATOMIC_SEQ_CST);
+#else
+    uint32_t res = 0;
+    core_spinlock_lock(sysdep, lock);
+    *obj += value;
+    res = *obj;
+    core_spinlock_unlock(sysdep, lock);
+    return res;
+#endif
+}
+
+uint32_t core_atomic_sub_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t value)
+{
+#if defined(CORE_ATOMIC_C11)
+    return (uint32_t)atomic_fetch_sub(obj, value) - value;
+#elif defined(CORE_ATOMIC_GNUC)
+    return __atomic_sub_fetch(obj, value, __ATOMIC_SEQ_CST);
+#else
+    uint32_t res = 0;
+    core_spinlock_lock(sysdep, lock);
+    *obj -= value;
+    res = *obj;
+    core_spinlock_unlock(sysdep, lock);
+    return res;
+#endif
+}
+
+/* 当*obj等于*expected时写入desired并返回1, 否则将当前值写回*expected并返回0 */
+uint8_t core_atomic_cas_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t *expected,
+                            uint32_t desired)
+{
+#if defined(CORE_ATOMIC_C11)
+    uint_least32_t old = *expected;
+    uint8_t res = (atomic_compare_exchange_strong(obj, &old, desired)) ? (1) : (0);
+    *expected = (uint32_t)old;
+    return res;
+#elif defined(CORE_ATOMIC_GNUC)
+    return (__atomic_compare_exchange_n(obj, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) ? (1) : (0);
+#else
+    uint8_t res = 0;
+    core_spinlock_lock(sysdep, lock);
+    if (*obj == *expected) {
+        *obj = desired;
+        res = 1;
+    } else {
+        *expected = *obj;
+    }
+    core_spinlock_unlock(sysdep, lock);
+    return res;
+#endif
+}
+
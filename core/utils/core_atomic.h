@@ -0,0 +1,40 @@
+#ifndef _CORE_ATOMIC_H_
+#define _CORE_ATOMIC_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "core_stdinc.h"
+#include "core_lock.h"
+#include "aiot_sysdep_api.h"
+
+/*
+ * 优先使用C11原子操作, 其次使用GCC/Clang的__atomic内建函数
+ * 两者都不支持时, 使用调用方传入的lock(由core_spinlock_init创建)保护计数器
+ */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+    #include <stdatomic.h>
+    #define CORE_ATOMIC_C11
+    typedef atomic_uint_least32_t core_atomic_u32_t;
+#elif defined(__GNUC__) && defined(__ATOMIC_SEQ_CST)
+    #define CORE_ATOMIC_GNUC
+    typedef volatile uint32_t core_atomic_u32_t;
+#else
+    #define CORE_ATOMIC_USE_LOCK
+    typedef volatile uint32_t core_atomic_u32_t;
+#endif
+
+void core_atomic_init_u32(core_atomic_u32_t *obj, uint32_t value);
+uint32_t core_atomic_load_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj);
+uint32_t core_atomic_add_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t value);
+uint32_t core_atomic_sub_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t value);
+uint8_t core_atomic_cas_u32(aiot_sysdep_portfile_t *sysdep, void *lock, core_atomic_u32_t *obj, uint32_t *expected,
+                            uint32_t desired);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
@@ -0,0 +1,29 @@
+#ifndef _CORE_CRC16_H_
+#define _CORE_CRC16_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "core_stdinc.h"
+
+/*
+ * CRC16/IBM(又称CRC-16/ARC): 多项式0x8005, 输入输出按位反转, 初值0, 用于MQTT文件下载的分块校验
+ * 默认使用slicing-by-8查表, 每次处理8字节, 查找表共4KB
+ * 定义CORE_CRC16_SMALL后只保留512字节的单表, 逐字节计算, 适用于Flash紧张的设备
+ */
+typedef struct {
+    uint16_t crc;
+} core_crc16_context_t;
+
+void core_crc16_init(core_crc16_context_t *ctx);
+void core_crc16_update(core_crc16_context_t *ctx, const uint8_t *input, uint32_t ilen);
+uint16_t core_crc16_finish(core_crc16_context_t *ctx);
+uint16_t core_crc16(const uint8_t *input, uint32_t ilen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
@@ -1,14 +1,27 @@
 #include "core_global.h"
 
+typedef struct {
+    void *network_handle;
+    char key[CORE_GLOBAL_CONN_KEY_MAX_LEN];
+    uint64_t idle_time;
+} core_global_conn_t;
+
 typedef struct {
     void *mutex;
+    void *id_lock;
     uint8_t is_inited;
     uint32_t used_count;
-    int32_t alink_id;
+    core_atomic_u32_t alink_id;
     char mqtt_backup_ip[16];
+    /* 进程内共享的重连令牌桶, 令牌数以千分之一个为单位 */
+    uint32_t connect_rate;
+    uint32_t connect_burst;
+    uint64_t connect_tokens;
+    uint64_t connect_last_time;
+    core_global_conn_t conn_pool[CORE_GLOBAL_CONN_POOL_SIZE];
 } g_core_global_t;
 
-g_core_global_t g_core_global = {NULL, 0, 0, 0, {0}};
+g_core_global_t g_core_global = {NULL, NULL, 0, 0, 0, {0}, 0, 0, 0, 0, {{0}}};
 
 int32_t core_global_init(aiot_sysdep_portfile_t *sysdep)
 {
@@ -20,6 +33,7 @@ int32_t core_global_init(aiot_sysdep_portfile_t *sysdep)
 
 
     g_core_global.mutex = sysdep->core_sysdep_mutex_init();
+    g_core_global.id_lock = core_spinlock_init(sysdep);
     g_core_global.used_count++;
 
     return STATE_SUCCESS;
@@ -27,16 +41,10 @@ int32_t core_global_init(aiot_sysdep_portfile_t *sysdep)
 
 int32_t core_global_alink_id_next(aiot_sysdep_portfile_t *sysdep, int32_t *alink_id)
 {
-    int32_t id = 0;
-    sysdep->core_sysdep_mutex_lock(g_core_global.mutex);
-    g_core_global.alink_id++;
-    if (g_core_global.alink_id < 0) {
-        g_core_global.alink_id = 0;
-    }
-    id = g_core_global.alink_id;
-    sysdep->core_sysdep_mutex_unlock(g_core_global.mutex);
+    uint32_t id = core_atomic_add_u32(sysdep, g_core_global.id_lock, &g_core_global.alink_id, 1);
 
-    *alink_id = id;
+    /* 与原先的自增溢出后归零保持一致, 只取低31位 */
+    *alink_id = (int32_t)(id & 0x7FFFFFFF);
     return STATE_SUCCESS;
 }
 
@@ -63,8 +71,153 @@ int32_t core_global_get_mqtt_backup_ip(aiot_sysdep_portfile_t *sysdep, char ip[1
     return STATE_SUCCESS;
 }
 
+int32_t core_global_set_connect_rate(aiot_sysdep_portfile_t *sysdep, uint32_t rate, uint32_t burst)
+{
+    sysdep->core_sysdep_mutex_lock(g_core_global.mutex);
+    g_core_global.connect_rate = rate;
+    g_core_global.connect_burst = (burst == 0) ? (1) : (burst);
+    g_core_global.connect_tokens = (uint64_t)g_core_global.connect_burst * 1000;
+    g_core_global.connect_last_time = sysdep->core_sysdep_time();
+    sysdep->core_sysdep_mutex_unlock(g_core_global.mutex);
+
+    return STATE_SUCCESS;
+}
+
+int32_t core_global_acquire_connect_token(aiot_sysdep_portfile_t *sysdep)
+{
+    int32_t res = STATE_SUCCESS;
+    uint64_t time_now = 0, capacity = 0;
+
+    sysdep->core_sysdep_mutex_lock(g_core_global.mutex);
+    if (g_core_global.connect_rate != 0) {
+        time_now = sysdep->core_sysdep_time();
+        capacity = (uint64_t)g_core_global.connect_burst * 1000;
+        if (time_now > g_core_global.connect_last_time) {
+            /* rate个/秒 等于 rate个千分之一令牌/毫秒 */
+            g_core_global.connect_tokens += (time_now - g_core_global.connect_last_time) * g_core_global.connect_rate;
+            if (g_core_global.connect_tokens > capacity) {
+                g_core_global.connect_tokens = capacity;
+            }
+        }
+        g_core_global.connect_last_time = time_now;
+
+        if (g_core_global.connect_tokens >= 1000) {
+            g_core_global.connect_tokens -= 1000;
+        } else {
+            res = STATE_MQTT_RECONNECT_RATE_LIMITED;
+        }
+    }
+    sysdep->core_sysdep_mutex_unlock(g_core_global.mutex);
+
+    return res;
+}
+
+static uint8_t _core_global_conn_expired(core_global_conn_t *conn, uint64_t time_now)
+{
+    return (time_now < conn->idle_time || time_now - conn->idle_time >= CORE_GLOBAL_CONN_IDLE_TIMEOUT_MS) ? 1 : 0;
+}
+
+/* 连接池里的连接都处于空闲状态, 关闭时不需要持有锁 */
+static void _core_global_conn_close(aiot_sysdep_portfile_t *sysdep, void *closing[], uint32_t count)
+{
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < count; idx++) {
+        sysdep->core_sysdep_network_deinit(&closing[idx]);
+    }
+}
+
+int32_t core_global_conn_park(aiot_sysdep_portfile_t *sysdep, const char *key, void *network_handle)
+{
+    void *closing[CORE_GLOBAL_CONN_POOL_SIZE];
+    uint32_t idx = 0, count = 0, slot = CORE_GLOBAL_CONN_POOL_SIZE, oldest = 0;
+    uint64_t time_now = 0;
+
+    if (key == NULL || network_handle == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (strlen(key) >= CORE_GLOBAL_CONN_KEY_MAX_LEN) {
+        return STATE_USER_INPUT_OUT_RANGE;
+    }
+    if (g_core_global.is_inited == 0) {
+        return STATE_USER_INPUT_EXEC_DISABLED;
+    }
+
+    sysdep->core_sysdep_mutex_lock(g_core_global.mutex);
+    time_now = sysdep->core_sysdep_time();
+    for (idx = 0; idx < CORE_GLOBAL_CONN_POOL_SIZE; idx++) {
+        core_global_conn_t *conn = &g_core_global.conn_pool[idx];
+        if (conn->network_handle != NULL && _core_global_conn_expired(conn, time_now) == 1) {
+            closing[count++] = conn->network_handle;
+            conn->network_handle = NULL;
+        }
+        if (conn->network_handle == NULL) {
+            if (slot == CORE_GLOBAL_CONN_POOL_SIZE) {
+                slot = idx;
+            }
+        } else if (conn->idle_time < g_core_global.conn_pool[oldest].idle_time) {
+            oldest = idx;
+        }
+    }
+    /* 池满时挤掉空闲最久的连接 */
+    if (slot == CORE_GLOBAL_CONN_POOL_SIZE) {
+        slot = oldest;
+        closing[count++] = g_core_global.conn_pool[slot].network_handle;
+    }
+    g_core_global.conn_pool[slot].network_handle = network_handle;
+    g_core_global.conn_pool[slot].idle_time = time_now;
+    memcpy(g_core_global.conn_pool[slot].key, key, strlen(key) + 1);
+    sysdep->core_sysdep_mutex_unlock(g_core_global.mutex);
+
+    _core_global_conn_close(sysdep, closing, count);
+
+    return STATE_SUCCESS;
+}
+
+void *core_global_conn_take(aiot_sysdep_portfile_t *sysdep, const char *key)
+{
+    void *closing[CORE_GLOBAL_CONN_POOL_SIZE];
+    void *network_handle = NULL;
+    uint32_t idx = 0, count = 0, found = CORE_GLOBAL_CONN_POOL_SIZE;
+    uint64_t time_now = 0;
+
+    if (key == NULL || g_core_global.is_inited == 0) {
+        return NULL;
+    }
+
+    sysdep->core_sysdep_mutex_lock(g_core_global.mutex);
+    time_now = sysdep->core_sysdep_time();
+    for (idx = 0; idx < CORE_GLOBAL_CONN_POOL_SIZE; idx++) {
+        core_global_conn_t *conn = &g_core_global.conn_pool[idx];
+        if (conn->network_handle == NULL || strcmp(conn->key, key) != 0) {
+            continue;
+        }
+        if (_core_global_conn_expired(conn, time_now) == 1) {
+            closing[count++] = conn->network_handle;
+            conn->network_handle = NULL;
+            continue;
+        }
+        /* 优先取最近放回的连接, 被对端关闭的可能性最小 */
+        if (found == CORE_GLOBAL_CONN_POOL_SIZE || conn->idle_time > g_core_global.conn_pool[found].idle_time) {
+            found = idx;
+        }
+    }
+    if (found != CORE_GLOBAL_CONN_POOL_SIZE) {
+        network_handle = g_core_global.conn_pool[found].network_handle;
+        g_core_global.conn_pool[found].network_handle = NULL;
+    }
+    sysdep->core_sysdep_mutex_unlock(g_core_global.mutex);
+
+    _core_global_conn_close(sysdep, closing, count);
+
+    return network_handle;
+}
+
 int32_t core_global_deinit(aiot_sysdep_portfile_t *sysdep)
 {
+    void *closing[CORE_GLOBAL_CONN_POOL_SIZE];
+    uint32_t idx = 0, count = 0;
+
     if (g_core_global.used_count > 0) {
         g_core_global.used_count--;
     }
@@ -72,11 +225,20 @@ int32_t core_global_deinit(aiot_sysdep_portfile_t *sysdep)
     if (g_core_global.used_count != 0) {
         return STATE_SUCCESS;
     }
+    for (idx = 0; idx < CORE_GLOBAL_CONN_POOL_SIZE; idx++) {
+        if (g_core_global.conn_pool[idx].network_handle != NULL) {
+            closing[count++] = g_core_global.conn_pool[idx].network_handle;
+            g_core_global.conn_pool[idx].network_handle = NULL;
+        }
+    }
+    _core_global_conn_close(sysdep, closing, count);
     sysdep->core_sysdep_mutex_deinit(&g_core_global.mutex);
+    core_spinlock_deinit(sysdep, &g_core_global.id_lock);
 
     g_core_global.mutex = NULL;
     g_core_global.is_inited = 0;
     g_core_global.used_count = 0;
+    g_core_global.connect_rate = 0;
 
     return STATE_SUCCESS;
 }
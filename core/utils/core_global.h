@@ -8,13 +8,24 @@ extern "C" {
 #include "core_stdinc.h"
 #include "aiot_state_api.h"
 #include "aiot_sysdep_api.h"
+#include "core_lock.h"
+#include "core_atomic.h"
 
 #define CORE_GLOBAL_MODULE_NAME "global"
 
+/* 进程内共享的空闲连接池, 同一服务器的HTTP请求可以复用已建立的TCP/TLS连接 */
+#define CORE_GLOBAL_CONN_POOL_SIZE          (4)
+#define CORE_GLOBAL_CONN_KEY_MAX_LEN        (144)
+#define CORE_GLOBAL_CONN_IDLE_TIMEOUT_MS    (15 * 1000)
+
 int32_t core_global_init(aiot_sysdep_portfile_t *sysdep);
 int32_t core_global_alink_id_next(aiot_sysdep_portfile_t *sysdep, int32_t *alink_id);
 int32_t core_global_set_mqtt_backup_ip(aiot_sysdep_portfile_t *sysdep, char ip[16]);
 int32_t core_global_get_mqtt_backup_ip(aiot_sysdep_portfile_t *sysdep, char ip[16]);
+int32_t core_global_set_connect_rate(aiot_sysdep_portfile_t *sysdep, uint32_t rate, uint32_t burst);
+int32_t core_global_acquire_connect_token(aiot_sysdep_portfile_t *sysdep);
+int32_t core_global_conn_park(aiot_sysdep_portfile_t *sysdep, const char *key, void *network_handle);
+void *core_global_conn_take(aiot_sysdep_portfile_t *sysdep, const char *key);
 int32_t core_global_deinit(aiot_sysdep_portfile_t *sysdep);
 
 #if defined(__cplusplus)
@@ -32,27 +32,86 @@ static int32_t _core_http_sysdep_return(int32_t sysdep_code, int32_t core_code)
     }
 }
 
+static void _core_http_session_reset(core_http_handle_t *http_handle)
+{
+    if (http_handle->session.buffer != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->session.buffer);
+    }
+    memset(&http_handle->session, 0, sizeof(core_http_session_t));
+}
+
+/* 连接池中以"host:port/凭证类型"区分连接, 明文和TLS连接不会混用 */
+static void _core_http_conn_key(core_http_handle_t *http_handle, char *host, uint16_t port,
+                                char key[CORE_GLOBAL_CONN_KEY_MAX_LEN])
+{
+    uint32_t offset = (uint32_t)strlen(host);
+    uint8_t len = 0;
+
+    memset(key, 0, CORE_GLOBAL_CONN_KEY_MAX_LEN);
+    memcpy(key, host, offset);
+    key[offset++] = ':';
+    core_uint2str(port, &key[offset], &len);
+    offset += len;
+    key[offset++] = '/';
+    if (http_handle->cred == NULL) {
+        key[offset] = '-';
+    } else {
+        core_uint2str((uint32_t)http_handle->cred->option, &key[offset], NULL);
+    }
+}
+
+/*
+ * 空闲期间对端可能已经关闭了连接, 复用前以极短的超时读一次:
+ * 超时说明连接正常, 读到错误或者多余的数据则关闭连接
+ */
+static int32_t _core_http_conn_probe(core_http_handle_t *http_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint8_t byte = 0;
+
+    res = http_handle->sysdep->core_sysdep_network_recv(http_handle->network_handle, &byte, 1,
+            CORE_HTTP_CONN_PROBE_TIMEOUT_MS, NULL);
+    if (res != 0) {
+        http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
+        http_handle->conn_idle = 0;
+        return STATE_SYS_DEPEND_NWK_CLOSED;
+    }
+
+    return STATE_SUCCESS;
+}
+
+/* 释放当前连接, 应答已经读完且服务器允许保持的连接放回连接池 */
+static void _core_http_conn_release(core_http_handle_t *http_handle)
+{
+    if (http_handle->network_handle == NULL) {
+        return;
+    }
+
+    if (http_handle->conn_idle == 0 ||
+        core_global_conn_park(http_handle->sysdep, http_handle->conn_key, http_handle->network_handle) < STATE_SUCCESS) {
+        http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
+    }
+    http_handle->network_handle = NULL;
+    http_handle->conn_idle = 0;
+    http_handle->requests_pending = 0;
+}
+
 static int32_t _core_http_connect(core_http_handle_t *http_handle)
 {
     int32_t res = STATE_SUCCESS;
     char host[128];
+    char key[CORE_GLOBAL_CONN_KEY_MAX_LEN];
     uint16_t port = 0;
     uint32_t port_u32 = 0;
     char *ptr = NULL;
-    /* disconnect first if network is already established */
-    if (http_handle->network_handle != NULL) {
-        http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
-    }
+
     if (http_handle->host == NULL) {
         return STATE_USER_INPUT_MISSING_HOST;
     }
-    if(strlen(http_handle->host) > sizeof(host)){
+    if(strlen(http_handle->host) >= sizeof(host)){
         return STATE_PORT_INPUT_OUT_RANGE;
     }
 
-    /* establish network connection */
-    core_sysdep_socket_type_t socket_type = CORE_SYSDEP_SOCKET_TCP_CLIENT;
-
     memset(host, 0, sizeof(host));
     ptr = strstr(http_handle->host, ":");
     if(ptr == NULL) {
@@ -63,6 +122,28 @@ static int32_t _core_http_connect(core_http_handle_t *http_handle)
         core_str2uint(ptr + 1, strlen(ptr + 1), &port_u32);
         port = port_u32;
     }
+    _core_http_conn_key(http_handle, host, port, key);
+
+    /* 当前连接空闲且连往同一服务器时直接复用, 否则先释放 */
+    if (http_handle->network_handle != NULL && http_handle->conn_idle == 1 && strcmp(http_handle->conn_key, key) == 0) {
+        if (_core_http_conn_probe(http_handle) == STATE_SUCCESS) {
+            return STATE_SUCCESS;
+        }
+    }
+    _core_http_conn_release(http_handle);
+
+    /* 其次复用其他实例放回连接池的连接 */
+    while ((http_handle->network_handle = core_global_conn_take(http_handle->sysdep, key)) != NULL) {
+        if (_core_http_conn_probe(http_handle) == STATE_SUCCESS) {
+            memcpy(http_handle->conn_key, key, sizeof(key));
+            http_handle->conn_idle = 1;
+            http_handle->requests_pending = 0;
+            return STATE_SUCCESS;
+        }
+    }
+
+    /* establish network connection */
+    core_sysdep_socket_type_t socket_type = CORE_SYSDEP_SOCKET_TCP_CLIENT;
 
     http_handle->network_handle = http_handle->sysdep->core_sysdep_network_init();
     if (http_handle->network_handle == NULL) {
@@ -96,6 +177,9 @@ static int32_t _core_http_connect(core_http_handle_t *http_handle)
         http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
         return _core_http_sysdep_return(res, STATE_SYS_DEPEND_NWK_EST_FAILED);
     }
+    memcpy(http_handle->conn_key, key, sizeof(key));
+    http_handle->conn_idle = 1;
+    http_handle->requests_pending = 0;
 
     return STATE_SUCCESS;
 }
@@ -155,7 +239,7 @@ static int32_t _core_http_send_header(core_http_handle_t *http_handle, char *met
     char *combine_header_src[] = { method, path, host, header, content_lenstr};
     uint32_t combine_header_len = 0;
 
-    res = core_sprintf(http_handle->sysdep, &combine_header, "%s %s HTTP/1.1\r\nHost: %s\r\n%sContent-Length: %s\r\n\r\n",
+    res = core_sprintf(http_handle->sysdep, &combine_header, "%s %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n%sContent-Length: %s\r\n\r\n",
                        combine_header_src, sizeof(combine_header_src) / sizeof(char *), CORE_HTTP_MODULE_NAME);
     if (res < STATE_SUCCESS) {
         return res;
@@ -203,6 +287,9 @@ void *core_http_init(void)
 
     http_handle->core_exec_enabled = 1;
 
+    /* 进程内连接池由core_global维护 */
+    core_global_init(sysdep);
+
     return http_handle;
 }
 
@@ -348,7 +435,11 @@ int32_t core_http_send(void *handle, const core_http_request_t *request)
         return STATE_USER_INPUT_EXEC_DISABLED;
     }
 
-    memset(&http_handle->session, 0, sizeof(core_http_session_t));
+    /* 流水线发送时session属于尚未读完的应答, 不能清除 */
+    if (http_handle->requests_pending == 0) {
+        _core_http_session_reset(http_handle);
+    }
+    http_handle->conn_idle = 0;
 
     _core_http_exec_inc(http_handle);
 
@@ -371,6 +462,7 @@ int32_t core_http_send(void *handle, const core_http_request_t *request)
             return res;
         }
     }
+    http_handle->requests_pending++;
 
     _core_http_exec_dec(http_handle);
 
@@ -392,39 +484,21 @@ static void _core_http_recv_status_code(core_http_handle_t *http_handle, uint32_
     http_handle->core_recv_handler(http_handle, &packet, http_handle->core_userdata);
 }
 
-static void _core_http_recv_header_pair(core_http_handle_t *http_handle, char *key, uint32_t key_len, char *value,
-                                        uint32_t value_len)
+/* key和value已经在header缓冲区中原地以'\0'结尾, 直接交给回调 */
+static void _core_http_recv_header_pair(core_http_handle_t *http_handle, char *key, char *value)
 {
-    char *pair_key = NULL, *pair_value = NULL;
     aiot_http_recv_t packet;
 
     if (http_handle->core_recv_handler == NULL) {
         return;
     }
 
-    pair_key = http_handle->sysdep->core_sysdep_malloc(key_len + 1, CORE_HTTP_MODULE_NAME);
-    if (pair_key == NULL) {
-        return;
-    }
-    memset(pair_key, 0, key_len + 1);
-    memcpy(pair_key, key, key_len);
-
-    pair_value = http_handle->sysdep->core_sysdep_malloc(value_len + 1, CORE_HTTP_MODULE_NAME);
-    if (pair_value == NULL) {
-        http_handle->sysdep->core_sysdep_free(pair_key);
-        return;
-    }
-    memset(pair_value, 0, value_len + 1);
-    memcpy(pair_value, value, value_len);
-
+    memset(&packet, 0, sizeof(aiot_http_recv_t));
     packet.type = AIOT_HTTPRECV_HEADER;
-    packet.data.header.key = pair_key;
-    packet.data.header.value = pair_value;
+    packet.data.header.key = key;
+    packet.data.header.value = value;
 
     http_handle->core_recv_handler(http_handle, &packet, http_handle->core_userdata);
-
-    http_handle->sysdep->core_sysdep_free(pair_key);
-    http_handle->sysdep->core_sysdep_free(pair_value);
 }
 
 static int32_t _core_http_recv(core_http_handle_t *http_handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms)
@@ -445,21 +519,101 @@ static int32_t _core_http_recv(core_http_handle_t *http_handle, uint8_t *buffer,
     return res;
 }
 
+/* 解析一行完整的header, line_len不含结尾的\r\n, 行尾的\r会被改写为'\0' */
+static int32_t _core_http_parse_header_line(core_http_handle_t *http_handle, char *line, uint32_t line_len,
+        uint32_t *body_total_len)
+{
+    uint32_t deli_idx = 0, value_len = 0;
+
+    /* status code */
+    if ((line_len >= (strlen("HTTP/1.1 ") + 2)) && (memcmp(line, "HTTP/1.1 ", strlen("HTTP/1.1 "))) == 0) {
+        uint32_t status_code = 0, code_idx = 0;
+        for (code_idx = strlen("HTTP/1.1 "); code_idx < line_len; code_idx++) {
+            if (line[code_idx] < '0' || line[code_idx] > '9') {
+                break;
+            }
+        }
+        if (core_str2uint(&line[strlen("HTTP/1.1 ")], (code_idx - strlen("HTTP/1.1 ")), &status_code) < STATE_SUCCESS) {
+            return STATE_HTTP_STATUS_LINE_INVALID;
+        }
+        http_handle->session.status_code = status_code;
+        _core_http_recv_status_code(http_handle, status_code);
+        return STATE_SUCCESS;
+    }
+
+    /* header, 以第一个": "分隔key和value */
+    for (deli_idx = 0; deli_idx + 1 < line_len; deli_idx++) {
+        if (line[deli_idx] == ':' && line[deli_idx + 1] == ' ') {
+            value_len = line_len - deli_idx - 2;
+            /* header名称和Connection, Transfer-Encoding的取值都不区分大小写 */
+            if (core_strcase_equal(line, deli_idx, "Content-Length") == 1) {
+                core_str2uint(&line[deli_idx + 2], value_len, body_total_len);
+                http_handle->session.content_len_received = 1;
+            } else if (core_strcase_equal(line, deli_idx, "Connection") == 1 &&
+                       core_strcase_equal(&line[deli_idx + 2], value_len, "close") == 1) {
+                http_handle->session.conn_close = 1;
+            } else if (core_strcase_equal(line, deli_idx, "Transfer-Encoding") == 1 && value_len >= strlen("chunked") &&
+                       core_strcase_equal(&line[line_len - strlen("chunked")], strlen("chunked"), "chunked") == 1) {
+                /* chunked必须是最后一个传输编码 */
+                http_handle->session.chunked = 1;
+            }
+            line[deli_idx] = '\0';
+            line[line_len] = '\0';
+            _core_http_recv_header_pair(http_handle, line, &line[deli_idx + 2]);
+            break;
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+/*
+ * 下一次读取的长度: 网络接口会一直等到读满或者超时, 所以只能读取应答中一定还存在的字节数,
+ * 否则较短的应答会白白等待一个接收超时. buffer中是当前行已收到的部分, 至少还差本行及空行的\r\n,
+ * 状态行还未收到时至少还有一个最短的状态行, 已经解析出Content-Length时还可以再加上整个body的长度
+ */
+static uint32_t _core_http_header_read_len(uint8_t *buffer, uint32_t len, uint8_t status_line_received,
+        uint32_t body_total_len, uint32_t space)
+{
+    uint32_t need = 0;
+    uint64_t total = 0;
+
+    if (len == 0) {
+        need = 2;
+    } else if (len == 1 && buffer[0] == '\r') {
+        need = 1;
+    } else if (buffer[len - 1] == '\r') {
+        need = 3;
+    } else {
+        need = 4;
+    }
+    if (status_line_received == 0 && len + need < CORE_HTTP_STATUS_LINE_MIN_LEN) {
+        need = CORE_HTTP_STATUS_LINE_MIN_LEN - len;
+    }
+
+    total = (uint64_t)need + body_total_len;
+    return (total < space) ? (uint32_t)total : space;
+}
+
 static int32_t _core_http_recv_header(core_http_handle_t *http_handle, uint32_t *body_total_len)
 {
     int32_t res = STATE_SUCCESS;
-    char *line = NULL;
-    uint32_t idx = 0, line_max_len = http_handle->header_line_max_len;
+    uint8_t *buffer = NULL, header_finished = 0, status_line_received = 0;
+    uint32_t buffer_len = http_handle->header_line_max_len, len = 0, line_start = 0, idx = 0, line_len = 0;
     uint64_t timenow_ms = 0;
 
-    line = http_handle->sysdep->core_sysdep_malloc(line_max_len, CORE_HTTP_MODULE_NAME);
-    if (line == NULL) {
+    if (buffer_len < CORE_HTTP_STATUS_LINE_MIN_LEN) {
+        return STATE_HTTP_HEADER_BUFFER_TOO_SHORT;
+    }
+
+    /* 缓冲区只需容纳一行header, 解析过的行会被移出 */
+    buffer = http_handle->sysdep->core_sysdep_malloc(buffer_len, CORE_HTTP_MODULE_NAME);
+    if (buffer == NULL) {
         return STATE_SYS_DEPEND_MALLOC_FAILED;
     }
-    memset(line, 0, line_max_len);
 
     timenow_ms = http_handle->sysdep->core_sysdep_time();
-    for (idx = 0; idx < line_max_len;) {
+    while (header_finished == 0) {
         if (timenow_ms > http_handle->sysdep->core_sysdep_time()) {
             timenow_ms = http_handle->sysdep->core_sysdep_time();
         }
@@ -467,121 +621,430 @@ static int32_t _core_http_recv_header(core_http_handle_t *http_handle, uint32_t
             res =  STATE_HTTP_HEADER_INVALID;
             break;
         }
-        if (idx + 2 > line_max_len) {
+        if (len == buffer_len) {
             res = STATE_HTTP_HEADER_BUFFER_TOO_SHORT;
             break;
         }
-        /* read http header, "\r\n" in the end */
-        if ((res = _core_http_recv(http_handle, (uint8_t *)&line[idx], 1,
-                                   http_handle->recv_timeout_ms)) < STATE_SUCCESS) {
-            break;
-        }
-        idx++;
-        if (res == 0 || (line[idx - 1] != '\r')) {
-            continue;
-        }
-        if ((res = _core_http_recv(http_handle, (uint8_t *)&line[idx], 1,
-                                   http_handle->recv_timeout_ms)) < STATE_SUCCESS) {
-            break;
-        }
-        idx++;
-        if (res == 0 || (line[idx - 1] != '\n')) {
-            continue;
-        }
 
-        core_log2(http_handle->sysdep, STATE_HTTP_LOG_RECV_HEADER, "< %.*s", &idx, line);
-        /* next line should be http response body */
-        if (idx == 2) {
+        res = _core_http_recv(http_handle, buffer + len,
+                              _core_http_header_read_len(buffer, len, status_line_received, *body_total_len, buffer_len - len),
+                              http_handle->recv_timeout_ms);
+        if (res < STATE_SUCCESS) {
             break;
         }
-        /* status code */
-        if ((idx > (strlen("HTTP/1.1 ") + 3)) && (memcmp(line, "HTTP/1.1 ", strlen("HTTP/1.1 "))) == 0) {
-            uint32_t status_code = 0, code_idx = 0;
-            for (code_idx = strlen("HTTP/1.1 "); code_idx < idx; code_idx++) {
-                if (line[code_idx] < '0' || line[code_idx] > '9') {
-                    break;
-                }
+
+        /* 从上次扫描到的位置继续查找行尾, 本次收到的数据中可能包含多行 */
+        idx = (len > 0) ? (len - 1) : 0;
+        len += res;
+        line_start = 0;
+        for (; idx + 1 < len; idx++) {
+            if (buffer[idx] != '\r' || buffer[idx + 1] != '\n') {
+                continue;
             }
-            res = core_str2uint(&line[strlen("HTTP/1.1 ")], (code_idx - strlen("HTTP/1.1 ")), &status_code);
-            if (res < STATE_SUCCESS) {
-                res = STATE_HTTP_STATUS_LINE_INVALID;
+            line_len = idx - line_start;
+            core_log2(http_handle->sysdep, STATE_HTTP_LOG_RECV_HEADER, "< %.*s\r\n", &line_len, &buffer[line_start]);
+            /* 空行, 之后是http response body */
+            if (line_len == 0) {
+                line_start = idx + 2;
+                header_finished = 1;
                 break;
             }
-            _core_http_recv_status_code(http_handle, status_code);
-        }
-        /* header */
-        {
-            uint32_t deli_idx = 0;
-            for (deli_idx = 0; deli_idx < idx; deli_idx++) {
-                if (line[deli_idx] == ':' && line[deli_idx + 1] == ' ') {
-                    if ((deli_idx + 2 == strlen("Content-Length: ")) && (memcmp(line, "Content-Length: ", deli_idx + 2) == 0)) {
-                        core_str2uint(&line[deli_idx + 2], (uint32_t)(idx - deli_idx - 4), body_total_len);
-                    }
-                    _core_http_recv_header_pair(http_handle, line, deli_idx, &line[deli_idx + 2], (uint32_t)(idx - deli_idx - 4));
-                }
+            res = _core_http_parse_header_line(http_handle, (char *)&buffer[line_start], line_len, body_total_len);
+            if (res < STATE_SUCCESS) {
+                break;
             }
+            status_line_received = 1;
+            line_start = idx + 2;
+            idx++;
+        }
+        if (res < STATE_SUCCESS) {
+            break;
+        }
+
+        /* 未处理的部分移到缓冲区开头 */
+        if (line_start > 0 && header_finished == 0) {
+            memmove(buffer, buffer + line_start, len - line_start);
+            len -= line_start;
         }
-        idx = 0;
-        memset(line, 0, line_max_len);
     }
 
-    http_handle->sysdep->core_sysdep_free(line);
+    if (res >= STATE_SUCCESS && header_finished == 1) {
+        res = STATE_SUCCESS;
+        /* 多读到的body留给_core_http_recv_body, 读取长度以Content-Length为界, 不会越过本次应答 */
+        if (len > line_start) {
+            http_handle->session.buffer = buffer;
+            http_handle->session.buffer_offset = line_start;
+            http_handle->session.buffer_len = len - line_start;
+            buffer = NULL;
+        }
+    }
+
+    if (buffer != NULL) {
+        http_handle->sysdep->core_sysdep_free(buffer);
+    }
 
     return res;
 }
 
-static int32_t _core_http_recv_body(core_http_handle_t *http_handle, uint32_t body_total_len)
+static void _core_http_recv_body_notify(core_http_handle_t *http_handle, uint8_t *buffer, uint32_t len)
 {
-    int32_t res = STATE_SUCCESS;
-    char *buffer = NULL;
-    uint32_t remaining_len = 0, buffer_len = 0;
+    aiot_http_recv_t packet;
 
-    if (http_handle->session.body_total_len == 0 && body_total_len == 0) {
-        return STATE_HTTP_READ_BODY_EMPTY;
+    core_log_hexdump(STATE_HTTP_LOG_RECV_CONTENT, '<', buffer, len);
+
+    http_handle->session.body_read_len += len;
+    if (http_handle->core_recv_handler != NULL) {
+        memset(&packet, 0, sizeof(aiot_http_recv_t));
+        packet.type = AIOT_HTTPRECV_BODY;
+        packet.data.body.buffer = buffer;
+        packet.data.body.len = len;
+
+        http_handle->core_recv_handler(http_handle, &packet, http_handle->core_userdata);
     }
+}
 
-    if (body_total_len != 0) {
-        http_handle->session.body_total_len = body_total_len;
-        remaining_len = body_total_len;
+/* header结束后确定body的边界, 1xx/204/304应答没有body */
+static void _core_http_body_start(core_http_handle_t *http_handle, uint32_t body_total_len)
+{
+    core_http_session_t *session = &http_handle->session;
+
+    session->body_total_len = body_total_len;
+    if (session->chunked == 1) {
+        session->body_mode = CORE_HTTP_BODY_CHUNKED;
+        session->chunk_sm = CORE_HTTP_CHUNK_SIZE;
+    } else if (session->content_len_received == 1 || session->status_code < 200 ||
+               session->status_code == 204 || session->status_code == 304) {
+        session->body_mode = CORE_HTTP_BODY_LENGTH;
     } else {
-        remaining_len = http_handle->session.body_total_len - http_handle->session.body_read_len;
+        session->body_mode = CORE_HTTP_BODY_UNTIL_CLOSE;
+    }
+}
+
+/* 应答是否已经完整读完, 读完且服务器允许保持的连接可以发送下一个请求 */
+static uint8_t _core_http_body_complete(core_http_handle_t *http_handle)
+{
+    core_http_session_t *session = &http_handle->session;
+
+    if (session->sm != CORE_HTTP_SM_READ_BODY) {
+        return 0;
+    }
+    if (session->body_mode == CORE_HTTP_BODY_LENGTH) {
+        return (session->body_read_len == session->body_total_len) ? 1 : 0;
+    }
+    if (session->body_mode == CORE_HTTP_BODY_CHUNKED) {
+        return (session->chunk_sm == CORE_HTTP_CHUNK_DONE) ? 1 : 0;
+    }
+
+    return 0;
+}
+
+/* 读取body的缓冲区在实例内复用, 只在body_buffer_max_len变化时重新分配 */
+static uint8_t *_core_http_body_buffer(core_http_handle_t *http_handle)
+{
+    if (http_handle->body_buffer != NULL && http_handle->body_buffer_len != http_handle->body_buffer_max_len) {
+        http_handle->sysdep->core_sysdep_free(http_handle->body_buffer);
+        http_handle->body_buffer = NULL;
+    }
+    if (http_handle->body_buffer == NULL) {
+        http_handle->body_buffer = http_handle->sysdep->core_sysdep_malloc(http_handle->body_buffer_max_len,
+                                   CORE_HTTP_MODULE_NAME);
+        http_handle->body_buffer_len = (http_handle->body_buffer == NULL) ? 0 : http_handle->body_buffer_max_len;
+    }
+
+    return http_handle->body_buffer;
+}
+
+static void _core_http_pending_consume(core_http_handle_t *http_handle, uint32_t len)
+{
+    http_handle->session.buffer_offset += len;
+    http_handle->session.buffer_len -= len;
+    if (http_handle->session.buffer_len == 0) {
+        http_handle->sysdep->core_sysdep_free(http_handle->session.buffer);
+        http_handle->session.buffer = NULL;
+    }
+}
+
+static int32_t _core_http_recv_body_pending(core_http_handle_t *http_handle, uint32_t buffer_len)
+{
+    uint32_t len = (http_handle->session.buffer_len < buffer_len) ? http_handle->session.buffer_len : buffer_len;
+
+    _core_http_recv_body_notify(http_handle, http_handle->session.buffer + http_handle->session.buffer_offset, len);
+    _core_http_pending_consume(http_handle, len);
+
+    return (int32_t)len;
+}
+
+static int32_t _core_http_recv_body_length(core_http_handle_t *http_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint8_t *buffer = NULL;
+    uint32_t remaining_len = 0, buffer_len = 0;
+
+    if (http_handle->session.body_total_len == 0) {
+        return STATE_HTTP_READ_BODY_EMPTY;
     }
 
+    remaining_len = http_handle->session.body_total_len - http_handle->session.body_read_len;
     if (remaining_len == 0) {
         return STATE_HTTP_READ_BODY_FINISHED;
     }
 
     buffer_len = (remaining_len < http_handle->body_buffer_max_len) ? (remaining_len) : (http_handle->body_buffer_max_len);
 
-    buffer = http_handle->sysdep->core_sysdep_malloc(buffer_len, CORE_HTTP_MODULE_NAME);
+    /* 先交付读取header时多读到的body */
+    if (http_handle->session.buffer_len > 0) {
+        return _core_http_recv_body_pending(http_handle, buffer_len);
+    }
+
+    buffer = _core_http_body_buffer(http_handle);
     if (buffer == NULL) {
         return STATE_SYS_DEPEND_MALLOC_FAILED;
     }
-    memset(buffer, 0, buffer_len);
 
     http_handle->sysdep->core_sysdep_mutex_lock(http_handle->recv_mutex);
-    res = _core_http_recv(http_handle, (uint8_t *)buffer, buffer_len, http_handle->recv_timeout_ms);
+    res = _core_http_recv(http_handle, buffer, buffer_len, http_handle->recv_timeout_ms);
     http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->recv_mutex);
     if (res > 0) {
-        aiot_http_recv_t packet;
+        _core_http_recv_body_notify(http_handle, buffer, (uint32_t)res);
+    }
 
-        core_log_hexdump(STATE_HTTP_LOG_RECV_CONTENT, '<', (uint8_t *)buffer, res);
+    return res;
+}
 
-        if (http_handle->core_recv_handler != NULL) {
-            http_handle->session.body_read_len += res;
-            memset(&packet, 0, sizeof(aiot_http_recv_t));
-            packet.type = AIOT_HTTPRECV_BODY;
-            packet.data.body.buffer = (uint8_t *)buffer;
-            packet.data.body.len = res;
+/* 没有长度信息的body一直读到对端关闭连接 */
+static int32_t _core_http_recv_body_until_close(core_http_handle_t *http_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint8_t *buffer = NULL;
 
-            http_handle->core_recv_handler(http_handle, &packet, http_handle->core_userdata);
-        }
+    if (http_handle->session.buffer_len > 0) {
+        return _core_http_recv_body_pending(http_handle, http_handle->body_buffer_max_len);
+    }
+    if (http_handle->network_handle == NULL) {
+        return STATE_HTTP_READ_BODY_FINISHED;
+    }
+
+    buffer = _core_http_body_buffer(http_handle);
+    if (buffer == NULL) {
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+
+    http_handle->sysdep->core_sysdep_mutex_lock(http_handle->recv_mutex);
+    res = _core_http_recv(http_handle, buffer, http_handle->body_buffer_max_len, http_handle->recv_timeout_ms);
+    http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->recv_mutex);
+    if (res > 0) {
+        _core_http_recv_body_notify(http_handle, buffer, (uint32_t)res);
+    } else if (res == STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED || res == STATE_PORT_TLS_RECV_CONNECTION_CLOSED) {
+        res = STATE_HTTP_READ_BODY_FINISHED;
     }
-    http_handle->sysdep->core_sysdep_free(buffer);
 
     return res;
 }
 
+/*
+ * 在读到的数据上原地解析chunked编码, 每段chunk数据直接以其在缓冲区中的位置交给回调, 不做拷贝.
+ * 解析状态保存在session中, chunk的长度行和数据可以任意地跨越两次读取
+ */
+static int32_t _core_http_chunk_decode(core_http_handle_t *http_handle, uint8_t *buffer, uint32_t len,
+                                       uint32_t *data_len)
+{
+    core_http_session_t *session = &http_handle->session;
+    uint32_t idx = 0, span = 0;
+    uint8_t ch = 0, nibble = 0;
+
+    *data_len = 0;
+    while (idx < len && session->chunk_sm != CORE_HTTP_CHUNK_DONE) {
+        ch = buffer[idx];
+        switch (session->chunk_sm) {
+            case CORE_HTTP_CHUNK_SIZE: {
+                if (ch >= '0' && ch <= '9') {
+                    nibble = ch - '0';
+                } else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+                    nibble = (ch | 0x20) - 'a' + 10;
+                } else if (session->chunk_digits > 0 && (ch == ';' || ch == ' ' || ch == '\t')) {
+                    session->chunk_sm = CORE_HTTP_CHUNK_EXT;
+                    break;
+                } else if (session->chunk_digits > 0 && ch == '\r') {
+                    session->chunk_sm = CORE_HTTP_CHUNK_SIZE_LF;
+                    break;
+                } else {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                if (session->chunk_digits == sizeof(uint32_t) * 2) {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                session->chunk_size = (session->chunk_size << 4) | nibble;
+                session->chunk_digits++;
+            }
+            break;
+            case CORE_HTTP_CHUNK_EXT: {
+                if (ch == '\r') {
+                    session->chunk_sm = CORE_HTTP_CHUNK_SIZE_LF;
+                }
+            }
+            break;
+            case CORE_HTTP_CHUNK_SIZE_LF: {
+                if (ch != '\n') {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                session->chunk_sm = (session->chunk_size == 0) ? CORE_HTTP_CHUNK_TRAILER : CORE_HTTP_CHUNK_DATA;
+            }
+            break;
+            case CORE_HTTP_CHUNK_DATA: {
+                span = (len - idx < session->chunk_size) ? (len - idx) : session->chunk_size;
+                _core_http_recv_body_notify(http_handle, &buffer[idx], span);
+                *data_len += span;
+                session->chunk_size -= span;
+                if (session->chunk_size == 0) {
+                    session->chunk_sm = CORE_HTTP_CHUNK_DATA_CR;
+                }
+                idx += span;
+                continue;
+            }
+            case CORE_HTTP_CHUNK_DATA_CR: {
+                if (ch != '\r') {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                session->chunk_sm = CORE_HTTP_CHUNK_DATA_LF;
+            }
+            break;
+            case CORE_HTTP_CHUNK_DATA_LF: {
+                if (ch != '\n') {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                session->chunk_sm = CORE_HTTP_CHUNK_SIZE;
+                session->chunk_digits = 0;
+            }
+            break;
+            case CORE_HTTP_CHUNK_TRAILER: {
+                if (ch == '\r') {
+                    session->chunk_sm = CORE_HTTP_CHUNK_TRAILER_LF;
+                } else {
+                    session->chunk_line_started = 1;
+                }
+            }
+            break;
+            case CORE_HTTP_CHUNK_TRAILER_LF: {
+                if (ch != '\n') {
+                    return STATE_HTTP_CHUNK_INVALID;
+                }
+                session->chunk_sm = (session->chunk_line_started == 0) ? CORE_HTTP_CHUNK_DONE : CORE_HTTP_CHUNK_TRAILER;
+                session->chunk_line_started = 0;
+            }
+            break;
+            default: {
+            }
+            break;
+        }
+        idx++;
+    }
+
+    return STATE_SUCCESS;
+}
+
+/*
+ * 与读取header时相同, 只能读取应答中一定还存在的字节数: 当前chunk剩余的部分,
+ * 加上之后最短的结尾"\r\n0\r\n\r\n"
+ */
+static uint32_t _core_http_chunk_read_len(core_http_session_t *session, uint32_t space)
+{
+    uint64_t need = 0, tail = 0;
+
+    /* 当前长度行如果就此结束, 之后至少还有的字节数 */
+    tail = (session->chunk_size == 0) ? 2 : ((uint64_t)session->chunk_size + 2 + 5);
+    switch (session->chunk_sm) {
+        case CORE_HTTP_CHUNK_SIZE: {
+            need = (session->chunk_digits == 0) ? 5 : (2 + tail);
+        }
+        break;
+        case CORE_HTTP_CHUNK_EXT: {
+            need = 2 + tail;
+        }
+        break;
+        case CORE_HTTP_CHUNK_SIZE_LF: {
+            need = 1 + tail;
+        }
+        break;
+        case CORE_HTTP_CHUNK_DATA: {
+            need = (uint64_t)session->chunk_size + 2 + 5;
+        }
+        break;
+        case CORE_HTTP_CHUNK_DATA_CR: {
+            need = 2 + 5;
+        }
+        break;
+        case CORE_HTTP_CHUNK_DATA_LF: {
+            need = 1 + 5;
+        }
+        break;
+        case CORE_HTTP_CHUNK_TRAILER: {
+            need = (session->chunk_line_started == 0) ? 2 : 4;
+        }
+        break;
+        case CORE_HTTP_CHUNK_TRAILER_LF: {
+            need = (session->chunk_line_started == 0) ? 1 : 3;
+        }
+        break;
+        default: {
+            need = 0;
+        }
+        break;
+    }
+
+    return (need < space) ? (uint32_t)need : space;
+}
+
+static int32_t _core_http_recv_body_chunked(core_http_handle_t *http_handle)
+{
+    int32_t res = STATE_SUCCESS;
+    uint8_t *buffer = NULL;
+    uint32_t data_len = 0, pending_len = 0;
+
+    /* 先解析读取header时多读到的部分 */
+    if (http_handle->session.buffer_len > 0) {
+        pending_len = http_handle->session.buffer_len;
+        res = _core_http_chunk_decode(http_handle, http_handle->session.buffer + http_handle->session.buffer_offset,
+                                      pending_len, &data_len);
+        _core_http_pending_consume(http_handle, pending_len);
+        if (res < STATE_SUCCESS || data_len > 0) {
+            return (res < STATE_SUCCESS) ? res : (int32_t)data_len;
+        }
+    }
+
+    buffer = _core_http_body_buffer(http_handle);
+    if (buffer == NULL) {
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+
+    /* 只读到chunk长度行或者结尾时没有数据可交付, 继续读取 */
+    while (data_len == 0 && http_handle->session.chunk_sm != CORE_HTTP_CHUNK_DONE) {
+        http_handle->sysdep->core_sysdep_mutex_lock(http_handle->recv_mutex);
+        res = _core_http_recv(http_handle, buffer, _core_http_chunk_read_len(&http_handle->session,
+                              http_handle->body_buffer_max_len), http_handle->recv_timeout_ms);
+        http_handle->sysdep->core_sysdep_mutex_unlock(http_handle->recv_mutex);
+        if (res <= 0) {
+            return res;
+        }
+        res = _core_http_chunk_decode(http_handle, buffer, (uint32_t)res, &data_len);
+        if (res < STATE_SUCCESS) {
+            return res;
+        }
+    }
+
+    return (data_len > 0) ? (int32_t)data_len : STATE_HTTP_READ_BODY_FINISHED;
+}
+
+static int32_t _core_http_recv_body(core_http_handle_t *http_handle)
+{
+    if (http_handle->session.body_mode == CORE_HTTP_BODY_CHUNKED) {
+        return _core_http_recv_body_chunked(http_handle);
+    } else if (http_handle->session.body_mode == CORE_HTTP_BODY_UNTIL_CLOSE) {
+        return _core_http_recv_body_until_close(http_handle);
+    }
+
+    return _core_http_recv_body_length(http_handle);
+}
+
 int32_t core_http_recv(void *handle)
 {
     int32_t res = STATE_SUCCESS;
@@ -592,7 +1055,7 @@ int32_t core_http_recv(void *handle)
         return STATE_USER_INPUT_NULL_POINTER;
     }
 
-    if (http_handle->network_handle == NULL) {
+    if (http_handle->network_handle == NULL && http_handle->session.body_mode != CORE_HTTP_BODY_UNTIL_CLOSE) {
         return STATE_SYS_DEPEND_NWK_CLOSED;
     }
 
@@ -610,12 +1073,23 @@ int32_t core_http_recv(void *handle)
             _core_http_exec_dec(http_handle);
             return res;
         }
+        http_handle->session.sm = CORE_HTTP_SM_READ_BODY;
+        _core_http_body_start(http_handle, body_total_len);
     }
-    http_handle->session.sm = CORE_HTTP_SM_READ_BODY;
 
-    res = _core_http_recv_body(http_handle, body_total_len);
+    res = _core_http_recv_body(http_handle);
+    /* 应答全部读完后, 连接上不再有未读数据, 可以发送下一个请求 */
+    if (http_handle->session.body_completed == 0 && _core_http_body_complete(http_handle) == 1) {
+        http_handle->session.body_completed = 1;
+        if (http_handle->requests_pending > 0) {
+            http_handle->requests_pending--;
+        }
+        if (http_handle->network_handle != NULL) {
+            http_handle->conn_idle = (http_handle->requests_pending == 0 && http_handle->session.conn_close == 0) ? 1 : 0;
+        }
+    }
     if (res == STATE_HTTP_READ_BODY_FINISHED || res == STATE_HTTP_READ_BODY_EMPTY) {
-        memset(&http_handle->session, 0, sizeof(core_http_session_t));
+        _core_http_session_reset(http_handle);
     }
 
     _core_http_exec_dec(http_handle);
@@ -640,32 +1114,50 @@ int32_t core_http_deinit(void **p_handle)
 
     http_handle->exec_enabled = 0;
     deinit_timeout_ms = http_handle->deinit_timeout_ms;
-    do {
-        if (http_handle->exec_count == 0) {
-            break;
-        }
+    while (http_handle->exec_count != 0 && deinit_timeout_ms > CORE_HTTP_DEINIT_INTERVAL_MS) {
         http_handle->sysdep->core_sysdep_sleep(CORE_HTTP_DEINIT_INTERVAL_MS);
-    } while ((deinit_timeout_ms > CORE_HTTP_DEINIT_INTERVAL_MS) && (deinit_timeout_ms - CORE_HTTP_DEINIT_INTERVAL_MS > 0));
+        deinit_timeout_ms -= CORE_HTTP_DEINIT_INTERVAL_MS;
+    }
 
     if (http_handle->exec_count != 0) {
         return STATE_HTTP_DEINIT_TIMEOUT;
     }
 
-    if (http_handle->network_handle != NULL) {
-        http_handle->sysdep->core_sysdep_network_deinit(&http_handle->network_handle);
-    }
+    _core_http_conn_release(http_handle);
 
+    _core_http_session_reset(http_handle);
+
+    if (http_handle->body_buffer != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->body_buffer);
+    }
     if (http_handle->host != NULL) {
         http_handle->sysdep->core_sysdep_free(http_handle->host);
     }
     if (http_handle->cred != NULL) {
         http_handle->sysdep->core_sysdep_free(http_handle->cred);
     }
+    if (http_handle->product_key != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->product_key);
+    }
+    if (http_handle->device_name != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->device_name);
+    }
+    if (http_handle->device_secret != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->device_secret);
+    }
+    if (http_handle->extend_devinfo != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->extend_devinfo);
+    }
+    if (http_handle->token != NULL) {
+        http_handle->sysdep->core_sysdep_free(http_handle->token);
+    }
 
     http_handle->sysdep->core_sysdep_mutex_deinit(&http_handle->data_mutex);
     http_handle->sysdep->core_sysdep_mutex_deinit(&http_handle->send_mutex);
     http_handle->sysdep->core_sysdep_mutex_deinit(&http_handle->recv_mutex);
 
+    core_global_deinit(http_handle->sysdep);
+
     http_handle->sysdep->core_sysdep_free(http_handle);
 
     *p_handle = NULL;
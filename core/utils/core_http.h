@@ -12,6 +12,7 @@ extern "C" {
 #include "core_string.h"
 #include "core_log.h"
 #include "core_auth.h"
+#include "core_global.h"
 #include "aiot_http_api.h"
 
 typedef enum {
@@ -19,10 +20,41 @@ typedef enum {
     CORE_HTTP_SM_READ_BODY
 } core_http_sm_t;
 
+typedef enum {
+    CORE_HTTP_BODY_LENGTH,          /* body以Content-Length为界 */
+    CORE_HTTP_BODY_CHUNKED,         /* Transfer-Encoding: chunked */
+    CORE_HTTP_BODY_UNTIL_CLOSE      /* 既没有Content-Length也不是chunked编码, body以连接关闭为界 */
+} core_http_body_mode_t;
+
+typedef enum {
+    CORE_HTTP_CHUNK_SIZE,           /* 十六进制的chunk长度 */
+    CORE_HTTP_CHUNK_EXT,            /* chunk长度后的扩展字段, 直接跳过 */
+    CORE_HTTP_CHUNK_SIZE_LF,
+    CORE_HTTP_CHUNK_DATA,
+    CORE_HTTP_CHUNK_DATA_CR,
+    CORE_HTTP_CHUNK_DATA_LF,
+    CORE_HTTP_CHUNK_TRAILER,        /* 长度为0的chunk之后的trailer, 以空行结束 */
+    CORE_HTTP_CHUNK_TRAILER_LF,
+    CORE_HTTP_CHUNK_DONE
+} core_http_chunk_sm_t;
+
 typedef struct {
     core_http_sm_t sm;
+    core_http_body_mode_t body_mode;
+    uint32_t status_code;
     uint32_t body_total_len;
     uint32_t body_read_len;
+    uint8_t *buffer;            /* 读取header时使用的缓冲区, header结束后用来暂存多读到的body */
+    uint32_t buffer_offset;     /* 暂存body在buffer中的起始位置 */
+    uint32_t buffer_len;        /* 暂存body的剩余长度 */
+    uint8_t content_len_received;   /* 应答中带有Content-Length, body读完即可确定应答结束 */
+    uint8_t conn_close;             /* 应答中带有"Connection: close", 应答结束后连接不可复用 */
+    uint8_t chunked;                /* 应答中带有"Transfer-Encoding: chunked" */
+    core_http_chunk_sm_t chunk_sm;
+    uint32_t chunk_size;            /* 当前chunk的长度, 进入CORE_HTTP_CHUNK_DATA后表示剩余未读的长度 */
+    uint8_t chunk_digits;
+    uint8_t chunk_line_started;     /* 当前trailer行是否已有内容 */
+    uint8_t body_completed;         /* 本次应答已经读完 */
 } core_http_session_t;
 
 typedef struct {
@@ -51,6 +83,7 @@ typedef struct {
     aiot_sysdep_network_cred_t *cred;
     char *token;
     uint8_t long_connection;
+    uint32_t pipeline_window;
     uint8_t exec_enabled;
     uint32_t exec_count;
     uint8_t core_exec_enabled;
@@ -59,6 +92,11 @@ typedef struct {
     void *send_mutex;
     void *recv_mutex;
     core_http_session_t session;
+    uint8_t *body_buffer;           /* 读取body的缓冲区, 长度为body_buffer_max_len, 在实例内复用 */
+    uint32_t body_buffer_len;
+    char conn_key[CORE_GLOBAL_CONN_KEY_MAX_LEN];    /* 当前连接对应的"host:port/cred", 用于判断能否复用 */
+    uint8_t conn_idle;                              /* 当前连接上没有未完成的应答, 可以直接发送下一个请求 */
+    uint32_t requests_pending;                      /* 已发送但应答尚未读完的请求数, 流水线发送时大于1 */
     aiot_http_event_handler_t event_handler;
     aiot_http_recv_handler_t recv_handler;
     aiot_http_recv_handler_t core_recv_handler;
@@ -76,6 +114,13 @@ typedef struct {
 #define CORE_HTTP_DEFAULT_HEADER_LINE_MAX_LEN      (128)
 #define CORE_HTTP_DEFAULT_BODY_MAX_LEN             (128)
 #define CORE_HTTP_DEFAULT_DEINIT_TIMEOUT_MS        (2 * 1000)
+/* 最短的应答"HTTP/1.1 200\r\n\r\n"的长度, 读取header时第一次可以放心读取的字节数 */
+#define CORE_HTTP_STATUS_LINE_MIN_LEN              (16)
+/* 批量上报时同一连接上最多连续发出而未收到应答的请求数, 默认不使用流水线, 上限避免双方的接收缓冲区被占满 */
+#define CORE_HTTP_DEFAULT_PIPELINE_WINDOW          (1)
+#define CORE_HTTP_PIPELINE_WINDOW_MAX              (8)
+/* 复用空闲连接前探测对端是否已经关闭连接的等待时间 */
+#define CORE_HTTP_CONN_PROBE_TIMEOUT_MS            (1)
 
 typedef enum {
     CORE_HTTPOPT_HOST,                  /* 数据类型: (char *), 服务器域名, 默认值: iot-as-http.cn-shanghai.aliyuncs.com        */
@@ -127,7 +172,7 @@ void *core_http_init(void);
 int32_t core_http_setopt(void *handle, core_http_option_t option, void *data);
 
 /**
- * @brief 建立网络连接
+ * @brief 建立网络连接, 若已有连往同一服务器的空闲连接(本实例或进程内连接池中)则直接复用
  *
  * @param handle HTTP句柄
  * @return int32_t
@@ -137,7 +182,7 @@ int32_t core_http_setopt(void *handle, core_http_option_t option, void *data);
 int32_t core_http_connect(void *handle);
 
 /**
- * @brief 发送HTTP请求
+ * @brief 发送HTTP请求, 可以在前一个请求的应答读完之前继续发送(流水线), 应答按发送顺序通过 @ref core_http_recv 读取
  *
  * @param[in] handle HTTP句柄
  * @param request 请求结构体, 查看 @ref core_http_request_t
@@ -155,6 +200,7 @@ int32_t core_http_send(void *handle, const core_http_request_t *request);
 
 /**
  * @brief 接受HTTP应答数据, 内部将解析状态码和Header并通过回调函数通知用户, 若应答中有body则保存到用户缓冲区中
+ *        body可以以Content-Length为界, 也可以是chunked编码或者以连接关闭为界, 收到的body片段直接通过回调交给用户
  *
  * @param[in] handle HTTP句柄
  * @param buffer 指向存放接受
@@ -169,12 +215,15 @@ int32_t core_http_send(void *handle, const core_http_request_t *request);
  * @retval STATE_HTTP_RECV_LINE_TOO_LONG, HTTP单行数据过长, 内部无法解析
  * @retval STATE_HTTP_PARSE_STATUS_LINE_FAILED, 无法解析状态码
  * @retval STATE_HTTP_GET_CONTENT_LEN_FAILED, 获取Content-Length失败
+ * @retval STATE_HTTP_CHUNK_INVALID, chunked编码格式错误
+ * @retval STATE_HTTP_READ_BODY_FINISHED, body已全部读完
+ * @retval STATE_HTTP_READ_BODY_EMPTY, 应答中没有body
  *
  */
 int32_t core_http_recv(void *handle);
 
 /**
- * @brief 销毁参数p_handle所指定的HTTP实例
+ * @brief 销毁参数p_handle所指定的HTTP实例, 应答已读完的可复用连接会放入进程内连接池
  *
  * @param[in] p_handle 指向HTTP句柄的指针
  * @return int32_t
@@ -0,0 +1,98 @@
+#include "core_lock.h"
+
+static uint8_t _core_lock_rwlock_supported(aiot_sysdep_portfile_t *sysdep)
+{
+    return (sysdep->core_sysdep_rwlock_init != NULL &&
+            sysdep->core_sysdep_rwlock_rdlock != NULL &&
+            sysdep->core_sysdep_rwlock_wrlock != NULL &&
+            sysdep->core_sysdep_rwlock_unlock != NULL &&
+            sysdep->core_sysdep_rwlock_deinit != NULL) ? (1) : (0);
+}
+
+static uint8_t _core_lock_spinlock_supported(aiot_sysdep_portfile_t *sysdep)
+{
+    return (sysdep->core_sysdep_spinlock_init != NULL &&
+            sysdep->core_sysdep_spinlock_lock != NULL &&
+            sysdep->core_sysdep_spinlock_unlock != NULL &&
+            sysdep->core_sysdep_spinlock_deinit != NULL) ? (1) : (0);
+}
+
+void *core_rwlock_init(aiot_sysdep_portfile_t *sysdep)
+{
+    if (_core_lock_rwlock_supported(sysdep)) {
+        return sysdep->core_sysdep_rwlock_init();
+    }
+    return sysdep->core_sysdep_mutex_init();
+}
+
+void core_rwlock_rdlock(aiot_sysdep_portfile_t *sysdep, void *rwlock)
+{
+    if (_core_lock_rwlock_supported(sysdep)) {
+        sysdep->core_sysdep_rwlock_rdlock(rwlock);
+    } else {
+        sysdep->core_sysdep_mutex_lock(rwlock);
+    }
+}
+
+void core_rwlock_wrlock(aiot_sysdep_portfile_t *sysdep, void *rwlock)
+{
+    if (_core_lock_rwlock_supported(sysdep)) {
+        sysdep->core_sysdep_rwlock_wrlock(rwlock);
+    } else {
+        sysdep->core_sysdep_mutex_lock(rwlock);
+    }
+}
+
+void core_rwlock_unlock(aiot_sysdep_portfile_t *sysdep, void *rwlock)
+{
+    if (_core_lock_rwlock_supported(sysdep)) {
+        sysdep->core_sysdep_rwlock_unlock(rwlock);
+    } else {
+        sysdep->core_sysdep_mutex_unlock(rwlock);
+    }
+}
+
+void core_rwlock_deinit(aiot_sysdep_portfile_t *sysdep, void **rwlock)
+{
+    if (_core_lock_rwlock_supported(sysdep)) {
+        sysdep->core_sysdep_rwlock_deinit(rwlock);
+    } else {
+        sysdep->core_sysdep_mutex_deinit(rwlock);
+    }
+}
+
+void *core_spinlock_init(aiot_sysdep_portfile_t *sysdep)
+{
+    if (_core_lock_spinlock_supported(sysdep)) {
+        return sysdep->core_sysdep_spinlock_init();
+    }
+    return sysdep->core_sysdep_mutex_init();
+}
+
+void core_spinlock_lock(aiot_sysdep_portfile_t *sysdep, void *spinlock)
+{
+    if (_core_lock_spinlock_supported(sysdep)) {
+        sysdep->core_sysdep_spinlock_lock(spinlock);
+    } else {
+        sysdep->core_sysdep_mutex_lock(spinlock);
+    }
+}
+
+void core_spinlock_unlock(aiot_sysdep_portfile_t *sysdep, void *spinlock)
+{
+    if (_core_lock_spinlock_supported(sysdep)) {
+        sysdep->core_sysdep_spinlock_unlock(spinlock);
+    } else {
+        sysdep->core_sysdep_mutex_unlock(spinlock);
+    }
+}
+
+void core_spinlock_deinit(aiot_sysdep_portfile_t *sysdep, void **spinlock)
+{
+    if (_core_lock_spinlock_supported(sysdep)) {
+        sysdep->core_sysdep_spinlock_deinit(spinlock);
+    } else {
+        sysdep->core_sysdep_mutex_deinit(spinlock);
+    }
+}
+
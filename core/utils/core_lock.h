@@ -0,0 +1,31 @@
+#ifndef _CORE_LOCK_H_
+#define _CORE_LOCK_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "core_stdinc.h"
+#include "aiot_sysdep_api.h"
+
+/*
+ * 读写锁与自旋锁在portfile中为可选接口, 未实现时以下接口自动退化为互斥锁
+ * 同一把锁的创建、加解锁和销毁必须使用同一个sysdep
+ */
+void *core_rwlock_init(aiot_sysdep_portfile_t *sysdep);
+void core_rwlock_rdlock(aiot_sysdep_portfile_t *sysdep, void *rwlock);
+void core_rwlock_wrlock(aiot_sysdep_portfile_t *sysdep, void *rwlock);
+void core_rwlock_unlock(aiot_sysdep_portfile_t *sysdep, void *rwlock);
+void core_rwlock_deinit(aiot_sysdep_portfile_t *sysdep, void **rwlock);
+
+void *core_spinlock_init(aiot_sysdep_portfile_t *sysdep);
+void core_spinlock_lock(aiot_sysdep_portfile_t *sysdep, void *spinlock);
+void core_spinlock_unlock(aiot_sysdep_portfile_t *sysdep, void *spinlock);
+void core_spinlock_deinit(aiot_sysdep_portfile_t *sysdep, void **spinlock);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
@@ -1,9 +1,66 @@
 #include "core_log.h"
 
-extern aiot_state_logcb_t g_logcb_handler;
-
 static core_log_t g_core_log = { .time_start = 0, .time_interval = 0, .timestamp = 0, .log_stamp = 1, .log_date = 0};
 
+/* 线程局部存储, 用于日志前缀日期的缓存以及异步日志的缓冲区 */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CORE_LOG_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+    #define CORE_LOG_THREAD_LOCAL __declspec(thread)
+#endif
+
+/*
+ * 同一秒内的日志前缀日期相同, 按线程缓存最近一次格式化的结果, 无需加锁
+ * 编译器不支持线程局部存储时每次都重新格式化
+ */
+#define CORE_LOG_DATE_MAXLEN (24)
+
+#ifdef CORE_LOG_THREAD_LOCAL
+static CORE_LOG_THREAD_LOCAL uint64_t g_core_log_date_second = 0;
+static CORE_LOG_THREAD_LOCAL char g_core_log_date[CORE_LOG_DATE_MAXLEN];
+static CORE_LOG_THREAD_LOCAL uint8_t g_core_log_date_len = 0;
+#endif
+
+/* 未列出的状态码按INFO级别处理 */
+static const struct {
+    int32_t code;
+    uint8_t level;
+} g_core_log_level_map[] = {
+    {STATE_MQTT_LOG_HEXDUMP,            AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_TOPIC,              AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_USERNAME,           AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_PASSWORD,           AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_CLIENTID,           AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_TLS_PSK,            AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_HTTP_LOG_SEND_HEADER,        AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_HTTP_LOG_SEND_CONTENT,       AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_HTTP_LOG_RECV_HEADER,        AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_HTTP_LOG_RECV_CONTENT,       AIOT_STATE_LOGLEVEL_DEBUG},
+    {STATE_MQTT_LOG_CONNECT_TIMEOUT,    AIOT_STATE_LOGLEVEL_WARN},
+    {STATE_MQTT_LOG_DISCONNECT,         AIOT_STATE_LOGLEVEL_WARN},
+    {STATE_MQTT_LOG_RECONNECTING,       AIOT_STATE_LOGLEVEL_WARN},
+    {STATE_HTTP_LOG_DISCONNECT,         AIOT_STATE_LOGLEVEL_WARN},
+};
+
+uint8_t core_log_check(int32_t code)
+{
+    uint32_t idx = 0, module = ((uint32_t)(-code) >> 8);
+    uint8_t level = AIOT_STATE_LOGLEVEL_INFO;
+
+    if (module < 32 && ((g_logcb_mask >> module) & 0x01) == 0) {
+        return 0;
+    }
+
+    for (idx = 0; idx < sizeof(g_core_log_level_map) / sizeof(g_core_log_level_map[0]); idx++) {
+        if (g_core_log_level_map[idx].code == code) {
+            level = g_core_log_level_map[idx].level;
+            break;
+        }
+    }
+
+    return (level <= g_logcb_level) ? (1) : (0);
+}
+
 static void _core_log_append_code(int32_t code, char *buffer)
 {
     uint8_t code_hex[4] = {0};
@@ -38,44 +95,57 @@ static uint64_t _core_log_get_timestamp(aiot_sysdep_portfile_t *sysdep)
     return timenow;
 }
 
-void _core_log_append_date(aiot_sysdep_portfile_t *sysdep, uint64_t timestamp, char *buffer)
+static uint8_t _core_log_format_date(uint64_t timestamp, char *buffer)
 {
-    int32_t res = STATE_SUCCESS;
-    char date_str[7][11] = {{0}};
-    char *time = NULL;
-    char *time_src[] = { date_str[0], date_str[1], date_str[2], date_str[3], date_str[4], date_str[5] };
-    char *time_fmt = "%s/%s/%s %s:%s:%s";
+    char *pos = buffer;
+    uint8_t len = 0;
+    uint32_t idx = 0;
+    uint32_t fields[6] = {0};
+    const char delim[6] = {'/', '/', ' ', ':', ':', '\0'};
     core_date_t date;
 
     memset(&date, 0, sizeof(core_date_t));
 
+    /* 格式为"%s/%s/%s %s:%s:%s" */
     core_utc2date(timestamp, 8, &date);
-    core_uint2str(date.year, date_str[0], NULL);
-    core_uint2str(date.mon, date_str[1], NULL);
-    core_uint2str(date.day, date_str[2], NULL);
-    core_uint2str(date.hour, date_str[3], NULL);
-    core_uint2str(date.min, date_str[4], NULL);
-    core_uint2str(date.sec, date_str[5], NULL);
-
-    res = core_sprintf(sysdep, &time, time_fmt, time_src, sizeof(time_src)/sizeof(char *), CORE_LOG_MODULE_NAME);
-    if (res >= STATE_SUCCESS) {
-        memcpy(buffer + strlen(buffer), time, strlen(time));
-
-        sysdep->core_sysdep_free(time);
+    fields[0] = date.year;
+    fields[1] = date.mon;
+    fields[2] = date.day;
+    fields[3] = date.hour;
+    fields[4] = date.min;
+    fields[5] = date.sec;
+
+    for (idx = 0; idx < sizeof(fields) / sizeof(fields[0]); idx++) {
+        core_uint2str(fields[idx], pos, &len);
+        pos += len;
+        *pos = delim[idx];
+        if (delim[idx] != '\0') {
+            pos++;
+        }
     }
-}
 
+    return (uint8_t)(pos - buffer);
+}
 
-static void _core_log_append_prefix(aiot_sysdep_portfile_t *sysdep, int32_t code, char *buffer)
+void _core_log_append_date(aiot_sysdep_portfile_t *sysdep, uint64_t timestamp, char *buffer)
 {
-    uint64_t timenow = 0;
-    if (sysdep == NULL) {
-        return;
-    }
+    char *pos = buffer + strlen(buffer);
 
-    timenow = _core_log_get_timestamp(sysdep);
+#ifdef CORE_LOG_THREAD_LOCAL
+    /* 秒数加1后再比较, 使得初始值0不会与时间戳0误匹配 */
+    if (g_core_log_date_second != timestamp / 1000 + 1) {
+        g_core_log_date_len = _core_log_format_date(timestamp, g_core_log_date);
+        g_core_log_date_second = timestamp / 1000 + 1;
+    }
+    memcpy(pos, g_core_log_date, g_core_log_date_len + 1);
+#else
+    _core_log_format_date(timestamp, pos);
+#endif
+}
 
 
+static void _core_log_append_prefix_time(aiot_sysdep_portfile_t *sysdep, uint64_t timenow, int32_t code, char *buffer)
+{
     if (1 == g_core_log.log_date) {
         memcpy(buffer + strlen(buffer), "[", strlen("["));
         _core_log_append_date(sysdep, timenow, buffer);
@@ -100,14 +170,21 @@ static void _core_log_append_prefix(aiot_sysdep_portfile_t *sysdep, int32_t code
     _core_log_append_code(code, buffer);
 }
 
-static void _core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *buffer, char *fmt, void *datas[],
-                      uint8_t count)
+static void _core_log_append_prefix(aiot_sysdep_portfile_t *sysdep, int32_t code, char *buffer)
+{
+    if (sysdep == NULL) {
+        return;
+    }
+
+    _core_log_append_prefix_time(sysdep, _core_log_get_timestamp(sysdep), code, buffer);
+}
+
+static void _core_log_format(char *buffer, char *fmt, void *datas[], uint8_t count)
 {
     uint32_t idx = 0, buffer_idx = 0, copy_len = 0, arg_flag = 0, arg_idx = 0;
     void *arg = datas[arg_idx];
     uint32_t fmt_len = (uint32_t) strlen(fmt);
 
-    _core_log_append_prefix(sysdep, code, buffer);
     buffer_idx += strlen(buffer);
 
     for (idx = 0; idx < fmt_len ;) {
@@ -165,6 +242,508 @@ static void _core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *buffer
     }
 }
 
+static void _core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *buffer, char *fmt, void *datas[],
+                      uint8_t count)
+{
+    _core_log_append_prefix(sysdep, code, buffer);
+    _core_log_format(buffer, fmt, datas, count);
+}
+
+static void _core_log_hexdump(int32_t code, char prefix, uint8_t *buffer, uint32_t len)
+{
+    uint32_t idx = 0, line_idx = 0, ch_idx = 0, code_len = 0;
+    /* [LK-XXXX] + 1 + 1 + 16*3 + 1 + 1 + 1 + 16 + 2*/
+    char hexdump[25 + 72] = {0};
+
+    g_logcb_handler(code, "\r\n");
+    _core_log_append_code(code, hexdump);
+    code_len = strlen(hexdump);
+
+    for (idx = 0; idx < len;) {
+        memset(hexdump + code_len, ' ', 71);
+        ch_idx = 2;
+        hexdump[code_len + 0] = prefix;
+        hexdump[code_len + 51] = '|';
+        hexdump[code_len + 52] = ' ';
+        for (line_idx = idx; ((line_idx - idx) < 16) && (line_idx < len); line_idx++) {
+            if ((line_idx - idx) == 8) {
+                ch_idx++;
+            }
+            core_hex2str((uint8_t *)&buffer[line_idx], 1, &hexdump[code_len + ch_idx], 0);
+            hexdump[code_len + ch_idx + 2] = ' ';
+            if (buffer[line_idx] >= 0x20 && buffer[line_idx] <= 0x7E) {
+                hexdump[code_len + 53 + (line_idx - idx)] = buffer[line_idx];
+            } else {
+                hexdump[code_len + 53 + (line_idx - idx)] = '.';
+            }
+            ch_idx += 3;
+        }
+        hexdump[code_len + 69] = '\r';
+        hexdump[code_len + 70] = '\n';
+        idx += (line_idx - idx);
+        g_logcb_handler(code, hexdump);
+    }
+    g_logcb_handler(code, "\r\n");
+}
+
+/*
+ * 异步日志: 每个线程首次输出日志时分配一个单生产者单消费者的环形缓冲区, 日志记录写入后立即返回,
+ * 由用户调用aiot_state_logbuf_drain()的线程统一投递给日志回调. 缓冲区满时丢弃记录并计数, 不会阻塞
+ *
+ * 缓冲区中保存的是未格式化的二进制记录: 记录头(@ref core_log_record_t) + 参数, 参数只拷贝原始值,
+ * 字符串拷贝内容, 时间戳前缀、整数转换、十六进制打印等格式化工作都推迟到投递时进行
+ * 记录长度为0表示缓冲区尾部剩余空间不足, 读取位置直接回到缓冲区起始处
+ */
+
+#define CORE_LOG_BUFFER_MIN_SIZE    (1024)
+
+/* 记录类型 */
+#define CORE_LOG_RECORD_FMT         (0)     /* core_log/core_log1~3, fmt为NULL时唯一的参数即为日志内容 */
+#define CORE_LOG_RECORD_HEXDUMP     (1)     /* core_log_hexdump, 参数为4字节长度 + 原始数据 */
+
+/* 参数类型 */
+#define CORE_LOG_ARG_NULL           (0)     /* 空指针 */
+#define CORE_LOG_ARG_OPAQUE         (1)     /* 非空但格式串中未使用的参数 */
+#define CORE_LOG_ARG_U32            (2)     /* %d, %x, 4字节 */
+#define CORE_LOG_ARG_LEN            (3)     /* %.*s的长度, 4字节, 不超过CORE_LOG_MAXLEN */
+#define CORE_LOG_ARG_STR            (4)     /* %s, 2字节长度 + 内容 + '\0' */
+#define CORE_LOG_ARG_LENSTR         (5)     /* %.*s的内容, 格式同CORE_LOG_ARG_STR */
+
+typedef struct {
+    uint32_t len;       /* 记录总长度, 4字节对齐 */
+    int32_t code;
+    uint8_t type;
+    uint8_t has_prefix;
+    uint8_t count;
+    char hexdump_prefix;
+    uint64_t timestamp;
+    char *fmt;          /* 格式串均为字符串常量, 只保存指针 */
+} core_log_record_t;
+
+typedef struct core_log_ring {
+    struct core_log_ring *next;
+    void *lock;
+    uint8_t *buffer;
+    uint32_t size;
+    core_atomic_u32_t head;     /* 写入位置, 只由所属线程修改 */
+    core_atomic_u32_t tail;     /* 读取位置, 只由投递线程修改 */
+    core_atomic_u32_t dropped;
+} core_log_ring_t;
+
+static uint32_t g_core_log_buffer_size = 0;
+static void *g_core_log_ring_lock = NULL;
+static core_log_ring_t *g_core_log_ring_list = NULL;
+static core_atomic_u32_t g_core_log_draining;
+
+#ifdef CORE_LOG_THREAD_LOCAL
+static CORE_LOG_THREAD_LOCAL core_log_ring_t *g_core_log_ring = NULL;
+static CORE_LOG_THREAD_LOCAL uint8_t g_core_log_ring_failed = 0;
+#endif
+
+static core_log_ring_t *_core_log_ring_create(aiot_sysdep_portfile_t *sysdep, uint32_t size)
+{
+    core_log_ring_t *ring = NULL;
+
+    ring = sysdep->core_sysdep_malloc(sizeof(core_log_ring_t), CORE_LOG_MODULE_NAME);
+    if (ring == NULL) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(core_log_ring_t));
+
+    ring->buffer = sysdep->core_sysdep_malloc(size, CORE_LOG_MODULE_NAME);
+    if (ring->buffer == NULL) {
+        sysdep->core_sysdep_free(ring);
+        return NULL;
+    }
+    ring->size = size;
+    ring->lock = core_spinlock_init(sysdep);
+    core_atomic_init_u32(&ring->head, 0);
+    core_atomic_init_u32(&ring->tail, 0);
+    core_atomic_init_u32(&ring->dropped, 0);
+
+    /* 缓冲区只在进程内累积, 不随线程退出释放 */
+    core_spinlock_lock(sysdep, g_core_log_ring_lock);
+    ring->next = g_core_log_ring_list;
+    g_core_log_ring_list = ring;
+    core_spinlock_unlock(sysdep, g_core_log_ring_lock);
+
+    return ring;
+}
+
+static uint8_t *_core_log_ring_reserve(aiot_sysdep_portfile_t *sysdep, core_log_ring_t *ring, uint32_t rec_len,
+                                       uint32_t *need)
+{
+    uint32_t head = 0, tail = 0, pos = 0, to_end = 0;
+
+    head = core_atomic_load_u32(sysdep, ring->lock, &ring->head);
+    tail = core_atomic_load_u32(sysdep, ring->lock, &ring->tail);
+    pos = head & (ring->size - 1);
+    to_end = ring->size - pos;
+    *need = (to_end < rec_len) ? (to_end + rec_len) : (rec_len);
+
+    if (ring->size - (head - tail) < *need) {
+        core_atomic_add_u32(sysdep, ring->lock, &ring->dropped, 1);
+        return NULL;
+    }
+
+    if (to_end < rec_len) {
+        memset(&ring->buffer[pos], 0, sizeof(uint32_t));
+        pos = 0;
+    }
+
+    return &ring->buffer[pos];
+}
+
+static void _core_log_ring_commit(aiot_sysdep_portfile_t *sysdep, core_log_ring_t *ring, uint32_t need)
+{
+    /* 记录内容写完后再更新写入位置 */
+    core_atomic_add_u32(sysdep, ring->lock, &ring->head, need);
+}
+
+static core_log_ring_t *_core_log_ring_get(aiot_sysdep_portfile_t *sysdep)
+{
+#ifdef CORE_LOG_THREAD_LOCAL
+    if (g_core_log_buffer_size == 0 || g_core_log_ring_failed != 0 || sysdep == NULL) {
+        return NULL;
+    }
+    if (g_core_log_ring == NULL) {
+        g_core_log_ring = _core_log_ring_create(sysdep, g_core_log_buffer_size);
+        g_core_log_ring_failed = (g_core_log_ring == NULL) ? (1) : (0);
+    }
+    return g_core_log_ring;
+#else
+    return NULL;
+#endif
+}
+
+/* 按照_core_log_format消费参数的方式, 确定每个参数需要保存的内容 */
+static void _core_log_arg_types(char *fmt, void *datas[], uint8_t count, uint8_t types[])
+{
+    uint32_t idx = 0, arg_flag = 0, arg_idx = 0;
+    void *arg = datas[arg_idx];
+    uint32_t fmt_len = (uint32_t) strlen(fmt);
+
+    for (idx = 0; idx < count; idx++) {
+        types[idx] = (datas[idx] == NULL) ? (CORE_LOG_ARG_NULL) : (CORE_LOG_ARG_OPAQUE);
+    }
+
+    for (idx = 0; idx < fmt_len;) {
+        if (arg_flag == 1) {
+            if (arg_idx < count - 1) {
+                arg = datas[++arg_idx];
+            } else {
+                arg = NULL;
+            }
+            arg_flag = 0;
+        }
+
+        if (fmt[idx] == '%' && idx + 1 < fmt_len && fmt[idx + 1] == 's' && arg != NULL) {
+            types[arg_idx] = CORE_LOG_ARG_STR;
+            idx += 2;
+            arg_flag = 1;
+        } else if (memcmp(&fmt[idx], "%.*s", strlen("%.*s")) == 0 && arg != NULL && (arg_idx + 1) < count) {
+            types[arg_idx] = CORE_LOG_ARG_LEN;
+            if (datas[arg_idx + 1] != NULL) {
+                types[arg_idx + 1] = CORE_LOG_ARG_LENSTR;
+            }
+            idx += strlen("%.*s");
+            arg_flag = 1;
+            arg_idx++;
+        } else if (fmt[idx] == '%' && idx + 1 < fmt_len && (fmt[idx + 1] == 'd' || fmt[idx + 1] == 'x') && arg != NULL) {
+            types[arg_idx] = CORE_LOG_ARG_U32;
+            idx += 2;
+            arg_flag = 1;
+        } else {
+            idx++;
+        }
+    }
+}
+
+/* output为NULL时只计算编码后的长度 */
+static uint32_t _core_log_arg_encode(void *datas[], uint8_t types[], uint8_t count, uint8_t *output)
+{
+    uint32_t idx = 0, offset = 0, value = 0, lenstr_len = 0;
+    uint16_t str_len = 0;
+
+    for (idx = 0; idx < count; idx++) {
+        if (output != NULL) {
+            output[offset] = types[idx];
+        }
+        offset += 1;
+
+        switch (types[idx]) {
+            case CORE_LOG_ARG_U32:
+            case CORE_LOG_ARG_LEN: {
+                value = *(uint32_t *)datas[idx];
+                if (types[idx] == CORE_LOG_ARG_LEN) {
+                    value = (value > CORE_LOG_MAXLEN) ? (CORE_LOG_MAXLEN) : (value);
+                    lenstr_len = value;
+                }
+                if (output != NULL) {
+                    memcpy(&output[offset], &value, sizeof(uint32_t));
+                }
+                offset += sizeof(uint32_t);
+            }
+            break;
+            case CORE_LOG_ARG_STR:
+            case CORE_LOG_ARG_LENSTR: {
+                if (types[idx] == CORE_LOG_ARG_STR) {
+                    str_len = (uint16_t)strnlen((char *)datas[idx], CORE_LOG_MAXLEN);
+                } else {
+                    str_len = (uint16_t)lenstr_len;
+                }
+                if (output != NULL) {
+                    memcpy(&output[offset], &str_len, sizeof(uint16_t));
+                    memcpy(&output[offset + sizeof(uint16_t)], datas[idx], str_len);
+                    output[offset + sizeof(uint16_t) + str_len] = '\0';
+                }
+                offset += sizeof(uint16_t) + str_len + 1;
+            }
+            break;
+            default: {
+            }
+            break;
+        }
+    }
+
+    return offset;
+}
+
+static void _core_log_arg_decode(uint8_t *input, uint8_t count, uint32_t values[], void *datas[])
+{
+    uint32_t idx = 0, offset = 0;
+    uint16_t str_len = 0;
+
+    for (idx = 0; idx < count; idx++) {
+        switch (input[offset++]) {
+            case CORE_LOG_ARG_OPAQUE: {
+                datas[idx] = &values[idx];
+            }
+            break;
+            case CORE_LOG_ARG_U32:
+            case CORE_LOG_ARG_LEN: {
+                memcpy(&values[idx], &input[offset], sizeof(uint32_t));
+                datas[idx] = &values[idx];
+                offset += sizeof(uint32_t);
+            }
+            break;
+            case CORE_LOG_ARG_STR:
+            case CORE_LOG_ARG_LENSTR: {
+                memcpy(&str_len, &input[offset], sizeof(uint16_t));
+                datas[idx] = &input[offset + sizeof(uint16_t)];
+                offset += sizeof(uint16_t) + str_len + 1;
+            }
+            break;
+            default: {
+                datas[idx] = NULL;
+            }
+            break;
+        }
+    }
+}
+
+/* sysdep为NULL时与同步输出一致, 不带时间戳和状态码前缀 */
+static uint8_t _core_log_ring_push_fmt(aiot_sysdep_portfile_t *sysdep, core_log_ring_t *ring, int32_t code,
+                                       char *fmt, void *datas[], uint8_t count)
+{
+    aiot_sysdep_portfile_t *ring_sysdep = (sysdep == NULL) ? (aiot_sysdep_get_portfile()) : (sysdep);
+    core_log_record_t record;
+    uint8_t types[3] = {0};
+    uint8_t *pos = NULL;
+    uint32_t need = 0;
+
+    if (fmt == NULL) {
+        types[0] = CORE_LOG_ARG_STR;
+    } else {
+        _core_log_arg_types(fmt, datas, count, types);
+    }
+
+    memset(&record, 0, sizeof(core_log_record_t));
+    record.len = (sizeof(core_log_record_t) + _core_log_arg_encode(datas, types, count, NULL) + 3) & ~((uint32_t)3);
+    record.code = code;
+    record.type = CORE_LOG_RECORD_FMT;
+    record.has_prefix = (sysdep == NULL) ? (0) : (1);
+    record.count = count;
+    record.timestamp = (sysdep == NULL) ? (0) : (_core_log_get_timestamp(sysdep));
+    record.fmt = fmt;
+
+    pos = _core_log_ring_reserve(ring_sysdep, ring, record.len, &need);
+    if (pos == NULL) {
+        return 0;
+    }
+    memcpy(pos, &record, sizeof(core_log_record_t));
+    _core_log_arg_encode(datas, types, count, pos + sizeof(core_log_record_t));
+    _core_log_ring_commit(ring_sysdep, ring, need);
+
+    return 1;
+}
+
+static uint8_t _core_log_ring_push_hexdump(aiot_sysdep_portfile_t *sysdep, core_log_ring_t *ring, int32_t code,
+        char prefix, uint8_t *buffer, uint32_t len)
+{
+    core_log_record_t record;
+    uint8_t *pos = NULL;
+    uint32_t need = 0;
+
+    memset(&record, 0, sizeof(core_log_record_t));
+    record.len = (sizeof(core_log_record_t) + sizeof(uint32_t) + len + 3) & ~((uint32_t)3);
+    record.code = code;
+    record.type = CORE_LOG_RECORD_HEXDUMP;
+    record.hexdump_prefix = prefix;
+
+    /* 超过缓冲区大小的报文无法写入, 同样计为丢弃 */
+    if (len > ring->size) {
+        core_atomic_add_u32(sysdep, ring->lock, &ring->dropped, 1);
+        return 0;
+    }
+
+    pos = _core_log_ring_reserve(sysdep, ring, record.len, &need);
+    if (pos == NULL) {
+        return 0;
+    }
+    memcpy(pos, &record, sizeof(core_log_record_t));
+    memcpy(pos + sizeof(core_log_record_t), &len, sizeof(uint32_t));
+    memcpy(pos + sizeof(core_log_record_t) + sizeof(uint32_t), buffer, len);
+    _core_log_ring_commit(sysdep, ring, need);
+
+    return 1;
+}
+
+static void _core_log_record_deliver(aiot_sysdep_portfile_t *sysdep, uint8_t *input)
+{
+    core_log_record_t record;
+    char buffer[CORE_LOG_MAXLEN + 3] = {0};
+    uint32_t values[3] = {0}, len = 0;
+    void *datas[3] = {NULL};
+    uint8_t *args = input + sizeof(core_log_record_t);
+
+    memcpy(&record, input, sizeof(core_log_record_t));
+
+    if (record.type == CORE_LOG_RECORD_HEXDUMP) {
+        memcpy(&len, args, sizeof(uint32_t));
+        _core_log_hexdump(record.code, record.hexdump_prefix, args + sizeof(uint32_t), len);
+        return;
+    }
+
+    _core_log_arg_decode(args, record.count, values, datas);
+
+    buffer[CORE_LOG_MAXLEN] = '\r';
+    buffer[CORE_LOG_MAXLEN + 1] = '\n';
+    if (record.has_prefix) {
+        _core_log_append_prefix_time(sysdep, record.timestamp, record.code, buffer);
+    }
+    if (record.fmt == NULL) {
+        len = (strlen(buffer) + strlen(datas[0]) > CORE_LOG_MAXLEN) ? (CORE_LOG_MAXLEN - strlen(buffer)) : (strlen(datas[0]));
+        memcpy(buffer + strlen(buffer), datas[0], len);
+    } else {
+        _core_log_format(buffer, record.fmt, datas, record.count);
+    }
+
+    g_logcb_handler(record.code, buffer);
+}
+
+int32_t core_log_set_buffer(uint32_t size)
+{
+    aiot_sysdep_portfile_t *sysdep = aiot_sysdep_get_portfile();
+    uint32_t ring_size = CORE_LOG_BUFFER_MIN_SIZE;
+
+    if (size == 0) {
+        g_core_log_buffer_size = 0;
+        return STATE_SUCCESS;
+    }
+
+    if (sysdep == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+
+    if (g_core_log_ring_lock == NULL) {
+        g_core_log_ring_lock = core_spinlock_init(sysdep);
+        if (g_core_log_ring_lock == NULL) {
+            return STATE_SYS_DEPEND_MALLOC_FAILED;
+        }
+        core_atomic_init_u32(&g_core_log_draining, 0);
+    }
+
+    /* 取不小于size的2的幂, 读写位置自然溢出时仍能正确取模 */
+    while (ring_size < size && ring_size < 0x80000000) {
+        ring_size <<= 1;
+    }
+
+#ifdef CORE_LOG_THREAD_LOCAL
+    g_core_log_buffer_size = ring_size;
+#endif
+    /* 编译器不支持线程局部存储时始终同步输出 */
+
+    return STATE_SUCCESS;
+}
+
+int32_t core_log_drain(void)
+{
+    aiot_sysdep_portfile_t *sysdep = aiot_sysdep_get_portfile();
+    core_log_ring_t *ring = NULL;
+    uint32_t head = 0, tail = 0, start = 0, pos = 0, rec_len = 0, expected = 0;
+    int32_t count = 0;
+
+    if (sysdep == NULL || g_core_log_ring_lock == NULL) {
+        return 0;
+    }
+
+    /* 同一时刻只允许一个线程投递 */
+    if (core_atomic_cas_u32(sysdep, g_core_log_ring_lock, &g_core_log_draining, &expected, 1) == 0) {
+        return 0;
+    }
+
+    core_spinlock_lock(sysdep, g_core_log_ring_lock);
+    ring = g_core_log_ring_list;
+    core_spinlock_unlock(sysdep, g_core_log_ring_lock);
+
+    for (; ring != NULL; ring = ring->next) {
+        start = tail = core_atomic_load_u32(sysdep, ring->lock, &ring->tail);
+        head = core_atomic_load_u32(sysdep, ring->lock, &ring->head);
+
+        /* 批量投递当前所有记录后, 再一次性更新读取位置 */
+        while (tail != head) {
+            pos = tail & (ring->size - 1);
+            memcpy(&rec_len, &ring->buffer[pos], sizeof(uint32_t));
+            if (rec_len == 0) {
+                tail += ring->size - pos;
+                continue;
+            }
+            if (g_logcb_handler != NULL) {
+                _core_log_record_deliver(sysdep, &ring->buffer[pos]);
+            }
+            tail += rec_len;
+            count++;
+        }
+        core_atomic_add_u32(sysdep, ring->lock, &ring->tail, tail - start);
+    }
+
+    core_atomic_sub_u32(sysdep, g_core_log_ring_lock, &g_core_log_draining, 1);
+
+    return count;
+}
+
+uint32_t core_log_dropped(void)
+{
+    aiot_sysdep_portfile_t *sysdep = aiot_sysdep_get_portfile();
+    core_log_ring_t *ring = NULL;
+    uint32_t dropped = 0;
+
+    if (sysdep == NULL || g_core_log_ring_lock == NULL) {
+        return 0;
+    }
+
+    core_spinlock_lock(sysdep, g_core_log_ring_lock);
+    ring = g_core_log_ring_list;
+    core_spinlock_unlock(sysdep, g_core_log_ring_lock);
+
+    for (; ring != NULL; ring = ring->next) {
+        dropped += core_atomic_load_u32(sysdep, ring->lock, &ring->dropped);
+    }
+
+    return dropped;
+}
+
 void core_log_set_timestamp(aiot_sysdep_portfile_t *sysdep, uint64_t timestamp)
 {
     g_core_log.timestamp = timestamp;
@@ -177,15 +756,23 @@ uint64_t core_log_get_timestamp(aiot_sysdep_portfile_t *sysdep)
     return _core_log_get_timestamp(sysdep);
 }
 
-void core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *data)
+void core_log_print(aiot_sysdep_portfile_t *sysdep, int32_t code, char *data)
 {
     char buffer[CORE_LOG_MAXLEN + 3] = {0};
     uint32_t len = 0;
+    core_log_ring_t *ring = NULL;
 
     if (g_logcb_handler == NULL) {
         return;
     }
 
+    ring = _core_log_ring_get((sysdep == NULL) ? (aiot_sysdep_get_portfile()) : (sysdep));
+    if (ring != NULL) {
+        void *datas[] = {data};
+        _core_log_ring_push_fmt(sysdep, ring, code, NULL, datas, 1);
+        return;
+    }
+
     buffer[CORE_LOG_MAXLEN] = '\r';
     buffer[CORE_LOG_MAXLEN + 1] = '\n';
     _core_log_append_prefix(sysdep, code, buffer);
@@ -195,52 +782,47 @@ void core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *data)
     g_logcb_handler(code, buffer);
 }
 
-void core_log1(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data)
+static void _core_log_print(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *datas[], uint8_t count)
 {
     char buffer[CORE_LOG_MAXLEN + 3] = {0};
-    void *datas[] = {data};
+    core_log_ring_t *ring = NULL;
 
     if (g_logcb_handler == NULL) {
         return;
     }
 
+    ring = _core_log_ring_get((sysdep == NULL) ? (aiot_sysdep_get_portfile()) : (sysdep));
+    if (ring != NULL) {
+        _core_log_ring_push_fmt(sysdep, ring, code, fmt, datas, count);
+        return;
+    }
+
     buffer[CORE_LOG_MAXLEN] = '\r';
     buffer[CORE_LOG_MAXLEN + 1] = '\n';
-    _core_log(sysdep, code, buffer, fmt, datas, 1);
+    _core_log(sysdep, code, buffer, fmt, datas, count);
 
     g_logcb_handler(code, buffer);
 }
 
-void core_log2(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2)
+void core_log_print1(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data)
 {
-    char buffer[CORE_LOG_MAXLEN + 3] = {0};
-    void *datas[] = {data1, data2};
+    void *datas[] = {data};
 
-    if (g_logcb_handler == NULL) {
-        return;
-    }
+    _core_log_print(sysdep, code, fmt, datas, 1);
+}
 
-    buffer[CORE_LOG_MAXLEN] = '\r';
-    buffer[CORE_LOG_MAXLEN + 1] = '\n';
-    _core_log(sysdep, code, buffer, fmt, datas, 2);
+void core_log_print2(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2)
+{
+    void *datas[] = {data1, data2};
 
-    g_logcb_handler(code, buffer);
+    _core_log_print(sysdep, code, fmt, datas, 2);
 }
 
-void core_log3(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2, void *data3)
+void core_log_print3(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2, void *data3)
 {
-    char buffer[CORE_LOG_MAXLEN + 3] = {0};
     void *datas[] = {data1, data2, data3};
 
-    if (g_logcb_handler == NULL) {
-        return;
-    }
-
-    buffer[CORE_LOG_MAXLEN] = '\r';
-    buffer[CORE_LOG_MAXLEN + 1] = '\n';
-    _core_log(sysdep, code, buffer, fmt, datas, 3);
-
-    g_logcb_handler(code, buffer);
+    _core_log_print(sysdep, code, fmt, datas, 3);
 }
 
 #if 0
@@ -262,44 +844,24 @@ void core_log4(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *da
 }
 #endif
 
-void core_log_hexdump(int32_t code, char prefix, uint8_t *buffer, uint32_t len)
+void core_log_print_hexdump(int32_t code, char prefix, uint8_t *buffer, uint32_t len)
 {
-    uint32_t idx = 0, line_idx = 0, ch_idx = 0, code_len = 0;
-    /* [LK-XXXX] + 1 + 1 + 16*3 + 1 + 1 + 1 + 16 + 2*/
-    char hexdump[25 + 72] = {0};
+    aiot_sysdep_portfile_t *sysdep = NULL;
+    core_log_ring_t *ring = NULL;
 
     if (g_logcb_handler == NULL || len == 0) {
         return;
     }
 
-    g_logcb_handler(code, "\r\n");
-    _core_log_append_code(code, hexdump);
-    code_len = strlen(hexdump);
-
-    for (idx = 0; idx < len;) {
-        memset(hexdump + code_len, ' ', 71);
-        ch_idx = 2;
-        hexdump[code_len + 0] = prefix;
-        hexdump[code_len + 51] = '|';
-        hexdump[code_len + 52] = ' ';
-        for (line_idx = idx; ((line_idx - idx) < 16) && (line_idx < len); line_idx++) {
-            if ((line_idx - idx) == 8) {
-                ch_idx++;
-            }
-            core_hex2str((uint8_t *)&buffer[line_idx], 1, &hexdump[code_len + ch_idx], 0);
-            hexdump[code_len + ch_idx + 2] = ' ';
-            if (buffer[line_idx] >= 0x20 && buffer[line_idx] <= 0x7E) {
-                hexdump[code_len + 53 + (line_idx - idx)] = buffer[line_idx];
-            } else {
-                hexdump[code_len + 53 + (line_idx - idx)] = '.';
-            }
-            ch_idx += 3;
-        }
-        hexdump[code_len + 69] = '\r';
-        hexdump[code_len + 70] = '\n';
-        idx += (line_idx - idx);
-        g_logcb_handler(code, hexdump);
+    if (g_core_log_buffer_size != 0) {
+        sysdep = aiot_sysdep_get_portfile();
+        ring = _core_log_ring_get(sysdep);
     }
-    g_logcb_handler(code, "\r\n");
+    if (ring != NULL) {
+        _core_log_ring_push_hexdump(sysdep, ring, code, prefix, buffer, len);
+        return;
+    }
+
+    _core_log_hexdump(code, prefix, buffer, len);
 }
 
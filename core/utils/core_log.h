@@ -7,6 +7,7 @@ extern "C" {
 
 #include "core_stdinc.h"
 #include "core_string.h"
+#include "core_atomic.h"
 #include "aiot_state_api.h"
 #include "aiot_sysdep_api.h"
 
@@ -21,16 +22,56 @@ typedef struct {
     uint8_t  log_date;
 } core_log_t;
 
+extern aiot_state_logcb_t g_logcb_handler;
+extern uint8_t g_logcb_level;
+extern uint32_t g_logcb_mask;
+
+/*
+ * 日志是否需要输出, 在格式化及参数求值之前判断
+ * 默认配置(DEBUG级别且不过滤模块)下只需判断是否设置了日志回调
+ */
+#define CORE_LOG_ENABLED(code) \
+    (g_logcb_handler != NULL && \
+     ((g_logcb_level == AIOT_STATE_LOGLEVEL_DEBUG && g_logcb_mask == AIOT_STATE_LOGMASK_ALL) || core_log_check(code)))
+
 void core_log_set_timestamp(aiot_sysdep_portfile_t *sysdep, uint64_t timestamp);
 uint64_t core_log_get_timestamp(aiot_sysdep_portfile_t *sysdep);
-void core_log(aiot_sysdep_portfile_t *sysdep, int32_t code, char *data);
-void core_log1(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data);
-void core_log2(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2);
-void core_log3(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2, void *data3);
-void core_log4(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2, void *data3, void *data4);
-void core_log_hexdump(int32_t code, char prefix, uint8_t *buffer, uint32_t len);
+uint8_t core_log_check(int32_t code);
+int32_t core_log_set_buffer(uint32_t size);
+int32_t core_log_drain(void);
+uint32_t core_log_dropped(void);
+void core_log_print(aiot_sysdep_portfile_t *sysdep, int32_t code, char *data);
+void core_log_print1(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data);
+void core_log_print2(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2);
+void core_log_print3(aiot_sysdep_portfile_t *sysdep, int32_t code, char *fmt, void *data1, void *data2, void *data3);
+void core_log_print_hexdump(int32_t code, char prefix, uint8_t *buffer, uint32_t len);
 void _core_log_append_date(aiot_sysdep_portfile_t *sysdep, uint64_t timestamp, char *buffer);
 
+/* 编译时定义CORE_LOG_DISABLED可去除全部日志代码 */
+#ifdef CORE_LOG_DISABLED
+#define core_log(sysdep, code, data) \
+    do { (void)(sysdep); (void)(data); } while (0)
+#define core_log1(sysdep, code, fmt, data) \
+    do { (void)(sysdep); (void)(data); } while (0)
+#define core_log2(sysdep, code, fmt, data1, data2) \
+    do { (void)(sysdep); (void)(data1); (void)(data2); } while (0)
+#define core_log3(sysdep, code, fmt, data1, data2, data3) \
+    do { (void)(sysdep); (void)(data1); (void)(data2); (void)(data3); } while (0)
+#define core_log_hexdump(code, prefix, buffer, len) \
+    do { (void)(buffer); (void)(len); } while (0)
+#else
+#define core_log(sysdep, code, data) \
+    do { if (CORE_LOG_ENABLED(code)) { core_log_print(sysdep, code, data); } } while (0)
+#define core_log1(sysdep, code, fmt, data) \
+    do { if (CORE_LOG_ENABLED(code)) { core_log_print1(sysdep, code, fmt, data); } } while (0)
+#define core_log2(sysdep, code, fmt, data1, data2) \
+    do { if (CORE_LOG_ENABLED(code)) { core_log_print2(sysdep, code, fmt, data1, data2); } } while (0)
+#define core_log3(sysdep, code, fmt, data1, data2, data3) \
+    do { if (CORE_LOG_ENABLED(code)) { core_log_print3(sysdep, code, fmt, data1, data2, data3); } } while (0)
+#define core_log_hexdump(code, prefix, buffer, len) \
+    do { if (CORE_LOG_ENABLED(code)) { core_log_print_hexdump(code, prefix, buffer, len); } } while (0)
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,250 @@
+#include "core_md5.h"
+
+/*
+ * 32-bit integer manipulation macros (little endian)
+ */
+#ifndef GET_UINT32_LE
+#define GET_UINT32_LE(n,b,i)                            \
+    do {                                                    \
+        (n) = ( (uint32_t) (b)[(i)    ]       )             \
+              | ( (uint32_t) (b)[(i) + 1] <<  8 )             \
+              | ( (uint32_t) (b)[(i) + 2] << 16 )             \
+              | ( (uint32_t) (b)[(i) + 3] << 24 );            \
+    } while( 0 )
+#endif
+
+#ifndef PUT_UINT32_LE
+#define PUT_UINT32_LE(n,b,i)                                    \
+    do {                                                            \
+        (b)[(i)    ] = (unsigned char) ( ( (n)       ) & 0xFF );    \
+        (b)[(i) + 1] = (unsigned char) ( ( (n) >>  8 ) & 0xFF );    \
+        (b)[(i) + 2] = (unsigned char) ( ( (n) >> 16 ) & 0xFF );    \
+        (b)[(i) + 3] = (unsigned char) ( ( (n) >> 24 ) & 0xFF );    \
+    } while( 0 )
+#endif
+
+static void _core_md5_zeroize(void *v, uint32_t n)
+{
+    volatile unsigned char *p = v;
+    while (n--) {
+        *p++ = 0;
+    }
+}
+
+void core_md5_init(core_md5_context_t *ctx)
+{
+    memset(ctx, 0, sizeof(core_md5_context_t));
+}
+
+void core_md5_free(core_md5_context_t *ctx)
+{
+    if (NULL == ctx) {
+        return;
+    }
+
+    _core_md5_zeroize(ctx, sizeof(core_md5_context_t));
+}
+
+void core_md5_starts(core_md5_context_t *ctx)
+{
+    ctx->total[0] = 0;
+    ctx->total[1] = 0;
+
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xEFCDAB89;
+    ctx->state[2] = 0x98BADCFE;
+    ctx->state[3] = 0x10325476;
+}
+
+#define MD5_F(x,y,z)    ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x,y,z)    ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x,y,z)    ((x) ^ (y) ^ (z))
+#define MD5_I(x,y,z)    ((y) ^ ((x) | ~(z)))
+#define MD5_ROTL(x,n)   (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define MD5_STEP(f,a,b,c,d,x,s,t)                   \
+    do {                                                \
+        (a) += f((b), (c), (d)) + (x) + (t);            \
+        (a) = MD5_ROTL((a), (s)) + (b);                 \
+    } while( 0 )
+
+/* 按块连续处理, 工作状态在整个循环中保持在局部变量里 */
+static void _core_md5_process(uint32_t state[4], const uint8_t *data, uint32_t blocks)
+{
+    uint32_t X[16], A, B, C, D;
+    for (; blocks > 0; blocks--, data += CORE_MD5_BLOCK_LENGTH) {
+        GET_UINT32_LE(X[ 0], data,  0);
+        GET_UINT32_LE(X[ 1], data,  4);
+        GET_UINT32_LE(X[ 2], data,  8);
+        GET_UINT32_LE(X[ 3], data, 12);
+        GET_UINT32_LE(X[ 4], data, 16);
+        GET_UINT32_LE(X[ 5], data, 20);
+        GET_UINT32_LE(X[ 6], data, 24);
+        GET_UINT32_LE(X[ 7], data, 28);
+        GET_UINT32_LE(X[ 8], data, 32);
+        GET_UINT32_LE(X[ 9], data, 36);
+        GET_UINT32_LE(X[10], data, 40);
+        GET_UINT32_LE(X[11], data, 44);
+        GET_UINT32_LE(X[12], data, 48);
+        GET_UINT32_LE(X[13], data, 52);
+        GET_UINT32_LE(X[14], data, 56);
+        GET_UINT32_LE(X[15], data, 60);
+
+        A = state[0];
+        B = state[1];
+        C = state[2];
+        D = state[3];
+
+        MD5_STEP(MD5_F, A, B, C, D, X[ 0],  7, 0xD76AA478);
+        MD5_STEP(MD5_F, D, A, B, C, X[ 1], 12, 0xE8C7B756);
+        MD5_STEP(MD5_F, C, D, A, B, X[ 2], 17, 0x242070DB);
+        MD5_STEP(MD5_F, B, C, D, A, X[ 3], 22, 0xC1BDCEEE);
+        MD5_STEP(MD5_F, A, B, C, D, X[ 4],  7, 0xF57C0FAF);
+        MD5_STEP(MD5_F, D, A, B, C, X[ 5], 12, 0x4787C62A);
+        MD5_STEP(MD5_F, C, D, A, B, X[ 6], 17, 0xA8304613);
+        MD5_STEP(MD5_F, B, C, D, A, X[ 7], 22, 0xFD469501);
+        MD5_STEP(MD5_F, A, B, C, D, X[ 8],  7, 0x698098D8);
+        MD5_STEP(MD5_F, D, A, B, C, X[ 9], 12, 0x8B44F7AF);
+        MD5_STEP(MD5_F, C, D, A, B, X[10], 17, 0xFFFF5BB1);
+        MD5_STEP(MD5_F, B, C, D, A, X[11], 22, 0x895CD7BE);
+        MD5_STEP(MD5_F, A, B, C, D, X[12],  7, 0x6B901122);
+        MD5_STEP(MD5_F, D, A, B, C, X[13], 12, 0xFD987193);
+        MD5_STEP(MD5_F, C, D, A, B, X[14], 17, 0xA679438E);
+        MD5_STEP(MD5_F, B, C, D, A, X[15], 22, 0x49B40821);
+
+        MD5_STEP(MD5_G, A, B, C, D, X[ 1],  5, 0xF61E2562);
+        MD5_STEP(MD5_G, D, A, B, C, X[ 6],  9, 0xC040B340);
+        MD5_STEP(MD5_G, C, D, A, B, X[11], 14, 0x265E5A51);
+        MD5_STEP(MD5_G, B, C, D, A, X[ 0], 20, 0xE9B6C7AA);
+        MD5_STEP(MD5_G, A, B, C, D, X[ 5],  5, 0xD62F105D);
+        MD5_STEP(MD5_G, D, A, B, C, X[10],  9, 0x02441453);
+        MD5_STEP(MD5_G, C, D, A, B, X[15], 14, 0xD8A1E681);
+        MD5_STEP(MD5_G, B, C, D, A, X[ 4], 20, 0xE7D3FBC8);
+        MD5_STEP(MD5_G, A, B, C, D, X[ 9],  5, 0x21E1CDE6);
+        MD5_STEP(MD5_G, D, A, B, C, X[14],  9, 0xC33707D6);
+        MD5_STEP(MD5_G, C, D, A, B, X[ 3], 14, 0xF4D50D87);
+        MD5_STEP(MD5_G, B, C, D, A, X[ 8], 20, 0x455A14ED);
+        MD5_STEP(MD5_G, A, B, C, D, X[13],  5, 0xA9E3E905);
+        MD5_STEP(MD5_G, D, A, B, C, X[ 2],  9, 0xFCEFA3F8);
+        MD5_STEP(MD5_G, C, D, A, B, X[ 7], 14, 0x676F02D9);
+        MD5_STEP(MD5_G, B, C, D, A, X[12], 20, 0x8D2A4C8A);
+
+        MD5_STEP(MD5_H, A, B, C, D, X[ 5],  4, 0xFFFA3942);
+        MD5_STEP(MD5_H, D, A, B, C, X[ 8], 11, 0x8771F681);
+        MD5_STEP(MD5_H, C, D, A, B, X[11], 16, 0x6D9D6122);
+        MD5_STEP(MD5_H, B, C, D, A, X[14], 23, 0xFDE5380C);
+        MD5_STEP(MD5_H, A, B, C, D, X[ 1],  4, 0xA4BEEA44);
+        MD5_STEP(MD5_H, D, A, B, C, X[ 4], 11, 0x4BDECFA9);
+        MD5_STEP(MD5_H, C, D, A, B, X[ 7], 16, 0xF6BB4B60);
+        MD5_STEP(MD5_H, B, C, D, A, X[10], 23, 0xBEBFBC70);
+        MD5_STEP(MD5_H, A, B, C, D, X[13],  4, 0x289B7EC6);
+        MD5_STEP(MD5_H, D, A, B, C, X[ 0], 11, 0xEAA127FA);
+        MD5_STEP(MD5_H, C, D, A, B, X[ 3], 16, 0xD4EF3085);
+        MD5_STEP(MD5_H, B, C, D, A, X[ 6], 23, 0x04881D05);
+        MD5_STEP(MD5_H, A, B, C, D, X[ 9],  4, 0xD9D4D039);
+        MD5_STEP(MD5_H, D, A, B, C, X[12], 11, 0xE6DB99E5);
+        MD5_STEP(MD5_H, C, D, A, B, X[15], 16, 0x1FA27CF8);
+        MD5_STEP(MD5_H, B, C, D, A, X[ 2], 23, 0xC4AC5665);
+
+        MD5_STEP(MD5_I, A, B, C, D, X[ 0],  6, 0xF4292244);
+        MD5_STEP(MD5_I, D, A, B, C, X[ 7], 10, 0x432AFF97);
+        MD5_STEP(MD5_I, C, D, A, B, X[14], 15, 0xAB9423A7);
+        MD5_STEP(MD5_I, B, C, D, A, X[ 5], 21, 0xFC93A039);
+        MD5_STEP(MD5_I, A, B, C, D, X[12],  6, 0x655B59C3);
+        MD5_STEP(MD5_I, D, A, B, C, X[ 3], 10, 0x8F0CCC92);
+        MD5_STEP(MD5_I, C, D, A, B, X[10], 15, 0xFFEFF47D);
+        MD5_STEP(MD5_I, B, C, D, A, X[ 1], 21, 0x85845DD1);
+        MD5_STEP(MD5_I, A, B, C, D, X[ 8],  6, 0x6FA87E4F);
+        MD5_STEP(MD5_I, D, A, B, C, X[15], 10, 0xFE2CE6E0);
+        MD5_STEP(MD5_I, C, D, A, B, X[ 6], 15, 0xA3014314);
+        MD5_STEP(MD5_I, B, C, D, A, X[13], 21, 0x4E0811A1);
+        MD5_STEP(MD5_I, A, B, C, D, X[ 4],  6, 0xF7537E82);
+        MD5_STEP(MD5_I, D, A, B, C, X[11], 10, 0xBD3AF235);
+        MD5_STEP(MD5_I, C, D, A, B, X[ 2], 15, 0x2AD7D2BB);
+        MD5_STEP(MD5_I, B, C, D, A, X[ 9], 21, 0xEB86D391);
+
+        state[0] += A;
+        state[1] += B;
+        state[2] += C;
+        state[3] += D;
+    }
+}
+
+void core_md5_update(core_md5_context_t *ctx, const unsigned char *input, uint32_t ilen)
+{
+    uint32_t fill;
+    uint32_t left;
+
+    if (ilen == 0) {
+        return;
+    }
+
+    left = ctx->total[0] & 0x3F;
+    fill = 64 - left;
+
+    ctx->total[0] += ilen;
+    if (ctx->total[0] < ilen) {
+        ctx->total[1]++;
+    }
+
+    if (left && ilen >= fill) {
+        memcpy((void *)(ctx->buffer + left), input, fill);
+        _core_md5_process(ctx->state, ctx->buffer, 1);
+        input += fill;
+        ilen  -= fill;
+        left = 0;
+    }
+
+    if (ilen >= 64) {
+        _core_md5_process(ctx->state, input, ilen / 64);
+        input += ilen & ~0x3F;
+        ilen  &= 0x3F;
+    }
+
+    if (ilen > 0) {
+        memcpy((void *)(ctx->buffer + left), input, ilen);
+    }
+}
+
+static const unsigned char md5_padding[64] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+void core_md5_finish(core_md5_context_t *ctx, uint8_t output[16])
+{
+    uint32_t last, padn;
+    uint32_t high, low;
+    unsigned char msglen[8];
+
+    high = (ctx->total[0] >> 29)
+           | (ctx->total[1] <<  3);
+    low  = (ctx->total[0] <<  3);
+
+    PUT_UINT32_LE(low,  msglen, 0);
+    PUT_UINT32_LE(high, msglen, 4);
+
+    last = ctx->total[0] & 0x3F;
+    padn = (last < 56) ? (56 - last) : (120 - last);
+
+    core_md5_update(ctx, md5_padding, padn);
+    core_md5_update(ctx, msglen, 8);
+
+    PUT_UINT32_LE(ctx->state[0], output,  0);
+    PUT_UINT32_LE(ctx->state[1], output,  4);
+    PUT_UINT32_LE(ctx->state[2], output,  8);
+    PUT_UINT32_LE(ctx->state[3], output, 12);
+}
+
+void core_md5(const uint8_t *input, uint32_t ilen, uint8_t output[16])
+{
+    core_md5_context_t ctx;
+
+    core_md5_init(&ctx);
+    core_md5_starts(&ctx);
+    core_md5_update(&ctx, input, ilen);
+    core_md5_finish(&ctx, output);
+    core_md5_free(&ctx);
+}
@@ -0,0 +1,77 @@
+#ifndef _CORE_MD5_H_
+#define _CORE_MD5_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "core_stdinc.h"
+
+#define CORE_MD5_DIGEST_LENGTH               (16)
+#define CORE_MD5_BLOCK_LENGTH                (64)
+
+/**
+ * \brief          MD5 context structure
+ *
+ * \warning        MD5 is considered a weak message digest, it is only used here to verify firmware
+ *                 integrity and for the legacy password format of the XJT platform
+ */
+typedef struct {
+    uint32_t total[2];          /*!< number of bytes processed  */
+    uint32_t state[4];          /*!< intermediate digest state  */
+    unsigned char buffer[64];   /*!< data block being processed */
+} core_md5_context_t;
+
+/**
+ * \brief          Initialize MD5 context
+ *
+ * \param ctx      MD5 context to be initialized
+ */
+void core_md5_init(core_md5_context_t *ctx);
+
+/**
+ * \brief          Clear MD5 context
+ *
+ * \param ctx      MD5 context to be cleared
+ */
+void core_md5_free(core_md5_context_t *ctx);
+
+/**
+ * \brief          MD5 context setup
+ *
+ * \param ctx      context to be initialized
+ */
+void core_md5_starts(core_md5_context_t *ctx);
+
+/**
+ * \brief          MD5 process buffer
+ *
+ * \param ctx      MD5 context
+ * \param input    buffer holding the data
+ * \param ilen     length of the input data
+ */
+void core_md5_update(core_md5_context_t *ctx, const unsigned char *input, uint32_t ilen);
+
+/**
+ * \brief          MD5 final digest
+ *
+ * \param ctx      MD5 context
+ * \param output   MD5 checksum result
+ */
+void core_md5_finish(core_md5_context_t *ctx, uint8_t output[16]);
+
+/**
+ * \brief          Output = MD5( input buffer )
+ *
+ * \param input    buffer holding the data
+ * \param ilen     length of the input data
+ * \param output   MD5 checksum result
+ */
+void core_md5(const uint8_t *input, uint32_t ilen, uint8_t output[16]);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
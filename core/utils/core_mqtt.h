@@ -12,6 +12,9 @@ extern "C" {
 #include "core_auth.h"
 #include "core_global.h"
 #include "core_diag.h"
+#include "core_rand.h"
+#include "core_lock.h"
+#include "core_atomic.h"
 #include "aiot_state_api.h"
 #include "aiot_sysdep_api.h"
 #include "aiot_mqtt_api.h"
@@ -98,6 +101,10 @@ extern "C" {
 /* MQTT 3.1 Publish Packet */
 #define CORE_MQTT_PUBLISH_PKT_TYPE                  (0x30)
 #define CORE_MQTT_PUBLISH_TOPICLEN_LEN              (2)
+/* PUBLISH报文头(含topic)的最大长度, 以及core_mqtt_pub_inplace要求payload之前预留的字节数 */
+#define CORE_MQTT_PUB_HEADER_MAXLEN(topic_len)      (CORE_MQTT_FIXED_HEADER_LEN + CORE_MQTT_REMAINLEN_MAXLEN + \
+        CORE_MQTT_UTF8_STR_EXTRA_LEN + (topic_len) + CORE_MQTT_PACKETID_LEN)
+#define CORE_MQTT_PUB_HEADROOM                      (CORE_MQTT_PUB_HEADER_MAXLEN(CORE_MQTT_TOPIC_MAXLEN))
 
 /* MQTT 3.1 Publish ACK Packet */
 #define CORE_MQTT_PUBACK_PKT_TYPE                   (0x40)
@@ -181,9 +188,11 @@ typedef struct {
     uint8_t enabled;
     uint32_t interval_ms;
     uint64_t last_retry_time;
-    uint8_t  backoff_enabled;         /*enabled backoff algorithm*/
+    uint8_t  backoff;                 /* aiot_mqtt_reconn_backoff_t */
     int32_t  rand_ms;
     int32_t  reconnect_counter;
+    uint32_t max_interval_ms;
+    uint32_t next_interval_ms;        /* exponential backoff: delay before next retry */
 } core_mqtt_reconnect_t;
 
 typedef struct {
@@ -191,6 +200,8 @@ typedef struct {
     uint8_t network_type;       /* 0: TCP, 1: TLS */
     uint64_t connect_timestamp;
     uint32_t connect_time_used;
+    uint32_t prepare_time_used;     /* 签名及CONNECT报文编码耗时, 命中缓存时接近0 */
+    uint32_t connack_time_used;     /* 发出CONNECT到解析完CONNACK的耗时 */
     uint64_t failed_timestamp;
     int32_t failed_error_code;
 
@@ -240,6 +251,8 @@ typedef struct {
     char *clientid;
     char *extend_clientid;
     char *security_mode;
+    uint8_t *conn_pkt;      /* 已编码的CONNECT报文, 重连时直接复用 */
+    uint32_t conn_pkt_len;
     uint16_t keep_alive_s;
     uint8_t clean_session;
     uint8_t append_requestid;
@@ -255,15 +268,16 @@ typedef struct {
     uint8_t disconnected;
     uint8_t disconnect_api_called;
     uint8_t exec_enabled;
-    uint32_t exec_count;
+    core_atomic_u32_t exec_count;
     uint32_t deinit_timeout_ms;
-    uint16_t packet_id;
+    core_atomic_u32_t packet_id;
     void *data_mutex;
     void *send_mutex;
     void *recv_mutex;
-    void *sub_mutex;
+    void *sub_rwlock;       /* sub_list读多写少, 消息分发时只持有读锁 */
     void *pub_mutex;
     void *process_handler_mutex;
+    void *counter_lock;     /* 不支持原子操作时保护exec_count和packet_id */
     struct core_list_head sub_list;
     struct core_list_head pub_list;
     struct core_list_head process_data_list;
@@ -295,6 +309,8 @@ typedef struct {
 #define CORE_MQTT_DEFAULT_RECONN_INTERVAL_MS       (2 * 1000)
 #define CORE_MQTT_DEFAULT_RECONN_RANDLIMIT_MS      (1 * 1000)
 #define CORE_MQTT_DEFAULT_RECONN_MAX_COUNTERS      (60)       /*mqtt 断线重连退避算法的最大计数*/
+#define CORE_MQTT_DEFAULT_RECONN_BACKOFF           (AIOT_MQTT_RECONN_BACKOFF_LINEAR)
+#define CORE_MQTT_DEFAULT_RECONN_MAX_INTERVAL_MS   (60 * 1000)
 #define CORE_MQTT_DEFAULT_DEINIT_TIMEOUT_MS        (2 * 1000)
 
 #define CORE_MQTT_DIAG_TLV_MQTT_CONNECTION         (0x0010)
@@ -314,6 +330,11 @@ int32_t core_mqtt_setopt(void *handle, core_mqtt_option_t option, void *data);
 char *core_mqtt_get_product_key(void *handle);
 char *core_mqtt_get_device_name(void *handle);
 uint16_t core_mqtt_get_port(void *handle);
+/*
+ * 与aiot_mqtt_pub相同, 但payload之前的CORE_MQTT_PUB_HEADROOM字节由调用者预留, 报文头直接写在其中,
+ * payload不再拷贝到新分配的报文中. 这段预留空间的内容会被覆盖
+ */
+int32_t core_mqtt_pub_inplace(void *handle, char *topic, uint8_t *payload, uint32_t payload_len, uint8_t qos);
 int32_t core_mqtt_get_nwkstats(void *handle, core_mqtt_nwkstats_info_t *nwk_stats_info);
 int32_t _core_mqtt_topic_compare(char *topic, uint32_t topic_len, char *cmp_topic, uint32_t cmp_topic_len);
 
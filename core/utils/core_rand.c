@@ -0,0 +1,72 @@
+#include "core_rand.h"
+
+/*
+ * 编译器支持线程局部存储时, 每个线程持有独立的生成器状态, 无需加锁
+ * 不支持时退化为直接调用portfile的随机数接口
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CORE_RAND_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+    #define CORE_RAND_THREAD_LOCAL __declspec(thread)
+#endif
+
+#ifdef CORE_RAND_THREAD_LOCAL
+static CORE_RAND_THREAD_LOCAL core_rand_t g_core_rand;
+static CORE_RAND_THREAD_LOCAL uint8_t g_core_rand_seeded = 0;
+#endif
+
+static uint32_t _core_rand_rotl(uint32_t x, uint32_t k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+void core_rand_seed(aiot_sysdep_portfile_t *sysdep, core_rand_t *state)
+{
+    sysdep->core_sysdep_rand((uint8_t *)state->s, sizeof(state->s));
+
+    /* 全零状态下xoshiro只会输出0 */
+    if ((state->s[0] | state->s[1] | state->s[2] | state->s[3]) == 0) {
+        uint64_t timenow = sysdep->core_sysdep_time();
+        state->s[0] = 0x9E3779B9;
+        state->s[1] = (uint32_t)timenow;
+        state->s[2] = (uint32_t)(timenow >> 32);
+        state->s[3] = (uint32_t)(uintptr_t)state;
+    }
+}
+
+uint32_t core_rand_next(core_rand_t *state)
+{
+    uint32_t result = _core_rand_rotl(state->s[1] * 5, 7) * 9;
+    uint32_t t = state->s[1] << 9;
+
+    state->s[2] ^= state->s[0];
+    state->s[3] ^= state->s[1];
+    state->s[1] ^= state->s[2];
+    state->s[0] ^= state->s[3];
+    state->s[2] ^= t;
+    state->s[3] = _core_rand_rotl(state->s[3], 11);
+
+    return result;
+}
+
+uint32_t core_rand_u32(aiot_sysdep_portfile_t *sysdep)
+{
+#ifdef CORE_RAND_THREAD_LOCAL
+    if (g_core_rand_seeded == 0) {
+        core_rand_seed(sysdep, &g_core_rand);
+        g_core_rand_seeded = 1;
+    }
+    return core_rand_next(&g_core_rand);
+#else
+    uint32_t value = 0;
+    sysdep->core_sysdep_rand((uint8_t *)&value, sizeof(value));
+    return value;
+#endif
+}
+
+uint32_t core_rand_range(aiot_sysdep_portfile_t *sysdep, uint32_t bound)
+{
+    /* 乘法取高位映射到[0, bound), 避免取模运算 */
+    return (uint32_t)(((uint64_t)core_rand_u32(sysdep) * bound) >> 32);
+}
+
@@ -0,0 +1,29 @@
+#ifndef _CORE_RAND_H_
+#define _CORE_RAND_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "core_stdinc.h"
+#include "aiot_sysdep_api.h"
+
+/*
+ * 非密码学用途的快速伪随机数(xoshiro128**), 用于重连抖动、请求ID等场景
+ * 需要不可预测性的场景(TLS、签名随机数等)仍然直接使用portfile中的core_sysdep_rand
+ */
+typedef struct {
+    uint32_t s[4];
+} core_rand_t;
+
+void core_rand_seed(aiot_sysdep_portfile_t *sysdep, core_rand_t *state);
+uint32_t core_rand_next(core_rand_t *state);
+uint32_t core_rand_u32(aiot_sysdep_portfile_t *sysdep);
+uint32_t core_rand_range(aiot_sysdep_portfile_t *sysdep, uint32_t bound);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
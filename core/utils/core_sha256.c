@@ -28,6 +28,34 @@
 #endif
 
 
+/*
+ * 压缩函数有三种实现: 可移植的C实现, x86的SHA扩展指令(SHA-NI)实现, ARMv8的SHA2指令实现
+ * 硬件实现在首次使用时按CPU特性检测结果选择, 定义CORE_SHA256_HW_DISABLED时只编译C实现
+ * ARMv8实现需要工具链以crypto扩展为目标编译(如-march=armv8-a+crypto)
+ */
+#if !defined(CORE_SHA256_HW_DISABLED) && (defined(__GNUC__) || defined(__clang__))
+    #if defined(__x86_64__) || defined(__i386__)
+        #define CORE_SHA256_SHANI
+        #include <immintrin.h>
+        #include <cpuid.h>
+    #elif defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+        #define CORE_SHA256_ARMV8
+        #include <arm_neon.h>
+        #if defined(__linux__)
+            #include <sys/auxv.h>
+            #include <asm/hwcap.h>
+        #endif
+    #endif
+#endif
+
+/* 多路计算使用GCC/Clang的向量扩展, 在x86上编译为SSE2指令, 在ARM上编译为NEON指令 */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CORE_SHA256_VECTOR
+    typedef uint32_t core_sha256_vec_t __attribute__((vector_size(16)));
+#endif
+
+typedef void (*core_sha256_process_func_t)(uint32_t state[8], const uint8_t *data, uint32_t blocks);
+
 static void utils_sha256_zeroize(void *v, uint32_t n)
 {
     volatile unsigned char *p = v;
@@ -115,68 +143,289 @@ static const uint32_t K[] = {
         d += temp1; h = temp1 + temp2;              \
     }
 
-void core_sha256_process(core_sha256_context_t *ctx, const unsigned char data[64])
+static void _core_sha256_process_c(uint32_t state[8], const uint8_t *data, uint32_t blocks)
 {
     uint32_t temp1, temp2, W[64];
     uint32_t A[8];
     unsigned int i;
 
-    for (i = 0; i < 8; i++) {
-        A[i] = ctx->state[i];
-    }
+    for (; blocks > 0; blocks--, data += CORE_SHA256_BLOCK_LENGTH) {
+        for (i = 0; i < 8; i++) {
+            A[i] = state[i];
+        }
 
 #if defined(MINI_SHA256_SMALLER)
-    for (i = 0; i < 64; i++) {
-        if (i < 16) {
+        for (i = 0; i < 64; i++) {
+            if (i < 16) {
+                GET_UINT32_BE(W[i], data, 4 * i);
+            } else {
+                R(i);
+            }
+
+            P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], W[i], K[i]);
+
+            temp1 = A[7];
+            A[7] = A[6];
+            A[6] = A[5];
+            A[5] = A[4];
+            A[4] = A[3];
+            A[3] = A[2];
+            A[2] = A[1];
+            A[1] = A[0];
+            A[0] = temp1;
+        }
+#else /* MINI_SHA256_SMALLER */
+        for (i = 0; i < 16; i++) {
             GET_UINT32_BE(W[i], data, 4 * i);
-        } else {
-            R(i);
         }
 
-        P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], W[i], K[i]);
-
-        temp1 = A[7];
-        A[7] = A[6];
-        A[6] = A[5];
-        A[5] = A[4];
-        A[4] = A[3];
-        A[3] = A[2];
-        A[2] = A[1];
-        A[1] = A[0];
-        A[0] = temp1;
+        for (i = 0; i < 16; i += 8) {
+            P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], W[i + 0], K[i + 0]);
+            P(A[7], A[0], A[1], A[2], A[3], A[4], A[5], A[6], W[i + 1], K[i + 1]);
+            P(A[6], A[7], A[0], A[1], A[2], A[3], A[4], A[5], W[i + 2], K[i + 2]);
+            P(A[5], A[6], A[7], A[0], A[1], A[2], A[3], A[4], W[i + 3], K[i + 3]);
+            P(A[4], A[5], A[6], A[7], A[0], A[1], A[2], A[3], W[i + 4], K[i + 4]);
+            P(A[3], A[4], A[5], A[6], A[7], A[0], A[1], A[2], W[i + 5], K[i + 5]);
+            P(A[2], A[3], A[4], A[5], A[6], A[7], A[0], A[1], W[i + 6], K[i + 6]);
+            P(A[1], A[2], A[3], A[4], A[5], A[6], A[7], A[0], W[i + 7], K[i + 7]);
+        }
+
+        for (i = 16; i < 64; i += 8) {
+            P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], R(i + 0), K[i + 0]);
+            P(A[7], A[0], A[1], A[2], A[3], A[4], A[5], A[6], R(i + 1), K[i + 1]);
+            P(A[6], A[7], A[0], A[1], A[2], A[3], A[4], A[5], R(i + 2), K[i + 2]);
+            P(A[5], A[6], A[7], A[0], A[1], A[2], A[3], A[4], R(i + 3), K[i + 3]);
+            P(A[4], A[5], A[6], A[7], A[0], A[1], A[2], A[3], R(i + 4), K[i + 4]);
+            P(A[3], A[4], A[5], A[6], A[7], A[0], A[1], A[2], R(i + 5), K[i + 5]);
+            P(A[2], A[3], A[4], A[5], A[6], A[7], A[0], A[1], R(i + 6), K[i + 6]);
+            P(A[1], A[2], A[3], A[4], A[5], A[6], A[7], A[0], R(i + 7), K[i + 7]);
+        }
+#endif /* MINI_SHA256_SMALLER */
+
+        for (i = 0; i < 8; i++) {
+            state[i] += A[i];
+        }
     }
-#else /* MINI_SHA256_SMALLER */
-    for (i = 0; i < 16; i++) {
-        GET_UINT32_BE(W[i], data, 4 * i);
+}
+
+#if defined(CORE_SHA256_SHANI)
+/* 每条sha256rnds2指令完成两轮, 状态按ABEF/CDGH两组存放在寄存器中 */
+__attribute__((target("sha,sse4.1")))
+static void _core_sha256_process_shani(uint32_t state[8], const uint8_t *data, uint32_t blocks)
+{
+    const __m128i shuf_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, msg, tmp, msg0, msg1, msg2, msg3, abef_save, cdgh_save;
+
+    tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+    state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             /* CDAB */
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       /* EFGH */
+    state0 = _mm_alignr_epi8(tmp, state1, 8);       /* ABEF */
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    /* CDGH */
+
+#define CORE_SHA256_SHANI_ROUNDS(m, k)                                      \
+    do {                                                                    \
+        msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *)&K[k]));    \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                \
+        msg = _mm_shuffle_epi32(msg, 0x0E);                                 \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);                \
+    } while (0)
+
+/* m0 = sha256msg2(sha256msg1(m0, m1) + alignr(m3, m2), m3) */
+#define CORE_SHA256_SHANI_SCHEDULE(m0, m1, m2, m3)                          \
+    do {                                                                    \
+        m0 = _mm_sha256msg1_epu32(m0, m1);                                  \
+        m0 = _mm_add_epi32(m0, _mm_alignr_epi8(m3, m2, 4));                 \
+        m0 = _mm_sha256msg2_epu32(m0, m3);                                  \
+    } while (0)
+
+    for (; blocks > 0; blocks--, data += CORE_SHA256_BLOCK_LENGTH) {
+        uint32_t k = 0;
+
+        abef_save = state0;
+        cdgh_save = state1;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 0)), shuf_mask);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), shuf_mask);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), shuf_mask);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), shuf_mask);
+
+        CORE_SHA256_SHANI_ROUNDS(msg0, 0);
+        CORE_SHA256_SHANI_ROUNDS(msg1, 4);
+        CORE_SHA256_SHANI_ROUNDS(msg2, 8);
+        CORE_SHA256_SHANI_ROUNDS(msg3, 12);
+        for (k = 16; k < 64; k += 16) {
+            CORE_SHA256_SHANI_SCHEDULE(msg0, msg1, msg2, msg3);
+            CORE_SHA256_SHANI_ROUNDS(msg0, k);
+            CORE_SHA256_SHANI_SCHEDULE(msg1, msg2, msg3, msg0);
+            CORE_SHA256_SHANI_ROUNDS(msg1, k + 4);
+            CORE_SHA256_SHANI_SCHEDULE(msg2, msg3, msg0, msg1);
+            CORE_SHA256_SHANI_ROUNDS(msg2, k + 8);
+            CORE_SHA256_SHANI_SCHEDULE(msg3, msg0, msg1, msg2);
+            CORE_SHA256_SHANI_ROUNDS(msg3, k + 12);
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+#undef CORE_SHA256_SHANI_ROUNDS
+#undef CORE_SHA256_SHANI_SCHEDULE
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          /* FEBA */
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       /* DCHG */
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    /* DCBA */
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       /* HGFE */
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+static uint8_t _core_sha256_hw_supported(void)
+{
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    /* SSSE3(pshufb)和SSE4.1(pblendw)是SHA-NI实现中数据重排所需要的 */
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & (1 << 9)) == 0 || (ecx & (1 << 19)) == 0) {
+        return 0;
+    }
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return 0;
     }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
 
-    for (i = 0; i < 16; i += 8) {
-        P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], W[i + 0], K[i + 0]);
-        P(A[7], A[0], A[1], A[2], A[3], A[4], A[5], A[6], W[i + 1], K[i + 1]);
-        P(A[6], A[7], A[0], A[1], A[2], A[3], A[4], A[5], W[i + 2], K[i + 2]);
-        P(A[5], A[6], A[7], A[0], A[1], A[2], A[3], A[4], W[i + 3], K[i + 3]);
-        P(A[4], A[5], A[6], A[7], A[0], A[1], A[2], A[3], W[i + 4], K[i + 4]);
-        P(A[3], A[4], A[5], A[6], A[7], A[0], A[1], A[2], W[i + 5], K[i + 5]);
-        P(A[2], A[3], A[4], A[5], A[6], A[7], A[0], A[1], W[i + 6], K[i + 6]);
-        P(A[1], A[2], A[3], A[4], A[5], A[6], A[7], A[0], W[i + 7], K[i + 7]);
+    return ((ebx & (1 << 29)) != 0) ? 1 : 0;
+}
+
+#define CORE_SHA256_HW_NAME         "sha-ni"
+#define _core_sha256_process_hw     _core_sha256_process_shani
+#elif defined(CORE_SHA256_ARMV8)
+static void _core_sha256_process_armv8(uint32_t state[8], const uint8_t *data, uint32_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]), state1 = vld1q_u32(&state[4]);
+    uint32x4_t abcd_save, efgh_save, msg0, msg1, msg2, msg3, tmp0, tmp2;
+
+#define CORE_SHA256_ARMV8_ROUNDS(m, k)                                      \
+    do {                                                                    \
+        tmp0 = vaddq_u32(m, vld1q_u32(&K[k]));                              \
+        tmp2 = state0;                                                      \
+        state0 = vsha256hq_u32(state0, state1, tmp0);                       \
+        state1 = vsha256h2q_u32(state1, tmp2, tmp0);                        \
+    } while (0)
+
+    for (; blocks > 0; blocks--, data += CORE_SHA256_BLOCK_LENGTH) {
+        uint32_t k = 0;
+
+        abcd_save = state0;
+        efgh_save = state1;
+
+        msg0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 0)));
+        msg1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+        msg2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+        msg3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+        for (k = 0; k < 48; k += 16) {
+            CORE_SHA256_ARMV8_ROUNDS(msg0, k);
+            msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
+            CORE_SHA256_ARMV8_ROUNDS(msg1, k + 4);
+            msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
+            CORE_SHA256_ARMV8_ROUNDS(msg2, k + 8);
+            msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
+            CORE_SHA256_ARMV8_ROUNDS(msg3, k + 12);
+            msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
+        }
+        CORE_SHA256_ARMV8_ROUNDS(msg0, 48);
+        CORE_SHA256_ARMV8_ROUNDS(msg1, 52);
+        CORE_SHA256_ARMV8_ROUNDS(msg2, 56);
+        CORE_SHA256_ARMV8_ROUNDS(msg3, 60);
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
     }
 
-    for (i = 16; i < 64; i += 8) {
-        P(A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7], R(i + 0), K[i + 0]);
-        P(A[7], A[0], A[1], A[2], A[3], A[4], A[5], A[6], R(i + 1), K[i + 1]);
-        P(A[6], A[7], A[0], A[1], A[2], A[3], A[4], A[5], R(i + 2), K[i + 2]);
-        P(A[5], A[6], A[7], A[0], A[1], A[2], A[3], A[4], R(i + 3), K[i + 3]);
-        P(A[4], A[5], A[6], A[7], A[0], A[1], A[2], A[3], R(i + 4), K[i + 4]);
-        P(A[3], A[4], A[5], A[6], A[7], A[0], A[1], A[2], R(i + 5), K[i + 5]);
-        P(A[2], A[3], A[4], A[5], A[6], A[7], A[0], A[1], R(i + 6), K[i + 6]);
-        P(A[1], A[2], A[3], A[4], A[5], A[6], A[7], A[0], R(i + 7), K[i + 7]);
+#undef CORE_SHA256_ARMV8_ROUNDS
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+
+static uint8_t _core_sha256_hw_supported(void)
+{
+#if defined(__linux__) && defined(HWCAP_SHA2)
+    return ((getauxval(AT_HWCAP) & HWCAP_SHA2) != 0) ? 1 : 0;
+#else
+    /* 非Linux平台无法在运行时查询, 以编译目标为准 */
+    return 1;
+#endif
+}
+
+#define CORE_SHA256_HW_NAME         "armv8"
+#define _core_sha256_process_hw     _core_sha256_process_armv8
+#endif
+
+/* 首次使用时选择实现, 并发初始化时各线程写入的是同一个值 */
+static core_sha256_process_func_t g_core_sha256_process = NULL;
+
+static core_sha256_process_func_t _core_sha256_process_func(void)
+{
+    core_sha256_process_func_t func = g_core_sha256_process;
+
+    if (func == NULL) {
+        func = _core_sha256_process_c;
+#if defined(CORE_SHA256_HW_NAME)
+        if (_core_sha256_hw_supported()) {
+            func = _core_sha256_process_hw;
+        }
+#endif
+        g_core_sha256_process = func;
     }
-#endif /* MINI_SHA256_SMALLER */
 
-    for (i = 0; i < 8; i++) {
-        ctx->state[i] += A[i];
+    return func;
+}
+
+int32_t core_sha256_set_impl(core_sha256_impl_t impl)
+{
+    switch (impl) {
+        case CORE_SHA256_IMPL_AUTO: {
+            g_core_sha256_process = NULL;
+        }
+        break;
+        case CORE_SHA256_IMPL_C: {
+            g_core_sha256_process = _core_sha256_process_c;
+        }
+        break;
+        case CORE_SHA256_IMPL_HW: {
+#if defined(CORE_SHA256_HW_NAME)
+            if (_core_sha256_hw_supported()) {
+                g_core_sha256_process = _core_sha256_process_hw;
+                break;
+            }
+#endif
+            return STATE_USER_INPUT_OUT_RANGE;
+        }
+        break;
+        default: {
+            return STATE_USER_INPUT_OUT_RANGE;
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+const char *core_sha256_impl_name(void)
+{
+#if defined(CORE_SHA256_HW_NAME)
+    if (_core_sha256_process_func() == _core_sha256_process_hw) {
+        return CORE_SHA256_HW_NAME;
     }
+#endif
+    return "c";
 }
+
+void core_sha256_process(core_sha256_context_t *ctx, const unsigned char data[64])
+{
+    _core_sha256_process_func()(ctx->state, data, 1);
+}
+
 void core_sha256_update(core_sha256_context_t *ctx, const unsigned char *input, uint32_t ilen)
 {
     size_t fill;
@@ -204,10 +453,10 @@ void core_sha256_update(core_sha256_context_t *ctx, const unsigned char *input,
         left = 0;
     }
 
-    while (ilen >= 64) {
-        core_sha256_process(ctx, input);
-        input += 64;
-        ilen  -= 64;
+    if (ilen >= 64) {
+        _core_sha256_process_func()(ctx->state, input, ilen / 64);
+        input += ilen & ~0x3F;
+        ilen  &= 0x3F;
     }
 
     if (ilen > 0) {
@@ -270,14 +519,18 @@ void core_hmac_sha256(const uint8_t *msg, uint32_t msg_len, const uint8_t *key,
     core_sha256_context_t context;
     uint8_t k_ipad[SHA256_KEY_IOPAD_SIZE];    /* inner padding - key XORd with ipad  */
     uint8_t k_opad[SHA256_KEY_IOPAD_SIZE];    /* outer padding - key XORd with opad */
+    uint8_t key_hash[SHA256_DIGEST_SIZE];
     int32_t i;
 
     if ((NULL == msg) || (NULL == key) || (NULL == output)) {
         return;
     }
 
+    /* 超过一个块的密钥先计算SHA-256, 用摘要作为密钥(RFC 2104) */
     if (key_len > SHA256_KEY_IOPAD_SIZE) {
-        return;
+        core_sha256(key, key_len, key_hash);
+        key = key_hash;
+        key_len = SHA256_DIGEST_SIZE;
     }
 
     /* start out by storing key in pads */
@@ -307,3 +560,204 @@ void core_hmac_sha256(const uint8_t *msg, uint32_t msg_len, const uint8_t *key,
     core_sha256_finish(&context, output);                       /* finish up 2nd pass */
 }
 
+/*
+ * 多路计算中的一路: 可选的一个前缀块(HMAC的k_ipad/k_opad)加上消息, 以及由消息尾部和填充组成的1~2个块
+ */
+typedef struct {
+    const uint8_t *prefix;
+    const uint8_t *input;
+    uint32_t full_blocks;
+    uint32_t blocks;
+    uint8_t tail[2 * CORE_SHA256_BLOCK_LENGTH];
+} core_sha256_lane_t;
+
+static void _core_sha256_lane_init(core_sha256_lane_t *lane, const uint8_t *prefix, const uint8_t *input,
+                                   uint32_t ilen)
+{
+    uint32_t rem = ilen & 0x3F, tail_blocks = (rem < CORE_SHA256_SHORT_BLOCK_LENGTH) ? 1 : 2;
+    uint64_t bits = ((uint64_t)ilen + ((prefix != NULL) ? CORE_SHA256_BLOCK_LENGTH : 0)) << 3;
+
+    lane->prefix = prefix;
+    lane->input = input;
+    lane->full_blocks = ilen / CORE_SHA256_BLOCK_LENGTH;
+    lane->blocks = ((prefix != NULL) ? 1 : 0) + lane->full_blocks + tail_blocks;
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    memcpy(lane->tail, input + (ilen - rem), rem);
+    lane->tail[rem] = 0x80;
+    PUT_UINT32_BE((uint32_t)(bits >> 32), lane->tail, tail_blocks * CORE_SHA256_BLOCK_LENGTH - 8);
+    PUT_UINT32_BE((uint32_t)bits, lane->tail, tail_blocks * CORE_SHA256_BLOCK_LENGTH - 4);
+}
+
+static const uint8_t *_core_sha256_lane_block(core_sha256_lane_t *lane, uint32_t block)
+{
+    if (lane->prefix != NULL) {
+        if (block == 0) {
+            return lane->prefix;
+        }
+        block--;
+    }
+    if (block < lane->full_blocks) {
+        return lane->input + block * CORE_SHA256_BLOCK_LENGTH;
+    }
+    return lane->tail + (block - lane->full_blocks) * CORE_SHA256_BLOCK_LENGTH;
+}
+
+#if defined(CORE_SHA256_VECTOR)
+#define VSHR(x,n)   ((x) >> (n))
+#define VROTR(x,n)  (((x) >> (n)) | ((x) << (32 - (n))))
+#define VS0(x)      (VROTR(x, 7) ^ VROTR(x,18) ^ VSHR(x, 3))
+#define VS1(x)      (VROTR(x,17) ^ VROTR(x,19) ^ VSHR(x,10))
+#define VS2(x)      (VROTR(x, 2) ^ VROTR(x,13) ^ VROTR(x,22))
+#define VS3(x)      (VROTR(x, 6) ^ VROTR(x,11) ^ VROTR(x,25))
+
+/* 最多CORE_SHA256_LANES路消息的压缩函数同时按列计算, 已经结束的路通过掩码保持状态不变 */
+static void _core_sha256_multi_vector(core_sha256_lane_t lane[], uint32_t num, uint8_t output[][32])
+{
+    static const uint8_t zero_block[CORE_SHA256_BLOCK_LENGTH] = {0};
+    core_sha256_vec_t state[8], A[8], W[16], mask, temp1, temp2;
+    const uint8_t *data[CORE_SHA256_LANES];
+    uint32_t blocks = 0, block = 0, i = 0, l = 0, w = 0;
+
+    for (i = 0; i < 8; i++) {
+        state[i] = (core_sha256_vec_t) {
+            0, 0, 0, 0
+        };
+    }
+    for (l = 0; l < num; l++) {
+        core_sha256_context_t ctx;
+        core_sha256_starts(&ctx);
+        for (i = 0; i < 8; i++) {
+            state[i][l] = ctx.state[i];
+        }
+        if (lane[l].blocks > blocks) {
+            blocks = lane[l].blocks;
+        }
+    }
+
+    for (block = 0; block < blocks; block++) {
+        for (l = 0; l < CORE_SHA256_LANES; l++) {
+            data[l] = (l < num && block < lane[l].blocks) ? _core_sha256_lane_block(&lane[l], block) : zero_block;
+            mask[l] = (l < num && block < lane[l].blocks) ? 0xFFFFFFFF : 0;
+        }
+        for (i = 0; i < 16; i++) {
+            for (l = 0; l < CORE_SHA256_LANES; l++) {
+                GET_UINT32_BE(w, data[l], 4 * i);
+                W[i][l] = w;
+            }
+        }
+        for (i = 0; i < 8; i++) {
+            A[i] = state[i];
+        }
+
+        for (i = 0; i < 64; i++) {
+            if (i >= 16) {
+                W[i & 15] += VS1(W[(i - 2) & 15]) + W[(i - 7) & 15] + VS0(W[(i - 15) & 15]);
+            }
+            temp1 = A[7] + VS3(A[4]) + (A[6] ^ (A[4] & (A[5] ^ A[6]))) + K[i] + W[i & 15];
+            temp2 = VS2(A[0]) + ((A[0] & A[1]) | (A[2] & (A[0] | A[1])));
+            A[7] = A[6];
+            A[6] = A[5];
+            A[5] = A[4];
+            A[4] = A[3] + temp1;
+            A[3] = A[2];
+            A[2] = A[1];
+            A[1] = A[0];
+            A[0] = temp1 + temp2;
+        }
+
+        for (i = 0; i < 8; i++) {
+            state[i] += A[i] & mask;
+        }
+    }
+
+    for (l = 0; l < num; l++) {
+        for (i = 0; i < 8; i++) {
+            PUT_UINT32_BE(state[i][l], output[l], 4 * i);
+        }
+    }
+}
+#endif
+
+/* 硬件实现逐路计算已经快于多路向量计算, 只有C实现时才使用向量计算 */
+static void _core_sha256_multi_lanes(core_sha256_lane_t lane[], uint32_t num, uint8_t output[][32])
+{
+    core_sha256_process_func_t func = _core_sha256_process_func();
+    core_sha256_context_t ctx;
+    uint32_t block = 0, l = 0;
+
+#if defined(CORE_SHA256_VECTOR)
+    if (func == _core_sha256_process_c && num > 1) {
+        _core_sha256_multi_vector(lane, num, output);
+        return;
+    }
+#endif
+
+    for (l = 0; l < num; l++) {
+        core_sha256_starts(&ctx);
+        if (lane[l].prefix != NULL) {
+            func(ctx.state, lane[l].prefix, 1);
+        }
+        func(ctx.state, lane[l].input, lane[l].full_blocks);
+        block = lane[l].blocks - lane[l].full_blocks - ((lane[l].prefix != NULL) ? 1 : 0);
+        func(ctx.state, lane[l].tail, block);
+        for (block = 0; block < 8; block++) {
+            PUT_UINT32_BE(ctx.state[block], output[l], 4 * block);
+        }
+    }
+}
+
+void core_sha256_multi(const uint8_t *input[], const uint32_t ilen[], uint8_t output[][32], uint32_t num)
+{
+    core_sha256_lane_t lane[CORE_SHA256_LANES];
+    uint32_t idx = 0, l = 0, group = 0;
+
+    for (idx = 0; idx < num; idx += group) {
+        group = (num - idx > CORE_SHA256_LANES) ? CORE_SHA256_LANES : (num - idx);
+        for (l = 0; l < group; l++) {
+            _core_sha256_lane_init(&lane[l], NULL, input[idx + l], ilen[idx + l]);
+        }
+        _core_sha256_multi_lanes(lane, group, &output[idx]);
+    }
+}
+
+void core_hmac_sha256_multi(const uint8_t *msg[], const uint32_t msg_len[], const uint8_t *key[],
+                            const uint32_t key_len[], uint8_t output[][32], uint32_t num)
+{
+    core_sha256_lane_t lane[CORE_SHA256_LANES];
+    uint8_t k_ipad[CORE_SHA256_LANES][SHA256_KEY_IOPAD_SIZE];
+    uint8_t k_opad[CORE_SHA256_LANES][SHA256_KEY_IOPAD_SIZE];
+    uint8_t inner[CORE_SHA256_LANES][SHA256_DIGEST_SIZE];
+    uint8_t key_hash[SHA256_DIGEST_SIZE];
+    const uint8_t *inner_ptr[CORE_SHA256_LANES];
+    uint32_t idx = 0, l = 0, i = 0, group = 0;
+
+    for (idx = 0; idx < num; idx += group) {
+        group = (num - idx > CORE_SHA256_LANES) ? CORE_SHA256_LANES : (num - idx);
+        for (l = 0; l < group; l++) {
+            memset(k_ipad[l], 0, SHA256_KEY_IOPAD_SIZE);
+            memset(k_opad[l], 0, SHA256_KEY_IOPAD_SIZE);
+            /* 与core_hmac_sha256一样, 超过一个块的密钥先计算SHA-256 */
+            if (key_len[idx + l] > SHA256_KEY_IOPAD_SIZE) {
+                core_sha256(key[idx + l], key_len[idx + l], key_hash);
+                memcpy(k_ipad[l], key_hash, SHA256_DIGEST_SIZE);
+                memcpy(k_opad[l], key_hash, SHA256_DIGEST_SIZE);
+            } else {
+                memcpy(k_ipad[l], key[idx + l], key_len[idx + l]);
+                memcpy(k_opad[l], key[idx + l], key_len[idx + l]);
+            }
+            for (i = 0; i < SHA256_KEY_IOPAD_SIZE; i++) {
+                k_ipad[l][i] ^= 0x36;
+                k_opad[l][i] ^= 0x5c;
+            }
+            _core_sha256_lane_init(&lane[l], k_ipad[l], msg[idx + l], msg_len[idx + l]);
+        }
+        _core_sha256_multi_lanes(lane, group, inner);
+
+        for (l = 0; l < group; l++) {
+            inner_ptr[l] = inner[l];
+            _core_sha256_lane_init(&lane[l], k_opad[l], inner_ptr[l], SHA256_DIGEST_SIZE);
+        }
+        _core_sha256_multi_lanes(lane, group, &output[idx]);
+    }
+}
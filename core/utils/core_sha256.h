@@ -6,12 +6,25 @@ extern "C" {
 #endif
 
 #include "core_stdinc.h"
+#include "aiot_state_api.h"
 
 #define CORE_SHA256_DIGEST_LENGTH            (32)
 #define CORE_SHA256_BLOCK_LENGTH             (64)
 #define CORE_SHA256_SHORT_BLOCK_LENGTH       (CORE_SHA256_BLOCK_LENGTH - 8)
 #define CORE_SHA256_DIGEST_STRING_LENGTH     (CORE_SHA256_DIGEST_LENGTH * 2 + 1)
 
+/* 多路计算时每组同时处理的消息数量 */
+#define CORE_SHA256_LANES                    (4)
+
+/**
+ * \brief          压缩函数的实现方式
+ */
+typedef enum {
+    CORE_SHA256_IMPL_AUTO,      /*!< 按CPU特性自动选择, 默认值 */
+    CORE_SHA256_IMPL_C,         /*!< 可移植的C实现 */
+    CORE_SHA256_IMPL_HW,        /*!< SHA-NI或ARMv8 SHA2指令实现 */
+} core_sha256_impl_t;
+
 /**
  * \brief          SHA-256 context structure
  */
@@ -73,8 +86,37 @@ void core_sha256_process(core_sha256_context_t *ctx, const unsigned char data[64
  */
 void core_sha256(const uint8_t *input, uint32_t ilen, uint8_t output[32]);
 
+/**
+ * \brief          output = HMAC-SHA-256( key, msg ), 超过一个块的密钥先计算SHA-256, 用摘要作为密钥(RFC 2104)
+ */
 void core_hmac_sha256(const uint8_t *msg, uint32_t msg_len, const uint8_t *key, uint32_t key_len, uint8_t output[32]);
 
+/**
+ * \brief          output[i] = SHA-256( input[i] ), 0 <= i < num
+ *
+ * \details        每CORE_SHA256_LANES条消息为一组同时计算, 只有C实现可用时使用SIMD按列计算,
+ *                 有硬件实现时逐条计算
+ */
+void core_sha256_multi(const uint8_t *input[], const uint32_t ilen[], uint8_t output[][32], uint32_t num);
+
+/**
+ * \brief          output[i] = HMAC-SHA-256( key[i], msg[i] ), 0 <= i < num, 用于批量计算子设备签名
+ */
+void core_hmac_sha256_multi(const uint8_t *msg[], const uint32_t msg_len[], const uint8_t *key[],
+                            const uint32_t key_len[], uint8_t output[][32], uint32_t num);
+
+/**
+ * \brief          指定压缩函数的实现方式, 主要用于测试和性能对比
+ *
+ * \return         STATE_SUCCESS, 或当前CPU不支持硬件实现时返回STATE_USER_INPUT_OUT_RANGE
+ */
+int32_t core_sha256_set_impl(core_sha256_impl_t impl);
+
+/**
+ * \brief          当前使用的实现名称: "c", "sha-ni"或"armv8"
+ */
+const char *core_sha256_impl_name(void);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -32,21 +32,69 @@ int32_t core_str2uint64(char *input, uint8_t input_len, uint64_t *output)
     return STATE_SUCCESS;
 }
 
-int32_t core_uint2str(uint32_t input, char *output, uint8_t *output_len)
+/* "00"~"99"的两位数字表, 整数转字符串时每次除以100, 一次写入两位 */
+static const char g_core_string_digits[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static uint8_t _core_uint_digits(uint32_t input)
 {
-    uint8_t i = 0, j = 0;
-    char temp[10] = {0};
+    uint8_t digits = 1;
 
-    do {
-        temp[i++] = input % 10 + '0';
-    } while ((input /= 10) > 0);
+    while (input >= 10000) {
+        input /= 10000;
+        digits += 4;
+    }
+    if (input >= 1000) {
+        return digits + 3;
+    }
+    if (input >= 100) {
+        return digits + 2;
+    }
+    if (input >= 10) {
+        return digits + 1;
+    }
+    return digits;
+}
 
-    do {
-        output[--i] = temp[j++];
-    } while (i > 0);
+/* 从output + digits处向前写入input的十进制表示 */
+static void _core_uint_write(uint32_t input, char *output, uint8_t digits)
+{
+    char *pos = output + digits;
+    uint32_t idx = 0;
+
+    while (input >= 100) {
+        idx = (input % 100) * 2;
+        input /= 100;
+        *--pos = g_core_string_digits[idx + 1];
+        *--pos = g_core_string_digits[idx];
+    }
+    if (input >= 10) {
+        idx = input * 2;
+        *--pos = g_core_string_digits[idx + 1];
+        *--pos = g_core_string_digits[idx];
+    } else {
+        *--pos = (char)('0' + input);
+    }
+}
+
+int32_t core_uint2str(uint32_t input, char *output, uint8_t *output_len)
+{
+    uint8_t digits = _core_uint_digits(input);
+
+    _core_uint_write(input, output, digits);
 
     if (output_len) {
-        *output_len = j;
+        *output_len = digits;
     }
 
     return STATE_SUCCESS;
@@ -86,19 +134,25 @@ int32_t core_int2hexstr(int32_t input, char *output, uint8_t *output_len)
 
 int32_t core_uint642str(uint64_t input, char *output, uint8_t *output_len)
 {
-    uint8_t i = 0, j = 0;
-    char temp[20] = {0};
+    uint32_t part[3] = {0};
+    uint8_t part_num = 0, digits = 0, idx = 0;
 
-    do {
-        temp[i++] = input % 10 + '0';
-    } while ((input /= 10) > 0);
+    /* 按10^8拆成最多3段, 只有拆分时用到64位除法, 每段内部都是32位运算 */
+    while (input > 0xFFFFFFFF) {
+        part[part_num++] = (uint32_t)(input % 100000000);
+        input /= 100000000;
+    }
 
-    do {
-        output[--i] = temp[j++];
-    } while (i > 0);
+    digits = _core_uint_digits((uint32_t)input);
+    _core_uint_write((uint32_t)input, output, digits);
+    for (idx = part_num; idx > 0; idx--) {
+        _core_uint_write(part[idx - 1], output + digits, 8);
+        memset(output + digits, '0', 8 - _core_uint_digits(part[idx - 1]));
+        digits += 8;
+    }
 
     if (output_len) {
-        *output_len = j;
+        *output_len = digits;
     }
 
     return STATE_SUCCESS;
@@ -106,48 +160,58 @@ int32_t core_uint642str(uint64_t input, char *output, uint8_t *output_len)
 
 int32_t core_int2str(int32_t input, char *output, uint8_t *output_len)
 {
-    uint8_t i = 0, j = 0, minus = 0;
-    char temp[11] = {0};
-    int64_t in = input;
+    uint32_t magnitude = (uint32_t)input;
+    uint8_t minus = 0, digits = 0;
 
-    if (in < 0) {
+    if (input < 0) {
         minus = 1;
-        in = -in;
-    }
-
-    do {
-        temp[minus + (i++)] = in % 10 + '0';
-    } while ((in /= 10) > 0);
-
-    do {
-        output[minus + (--i)] = temp[minus + (j++)];
-    } while (i > 0);
-
-    if (minus == 1) {
+        magnitude = 0U - magnitude;
         output[0] = '-';
     }
 
+    digits = _core_uint_digits(magnitude);
+    _core_uint_write(magnitude, output + minus, digits);
+
     if (output_len) {
-        *output_len = j + minus;
+        *output_len = digits + minus;
     }
 
     return STATE_SUCCESS;
 }
 
+/* 大写十六进制字符表, 小写时对结果或上0x20即可('0'~'9'本身已含0x20) */
+static const char g_core_string_hex_upper[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/* 十六进制字符到数值的查找表, 0xFF表示非法字符 */
+static const uint8_t g_core_string_hex_value[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
 int32_t core_hex2str(uint8_t *input, uint32_t input_len, char *output, uint8_t lowercase)
 {
-    char *upper = "0123456789ABCDEF";
-    char *lower = "0123456789abcdef";
-    char *encode = upper;
-    int i = 0, j = 0;
-
-    if (lowercase) {
-        encode = lower;
-    }
+    char mask = (lowercase) ? 0x20 : 0x00;
+    uint32_t idx = 0;
 
-    for (i = 0; i < input_len; i++) {
-        output[j++] = encode[(input[i] >> 4) & 0xf];
-        output[j++] = encode[(input[i]) & 0xf];
+    for (idx = 0; idx < input_len; idx++) {
+        output[2 * idx] = g_core_string_hex_upper[input[idx] >> 4] | mask;
+        output[2 * idx + 1] = g_core_string_hex_upper[input[idx] & 0x0F] | mask;
     }
 
     return STATE_SUCCESS;
@@ -156,26 +220,19 @@ int32_t core_hex2str(uint8_t *input, uint32_t input_len, char *output, uint8_t l
 int32_t core_str2hex(char *input, uint32_t input_len, uint8_t *output)
 {
     uint32_t idx = 0;
+    uint8_t high = 0, low = 0;
 
     if (input_len % 2 != 0) {
         return STATE_USER_INPUT_OUT_RANGE;
     }
 
     for (idx = 0; idx < input_len; idx += 2) {
-        if (input[idx] >= '0' && input[idx] <= '9') {
-            output[idx / 2] = (input[idx] - '0') << 4;
-        } else if (input[idx] >= 'A' && input[idx] <= 'F') {
-            output[idx / 2] = (input[idx] - 'A' + 0x0A) << 4;
-        } else if (input[idx] >= 'a' && input[idx] <= 'f') {
-            output[idx / 2] = (input[idx] - 'a' + 0x0A) << 4;
-        }
-        if (input[idx + 1] >= '0' && input[idx + 1] <= '9') {
-            output[idx / 2] |= (input[idx + 1] - '0');
-        } else if (input[idx + 1] >= 'A' && input[idx + 1] <= 'F') {
-            output[idx / 2] |= (input[idx + 1] - 'A' + 0x0A);
-        } else if (input[idx + 1] >= 'a' && input[idx + 1] <= 'f') {
-            output[idx / 2] |= (input[idx + 1] - 'a' + 0x0A);
+        high = g_core_string_hex_value[(uint8_t)input[idx]];
+        low = g_core_string_hex_value[(uint8_t)input[idx + 1]];
+        if ((high | low) > 0x0F) {
+            return STATE_USER_INPUT_OUT_RANGE;
         }
+        output[idx / 2] = (uint8_t)((high << 4) | low);
     }
 
     return STATE_SUCCESS;
@@ -198,11 +255,31 @@ int32_t core_strdup(aiot_sysdep_portfile_t *sysdep, char **dest, char *src, char
     return STATE_SUCCESS;
 }
 
+uint8_t core_strcase_equal(const char *str, uint32_t str_len, const char *token)
+{
+    uint32_t idx = 0;
+    char a = 0, b = 0;
+
+    if (str_len != strlen(token)) {
+        return 0;
+    }
+    for (idx = 0; idx < str_len; idx++) {
+        a = (str[idx] >= 'A' && str[idx] <= 'Z') ? str[idx] + ('a' - 'A') : str[idx];
+        b = (token[idx] >= 'A' && token[idx] <= 'Z') ? token[idx] + ('a' - 'A') : token[idx];
+        if (a != b) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 int32_t core_sprintf(aiot_sysdep_portfile_t *sysdep, char **dest, char *fmt, char *src[], uint8_t count,
                      char *module_name)
 {
     char *buffer = NULL, *value = NULL;
-    uint8_t idx = 0, percent_idx = 0;
+    uint8_t percent_idx = 0;
+    uint32_t idx = 0, offset = 0, value_len = 0;
     uint32_t buffer_len = 0;
     uint32_t fmt_len = (uint32_t)strlen(fmt);
 
@@ -220,22 +297,160 @@ int32_t core_sprintf(aiot_sysdep_portfile_t *sysdep, char **dest, char *fmt, cha
     if (buffer == NULL) {
         return STATE_SYS_DEPEND_MALLOC_FAILED;
     }
-    memset(buffer, 0, buffer_len + 1);
 
-    for (idx = 0, percent_idx = 0; idx < fmt_len;) {
-        if (fmt[idx] == '%' && idx + 1 < fmt_len && fmt[idx + 1] == 's') {
+    /* 按写入偏移追加, 避免每个字符都重新strlen */
+    for (idx = 0, percent_idx = 0; idx < fmt_len && offset < buffer_len;) {
+        if (fmt[idx] == '%' && idx + 1 < fmt_len && fmt[idx + 1] == 's' && percent_idx < count) {
             value = (*(src + percent_idx) == NULL) ? ("") : (*(src + percent_idx));
-            memcpy(buffer + strlen(buffer), value, strlen(value));
+            value_len = (uint32_t)strlen(value);
+            if (value_len > buffer_len - offset) {
+                value_len = buffer_len - offset;
+            }
+            memcpy(buffer + offset, value, value_len);
+            offset += value_len;
             percent_idx++;
             idx += 2;
         } else {
-            buffer[strlen(buffer)] = fmt[idx++];
+            buffer[offset++] = fmt[idx++];
         }
     }
+    buffer[offset] = '\0';
     *dest = buffer;
     return STATE_SUCCESS;
 }
 
+static uint32_t _core_snprintf_number(uint64_t value, uint8_t hex, char *output)
+{
+    char digits[20];
+    uint32_t len = 0, idx = 0;
+
+    do {
+        if (hex) {
+            digits[len++] = "0123456789abcdef"[value & 0x0F];
+            value >>= 4;
+        } else {
+            digits[len++] = (char)('0' + value % 10);
+            value /= 10;
+        }
+    } while (value > 0);
+
+    for (idx = 0; idx < len; idx++) {
+        output[idx] = digits[len - idx - 1];
+    }
+
+    return len;
+}
+
+static void _core_snprintf_append(char *dest, uint32_t dest_len, uint32_t *offset, const char *value, uint32_t len)
+{
+    if (dest != NULL && *offset + 1 < dest_len) {
+        memcpy(dest + *offset, value, (*offset + len < dest_len) ? len : (dest_len - *offset - 1));
+    }
+    *offset += len;
+}
+
+int32_t core_snprintf(char *dest, uint32_t dest_len, char *fmt, void *src[], uint8_t count)
+{
+    char number[21];
+    char *value = NULL;
+    uint32_t offset = 0, value_len = 0, literal = 0;
+    uint8_t src_idx = 0;
+    int64_t signed_value = 0;
+
+    while (*fmt != '\0') {
+        /* 连续的普通字符一次性拷贝 */
+        for (literal = 0; fmt[literal] != '\0' && fmt[literal] != '%'; literal++);
+        if (literal > 0) {
+            _core_snprintf_append(dest, dest_len, &offset, fmt, literal);
+            fmt += literal;
+            continue;
+        }
+
+        fmt++;
+        if (*fmt == '%') {
+            _core_snprintf_append(dest, dest_len, &offset, "%", 1);
+            fmt++;
+            continue;
+        }
+
+        if (src_idx >= count) {
+            return STATE_USER_INPUT_OUT_RANGE;
+        }
+
+        if (*fmt == 's') {
+            value = (src[src_idx] == NULL) ? ("") : ((char *)src[src_idx]);
+            _core_snprintf_append(dest, dest_len, &offset, value, (uint32_t)strlen(value));
+            fmt += 1;
+            src_idx += 1;
+        } else if (memcmp(fmt, ".*s", 3) == 0) {
+            if (src_idx + 1 >= count || src[src_idx] == NULL) {
+                return STATE_USER_INPUT_OUT_RANGE;
+            }
+            value_len = *(uint32_t *)src[src_idx];
+            value = (src[src_idx + 1] == NULL) ? ("") : ((char *)src[src_idx + 1]);
+            if (src[src_idx + 1] == NULL) {
+                value_len = 0;
+            }
+            _core_snprintf_append(dest, dest_len, &offset, value, value_len);
+            fmt += 3;
+            src_idx += 2;
+        } else if (*fmt == 'd' && src[src_idx] != NULL) {
+            signed_value = *(int32_t *)src[src_idx];
+            value_len = 0;
+            if (signed_value < 0) {
+                number[value_len++] = '-';
+                signed_value = -signed_value;
+            }
+            value_len += _core_snprintf_number((uint64_t)signed_value, 0, number + value_len);
+            _core_snprintf_append(dest, dest_len, &offset, number, value_len);
+            fmt += 1;
+            src_idx += 1;
+        } else if ((*fmt == 'u' || *fmt == 'x') && src[src_idx] != NULL) {
+            value_len = _core_snprintf_number(*(uint32_t *)src[src_idx], (*fmt == 'x'), number);
+            _core_snprintf_append(dest, dest_len, &offset, number, value_len);
+            fmt += 1;
+            src_idx += 1;
+        } else if (memcmp(fmt, "llu", 3) == 0 && src[src_idx] != NULL) {
+            value_len = _core_snprintf_number(*(uint64_t *)src[src_idx], 0, number);
+            _core_snprintf_append(dest, dest_len, &offset, number, value_len);
+            fmt += 3;
+            src_idx += 1;
+        } else {
+            return STATE_USER_INPUT_OUT_RANGE;
+        }
+    }
+
+    if (dest != NULL && dest_len > 0) {
+        dest[(offset < dest_len) ? offset : (dest_len - 1)] = '\0';
+    }
+
+    return (int32_t)offset;
+}
+
+int32_t core_sprintf_buf(aiot_sysdep_portfile_t *sysdep, char *buffer, uint32_t buffer_len, char **dest, char *fmt,
+                         void *src[], uint8_t count, char *module_name)
+{
+    int32_t len = 0;
+
+    len = core_snprintf(buffer, buffer_len, fmt, src, count);
+    if (len < 0) {
+        return len;
+    }
+    if (buffer != NULL && (uint32_t)len < buffer_len) {
+        *dest = buffer;
+        return len;
+    }
+
+    /* 调用者提供的缓冲区放不下时, 按第一遍得到的长度从堆上分配 */
+    *dest = sysdep->core_sysdep_malloc((uint32_t)len + 1, module_name);
+    if (*dest == NULL) {
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+    core_snprintf(*dest, (uint32_t)len + 1, fmt, src, count);
+
+    return len;
+}
+
 int32_t core_json_value(const char *input, uint32_t input_len, const char *key, uint32_t key_len, char **value,
                         uint32_t *value_len)
 {
@@ -293,15 +508,424 @@ int32_t core_json_value(const char *input, uint32_t input_len, const char *key,
     return STATE_USER_INPUT_JSON_PARSE_FAILED;
 }
 
+#define CORE_JSON_INDEX_DEPTH (16)
+
+static uint32_t _core_json_skip_space(const char *input, uint32_t input_len, uint32_t idx)
+{
+    while (idx < input_len && (input[idx] == ' ' || input[idx] == '\t' || input[idx] == '\r' || input[idx] == '\n')) {
+        idx++;
+    }
+    return idx;
+}
+
+/* idx指向起始引号之后, 返回结束引号的位置, 未找到时返回input_len */
+static uint32_t _core_json_skip_string(const char *input, uint32_t input_len, uint32_t idx)
+{
+    for (; idx < input_len; idx++) {
+        if (input[idx] == '\\') {
+            idx++;
+        } else if (input[idx] == '"') {
+            return idx;
+        }
+    }
+    return input_len;
+}
+
+int32_t core_json_index(core_json_index_t *index, const char *input, uint32_t input_len, core_json_token_t *tokens,
+                        uint32_t token_max)
+{
+    struct {
+        uint8_t is_object;
+        int32_t token;
+    } stack[CORE_JSON_INDEX_DEPTH];
+    uint32_t depth = 0, idx = 0, start = 0, end = 0;
+    int32_t token = 0;
+    char c = 0;
+
+    memset(index, 0, sizeof(core_json_index_t));
+    index->input = input;
+    index->input_len = input_len;
+    index->tokens = tokens;
+    index->token_max = token_max;
+    index->indexed_len = input_len;
+
+    idx = _core_json_skip_space(input, input_len, 0);
+    if (idx >= input_len || (input[idx] != '{' && input[idx] != '[')) {
+        goto failed;
+    }
+    stack[0].is_object = (input[idx] == '{');
+    stack[0].token = -1;
+    depth = 1;
+    idx++;
+
+    while (depth > 0) {
+        idx = _core_json_skip_space(input, input_len, idx);
+        if (idx >= input_len) {
+            goto failed;
+        }
+
+        c = input[idx];
+        if (c == ',') {
+            idx++;
+            continue;
+        }
+        if (c == '}' || c == ']') {
+            if (stack[depth - 1].is_object != (c == '}')) {
+                goto failed;
+            }
+            depth--;
+            if (stack[depth].token >= 0) {
+                tokens[stack[depth].token].value_len = idx - tokens[stack[depth].token].value_offset + 1;
+            }
+            idx++;
+            continue;
+        }
+
+        /* 对象内先解析key, 再解析value; 数组内直接解析value */
+        token = -1;
+        if (stack[depth - 1].is_object) {
+            if (c != '"') {
+                goto failed;
+            }
+            start = idx + 1;
+            end = _core_json_skip_string(input, input_len, start);
+            idx = _core_json_skip_space(input, input_len, end + 1);
+            if (idx >= input_len || input[idx] != ':') {
+                goto failed;
+            }
+            idx = _core_json_skip_space(input, input_len, idx + 1);
+            if (idx >= input_len) {
+                goto failed;
+            }
+            if (index->token_num < token_max) {
+                token = (int32_t)index->token_num++;
+                tokens[token].key_offset = start;
+                tokens[token].key_len = end - start;
+            } else if (index->indexed_len == input_len) {
+                /* token用完, 此位置之后的key在查找时退化为逐字节扫描 */
+                index->indexed_len = start - 1;
+            }
+            c = input[idx];
+        }
+
+        if (c == '{' || c == '[') {
+            if (depth >= CORE_JSON_INDEX_DEPTH) {
+                goto failed;
+            }
+            stack[depth].is_object = (c == '{');
+            stack[depth].token = token;
+            depth++;
+            if (token >= 0) {
+                tokens[token].value_offset = idx;
+            }
+            idx++;
+        } else if (c == '"') {
+            start = idx + 1;
+            idx = _core_json_skip_string(input, input_len, start);
+            if (idx >= input_len) {
+                goto failed;
+            }
+            if (token >= 0) {
+                tokens[token].value_offset = start;
+                tokens[token].value_len = idx - start;
+            }
+            idx++;
+        } else {
+            start = idx;
+            while (idx < input_len && input[idx] != ',' && input[idx] != '}' && input[idx] != ']' &&
+                   input[idx] != ' ' && input[idx] != '\t' && input[idx] != '\r' && input[idx] != '\n') {
+                idx++;
+            }
+            if (token >= 0) {
+                tokens[token].value_offset = start;
+                tokens[token].value_len = idx - start;
+            }
+        }
+    }
+
+    return (int32_t)index->token_num;
+
+failed:
+    /* 无法建立索引时所有查找都退化为core_json_value, 行为与逐key扫描一致 */
+    index->token_num = 0;
+    index->indexed_len = 0;
+    return STATE_USER_INPUT_JSON_PARSE_FAILED;
+}
+
+int32_t core_json_index_scope_value(const core_json_index_t *index, const char *scope, uint32_t scope_len,
+                                    const char *key, uint32_t key_len, char **value, uint32_t *value_len)
+{
+    uint32_t scope_start = (uint32_t)(scope - index->input), scope_end = scope_start + scope_len;
+    uint32_t low = 0, high = index->token_num, mid = 0;
+    const core_json_token_t *token = NULL;
+
+    /* token按key在报文中的位置有序, 二分找到scope内的第一个key */
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (index->tokens[mid].key_offset < scope_start) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (; low < index->token_num && index->tokens[low].key_offset < scope_end; low++) {
+        token = &index->tokens[low];
+        if (token->key_len == key_len && memcmp(&index->input[token->key_offset], key, key_len) == 0) {
+            *value = (char *)&index->input[token->value_offset];
+            *value_len = token->value_len;
+            return STATE_SUCCESS;
+        }
+    }
+
+    if (scope_end > index->indexed_len) {
+        return core_json_value(scope, scope_len, key, key_len, value, value_len);
+    }
+
+    return STATE_USER_INPUT_JSON_PARSE_FAILED;
+}
+
+int32_t core_json_index_value(const core_json_index_t *index, const char *key, uint32_t key_len, char **value,
+                              uint32_t *value_len)
+{
+    return core_json_index_scope_value(index, index->input, index->input_len, key, key_len, value, value_len);
+}
+
+int32_t core_json_writer_init(core_json_writer_t *writer, aiot_sysdep_portfile_t *sysdep, uint32_t headroom,
+                              uint32_t capacity, char *module_name)
+{
+    memset(writer, 0, sizeof(core_json_writer_t));
+    writer->sysdep = sysdep;
+    writer->module_name = module_name;
+    writer->headroom = headroom;
+    writer->buffer_len = headroom + ((capacity == 0) ? CORE_JSON_WRITER_DEFAULT_LEN : capacity);
+    writer->buffer = sysdep->core_sysdep_malloc(writer->buffer_len, module_name);
+    if (writer->buffer == NULL) {
+        writer->buffer_len = 0;
+        writer->error = STATE_SYS_DEPEND_MALLOC_FAILED;
+        return STATE_SYS_DEPEND_MALLOC_FAILED;
+    }
+
+    return STATE_SUCCESS;
+}
+
+void core_json_writer_deinit(core_json_writer_t *writer)
+{
+    if (writer->buffer != NULL) {
+        writer->sysdep->core_sysdep_free(writer->buffer);
+    }
+    writer->buffer = NULL;
+    writer->buffer_len = 0;
+}
+
+/* 保证还能追加len个字节, 容量不足时至少翻倍扩容, 使整体拷贝次数与输出长度成对数关系 */
+static int32_t _core_json_writer_reserve(core_json_writer_t *writer, uint32_t len)
+{
+    uint32_t need = 0, new_len = 0;
+    uint8_t *new_buffer = NULL;
+
+    if (writer->error < STATE_SUCCESS) {
+        return writer->error;
+    }
+    if (len > 0x7FFFFFFF - writer->headroom - writer->len) {
+        writer->error = STATE_USER_INPUT_OUT_RANGE;
+        return writer->error;
+    }
+    need = writer->headroom + writer->len + len;
+    if (need <= writer->buffer_len) {
+        return STATE_SUCCESS;
+    }
+
+    new_len = writer->buffer_len * 2;
+    if (new_len < need) {
+        new_len = need;
+    }
+    new_buffer = writer->sysdep->core_sysdep_malloc(new_len, writer->module_name);
+    if (new_buffer == NULL) {
+        writer->error = STATE_SYS_DEPEND_MALLOC_FAILED;
+        return writer->error;
+    }
+    memcpy(new_buffer + writer->headroom, writer->buffer + writer->headroom, writer->len);
+    writer->sysdep->core_sysdep_free(writer->buffer);
+    writer->buffer = new_buffer;
+    writer->buffer_len = new_len;
+
+    return STATE_SUCCESS;
+}
+
+static void _core_json_writer_append(core_json_writer_t *writer, const char *data, uint32_t len)
+{
+    if (_core_json_writer_reserve(writer, len) < STATE_SUCCESS) {
+        return;
+    }
+    memcpy(writer->buffer + writer->headroom + writer->len, data, len);
+    writer->len += len;
+}
+
+static void _core_json_writer_char(core_json_writer_t *writer, char c)
+{
+    if (_core_json_writer_reserve(writer, 1) < STATE_SUCCESS) {
+        return;
+    }
+    writer->buffer[writer->headroom + writer->len++] = (uint8_t)c;
+}
+
+/* 同一层级中除第一个元素外, 每个元素之前需要一个逗号 */
+static void _core_json_writer_separator(core_json_writer_t *writer)
+{
+    if (writer->need_comma) {
+        _core_json_writer_char(writer, ',');
+    }
+    writer->need_comma = 1;
+}
+
+static void _core_json_writer_escape(core_json_writer_t *writer, const char *value, uint32_t value_len)
+{
+    const char *hex = "0123456789abcdef";
+    uint32_t idx = 0, start = 0;
+    char escape[6] = {'\\', 'u', '0', '0', 0, 0};
+    uint8_t c = 0;
+
+    _core_json_writer_char(writer, '"');
+    for (idx = 0; idx < value_len; idx++) {
+        c = (uint8_t)value[idx];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        /* 不需要转义的连续字节整段拷贝 */
+        _core_json_writer_append(writer, &value[start], idx - start);
+        start = idx + 1;
+
+        escape[1] = 'u';
+        switch (c) {
+            case '"':
+            case '\\': {
+                escape[1] = (char)c;
+            }
+            break;
+            case '\b': {
+                escape[1] = 'b';
+            }
+            break;
+            case '\f': {
+                escape[1] = 'f';
+            }
+            break;
+            case '\n': {
+                escape[1] = 'n';
+            }
+            break;
+            case '\r': {
+                escape[1] = 'r';
+            }
+            break;
+            case '\t': {
+                escape[1] = 't';
+            }
+            break;
+            default: {
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0x0F];
+            }
+            break;
+        }
+        _core_json_writer_append(writer, escape, (escape[1] == 'u') ? 6 : 2);
+    }
+    _core_json_writer_append(writer, &value[start], value_len - start);
+    _core_json_writer_char(writer, '"');
+}
+
+void core_json_writer_object_begin(core_json_writer_t *writer)
+{
+    _core_json_writer_separator(writer);
+    _core_json_writer_char(writer, '{');
+    writer->need_comma = 0;
+}
+
+void core_json_writer_object_end(core_json_writer_t *writer)
+{
+    _core_json_writer_char(writer, '}');
+    writer->need_comma = 1;
+}
+
+void core_json_writer_array_begin(core_json_writer_t *writer)
+{
+    _core_json_writer_separator(writer);
+    _core_json_writer_char(writer, '[');
+    writer->need_comma = 0;
+}
+
+void core_json_writer_array_end(core_json_writer_t *writer)
+{
+    _core_json_writer_char(writer, ']');
+    writer->need_comma = 1;
+}
+
+void core_json_writer_key(core_json_writer_t *writer, const char *key)
+{
+    _core_json_writer_separator(writer);
+    _core_json_writer_escape(writer, key, (uint32_t)strlen(key));
+    _core_json_writer_char(writer, ':');
+    writer->need_comma = 0;
+}
+
+void core_json_writer_string(core_json_writer_t *writer, const char *value)
+{
+    _core_json_writer_separator(writer);
+    if (value == NULL) {
+        _core_json_writer_append(writer, "null", 4);
+        return;
+    }
+    _core_json_writer_escape(writer, value, (uint32_t)strlen(value));
+}
+
+void core_json_writer_int(core_json_writer_t *writer, int64_t value)
+{
+    char number[21] = {0};
+    uint8_t number_len = 0;
+    uint64_t magnitude = (value < 0) ? (~(uint64_t)value + 1) : (uint64_t)value;
+
+    _core_json_writer_separator(writer);
+    if (value < 0) {
+        _core_json_writer_char(writer, '-');
+    }
+    core_uint642str(magnitude, number, &number_len);
+    _core_json_writer_append(writer, number, number_len);
+}
+
+void core_json_writer_uint(core_json_writer_t *writer, uint64_t value)
+{
+    char number[21] = {0};
+    uint8_t number_len = 0;
+
+    _core_json_writer_separator(writer);
+    core_uint642str(value, number, &number_len);
+    _core_json_writer_append(writer, number, number_len);
+}
+
+void core_json_writer_bool(core_json_writer_t *writer, uint8_t value)
+{
+    _core_json_writer_separator(writer);
+    if (value) {
+        _core_json_writer_append(writer, "true", 4);
+    } else {
+        _core_json_writer_append(writer, "false", 5);
+    }
+}
+
+void core_json_writer_raw(core_json_writer_t *writer, const char *value, uint32_t value_len)
+{
+    _core_json_writer_separator(writer);
+    _core_json_writer_append(writer, value, value_len);
+}
+
 int32_t core_utc2date(uint64_t utc, int8_t zone, core_date_t *date)
 {
     uint32_t day_sec = 0, day_num = 0;
+    uint32_t era = 0, doe = 0, yoe = 0, doy = 0, mp = 0;
     uint64_t utc_zone_s = 0;
 
-#define DAYS_IN_YEAR(year)        (IS_LEAP_YEAR(year) ? 366 : 365)
-#define IS_LEAP_YEAR(year)        (!((year) % 400) || (((year) % 100) && !((year) % 4)))
-#define DAYS_IN_MONTH(lpyr, mon)  ((mon == 1)?(28 + lpyr):((mon > 6)?(((mon - 1) & 1)?(30):(31)):((mon & 1)?(30):(31))))
-
     date->msec = utc % 1000;
     utc_zone_s = (utc / 1000) + (zone * 60 * 60);
 
@@ -312,19 +936,20 @@ int32_t core_utc2date(uint64_t utc, int8_t zone, core_date_t *date)
     date->min = (day_sec % 3600) / 60;
     date->hour = day_sec / 3600;
 
-    date->year = 1970;
-    while (day_num >= DAYS_IN_YEAR(date->year)) {
-        day_num -= DAYS_IN_YEAR(date->year);
-        date->year++;
-    }
-
-    date->mon = 0;
-    while (day_num >= DAYS_IN_MONTH(IS_LEAP_YEAR(date->year), date->mon)) {
-        day_num -= DAYS_IN_MONTH(IS_LEAP_YEAR(date->year), date->mon);
-        date->mon++;
-    }
-    date->mon++;
-    date->day = day_num + 1;
+    /*
+     * 由1970-01-01起的天数直接换算年月日(civil from days), 不再逐年逐月累减
+     * 以0000-03-01为起点, 每400年(146097天)为一个周期, 闰日位于每年的最后一天
+     */
+    day_num += 719468;
+    era = day_num / 146097;
+    doe = day_num - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+
+    date->day = doy - (153 * mp + 2) / 5 + 1;
+    date->mon = (mp < 10) ? (mp + 3) : (mp - 9);
+    date->year = yoe + era * 400 + (date->mon <= 2);
 
     return 0;
 }
@@ -19,6 +19,50 @@ typedef struct {
     uint32_t msec;
 } core_date_t;
 
+/* 一个key及其value在报文中的位置, value的取值方式与core_json_value一致 */
+typedef struct {
+    uint32_t key_offset;
+    uint32_t key_len;
+    uint32_t value_offset;
+    uint32_t value_len;
+} core_json_token_t;
+
+/*
+ * 对JSON报文做一次扫描, 把所有层级对象中的key按出现顺序记录到调用者提供的tokens数组中, 不分配内存
+ * tokens不足或报文无法解析时, indexed_len之后的key在查找时退化为core_json_value逐字节扫描
+ */
+typedef struct {
+    const char *input;
+    uint32_t input_len;
+    core_json_token_t *tokens;
+    uint32_t token_max;
+    uint32_t token_num;
+    uint32_t indexed_len;
+} core_json_index_t;
+
+/* 组件接收回调中建立索引时使用的默认token数量 */
+#define CORE_JSON_INDEX_TOKENS (32)
+
+/*
+ * 只追加的JSON输出, 边构造边写入从portfile分配的缓冲区, 不经过中间的JSON树
+ * buffer头部预留headroom字节不写内容, 供调用者原地填写报文头(如MQTT PUBLISH头), 使payload无需再拷贝一次
+ * JSON内容位于buffer + headroom, 长度为len, 不以'\0'结尾
+ * 写入过程中的错误记录在error中, 此后的写入都不再生效, 调用者只需在最后检查一次
+ */
+typedef struct {
+    aiot_sysdep_portfile_t *sysdep;
+    char *module_name;
+    uint8_t *buffer;
+    uint32_t buffer_len;
+    uint32_t headroom;
+    uint32_t len;
+    uint8_t need_comma;
+    int32_t error;
+} core_json_writer_t;
+
+/* core_json_writer_init未指定容量时的初始容量, 不足时按倍数扩容 */
+#define CORE_JSON_WRITER_DEFAULT_LEN (256)
+
 int32_t core_str2uint(char *input, uint8_t input_len, uint32_t *output);
 int32_t core_str2uint64(char *input, uint8_t input_len, uint64_t *output);
 int32_t core_uint2str(uint32_t input, char *output, uint8_t *output_len);
@@ -28,10 +72,48 @@ int32_t core_int2hexstr(int32_t input, char *output, uint8_t *output_len);
 int32_t core_hex2str(uint8_t *input, uint32_t input_len, char *output, uint8_t lowercase);
 int32_t core_str2hex(char *input, uint32_t input_len, uint8_t *output);
 int32_t core_strdup(aiot_sysdep_portfile_t *sysdep, char **dest, char *src, char *module_name);
+/* 不区分ASCII字母大小写比较长度为str_len的str与token, 用于HTTP header名称等, 相等时返回1 */
+uint8_t core_strcase_equal(const char *str, uint32_t str_len, const char *token);
 int32_t core_sprintf(aiot_sysdep_portfile_t *sysdep, char **dest, char *fmt, char *src[], uint8_t count,
                      char *module_name);
+/*
+ * 按fmt格式化到dest, 与snprintf一致返回完整输出所需的长度(不含结尾'\0'), dest为NULL或长度不足时只计算长度,
+ * dest_len大于0时总是以'\0'结尾. src中依次存放与转换符对应的参数指针:
+ *   %s: char *, NULL按空字符串输出
+ *   %.*s: uint32_t *长度和char *字符串, 占用两项
+ *   %d: int32_t *, %u: uint32_t *, %x: uint32_t *(小写十六进制), %llu: uint64_t *
+ *   %%: 输出'%', 不占用参数
+ */
+int32_t core_snprintf(char *dest, uint32_t dest_len, char *fmt, void *src[], uint8_t count);
+/*
+ * 优先写入调用者提供的buffer(通常是栈上的内存), 放不下时再从堆上分配
+ * 返回输出长度, *dest不等于buffer时需由调用者释放
+ */
+int32_t core_sprintf_buf(aiot_sysdep_portfile_t *sysdep, char *buffer, uint32_t buffer_len, char **dest, char *fmt,
+                         void *src[], uint8_t count, char *module_name);
 int32_t core_json_value(const char *input, uint32_t input_len, const char *key, uint32_t key_len, char **value,
                         uint32_t *value_len);
+int32_t core_json_index(core_json_index_t *index, const char *input, uint32_t input_len, core_json_token_t *tokens,
+                        uint32_t token_max);
+int32_t core_json_index_value(const core_json_index_t *index, const char *key, uint32_t key_len, char **value,
+                              uint32_t *value_len);
+int32_t core_json_index_scope_value(const core_json_index_t *index, const char *scope, uint32_t scope_len,
+                                    const char *key, uint32_t key_len, char **value, uint32_t *value_len);
+int32_t core_json_writer_init(core_json_writer_t *writer, aiot_sysdep_portfile_t *sysdep, uint32_t headroom,
+                              uint32_t capacity, char *module_name);
+void core_json_writer_deinit(core_json_writer_t *writer);
+void core_json_writer_object_begin(core_json_writer_t *writer);
+void core_json_writer_object_end(core_json_writer_t *writer);
+void core_json_writer_array_begin(core_json_writer_t *writer);
+void core_json_writer_array_end(core_json_writer_t *writer);
+void core_json_writer_key(core_json_writer_t *writer, const char *key);
+/* value为NULL时输出null */
+void core_json_writer_string(core_json_writer_t *writer, const char *value);
+void core_json_writer_int(core_json_writer_t *writer, int64_t value);
+void core_json_writer_uint(core_json_writer_t *writer, uint64_t value);
+void core_json_writer_bool(core_json_writer_t *writer, uint8_t value);
+/* 原样写入调用者已经序列化好的JSON值 */
+void core_json_writer_raw(core_json_writer_t *writer, const char *value, uint32_t value_len);
 int32_t core_utc2date(uint64_t utc, int8_t zone, core_date_t *date);
 int32_t core_strcat(aiot_sysdep_portfile_t *sysdep, char **dest, char *src1, char *src2, char *module_name);
 
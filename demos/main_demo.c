@@ -8,7 +8,8 @@
 #include "aiot_mqtt_api.h"
 #include "aiot_ota_api.h"
 #include "aiot_dm_api.h"
-#include "md5.h"
+#include "core_md5.h"
+#include "core_string.h"
 
 char *username          = "";
 char *password          = "";
@@ -371,8 +372,12 @@ int main(int argc, char *argv[])
     if (strlen(password) == 0)
     {
         char xjt_password[100] = {0};
+        uint8_t digest[CORE_MD5_DIGEST_LENGTH] = {0};
+        char digest_str[CORE_MD5_DIGEST_LENGTH * 2 + 1] = {0};
         sprintf(xjt_password,"identify:%s",device_name);
-        Md5GenerateStr(xjt_password, strlen(xjt_password), password);
+        core_md5((uint8_t *)xjt_password, strlen(xjt_password), digest);
+        core_hex2str(digest, CORE_MD5_DIGEST_LENGTH, digest_str, 1);
+        sprintf(password, "%s", digest_str);
     }
     /* 配置设备username */
     aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_USERNAME, (void *)username);
@@ -0,0 +1,2228 @@
+/*
+ * 这个例程适用于`Linux`这类支持pthread的POSIX设备, 用于评估SDK在多线程下的性能, 不需要连接云平台
+ *
+ * + 基于posix portfile, 将网络接口替换为进程内的模拟服务端, 收到CONNECT后立即回复CONNACK, 其它报文直接丢弃
+ * + 发布测试: 1~16个线程共用一个MQTT实例并发调用aiot_mqtt_pub, 统计每秒的调用次数
+ * + 重连风暴测试: 10000个MQTT实例连接模拟服务端, 服务端中断一段时间后恢复, 统计恢复后每秒的建连次数,
+ *   对比线性退避、指数退避(去相关抖动)以及叠加进程级限速时的效果
+ * + 日志开销测试: 单线程发布, 对比未设置日志回调、设置回调但按级别过滤掉发布日志、全部输出时的吞吐量,
+ *   使用-DCORE_LOG_DISABLED编译时日志代码被完全去除, 可用于对比
+ * + 慢速日志测试: 日志回调每条耗时约数十微秒(模拟串口输出), 对比同步输出与异步缓冲区+独立投递线程时的发布吞吐量
+ * + 物模型上报测试: 单线程调用aiot_dm_send上报不同长度的属性, 统计每秒的上报次数, 主要反映topic与payload的拼装开销
+ * + JSON查找测试: 对典型的OTA推送和物模型下行报文, 对比逐key调用core_json_value与先建立索引再查找的耗时
+ * + 子设备批量操作测试: 200个子设备的拓扑添加、批量上线和拓扑删除, 统计每次操作通过portfile申请内存的次数和耗时.
+ *   payload由core_json_writer直接写入发布缓冲区, 每次操作只申请这一个缓冲区
+ *
+ * + 摘要算法测试: 对比SHA-256的C实现与硬件指令实现、单路与多路计算、MD5的吞吐量, 以及子设备签名长度消息的HMAC-SHA256
+ * + CRC16测试: 按MQTT文件下载的分块大小计算CRC16/IBM的吞吐量, 并校验标准测试向量
+ * + 字符串工具测试: core_string.c中整数、十六进制与日期转换函数, 以及日志前缀日期的单次调用耗时
+ *
+ * + HTTP上报测试: 进程内模拟HTTP服务端(往返时延10ms, 建连30ms), 对比每条消息重新建连并认证、缓存token、
+ *   长连接以及在长连接上批量流水线上报时的每秒上报条数
+ * + OTA下载测试: 模拟服务端往返时延50ms, 单个连接每个往返时延最多收到64KB, 对比单连接与多个连接分段并行下载2MB固件的速度,
+ *   以及某个连接中途断开时只对该分段续传的情况, 下载中途模拟设备重启后从保存的断点记录继续下载并校验digest
+ * + OTA下载流水线测试: 模拟服务端往返时延1ms, 接收不再是瓶颈, 对比2KB固定缓冲区、自适应缓冲区以及在独立线程中计算digest时
+ *   下载64MB固件的速度, 用户回调模拟写flash时的阻塞等待, 并输出各阶段的耗时
+ * + MQTT文件下载测试: 模拟服务端往返时延50ms、链路带宽512KB/s, 对比同时等待1~16个分块回复时下载256KB文件的速度,
+ *   以及某个分块的回复丢失时只重新请求该块的情况, 并对比固定块长度与按回复情况自适应调整块长度和窗口时下载1MB文件的有效吞吐量
+ * + MQTT下载回复解析测试: 模拟服务端立即回复分块请求, 经aiot_mqtt_recv交给下载实例, 对比JSON格式与二进制格式的回复头
+ *   在回复因偏移不符被丢弃(只解析回复头)以及被接收(加上CRC16校验、交付和请求下一块)时每个回复的耗时
+ *
+ * 运行时可通过参数选择测试项: pub, storm, log, logbuf, dm, json, subdev, sha, crc, string, http, ota, dlpipe, mqttdl,
+ * mdparse, 不带参数时全部运行
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <inttypes.h>
+
+#include "aiot_state_api.h"
+#include "aiot_sysdep_api.h"
+#include "aiot_mqtt_api.h"
+#include "aiot_dm_api.h"
+#include "aiot_subdev_api.h"
+#include "aiot_http_api.h"
+#include "aiot_ota_api.h"
+#include "aiot_mqtt_download_api.h"
+#include "core_string.h"
+#include "core_sha256.h"
+#include "core_md5.h"
+#include "core_crc16.h"
+#include "core_log.h"
+#include "core_http.h"
+
+/* 位于portfiles/aiot_port文件夹下的系统适配函数集合 */
+extern aiot_sysdep_portfile_t g_aiot_sysdep_portfile;
+
+/* 在posix portfile基础上替换网络接口后的适配函数集合 */
+static aiot_sysdep_portfile_t g_bench_portfile;
+
+#define BENCH_MAX_THREADS       (16)
+#define BENCH_PUB_PER_THREAD    (200000)
+
+#define BENCH_SLOWLOG_PUB_COUNT (2000)
+#define BENCH_SLOWLOG_DELAY_US  (20)
+#define BENCH_LOGBUF_SIZE       (64 * 1024)
+
+#define BENCH_DM_POST_COUNT     (200000)
+#define BENCH_JSON_PARSE_COUNT  (200000)
+#define BENCH_SUBDEV_NUM        (200)
+#define BENCH_SUBDEV_ROUNDS     (200)
+#define BENCH_SHA_BUFFER_LEN    (1024 * 1024)
+#define BENCH_SHA_ROUNDS        (64)
+#define BENCH_HMAC_MSG_LEN      (110)
+#define BENCH_HMAC_COUNT        (400000)
+#define BENCH_CRC_BLOCK_LEN     (5 * 1024)
+#define BENCH_CRC_BLOCKS        (40000)
+#define BENCH_STRING_COUNT      (2000000)
+
+#define BENCH_HTTP_HOST         "bench.http"
+#define BENCH_HTTP_RTT_MS       (10)
+#define BENCH_HTTP_CONNECT_MS   (3 * BENCH_HTTP_RTT_MS)
+#define BENCH_HTTP_MSG_COUNT    (40)
+#define BENCH_HTTP_QUEUE_MAX    (16)
+
+#define BENCH_OTA_RTT_MS        (50)
+#define BENCH_OTA_WINDOW        (64 * 1024)
+#define BENCH_OTA_FIRMWARE_LEN  (2 * 1024 * 1024)
+#define BENCH_DLPIPE_RTT_MS     (1)
+#define BENCH_DLPIPE_WINDOW     (4 * 1024 * 1024)
+#define BENCH_DLPIPE_FIRMWARE_LEN (64 * 1024 * 1024)
+#define BENCH_DLPIPE_WRITE_US_PER_MB (2000)
+#define BENCH_MQTTDL_RTT_MS     (50)
+#define BENCH_MQTTDL_RATE       (512 * 1024)
+#define BENCH_MQTTDL_FILE_LEN   (256 * 1024)
+#define BENCH_MQTTDL_ADAPTIVE_FILE_LEN (1024 * 1024)
+#define BENCH_MDPARSE_COUNT     (100000)
+/* 回复中的偏移保持10位十进制数, 预先生成的JSON回复头可以原地改写偏移 */
+#define BENCH_MDPARSE_RANGE_START (1000000000U)
+#define BENCH_MQTTDL_QUEUE_MAX  (32)
+#define BENCH_MQTTDL_TOPIC      "/sys/bench_pk/bench_dn/thing/file/download"
+
+#define BENCH_STORM_HANDLES     (10000)
+#define BENCH_STORM_OUTAGE_MS   (3 * 1000)
+#define BENCH_STORM_WINDOW_S    (20)
+
+/* 模拟服务端状态, 服务端中断时新建连接失败, 已有连接读取时返回连接关闭 */
+static volatile uint8_t g_bench_broker_up = 1;
+static uint64_t g_bench_broker_up_time = 0;
+static uint32_t g_bench_connect_hist[BENCH_STORM_WINDOW_S];
+
+/*
+ * 模拟HTTP服务端的连接上下文, 按Content-Length切分收到的请求, /auth回复token, GET请求按Range回复固件内容,
+ * 其它路径回复上报成功, 每个应答在请求发出一个往返时延之后开始到达.
+ * 连接上的应答依次组成一条字节流, 每个往返时延最多到达一个TCP窗口, 且未读取的数据不超过一个窗口,
+ * 以此模拟单个连接在高时延链路上的吞吐上限
+ */
+typedef struct {
+    uint8_t     header[256];        /* 应答header, 普通应答的body也放在这里 */
+    uint32_t    header_len;
+    uint32_t    body_offset;        /* 固件应答的body在固件中的位置 */
+    uint32_t    body_len;
+    uint32_t    stream_end;         /* 应答结束处在字节流中的位置 */
+    uint64_t    ready;
+} bench_http_response_t;
+
+typedef struct {
+    uint8_t     closed;
+    char        request[2048];
+    uint32_t    request_len;
+    bench_http_response_t response[BENCH_HTTP_QUEUE_MAX];
+    uint32_t    response_num;
+    uint32_t    stream_read;        /* 字节流中已经读取的位置 */
+    uint32_t    stream_arrived;     /* 字节流中已经到达的位置 */
+    uint64_t    stream_time;        /* 上次计算到达量的时间 */
+} bench_http_conn_t;
+
+/*
+ * 模拟MQTT文件下载服务端, 收到分块请求后回复该块, 回复在请求发出一个往返时延之后开始到达,
+ * 并按链路带宽依次排队, 以此模拟单个MQTT连接的吞吐上限
+ */
+typedef struct {
+    uint32_t    offset;
+    uint32_t    size;
+    uint8_t     binary;             /* 请求中要求使用二进制格式的回复头 */
+    uint64_t    ready;
+} bench_mqttdl_reply_t;
+
+typedef struct {
+    bench_mqttdl_reply_t reply[BENCH_MQTTDL_QUEUE_MAX];
+    uint32_t    reply_num;
+    uint64_t    link_free;          /* 链路上前一个回复到达完的时间 */
+    uint8_t    *packet;             /* 正在读取的PUBLISH报文 */
+    uint32_t    packet_len;
+    uint32_t    packet_offset;
+} bench_mqttdl_conn_t;
+
+/* 模拟服务端的连接上下文 */
+typedef struct {
+    uint8_t     pending[4];
+    uint32_t    pending_len;
+    uint32_t    pending_offset;
+    bench_http_conn_t *http;
+    bench_mqttdl_conn_t *mqttdl;    /* 只有发起文件下载的连接才会创建 */
+} bench_network_t;
+
+static uint32_t g_bench_http_connects = 0;
+static uint32_t g_bench_http_rtt_ms = BENCH_HTTP_RTT_MS;
+/* 固件下载应答读到该位置时断开一次连接, 用于验证出错的分段单独续传 */
+static uint32_t g_bench_ota_reset_at = 0;
+/* 模拟不支持Range的服务端, 总是用200回复整个固件, header名称使用小写 */
+static uint8_t g_bench_ota_no_range = 0;
+static uint32_t g_bench_ota_window = BENCH_OTA_WINDOW;
+static uint32_t g_bench_ota_firmware_len = BENCH_OTA_FIRMWARE_LEN;
+
+static uint32_t g_bench_mqttdl_requests = 0;
+/* 丢弃对该偏移的第一次请求的回复, 用于验证只重新请求超时的块 */
+static uint32_t g_bench_mqttdl_drop_at = 0;
+/* 每隔若干个请求丢弃一个回复, 用于模拟有丢包的链路 */
+static uint32_t g_bench_mqttdl_loss_every = 0;
+static uint32_t g_bench_mqttdl_file_len = BENCH_MQTTDL_FILE_LEN;
+/* 链路上排队等待发送的数据超过该长度时丢弃新的回复, 用于模拟拥塞, 0表示不限制 */
+static uint32_t g_bench_mqttdl_queue_limit = 0;
+static uint8_t g_bench_mqttdl_binary = 0;
+
+/*
+ * MQTT下载回复解析测试时, 模拟服务端收到分块请求后立即回复. 回复报文预先生成, 每次只改写其中的偏移,
+ * 数据内容不变, 因此CRC始终正确. stale为1时不等待请求, 一直回复同一个不在等待中的偏移
+ */
+typedef struct {
+    uint8_t    *packet;
+    uint32_t    packet_start;       /* 报文在packet中的起始位置 */
+    uint32_t    packet_len;
+    uint32_t    field_pos;          /* 偏移字段在packet中的位置 */
+    uint32_t    read_pos;
+    uint8_t     binary;
+    uint8_t     stale;
+    uint8_t     armed;
+} bench_mdparse_replay_t;
+
+static bench_mdparse_replay_t g_bench_mdparse_replay;
+
+static uint8_t bench_ota_byte(uint32_t offset)
+{
+    return (uint8_t)(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+
+static void bench_http_respond(bench_http_conn_t *http, const char *request, const char *path)
+{
+    bench_http_response_t *response = NULL;
+    const char *body = NULL, *range = NULL, *fmt = NULL;
+    unsigned int range_start = 0, range_end = g_bench_ota_firmware_len - 1;
+
+    if (http->response_num == BENCH_HTTP_QUEUE_MAX) {
+        return;
+    }
+    response = &http->response[http->response_num];
+    memset(response, 0, sizeof(bench_http_response_t));
+
+    if (strncmp(request, "GET ", strlen("GET ")) == 0) {
+        range = strstr(request, "Range: bytes=");
+        if (range != NULL && g_bench_ota_no_range == 0) {
+            sscanf(range + strlen("Range: bytes="), "%u-%u", &range_start, &range_end);
+        }
+        if (range_end >= g_bench_ota_firmware_len) {
+            range_end = g_bench_ota_firmware_len - 1;
+        }
+        fmt = (g_bench_ota_no_range == 0) ? "HTTP/1.1 206 Partial Content\r\nContent-Length: %u\r\n\r\n" :
+              "HTTP/1.1 200 OK\r\ncontent-length: %u\r\n\r\n";
+        response->header_len = snprintf((char *)response->header, sizeof(response->header), fmt,
+                                        range_end - range_start + 1);
+        response->body_offset = range_start;
+        response->body_len = range_end - range_start + 1;
+    } else {
+        if (strncmp(path, "/auth", strlen("/auth")) == 0) {
+            body = "{\"code\":0,\"message\":\"success\",\"info\":{\"token\":\"a1b2c3d4e5f6bench0123456789abcdef\"}}";
+        } else {
+            body = "{\"code\":0,\"message\":\"success\",\"info\":{\"messageId\":892687627916247040}}";
+        }
+        response->header_len = snprintf((char *)response->header, sizeof(response->header),
+                                        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%s",
+                                        (int)strlen(body), body);
+    }
+
+    response->stream_end = ((http->response_num == 0) ? http->stream_read : http->response[http->response_num -
+                            1].stream_end) + response->header_len + response->body_len;
+    response->ready = g_bench_portfile.core_sysdep_time() + g_bench_http_rtt_ms;
+    http->response_num++;
+}
+
+static int32_t bench_http_send(bench_http_conn_t *http, uint8_t *buffer, uint32_t len)
+{
+    char *header_end = NULL, *content_len = NULL, path[64];
+    uint32_t request_len = 0;
+
+    if (http->request_len + len > sizeof(http->request) - 1) {
+        return STATE_PORT_NETWORK_SEND_CONNECTION_CLOSED;
+    }
+    memcpy(http->request + http->request_len, buffer, len);
+    http->request_len += len;
+    http->request[http->request_len] = '\0';
+
+    /* 处理所有已经完整收到的请求 */
+    while ((header_end = strstr(http->request, "\r\n\r\n")) != NULL) {
+        request_len = (uint32_t)(header_end - http->request) + 4;
+        content_len = strstr(http->request, "Content-Length: ");
+        if (content_len != NULL && content_len < header_end) {
+            request_len += (uint32_t)atoi(content_len + strlen("Content-Length: "));
+        }
+        if (request_len > http->request_len) {
+            break;
+        }
+        memset(path, 0, sizeof(path));
+        sscanf(http->request, "%*s %63s", path);
+        bench_http_respond(http, http->request, path);
+
+        memmove(http->request, http->request + request_len, http->request_len - request_len + 1);
+        http->request_len -= request_len;
+    }
+
+    return (int32_t)len;
+}
+
+/* 按窗口和往返时延推进字节流的到达位置, 应答在ready之前不会开始到达 */
+static void bench_http_arrive(bench_http_conn_t *http)
+{
+    uint64_t timenow = g_bench_portfile.core_sysdep_time(), start = 0;
+    uint32_t idx = 0, take = 0, limit = 0;
+
+    for (idx = 0; idx < http->response_num; idx++) {
+        bench_http_response_t *response = &http->response[idx];
+
+        if (response->stream_end <= http->stream_arrived) {
+            continue;
+        }
+        start = (http->stream_time > response->ready) ? http->stream_time : response->ready;
+        if (start >= timenow) {
+            break;
+        }
+        limit = http->stream_read + g_bench_ota_window - http->stream_arrived;
+        take = (uint32_t)((timenow - start) * g_bench_ota_window / g_bench_http_rtt_ms);
+        take = (take < limit) ? take : limit;
+        take = (take < response->stream_end - http->stream_arrived) ? take : response->stream_end - http->stream_arrived;
+        http->stream_arrived += take;
+        http->stream_time = start + (uint64_t)take * g_bench_http_rtt_ms / g_bench_ota_window;
+        if (http->stream_arrived < response->stream_end) {
+            break;
+        }
+    }
+    http->stream_time = timenow;
+}
+
+/* 读取字节流中已经到达的内容, 返回-1表示模拟的连接中断 */
+static int32_t bench_http_read_stream(bench_http_conn_t *http, uint8_t *buffer, uint32_t len)
+{
+    uint32_t copied = 0;
+
+    bench_http_arrive(http);
+    while (copied < len && http->stream_read < http->stream_arrived) {
+        bench_http_response_t *response = &http->response[0];
+        uint32_t begin = response->stream_end - response->body_len - response->header_len;
+        uint32_t pos = http->stream_read - begin, chunk = 0;
+
+        if (pos < response->header_len) {
+            chunk = response->header_len - pos;
+            chunk = (chunk < len - copied) ? chunk : len - copied;
+            chunk = (chunk < http->stream_arrived - http->stream_read) ? chunk : http->stream_arrived - http->stream_read;
+            memcpy(buffer + copied, response->header + pos, chunk);
+        } else {
+            uint32_t body_pos = response->body_offset + pos - response->header_len, idx = 0;
+
+            if (g_bench_ota_reset_at != 0 && body_pos >= g_bench_ota_reset_at) {
+                g_bench_ota_reset_at = 0;
+                http->closed = 1;
+                return -1;
+            }
+            chunk = response->stream_end - http->stream_read;
+            chunk = (chunk < len - copied) ? chunk : len - copied;
+            chunk = (chunk < http->stream_arrived - http->stream_read) ? chunk : http->stream_arrived - http->stream_read;
+            for (idx = 0; idx < chunk; idx++) {
+                buffer[copied + idx] = bench_ota_byte(body_pos + idx);
+            }
+        }
+        copied += chunk;
+        http->stream_read += chunk;
+
+        /* 已读完的应答出队 */
+        if (http->stream_read == response->stream_end) {
+            memmove(http->response, http->response + 1, (http->response_num - 1) * sizeof(bench_http_response_t));
+            http->response_num--;
+        }
+    }
+
+    return (int32_t)copied;
+}
+
+static int32_t bench_http_recv(bench_http_conn_t *http, uint8_t *buffer, uint32_t len, uint32_t timeout_ms)
+{
+    uint64_t deadline = g_bench_portfile.core_sysdep_time() + timeout_ms;
+    int32_t res = 0;
+    uint32_t copied = 0;
+
+    if (http->closed == 1) {
+        return STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
+    }
+
+    /* 等到足够的应答数据到达, 或者超时 */
+    while (1) {
+        res = bench_http_read_stream(http, buffer + copied, len - copied);
+        if (res < 0) {
+            return (copied > 0) ? (int32_t)copied : STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
+        }
+        copied += (uint32_t)res;
+        if (copied == len || g_bench_portfile.core_sysdep_time() >= deadline) {
+            break;
+        }
+        usleep(1000);
+    }
+
+    return (int32_t)copied;
+}
+
+/* 从分块请求的payload中取出某个数字字段的值 */
+static uint32_t bench_mqttdl_field(const char *payload, const char *key)
+{
+    const char *value = strstr(payload, key);
+
+    if (value == NULL) {
+        return 0;
+    }
+    return (uint32_t)strtoul(value + strlen(key), NULL, 10);
+}
+
+/* 把偏移写入预先生成的回复, 之后读取时交付该回复 */
+static void bench_mdparse_arm(uint32_t offset)
+{
+    bench_mdparse_replay_t *replay = &g_bench_mdparse_replay;
+    char digits[11];
+    uint32_t idx = 0;
+
+    if (replay->binary) {
+        for (idx = 0; idx < 4; idx++) {
+            replay->packet[replay->field_pos + idx] = (uint8_t)(offset >> (24 - idx * 8));
+        }
+    } else {
+        core_uint2str(offset, digits, NULL);
+        memcpy(replay->packet + replay->field_pos, digits, 10);
+    }
+    replay->read_pos = replay->packet_start;
+    replay->armed = 1;
+}
+
+static int32_t bench_mdparse_recv(uint8_t *buffer, uint32_t len)
+{
+    bench_mdparse_replay_t *replay = &g_bench_mdparse_replay;
+    uint32_t copy_len = replay->packet_len - replay->read_pos;
+
+    if (replay->armed == 0) {
+        return 0;
+    }
+    copy_len = (copy_len > len) ? (len) : (copy_len);
+    memcpy(buffer, replay->packet + replay->read_pos, copy_len);
+    replay->read_pos += copy_len;
+    if (replay->read_pos == replay->packet_len) {
+        replay->read_pos = replay->packet_start;
+        replay->armed = replay->stale;
+    }
+
+    return (int32_t)copy_len;
+}
+
+static void bench_mqttdl_request(bench_network_t *network, uint8_t *buffer, uint32_t len)
+{
+    bench_mqttdl_conn_t *mqttdl = network->mqttdl;
+    bench_mqttdl_reply_t *reply = NULL;
+    uint32_t pos = 1, multiplier = 1, remain_len = 0, topic_len = 0, payload_len = 0;
+    char payload[512];
+    uint64_t now = g_bench_portfile.core_sysdep_time();
+
+    /* QoS0的PUBLISH报文: 剩余长度, topic, payload */
+    do {
+        remain_len += (buffer[pos] & 0x7F) * multiplier;
+        multiplier *= 128;
+    } while ((buffer[pos++] & 0x80) != 0 && pos < len);
+    topic_len = buffer[pos] << 8 | buffer[pos + 1];
+    if (topic_len != strlen(BENCH_MQTTDL_TOPIC) || memcmp(buffer + pos + 2, BENCH_MQTTDL_TOPIC, topic_len) != 0) {
+        return;
+    }
+    payload_len = remain_len - 2 - topic_len;
+    payload_len = (payload_len < sizeof(payload) - 1) ? payload_len : sizeof(payload) - 1;
+    memcpy(payload, buffer + pos + 2 + topic_len, payload_len);
+    payload[payload_len] = '\0';
+
+    if (g_bench_mdparse_replay.packet != NULL) {
+        if (g_bench_mdparse_replay.stale == 0) {
+            bench_mdparse_arm(bench_mqttdl_field(payload, "\"offset\":"));
+        }
+        return;
+    }
+
+    if (mqttdl == NULL) {
+        mqttdl = network->mqttdl = malloc(sizeof(bench_mqttdl_conn_t));
+        if (mqttdl == NULL) {
+            return;
+        }
+        memset(mqttdl, 0, sizeof(bench_mqttdl_conn_t));
+    }
+    g_bench_mqttdl_requests++;
+    if (mqttdl->reply_num == BENCH_MQTTDL_QUEUE_MAX) {
+        return;
+    }
+    reply = &mqttdl->reply[mqttdl->reply_num];
+    reply->size = bench_mqttdl_field(payload, "\"size\":");
+    reply->offset = bench_mqttdl_field(payload, "\"offset\":");
+    reply->binary = (strstr(payload, "\"headerFormat\":\"binary\"") != NULL) ? 1 : 0;
+    if (g_bench_mqttdl_drop_at != 0 && reply->offset == g_bench_mqttdl_drop_at) {
+        g_bench_mqttdl_drop_at = 0;
+        return;
+    }
+    if (g_bench_mqttdl_loss_every != 0 && g_bench_mqttdl_requests % g_bench_mqttdl_loss_every == 0) {
+        return;
+    }
+
+    /* 请求经过半个往返到达服务端, 回复再经过半个往返开始到达, 同时按带宽排队 */
+    reply->ready = now + BENCH_MQTTDL_RTT_MS;
+    if (reply->ready < mqttdl->link_free) {
+        reply->ready = mqttdl->link_free;
+    }
+    if (g_bench_mqttdl_queue_limit != 0 &&
+            (reply->ready - now - BENCH_MQTTDL_RTT_MS) * BENCH_MQTTDL_RATE / 1000 > g_bench_mqttdl_queue_limit) {
+        return;
+    }
+    reply->ready += (uint64_t)reply->size * 1000 / BENCH_MQTTDL_RATE;
+    mqttdl->link_free = reply->ready;
+    mqttdl->reply_num++;
+}
+
+/* 按JSON或二进制格式生成一个分块回复的payload, 返回payload长度 */
+static uint32_t bench_mqttdl_payload(uint8_t *buffer, uint32_t offset, uint32_t size, uint8_t binary)
+{
+    uint32_t header_len = 0, idx = 0;
+    uint16_t crc16 = 0;
+    uint8_t *data = NULL;
+
+    if (binary) {
+        /* magic(2) code(2) bOffset(4) bSize(4) fileLength(4) crc16(2) reserved(2) fileToken(16), 大端 */
+        header_len = 36;
+        memset(buffer, 0, header_len);
+        buffer[0] = 0xFF;
+        buffer[1] = 0xFF;
+        buffer[3] = 200;
+        for (idx = 0; idx < 4; idx++) {
+            buffer[4 + idx] = (uint8_t)(offset >> (24 - idx * 8));
+            buffer[8 + idx] = (uint8_t)(size >> (24 - idx * 8));
+            buffer[12 + idx] = (uint8_t)(g_bench_mqttdl_file_len >> (24 - idx * 8));
+        }
+        memcpy(buffer + 20, "bench", strlen("bench"));
+    } else {
+        /* 头长度(2) JSON头 文件数据 crc16(2, 小端) */
+        header_len = snprintf((char *)buffer + 2, 160,
+                              "{\"code\":200,\"data\":{\"bSize\":%u,\"bOffset\":%u,\"fileLength\":%u,\"fileToken\":\"bench\"}}",
+                              size, offset, g_bench_mqttdl_file_len);
+        buffer[0] = (uint8_t)(header_len >> 8);
+        buffer[1] = (uint8_t)header_len;
+        header_len += 2;
+    }
+
+    data = buffer + header_len;
+    for (idx = 0; idx < size; idx++) {
+        data[idx] = bench_ota_byte(offset + idx);
+    }
+    crc16 = core_crc16(data, size);
+    if (binary) {
+        buffer[16] = (uint8_t)(crc16 >> 8);
+        buffer[17] = (uint8_t)crc16;
+        return header_len + size;
+    }
+    data[size] = (uint8_t)crc16;
+    data[size + 1] = (uint8_t)(crc16 >> 8);
+
+    return header_len + size + 2;
+}
+
+/* 把最早到达的回复组装成发往download_reply的PUBLISH报文 */
+static int32_t bench_mqttdl_build(bench_mqttdl_conn_t *mqttdl)
+{
+    const char *topic = BENCH_MQTTDL_TOPIC "_reply";
+    bench_mqttdl_reply_t *reply = &mqttdl->reply[0];
+    uint32_t topic_len = strlen(topic), payload_pos = 5 + 2 + topic_len;
+    uint32_t payload_len = 0, remain_len = 0, len_bytes = 0, pos = 0;
+
+    /* 先在预留的报文头空间之后生成payload, 再根据长度往前填写固定头和topic */
+    mqttdl->packet = malloc(payload_pos + 2 + 160 + reply->size + 2);
+    if (mqttdl->packet == NULL) {
+        return -1;
+    }
+    payload_len = bench_mqttdl_payload(mqttdl->packet + payload_pos, reply->offset, reply->size, reply->binary);
+    remain_len = 2 + topic_len + payload_len;
+    for (len_bytes = 1; (remain_len >> (7 * len_bytes)) != 0; len_bytes++);
+
+    pos = payload_pos - (1 + len_bytes + 2 + topic_len);
+    mqttdl->packet_offset = pos;
+    mqttdl->packet_len = payload_pos + payload_len;
+    mqttdl->packet[pos++] = 0x30;
+    do {
+        mqttdl->packet[pos] = remain_len % 128;
+        remain_len /= 128;
+        mqttdl->packet[pos++] |= (remain_len > 0) ? 0x80 : 0x00;
+    } while (remain_len > 0);
+    mqttdl->packet[pos++] = (uint8_t)(topic_len >> 8);
+    mqttdl->packet[pos++] = (uint8_t)topic_len;
+    memcpy(mqttdl->packet + pos, topic, topic_len);
+
+    memmove(&mqttdl->reply[0], &mqttdl->reply[1], (mqttdl->reply_num - 1) * sizeof(bench_mqttdl_reply_t));
+    mqttdl->reply_num--;
+
+    return 0;
+}
+
+static int32_t bench_mqttdl_recv(bench_mqttdl_conn_t *mqttdl, uint8_t *buffer, uint32_t len, uint32_t timeout_ms)
+{
+    uint64_t now = g_bench_portfile.core_sysdep_time();
+    uint32_t copy_len = 0;
+
+    if (mqttdl->packet == NULL) {
+        if (mqttdl->reply_num == 0) {
+            return 0;
+        }
+        /* 等待下一个回复到达, 最多等到读超时 */
+        if (mqttdl->reply[0].ready > now) {
+            if (mqttdl->reply[0].ready - now > timeout_ms) {
+                usleep(timeout_ms * 1000);
+                return 0;
+            }
+            usleep((mqttdl->reply[0].ready - now) * 1000);
+        }
+        if (bench_mqttdl_build(mqttdl) < 0) {
+            return STATE_PORT_MALLOC_FAILED;
+        }
+    }
+
+    copy_len = mqttdl->packet_len - mqttdl->packet_offset;
+    copy_len = (copy_len > len) ? (len) : (copy_len);
+    memcpy(buffer, mqttdl->packet + mqttdl->packet_offset, copy_len);
+    mqttdl->packet_offset += copy_len;
+    if (mqttdl->packet_offset == mqttdl->packet_len) {
+        free(mqttdl->packet);
+        mqttdl->packet = NULL;
+    }
+
+    return (int32_t)copy_len;
+}
+
+static void *bench_network_init(void)
+{
+    bench_network_t *network = malloc(sizeof(bench_network_t));
+    if (network == NULL) {
+        return NULL;
+    }
+    memset(network, 0, sizeof(bench_network_t));
+    return network;
+}
+
+static int32_t bench_network_setopt(void *handle, core_sysdep_network_option_t optname, void *data)
+{
+    bench_network_t *network = (bench_network_t *)handle;
+
+    /* 连往BENCH_HTTP_HOST的连接由模拟HTTP服务端处理 */
+    if (optname == CORE_SYSDEP_NETWORK_HOST && strcmp((char *)data, BENCH_HTTP_HOST) == 0 && network->http == NULL) {
+        network->http = malloc(sizeof(bench_http_conn_t));
+        if (network->http == NULL) {
+            return STATE_PORT_MALLOC_FAILED;
+        }
+        memset(network->http, 0, sizeof(bench_http_conn_t));
+    }
+    return STATE_SUCCESS;
+}
+
+static int32_t bench_network_establish(void *handle)
+{
+    bench_network_t *network = (bench_network_t *)handle;
+
+    if (g_bench_broker_up == 0) {
+        return STATE_PORT_NETWORK_CONNECT_FAILED;
+    }
+    /* TCP与TLS握手大约需要3个往返 */
+    if (network->http != NULL) {
+        g_bench_http_connects++;
+        usleep(3 * g_bench_http_rtt_ms * 1000);
+    }
+    return STATE_SUCCESS;
+}
+
+static int32_t bench_network_recv(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                  core_sysdep_addr_t *addr)
+{
+    bench_network_t *network = (bench_network_t *)handle;
+    uint32_t copy_len = network->pending_len - network->pending_offset;
+
+    if (network->http != NULL) {
+        return bench_http_recv(network->http, buffer, len, timeout_ms);
+    }
+    if (g_bench_broker_up == 0) {
+        return STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
+    }
+    if (copy_len == 0) {
+        if (g_bench_mdparse_replay.packet != NULL) {
+            return bench_mdparse_recv(buffer, len);
+        }
+        if (network->mqttdl != NULL) {
+            return bench_mqttdl_recv(network->mqttdl, buffer, len, timeout_ms);
+        }
+        /* 没有待接收的数据, 直接按读超时返回, 避免拖慢大量实例的轮询 */
+        return 0;
+    }
+    copy_len = (copy_len > len) ? (len) : (copy_len);
+    memcpy(buffer, network->pending + network->pending_offset, copy_len);
+    network->pending_offset += copy_len;
+
+    return (int32_t)copy_len;
+}
+
+static int32_t bench_network_send(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                  core_sysdep_addr_t *addr)
+{
+    bench_network_t *network = (bench_network_t *)handle;
+
+    if (network->http != NULL) {
+        if (network->http->closed == 1) {
+            return STATE_PORT_NETWORK_SEND_CONNECTION_CLOSED;
+        }
+        return bench_http_send(network->http, buffer, len);
+    }
+    if (g_bench_broker_up == 0) {
+        return STATE_PORT_NETWORK_SEND_CONNECTION_CLOSED;
+    }
+
+    /* CONNECT报文, 回复CONNACK(连接已接受), 并按服务端恢复后的秒数统计建连次数 */
+    if ((buffer[0] & 0xF0) == 0x10) {
+        uint64_t second = (g_bench_portfile.core_sysdep_time() - g_bench_broker_up_time) / 1000;
+        if (g_bench_broker_up_time != 0 && second < BENCH_STORM_WINDOW_S) {
+            g_bench_connect_hist[second]++;
+        }
+        network->pending[0] = 0x20;
+        network->pending[1] = 0x02;
+        network->pending[2] = 0x00;
+        network->pending[3] = 0x00;
+        network->pending_len = 4;
+        network->pending_offset = 0;
+    }
+    /* PUBLISH报文, 文件下载的分块请求交给模拟下载服务端 */
+    if (buffer[0] == 0x30) {
+        bench_mqttdl_request(network, buffer, len);
+    }
+
+    return (int32_t)len;
+}
+
+static int32_t bench_network_deinit(void **handle)
+{
+    if (handle == NULL || *handle == NULL) {
+        return STATE_PORT_INPUT_NULL_POINTER;
+    }
+    if (((bench_network_t *)*handle)->http != NULL) {
+        free(((bench_network_t *)*handle)->http);
+    }
+    if (((bench_network_t *)*handle)->mqttdl != NULL) {
+        if (((bench_network_t *)*handle)->mqttdl->packet != NULL) {
+            free(((bench_network_t *)*handle)->mqttdl->packet);
+        }
+        free(((bench_network_t *)*handle)->mqttdl);
+    }
+    free(*handle);
+    *handle = NULL;
+    return STATE_SUCCESS;
+}
+
+static void *bench_mqtt_create(void)
+{
+    void *mqtt_handle = NULL;
+    uint16_t port = 1883;
+    aiot_sysdep_network_cred_t cred;
+
+    memset(&cred, 0, sizeof(aiot_sysdep_network_cred_t));
+    cred.option = AIOT_SYSDEP_NETWORK_CRED_NONE;
+
+    mqtt_handle = aiot_mqtt_init();
+    if (mqtt_handle == NULL) {
+        return NULL;
+    }
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_HOST, (void *)"127.0.0.1");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_PORT, (void *)&port);
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_PRODUCT_KEY, (void *)"bench_pk");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_DEVICE_NAME, (void *)"bench_dn");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_DEVICE_SECRET, (void *)"bench_ds");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_NETWORK_CRED, (void *)&cred);
+
+    return mqtt_handle;
+}
+
+static void *bench_pub_thread(void *args)
+{
+    void *mqtt_handle = args;
+    char *pub_topic = "/sys/bench_pk/bench_dn/thing/event/property/post";
+    char *pub_payload = "{\"id\":\"1\",\"version\":\"1.0\",\"params\":{\"LightSwitch\":0}}";
+    uint32_t i = 0;
+
+    for (i = 0; i < BENCH_PUB_PER_THREAD; i++) {
+        if (aiot_mqtt_pub(mqtt_handle, pub_topic, (uint8_t *)pub_payload, (uint32_t)strlen(pub_payload), 0) < 0) {
+            printf("aiot_mqtt_pub failed\n");
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static int32_t bench_pub(void)
+{
+    void *mqtt_handle = NULL;
+    pthread_t threads[BENCH_MAX_THREADS];
+    uint32_t thread_num = 0, i = 0;
+    uint64_t time_start = 0, time_used = 0;
+    int32_t res = STATE_SUCCESS;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        printf("aiot_mqtt_init failed\n");
+        return -1;
+    }
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+
+    printf("pub bench, %d pub calls per thread\n", BENCH_PUB_PER_THREAD);
+    for (thread_num = 1; thread_num <= BENCH_MAX_THREADS; thread_num *= 2) {
+        time_start = g_bench_portfile.core_sysdep_time();
+        for (i = 0; i < thread_num; i++) {
+            pthread_create(&threads[i], NULL, bench_pub_thread, mqtt_handle);
+        }
+        for (i = 0; i < thread_num; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        time_used = g_bench_portfile.core_sysdep_time() - time_start;
+        if (time_used == 0) {
+            time_used = 1;
+        }
+        printf("  threads: %2d, time: %5" PRIu64 " ms, pub calls/s: %" PRIu64 "\n", thread_num, time_used,
+               (uint64_t)thread_num * BENCH_PUB_PER_THREAD * 1000 / time_used);
+    }
+
+    aiot_mqtt_disconnect(mqtt_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+/* 日志回调只统计输出的字节数, 不实际打印, 开启慢速模式时每条日志额外等待一段时间 */
+static uint64_t g_bench_log_bytes = 0;
+static uint8_t g_bench_log_slow = 0;
+static volatile uint8_t g_bench_log_drain_running = 0;
+
+static int32_t bench_log_cb(int32_t code, char *message)
+{
+    g_bench_log_bytes += strlen(message);
+    if (g_bench_log_slow) {
+        usleep(BENCH_SLOWLOG_DELAY_US);
+    }
+    return 0;
+}
+
+static void *bench_log_drain_thread(void *args)
+{
+    while (g_bench_log_drain_running) {
+        if (aiot_state_logbuf_drain() == 0) {
+            usleep(1000);
+        }
+    }
+    aiot_state_logbuf_drain();
+
+    return NULL;
+}
+
+static void bench_log_run(void *mqtt_handle, const char *name, uint32_t count)
+{
+    char *pub_topic = "/sys/bench_pk/bench_dn/thing/event/property/post";
+    char *pub_payload = "{\"id\":\"1\",\"version\":\"1.0\",\"params\":{\"LightSwitch\":0}}";
+    uint64_t time_start = 0, time_used = 0;
+    uint32_t i = 0;
+
+    g_bench_log_bytes = 0;
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < count; i++) {
+        aiot_mqtt_pub(mqtt_handle, pub_topic, (uint8_t *)pub_payload, (uint32_t)strlen(pub_payload), 0);
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+    printf("  %-40s time: %5" PRIu64 " ms, pub calls/s: %8" PRIu64 ", log bytes: %" PRIu64 "\n", name, time_used,
+           (uint64_t)count * 1000 / time_used, g_bench_log_bytes);
+}
+
+static int32_t bench_log(void)
+{
+    void *mqtt_handle = NULL;
+    int32_t res = STATE_SUCCESS;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        printf("aiot_mqtt_init failed\n");
+        return -1;
+    }
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+
+#ifdef CORE_LOG_DISABLED
+    printf("log bench, %d pub calls, logs compiled out\n", BENCH_PUB_PER_THREAD);
+#else
+    printf("log bench, %d pub calls\n", BENCH_PUB_PER_THREAD);
+#endif
+    aiot_state_set_logcb(NULL);
+    bench_log_run(mqtt_handle, "no log callback", BENCH_PUB_PER_THREAD);
+
+    aiot_state_set_logcb(bench_log_cb);
+    aiot_state_set_loglevel(AIOT_STATE_LOGLEVEL_INFO);
+    bench_log_run(mqtt_handle, "log callback, level INFO", BENCH_PUB_PER_THREAD);
+
+    aiot_state_set_loglevel(AIOT_STATE_LOGLEVEL_DEBUG);
+    aiot_state_set_logmask(AIOT_STATE_LOGMASK_ALL & ~AIOT_STATE_LOGMASK(STATE_MQTT_BASE));
+    bench_log_run(mqtt_handle, "log callback, level DEBUG, MQTT masked", BENCH_PUB_PER_THREAD);
+
+    aiot_state_set_logmask(AIOT_STATE_LOGMASK_ALL);
+    bench_log_run(mqtt_handle, "log callback, level DEBUG", BENCH_PUB_PER_THREAD);
+
+    aiot_state_set_logcb(NULL);
+    aiot_mqtt_disconnect(mqtt_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+static int32_t bench_logbuf(void)
+{
+    void *mqtt_handle = NULL;
+    pthread_t drain_thread;
+    int32_t res = STATE_SUCCESS;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        printf("aiot_mqtt_init failed\n");
+        return -1;
+    }
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+
+    printf("slow log sink bench, %d pub calls, %d us per log line\n", BENCH_SLOWLOG_PUB_COUNT, BENCH_SLOWLOG_DELAY_US);
+    aiot_state_set_logcb(bench_log_cb);
+    aiot_state_set_loglevel(AIOT_STATE_LOGLEVEL_DEBUG);
+    g_bench_log_slow = 1;
+    bench_log_run(mqtt_handle, "synchronous log callback", BENCH_SLOWLOG_PUB_COUNT);
+
+    res = aiot_state_set_logbuf(BENCH_LOGBUF_SIZE);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_state_set_logbuf failed: -0x%04X\n", -res);
+    } else {
+        g_bench_log_drain_running = 1;
+        pthread_create(&drain_thread, NULL, bench_log_drain_thread, NULL);
+        bench_log_run(mqtt_handle, "log buffer + drain thread", BENCH_SLOWLOG_PUB_COUNT);
+        g_bench_log_drain_running = 0;
+        pthread_join(drain_thread, NULL);
+        printf("  %-40s delivered log bytes: %" PRIu64 ", dropped records: %d\n", "", g_bench_log_bytes,
+               aiot_state_logbuf_dropped());
+        aiot_state_set_logbuf(0);
+    }
+
+    g_bench_log_slow = 0;
+    aiot_state_set_logcb(NULL);
+    aiot_mqtt_disconnect(mqtt_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+static int32_t bench_dm_run(void *dm_handle, uint32_t params_len)
+{
+    aiot_dm_msg_t msg;
+    char *params = NULL;
+    uint64_t time_start = 0, time_used = 0;
+    uint32_t i = 0;
+
+    /* 形如{"LightSwitch":0,"LightSwitch":0,...}的属性列表 */
+    params = malloc(params_len + 1);
+    if (params == NULL) {
+        return -1;
+    }
+    for (i = 0; i < params_len; i++) {
+        params[i] = "\"LightSwitch\":0,"[i % 16];
+    }
+    params[0] = '{';
+    params[params_len - 1] = '}';
+    params[params_len] = '\0';
+
+    memset(&msg, 0, sizeof(aiot_dm_msg_t));
+    msg.type = AIOT_XJTDMMSG_PROPERTY_POST;
+    msg.data.property_post.params = params;
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_DM_POST_COUNT; i++) {
+        if (aiot_dm_send(dm_handle, &msg) < 0) {
+            printf("aiot_dm_send failed\n");
+            break;
+        }
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+    printf("  params: %5d bytes, time: %5" PRIu64 " ms, posts/s: %" PRIu64 "\n", params_len, time_used,
+           (uint64_t)BENCH_DM_POST_COUNT * 1000 / time_used);
+
+    free(params);
+    return 0;
+}
+
+static int32_t bench_dm(void)
+{
+    void *mqtt_handle = NULL, *dm_handle = NULL;
+    uint32_t params_len[] = { 64, 256, 1024, 4096 };
+    uint32_t i = 0;
+    int32_t res = STATE_SUCCESS;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        printf("aiot_mqtt_init failed\n");
+        return -1;
+    }
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+
+    dm_handle = aiot_dm_init();
+    if (dm_handle == NULL) {
+        printf("aiot_dm_init failed\n");
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+    aiot_dm_setopt(dm_handle, AIOT_DMOPT_MQTT_HANDLE, mqtt_handle);
+
+    printf("dm bench, %d property posts per case\n", BENCH_DM_POST_COUNT);
+    for (i = 0; i < sizeof(params_len) / sizeof(params_len[0]); i++) {
+        if (bench_dm_run(dm_handle, params_len[i]) < 0) {
+            break;
+        }
+    }
+
+    aiot_dm_deinit(&dm_handle);
+    aiot_mqtt_disconnect(mqtt_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+static const char *g_bench_json_ota =
+    "{\"code\":\"1000\",\"data\":{\"size\":432945,\"version\":\"2.0.0\",\"isDiff\":1,"
+    "\"url\":\"https://ota-cn-shanghai.oss-cn-shanghai.aliyuncs.com/ota/firmware/app.bin?Expires=1607333213"
+    "&OSSAccessKeyId=cS8uRRy54RszYWna&Signature=xYj6a%2BrmbPQ8Gub%2F7xtQx1VwO3o%3D\","
+    "\"md5\":\"93230c3bde425a9d7984a594ac55ea1e\",\"sign\":\"93230c3bde425a9d7984a594ac55ea1e\","
+    "\"signMethod\":\"Md5\",\"module\":\"default\",\"extData\":{\"key1\":\"value1\",\"key2\":\"value2\"}},"
+    "\"id\":1507707025,\"message\":\"success\"}";
+static const char *g_bench_json_ota_keys[] = {
+    "data", "version", "signMethod", "dProtocol", "module", "extData", "files", "size", "sign", "url"
+};
+
+static const char *g_bench_json_dm =
+    "{\"id\":\"123456\",\"serviceId\":\"property\",\"eid\":\"eid_0001\","
+    "\"params\":{\"LightSwitch\":1,\"Brightness\":80,\"ColorTemperature\":4000,"
+    "\"WorkMode\":{\"mode\":2,\"timer\":[30,60,90]}},\"version\":\"1.0\",\"method\":\"thing.service.property.set\"}";
+static const char *g_bench_json_dm_keys[] = {
+    "id", "serviceId", "eid", "params"
+};
+
+static void bench_json_run(const char *name, const char *payload, const char *keys[], uint32_t key_num)
+{
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
+    uint32_t payload_len = (uint32_t)strlen(payload), i = 0, j = 0, found = 0;
+    uint64_t time_start = 0, time_scan = 0, time_index = 0;
+    char *value = NULL;
+    uint32_t value_len = 0;
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_JSON_PARSE_COUNT; i++) {
+        for (j = 0; j < key_num; j++) {
+            found += (core_json_value(payload, payload_len, keys[j], (uint32_t)strlen(keys[j]), &value,
+                                      &value_len) == STATE_SUCCESS);
+        }
+    }
+    time_scan = g_bench_portfile.core_sysdep_time() - time_start;
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_JSON_PARSE_COUNT; i++) {
+        core_json_index(&index, payload, payload_len, tokens, CORE_JSON_INDEX_TOKENS);
+        for (j = 0; j < key_num; j++) {
+            found -= (core_json_index_value(&index, keys[j], (uint32_t)strlen(keys[j]), &value,
+                                            &value_len) == STATE_SUCCESS);
+        }
+    }
+    time_index = g_bench_portfile.core_sysdep_time() - time_start;
+
+    printf("  %-4s %4d bytes, %2d keys, core_json_value: %5" PRIu64 " ms, core_json_index: %5" PRIu64 " ms%s\n",
+           name, payload_len, key_num, time_scan, time_index, (found == 0) ? "" : " (result mismatch)");
+}
+
+static int32_t bench_json(void)
+{
+    printf("json bench, %d messages per case\n", BENCH_JSON_PARSE_COUNT);
+    bench_json_run("ota", g_bench_json_ota, g_bench_json_ota_keys,
+                   sizeof(g_bench_json_ota_keys) / sizeof(g_bench_json_ota_keys[0]));
+    bench_json_run("dm", g_bench_json_dm, g_bench_json_dm_keys,
+                   sizeof(g_bench_json_dm_keys) / sizeof(g_bench_json_dm_keys[0]));
+
+    return 0;
+}
+
+static uint32_t g_bench_malloc_count = 0;
+
+static void *bench_counting_malloc(uint32_t size, char *name)
+{
+    g_bench_malloc_count++;
+    return g_aiot_sysdep_portfile.core_sysdep_malloc(size, name);
+}
+
+static int32_t bench_subdev(void)
+{
+    void *mqtt_handle = NULL, *subdev_handle = NULL;
+    aiot_subdev_dev_t *dev = NULL;
+    char (*device_name)[32] = NULL;
+    const char *name[] = { "topo_add", "batch_login", "topo_delete" };
+    uint64_t time_start = 0, time_used = 0;
+    uint32_t i = 0, op = 0, malloc_count = 0;
+    int32_t res = STATE_SUCCESS;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        printf("aiot_mqtt_init failed\n");
+        return -1;
+    }
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+    subdev_handle = aiot_subdev_init();
+    aiot_subdev_setopt(subdev_handle, AIOT_SUBDEVOPT_MQTT_HANDLE, mqtt_handle);
+
+    dev = malloc(sizeof(aiot_subdev_dev_t) * BENCH_SUBDEV_NUM);
+    device_name = malloc(sizeof(*device_name) * BENCH_SUBDEV_NUM);
+    for (i = 0; i < BENCH_SUBDEV_NUM; i++) {
+        snprintf(device_name[i], sizeof(device_name[i]), "bench_subdev_%04d", i);
+        dev[i].product_key = "bench_sub_pk";
+        dev[i].device_name = device_name[i];
+        dev[i].device_secret = "d5ZJCEXBf6rUvt5ugZrwmKY1J3Ha4qd7";
+        dev[i].product_secret = NULL;
+    }
+
+    printf("subdev bench, %d sub-devices per operation\n", BENCH_SUBDEV_NUM);
+    /* SDK内部使用的是portfile的副本, 修改后需要重新设置 */
+    g_bench_portfile.core_sysdep_malloc = bench_counting_malloc;
+    aiot_sysdep_set_portfile(&g_bench_portfile);
+    for (op = 0; op < sizeof(name) / sizeof(name[0]); op++) {
+        g_bench_malloc_count = 0;
+        time_start = g_bench_portfile.core_sysdep_time();
+        for (i = 0; i < BENCH_SUBDEV_ROUNDS; i++) {
+            if (op == 0) {
+                res = aiot_subdev_send_topo_add(subdev_handle, dev, BENCH_SUBDEV_NUM);
+            } else if (op == 1) {
+                res = aiot_subdev_send_batch_login(subdev_handle, dev, BENCH_SUBDEV_NUM);
+            } else {
+                res = aiot_subdev_send_topo_delete(subdev_handle, dev, BENCH_SUBDEV_NUM);
+            }
+            if (res < STATE_SUCCESS) {
+                printf("%s failed: -0x%04X\n", name[op], -res);
+                break;
+            }
+        }
+        time_used = g_bench_portfile.core_sysdep_time() - time_start;
+        malloc_count = g_bench_malloc_count;
+        printf("  %-12s mallocs/op: %5d, time/op: %" PRIu64 " us\n", name[op], malloc_count / BENCH_SUBDEV_ROUNDS,
+               time_used * 1000 / BENCH_SUBDEV_ROUNDS);
+    }
+    g_bench_portfile.core_sysdep_malloc = g_aiot_sysdep_portfile.core_sysdep_malloc;
+    aiot_sysdep_set_portfile(&g_bench_portfile);
+
+    free(device_name);
+    free(dev);
+    aiot_subdev_deinit(&subdev_handle);
+    aiot_mqtt_disconnect(mqtt_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+static void bench_sha_report(const char *name, uint64_t bytes, uint64_t time_used)
+{
+    if (time_used == 0) {
+        time_used = 1;
+    }
+    printf("  %-28s time: %5" PRIu64 " ms, MB/s: %6" PRIu64 "\n", name, time_used, bytes * 1000 / time_used / (1024 * 1024));
+}
+
+static void bench_sha_run(const char *impl_name, uint8_t *buffer)
+{
+    const uint8_t *input[CORE_SHA256_LANES];
+    uint32_t ilen[CORE_SHA256_LANES];
+    uint8_t output[CORE_SHA256_LANES][32];
+    char name[32] = {0};
+    uint64_t time_start = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < CORE_SHA256_LANES; i++) {
+        input[i] = buffer + i * (BENCH_SHA_BUFFER_LEN / CORE_SHA256_LANES);
+        ilen[i] = BENCH_SHA_BUFFER_LEN / CORE_SHA256_LANES;
+    }
+
+    snprintf(name, sizeof(name), "sha256 %s single", impl_name);
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_SHA_ROUNDS; i++) {
+        core_sha256(buffer, BENCH_SHA_BUFFER_LEN, output[0]);
+    }
+    bench_sha_report(name, (uint64_t)BENCH_SHA_BUFFER_LEN * BENCH_SHA_ROUNDS,
+                     g_bench_portfile.core_sysdep_time() - time_start);
+
+    snprintf(name, sizeof(name), "sha256 %s %d-lane multi", impl_name, CORE_SHA256_LANES);
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_SHA_ROUNDS; i++) {
+        core_sha256_multi(input, ilen, output, CORE_SHA256_LANES);
+    }
+    bench_sha_report(name, (uint64_t)BENCH_SHA_BUFFER_LEN * BENCH_SHA_ROUNDS,
+                     g_bench_portfile.core_sysdep_time() - time_start);
+}
+
+static void bench_hmac_run(const char *impl_name)
+{
+    uint8_t msg[CORE_SHA256_LANES][BENCH_HMAC_MSG_LEN];
+    const uint8_t *msg_ptr[CORE_SHA256_LANES], *key_ptr[CORE_SHA256_LANES];
+    uint32_t msg_len[CORE_SHA256_LANES], key_len[CORE_SHA256_LANES];
+    uint8_t output[CORE_SHA256_LANES][32];
+    const char *key = "d5ZJCEXBf6rUvt5ugZrwmKY1J3Ha4qd7";
+    uint64_t time_start = 0, time_single = 0, time_multi = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < CORE_SHA256_LANES; i++) {
+        memset(msg[i], 'a' + i, BENCH_HMAC_MSG_LEN);
+        msg_ptr[i] = msg[i];
+        msg_len[i] = BENCH_HMAC_MSG_LEN;
+        key_ptr[i] = (const uint8_t *)key;
+        key_len[i] = (uint32_t)strlen(key);
+    }
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_HMAC_COUNT; i++) {
+        core_hmac_sha256(msg[i % CORE_SHA256_LANES], BENCH_HMAC_MSG_LEN, (uint8_t *)key, key_len[0],
+                         output[i % CORE_SHA256_LANES]);
+    }
+    time_single = g_bench_portfile.core_sysdep_time() - time_start;
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_HMAC_COUNT; i += CORE_SHA256_LANES) {
+        core_hmac_sha256_multi(msg_ptr, msg_len, key_ptr, key_len, output, CORE_SHA256_LANES);
+    }
+    time_multi = g_bench_portfile.core_sysdep_time() - time_start;
+
+    printf("  hmac %-3s %d bytes x %d, single: %5" PRIu64 " ms, %d-lane multi: %5" PRIu64 " ms\n", impl_name,
+           BENCH_HMAC_MSG_LEN, BENCH_HMAC_COUNT, time_single, CORE_SHA256_LANES, time_multi);
+}
+
+static int32_t bench_sha(void)
+{
+    uint8_t *buffer = NULL, output[16];
+    uint64_t time_start = 0;
+    uint32_t i = 0;
+
+    buffer = malloc(BENCH_SHA_BUFFER_LEN);
+    if (buffer == NULL) {
+        return -1;
+    }
+    for (i = 0; i < BENCH_SHA_BUFFER_LEN; i++) {
+        buffer[i] = (uint8_t)(i * 131);
+    }
+
+    printf("digest bench, %d MB per case, hardware: %s\n", BENCH_SHA_BUFFER_LEN * BENCH_SHA_ROUNDS / (1024 * 1024),
+           (core_sha256_set_impl(CORE_SHA256_IMPL_HW) == STATE_SUCCESS) ? core_sha256_impl_name() : "none");
+
+    core_sha256_set_impl(CORE_SHA256_IMPL_C);
+    bench_sha_run("c", buffer);
+    bench_hmac_run("c");
+    if (core_sha256_set_impl(CORE_SHA256_IMPL_HW) == STATE_SUCCESS) {
+        bench_sha_run("hw", buffer);
+        bench_hmac_run("hw");
+    }
+    core_sha256_set_impl(CORE_SHA256_IMPL_AUTO);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_SHA_ROUNDS; i++) {
+        core_md5(buffer, BENCH_SHA_BUFFER_LEN, output);
+    }
+    bench_sha_report("md5", (uint64_t)BENCH_SHA_BUFFER_LEN * BENCH_SHA_ROUNDS,
+                     g_bench_portfile.core_sysdep_time() - time_start);
+
+    free(buffer);
+
+    return 0;
+}
+
+static int32_t bench_crc(void)
+{
+    uint8_t *buffer = NULL;
+    const char *check = "123456789";
+    core_crc16_context_t ctx;
+    uint64_t time_start = 0, time_used = 0;
+    uint32_t i = 0, offset = 0, chunk = 1;
+    uint16_t crc = 0, mismatch = 0;
+
+    buffer = malloc(BENCH_CRC_BLOCK_LEN);
+    if (buffer == NULL) {
+        return -1;
+    }
+    for (i = 0; i < BENCH_CRC_BLOCK_LEN; i++) {
+        buffer[i] = (uint8_t)(i * 131);
+    }
+
+    /* CRC-16/ARC的标准校验值, 以及分段计算与一次计算的结果必须一致 */
+    mismatch |= (core_crc16((const uint8_t *)check, (uint32_t)strlen(check)) != 0xBB3D);
+    core_crc16_init(&ctx);
+    for (offset = 0; offset < BENCH_CRC_BLOCK_LEN; offset += chunk, chunk = chunk * 3 % 61 + 1) {
+        core_crc16_update(&ctx, buffer + offset, (BENCH_CRC_BLOCK_LEN - offset < chunk) ? (BENCH_CRC_BLOCK_LEN - offset) : chunk);
+    }
+    mismatch |= (core_crc16_finish(&ctx) != core_crc16(buffer, BENCH_CRC_BLOCK_LEN));
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_CRC_BLOCKS; i++) {
+        crc += core_crc16(buffer, BENCH_CRC_BLOCK_LEN);
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+
+    printf("crc16 bench, %d bytes per block\n", BENCH_CRC_BLOCK_LEN);
+    printf("  %d blocks, time: %5" PRIu64 " ms, MB/s: %6" PRIu64 ", sum: 0x%04X%s\n", BENCH_CRC_BLOCKS, time_used,
+           (uint64_t)BENCH_CRC_BLOCK_LEN * BENCH_CRC_BLOCKS * 1000 / time_used / (1024 * 1024), crc,
+           mismatch ? " (vector mismatch)" : "");
+
+    free(buffer);
+
+    return 0;
+}
+
+static void bench_string_report(const char *name, uint64_t time_start, uint32_t sink)
+{
+    uint64_t time_used = g_bench_portfile.core_sysdep_time() - time_start;
+
+    printf("  %-28s %6" PRIu64 " ns/call (%u)\n", name, time_used * 1000000 / BENCH_STRING_COUNT, sink & 0xFF);
+}
+
+static int32_t bench_string(void)
+{
+    char output[80] = {0};
+    uint8_t digest[32] = {0}, output_len = 0;
+    uint64_t time_start = 0, utc = 1600000000000ULL;
+    core_date_t date;
+    uint32_t i = 0, sink = 0;
+
+    for (i = 0; i < sizeof(digest); i++) {
+        digest[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    printf("string bench, %d calls per case\n", BENCH_STRING_COUNT);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        core_uint2str(i * 2654435761U, output, &output_len);
+        sink += output_len + output[0];
+    }
+    bench_string_report("core_uint2str", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        core_uint642str(utc + i, output, &output_len);
+        sink += output_len + output[12];
+    }
+    bench_string_report("core_uint642str (timestamp)", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        core_int2str((int32_t)(i * 2654435761U), output, &output_len);
+        sink += output_len + output[0];
+    }
+    bench_string_report("core_int2str", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        digest[0] = (uint8_t)i;
+        core_hex2str(digest, sizeof(digest), output, 0);
+        sink += output[1];
+    }
+    bench_string_report("core_hex2str (32 bytes)", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        output[1] = "0123456789abcdef"[i & 0x0F];
+        core_str2hex(output, sizeof(digest) * 2, digest);
+        sink += digest[0];
+    }
+    bench_string_report("core_str2hex (64 chars)", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        core_utc2date(utc + (uint64_t)i * 1000003, 8, &date);
+        sink += date.year + date.day;
+    }
+    bench_string_report("core_utc2date", time_start, sink);
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_STRING_COUNT; i++) {
+        output[0] = '\0';
+        _core_log_append_date(&g_bench_portfile, utc + i / 64, output);
+        sink += output[5];
+    }
+    bench_string_report("log date prefix", time_start, sink);
+
+    return 0;
+}
+
+static int32_t bench_http_run(const char *name, uint8_t auth_each, uint8_t long_connection, uint32_t batch,
+                              uint32_t window)
+{
+    void *http_handle = NULL;
+    char *topic = "/a1bench/bench-device/user/update";
+    char *payload = "{\"id\":\"1\",\"params\":{\"temperature\":23.5,\"humidity\":61}}";
+    aiot_http_msg_t msgs[CORE_HTTP_PIPELINE_WINDOW_MAX];
+    uint64_t time_start = 0, time_used = 0;
+    uint32_t i = 0, j = 0, acked = 0;
+    int32_t res = STATE_SUCCESS;
+
+    http_handle = aiot_http_init();
+    if (http_handle == NULL) {
+        return -1;
+    }
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_HOST, (void *)BENCH_HTTP_HOST);
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_PRODUCT_KEY, (void *)"a1bench");
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_DEVICE_NAME, (void *)"bench-device");
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_DEVICE_SECRET, (void *)"0123456789abcdef0123456789abcdef");
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_LONG_CONNECTION, &long_connection);
+    aiot_http_setopt(http_handle, AIOT_HTTPOPT_PIPELINE_WINDOW, &window);
+
+    /* 缓存token的场景先认证一次, 不计入统计 */
+    if (auth_each == 0 && aiot_http_auth(http_handle) < STATE_SUCCESS) {
+        aiot_http_deinit(&http_handle);
+        return -1;
+    }
+    g_bench_http_connects = 0;
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (i = 0; i < BENCH_HTTP_MSG_COUNT; i += batch) {
+        if (batch > 1) {
+            for (j = 0; j < batch; j++) {
+                msgs[j].topic = topic;
+                msgs[j].payload = (uint8_t *)payload;
+                msgs[j].payload_len = (uint32_t)strlen(payload);
+            }
+            res = aiot_http_send_batch(http_handle, msgs, batch);
+            if (res > 0) {
+                acked += (uint32_t)res;
+            }
+            continue;
+        }
+        if (auth_each == 1 && aiot_http_auth(http_handle) < STATE_SUCCESS) {
+            continue;
+        }
+        if (aiot_http_send(http_handle, topic, (uint8_t *)payload, (uint32_t)strlen(payload)) >= STATE_SUCCESS &&
+            aiot_http_recv(http_handle) > 0) {
+            acked++;
+        }
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+
+    printf("  %-36s acked: %3d/%d, connects: %3d, time: %5" PRIu64 " ms, msgs/s: %6" PRIu64 "\n", name, acked,
+           BENCH_HTTP_MSG_COUNT, g_bench_http_connects, time_used, (uint64_t)acked * 1000 / time_used);
+
+    aiot_http_deinit(&http_handle);
+
+    return 0;
+}
+
+static int32_t bench_http(void)
+{
+    printf("http report bench, rtt %d ms, connect %d ms, %d messages\n", BENCH_HTTP_RTT_MS, BENCH_HTTP_CONNECT_MS,
+           BENCH_HTTP_MSG_COUNT);
+
+    if (bench_http_run("reconnect + auth per message", 1, 0, 1, 1) < 0 ||
+        bench_http_run("cached token, reconnect per message", 0, 0, 1, 1) < 0 ||
+        bench_http_run("cached token, persistent connection", 0, 1, 1, 1) < 0 ||
+        bench_http_run("batch of 8, sequential", 0, 1, 8, 1) < 0 ||
+        bench_http_run("batch of 8, pipelined", 0, 1, 8, CORE_HTTP_PIPELINE_WINDOW_MAX) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* 固件下载的接收回调, 检查内容是否按顺序交付 */
+typedef struct {
+    uint32_t offset;
+    uint32_t mismatch;
+    int32_t  percent;
+    uint32_t write_us_per_mb;   /* 模拟写flash时阻塞等待的时间, 等待期间不占用CPU */
+    uint32_t write_pending_us;
+    uint32_t reboot_at;         /* 交付到该位置时模拟设备重启, 中止下载 */
+    aiot_download_checkpoint_t checkpoint;
+    uint32_t checkpoints;
+} bench_ota_context_t;
+
+/* 模拟把断点记录写入非易失存储 */
+static void bench_ota_checkpoint_handler(void *handle, const aiot_download_checkpoint_t *checkpoint, void *userdata)
+{
+    bench_ota_context_t *context = (bench_ota_context_t *)userdata;
+
+    memcpy(&context->checkpoint, checkpoint, sizeof(aiot_download_checkpoint_t));
+    context->checkpoints++;
+}
+
+static void bench_ota_recv_handler(void *handle, const aiot_download_recv_t *packet, void *userdata)
+{
+    bench_ota_context_t *context = (bench_ota_context_t *)userdata;
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < packet->data.len; idx++) {
+        if (packet->data.buffer[idx] != bench_ota_byte(context->offset + idx)) {
+            context->mismatch++;
+            break;
+        }
+    }
+    context->offset += packet->data.len;
+    context->percent = packet->data.percent;
+
+    /* 累计到一定时长再休眠, 避免usleep自身的开销随回调次数放大 */
+    context->write_pending_us += (uint32_t)((uint64_t)packet->data.len * context->write_us_per_mb / (1024 * 1024));
+    if (context->write_pending_us >= 100) {
+        usleep(context->write_pending_us);
+        context->write_pending_us = 0;
+    }
+}
+
+static void *bench_ota_init(char *digest, bench_ota_context_t *context)
+{
+    void *dl_handle = NULL;
+    aiot_download_task_desc_t task_desc;
+
+    memset(&task_desc, 0, sizeof(aiot_download_task_desc_t));
+    task_desc.url = "http://" BENCH_HTTP_HOST "/firmware.bin";
+    task_desc.size_total = g_bench_ota_firmware_len;
+    task_desc.digest_method = AIOT_OTA_DIGEST_MD5;
+    task_desc.expect_digest = digest;
+    memset(context, 0, sizeof(bench_ota_context_t));
+
+    dl_handle = aiot_download_init();
+    if (dl_handle == NULL) {
+        return NULL;
+    }
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_TASK_DESC, &task_desc);
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_RECV_HANDLER, (void *)bench_ota_recv_handler);
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_USERDATA, context);
+
+    return dl_handle;
+}
+
+/* 下载整个固件, 返回断点续传的次数 */
+static uint32_t bench_ota_download(void *dl_handle, bench_ota_context_t *context)
+{
+    uint32_t renewals = 0;
+    int32_t res = STATE_SUCCESS;
+
+    res = aiot_download_send_request(dl_handle);
+    while ((res >= STATE_SUCCESS || res == STATE_DOWNLOAD_RENEWAL_REQUEST_SENT || res == STATE_DOWNLOAD_RECV_ERROR) &&
+           (context->reboot_at == 0 || context->offset < context->reboot_at)) {
+        res = aiot_download_recv(dl_handle);
+        if (res == STATE_DOWNLOAD_RENEWAL_REQUEST_SENT) {
+            renewals++;
+        }
+        if (res == STATE_DOWNLOAD_FINISHED) {
+            break;
+        }
+        /* 单连接下载出错后, 下一次aiot_download_recv会发起断点续传 */
+        if (res < STATE_SUCCESS && res != STATE_DOWNLOAD_RENEWAL_REQUEST_SENT) {
+            res = STATE_DOWNLOAD_RECV_ERROR;
+        }
+    }
+
+    return renewals;
+}
+
+static int32_t bench_ota_run(const char *name, uint32_t segment_num, char *digest, uint32_t reset_at)
+{
+    void *dl_handle = NULL;
+    bench_ota_context_t context;
+    uint32_t renewals = 0;
+    uint64_t time_start = 0, time_used = 0;
+
+    dl_handle = bench_ota_init(digest, &context);
+    if (dl_handle == NULL) {
+        return -1;
+    }
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_SEGMENT_NUM, &segment_num);
+
+    g_bench_http_connects = 0;
+    g_bench_ota_reset_at = reset_at;
+    time_start = g_bench_portfile.core_sysdep_time();
+    renewals = bench_ota_download(dl_handle, &context);
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+
+    printf("  %-28s connects: %2d, renewals: %d, time: %5" PRIu64 " ms, KB/s: %6" PRIu64 ", %s\n", name,
+           g_bench_http_connects, renewals, time_used, (uint64_t)context.offset * 1000 / 1024 / time_used,
+           (context.offset == BENCH_OTA_FIRMWARE_LEN && context.mismatch == 0 && context.percent == 100) ? "digest ok" :
+           "FAILED");
+
+    aiot_download_deinit(&dl_handle);
+
+    return 0;
+}
+
+/* 下载到reboot_at时丢弃下载实例, 再用新的实例从保存的断点记录继续下载, 统计重启后重新下载的字节数 */
+static int32_t bench_ota_resume_run(const char *name, uint32_t segment_num, char *digest, uint32_t reboot_at)
+{
+    void *dl_handle = NULL;
+    bench_ota_context_t context;
+    aiot_download_checkpoint_t checkpoint;
+    uint32_t resumed_at = 0;
+    uint64_t time_start = 0, time_used = 0;
+    int32_t res = STATE_SUCCESS;
+
+    dl_handle = bench_ota_init(digest, &context);
+    if (dl_handle == NULL) {
+        return -1;
+    }
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_SEGMENT_NUM, &segment_num);
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_CHECKPOINT_HANDLER, (void *)bench_ota_checkpoint_handler);
+    context.reboot_at = reboot_at;
+
+    g_bench_http_connects = 0;
+    time_start = g_bench_portfile.core_sysdep_time();
+    bench_ota_download(dl_handle, &context);
+    memcpy(&checkpoint, &context.checkpoint, sizeof(aiot_download_checkpoint_t));
+    aiot_download_deinit(&dl_handle);
+
+    /* 重启后只剩下非易失存储中的断点记录 */
+    dl_handle = bench_ota_init(digest, &context);
+    if (dl_handle == NULL) {
+        return -1;
+    }
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_SEGMENT_NUM, &segment_num);
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_CHECKPOINT_HANDLER, (void *)bench_ota_checkpoint_handler);
+    res = aiot_download_setopt(dl_handle, AIOT_DLOPT_CHECKPOINT_RESUME, &checkpoint);
+    if (res == STATE_SUCCESS) {
+        resumed_at = checkpoint.offset;
+        context.offset = checkpoint.offset;
+    }
+    bench_ota_download(dl_handle, &context);
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+
+    printf("  %-28s connects: %2d, resumed at %4d KB, time: %5" PRIu64 " ms, %s\n", name, g_bench_http_connects,
+           resumed_at / 1024, time_used,
+           (res == STATE_SUCCESS && context.offset == BENCH_OTA_FIRMWARE_LEN && context.mismatch == 0 &&
+            context.percent == 100) ? "digest ok" : "FAILED");
+
+    aiot_download_deinit(&dl_handle);
+
+    return 0;
+}
+
+/* 计算模拟固件的MD5, 作为下载任务中的期望值 */
+static int32_t bench_ota_digest(uint32_t firmware_len, char digest[33])
+{
+    uint8_t *buffer = NULL, output[16];
+    uint32_t idx = 0, offset = 0;
+    core_md5_context_t ctx;
+
+    buffer = malloc(BENCH_OTA_WINDOW);
+    if (buffer == NULL) {
+        return -1;
+    }
+    core_md5_init(&ctx);
+    core_md5_starts(&ctx);
+    for (offset = 0; offset < firmware_len; offset += BENCH_OTA_WINDOW) {
+        for (idx = 0; idx < BENCH_OTA_WINDOW; idx++) {
+            buffer[idx] = bench_ota_byte(offset + idx);
+        }
+        core_md5_update(&ctx, buffer, BENCH_OTA_WINDOW);
+    }
+    core_md5_finish(&ctx, output);
+    core_md5_free(&ctx);
+    core_hex2str(output, sizeof(output), digest, 1);
+    free(buffer);
+
+    return 0;
+}
+
+static int32_t bench_ota(void)
+{
+    char digest[33];
+
+    if (bench_ota_digest(BENCH_OTA_FIRMWARE_LEN, digest) < 0) {
+        return -1;
+    }
+
+    printf("ota download bench, rtt %d ms, %d KB window per connection, %d KB firmware\n", BENCH_OTA_RTT_MS,
+           BENCH_OTA_WINDOW / 1024, BENCH_OTA_FIRMWARE_LEN / 1024);
+
+    g_bench_http_rtt_ms = BENCH_OTA_RTT_MS;
+    bench_ota_run("1 connection", 1, digest, 0);
+    bench_ota_run("2 segments", 2, digest, 0);
+    bench_ota_run("4 segments", 4, digest, 0);
+    bench_ota_run("8 segments", 8, digest, 0);
+    bench_ota_run("4 segments, one reset", 4, digest, BENCH_OTA_FIRMWARE_LEN / 3);
+    g_bench_ota_no_range = 1;
+    bench_ota_run("4 segments, no Range support", 4, digest, 0);
+    g_bench_ota_no_range = 0;
+    bench_ota_resume_run("1 connection, reboot at 60%", 1, digest, BENCH_OTA_FIRMWARE_LEN / 10 * 6);
+    bench_ota_resume_run("4 segments, reboot at 60%", 4, digest, BENCH_OTA_FIRMWARE_LEN / 10 * 6);
+    g_bench_http_rtt_ms = BENCH_HTTP_RTT_MS;
+
+    return 0;
+}
+
+static void bench_mqttdl_recv_handler(void *handle, const aiot_mqtt_download_recv_t *packet, void *userdata)
+{
+    bench_ota_context_t *context = (bench_ota_context_t *)userdata;
+    uint32_t idx = 0;
+
+    if (packet->type != AIOT_MDRECV_DATA_RESP) {
+        return;
+    }
+    for (idx = 0; idx < packet->data.data_resp.data_size; idx++) {
+        if ((uint8_t)packet->data.data_resp.data[idx] != bench_ota_byte(context->offset + idx)) {
+            context->mismatch++;
+            break;
+        }
+    }
+    context->offset += packet->data.data_resp.data_size;
+    context->percent = packet->data.data_resp.percent;
+}
+
+static int32_t bench_mqttdl_run(const char *name, char *digest, uint32_t window_size, uint32_t request_size,
+                                uint8_t adaptive, uint32_t block_timeout_ms, uint32_t drop_at)
+{
+    void *mqtt_handle = NULL, *md_handle = NULL;
+    aiot_download_task_desc_t task_desc;
+    aiot_mqtt_download_stats_t stats;
+    bench_ota_context_t context;
+    int32_t res = STATE_SUCCESS;
+    uint64_t time_start = 0, time_used = 0;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        return -1;
+    }
+    if (aiot_mqtt_connect(mqtt_handle) < STATE_SUCCESS) {
+        aiot_mqtt_deinit(&mqtt_handle);
+        return -1;
+    }
+
+    memset(&task_desc, 0, sizeof(aiot_download_task_desc_t));
+    task_desc.size_total = g_bench_mqttdl_file_len;
+    task_desc.digest_method = AIOT_OTA_DIGEST_MD5;
+    task_desc.expect_digest = digest;
+    task_desc.mqtt_handle = mqtt_handle;
+    memset(&context, 0, sizeof(bench_ota_context_t));
+
+    md_handle = aiot_mqtt_download_init();
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_TASK_DESC, &task_desc);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_RECV_HANDLE, (void *)bench_mqttdl_recv_handler);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_USERDATA, &context);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_WINDOW_SIZE, &window_size);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_DATA_REQUEST_SIZE, &request_size);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BLOCK_TIMEOUT_MS, &block_timeout_ms);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_ADAPTIVE, &adaptive);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BINARY_HEADER, &g_bench_mqttdl_binary);
+
+    g_bench_mqttdl_requests = 0;
+    g_bench_mqttdl_drop_at = drop_at;
+    time_start = g_bench_portfile.core_sysdep_time();
+    while (res != STATE_MQTT_DOWNLOAD_SUCCESS && res != STATE_MQTT_DOWNLOAD_FAILED_TIMEOUT &&
+           res != STATE_MQTT_DOWNLOAD_FAILED_MISMATCH && res != STATE_MQTT_DOWNLOAD_FAILED_RECVERROR) {
+        aiot_mqtt_recv(mqtt_handle);
+        res = aiot_mqtt_download_process(md_handle);
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    aiot_mqtt_download_get_stats(md_handle, &stats);
+
+    printf("  %-34s requests: %3d, retries: %2d, time: %5" PRIu64 " ms, goodput KB/s: %4d, block: %2d KB, window: %2d, %s\n",
+           name, stats.request_count, stats.retry_count, time_used, stats.goodput / 1024, stats.block_size / 1024,
+           stats.window, (res == STATE_MQTT_DOWNLOAD_SUCCESS && context.offset == g_bench_mqttdl_file_len &&
+                          context.mismatch == 0) ? "digest ok" : "FAILED");
+
+    aiot_mqtt_download_deinit(&md_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    return 0;
+}
+
+static int32_t bench_mqttdl(void)
+{
+    char digest[33];
+
+    if (bench_ota_digest(BENCH_MQTTDL_FILE_LEN, digest) < 0) {
+        return -1;
+    }
+
+    printf("mqtt download bench, rtt %d ms, %d KB/s link, %d KB file, 5 KB blocks\n", BENCH_MQTTDL_RTT_MS,
+           BENCH_MQTTDL_RATE / 1024, BENCH_MQTTDL_FILE_LEN / 1024);
+
+    g_bench_mqttdl_file_len = BENCH_MQTTDL_FILE_LEN;
+    bench_mqttdl_run("window 1", digest, 1, 5 * 1024, 0, 10 * 1000, 0);
+    bench_mqttdl_run("window 4", digest, 4, 5 * 1024, 0, 10 * 1000, 0);
+    bench_mqttdl_run("window 8", digest, 8, 5 * 1024, 0, 10 * 1000, 0);
+    bench_mqttdl_run("window 16", digest, 16, 5 * 1024, 0, 10 * 1000, 0);
+    bench_mqttdl_run("window 1, one reply lost", digest, 1, 5 * 1024, 0, 500, 25 * 5 * 1024);
+    bench_mqttdl_run("window 8, one reply lost", digest, 8, 5 * 1024, 0, 500, 25 * 5 * 1024);
+    g_bench_mqttdl_binary = 1;
+    bench_mqttdl_run("window 8, binary header", digest, 8, 5 * 1024, 0, 10 * 1000, 0);
+    g_bench_mqttdl_binary = 0;
+
+    /* 自适应调整需要一段时间收敛, 使用更大的文件 */
+    if (bench_ota_digest(BENCH_MQTTDL_ADAPTIVE_FILE_LEN, digest) < 0) {
+        return -1;
+    }
+    printf("mqtt download adaptive bench, %d KB file, block size up to 32 KB, 300 ms block timeout\n",
+           BENCH_MQTTDL_ADAPTIVE_FILE_LEN / 1024);
+
+    g_bench_mqttdl_file_len = BENCH_MQTTDL_ADAPTIVE_FILE_LEN;
+    bench_mqttdl_run("fixed, window 4", digest, 4, 5 * 1024, 0, 300, 0);
+    bench_mqttdl_run("adaptive, window up to 4", digest, 4, 5 * 1024, 1, 300, 0);
+    bench_mqttdl_run("fixed, window 16", digest, 16, 5 * 1024, 0, 300, 0);
+    bench_mqttdl_run("adaptive, window up to 16", digest, 16, 5 * 1024, 1, 300, 0);
+    g_bench_mqttdl_loss_every = 50;
+    bench_mqttdl_run("fixed, window 16, 2% loss", digest, 16, 5 * 1024, 0, 300, 0);
+    bench_mqttdl_run("adaptive, window up to 16, 2% loss", digest, 16, 5 * 1024, 1, 300, 0);
+    g_bench_mqttdl_loss_every = 0;
+    g_bench_mqttdl_queue_limit = 64 * 1024;
+    bench_mqttdl_run("fixed, 16 x 16 KB, 64 KB queue", digest, 16, 16 * 1024, 0, 300, 0);
+    bench_mqttdl_run("adaptive, 16 x 16 KB, 64 KB queue", digest, 16, 16 * 1024, 1, 300, 0);
+    g_bench_mqttdl_queue_limit = 0;
+    g_bench_mqttdl_file_len = BENCH_MQTTDL_FILE_LEN;
+
+    return 0;
+}
+
+/* 回复的数据不随偏移变化, 回调只统计交付的长度 */
+static void bench_mdparse_recv_handler(void *handle, const aiot_mqtt_download_recv_t *packet, void *userdata)
+{
+    *(uint32_t *)userdata += packet->data.data_resp.data_size;
+}
+
+/* 生成偏移为BENCH_MDPARSE_RANGE_START的回复报文, 并找到其中偏移字段的位置 */
+static int32_t bench_mdparse_build(uint8_t binary)
+{
+    bench_mdparse_replay_t *replay = &g_bench_mdparse_replay;
+    bench_mqttdl_conn_t conn;
+    uint8_t field[10];
+    uint32_t field_len = 0, idx = 0;
+
+    memset(&conn, 0, sizeof(bench_mqttdl_conn_t));
+    conn.reply[0].offset = BENCH_MDPARSE_RANGE_START;
+    conn.reply[0].size = BENCH_CRC_BLOCK_LEN;
+    conn.reply[0].binary = binary;
+    conn.reply_num = 1;
+    if (bench_mqttdl_build(&conn) < 0) {
+        return -1;
+    }
+
+    if (binary) {
+        for (field_len = 0; field_len < 4; field_len++) {
+            field[field_len] = (uint8_t)(BENCH_MDPARSE_RANGE_START >> (24 - field_len * 8));
+        }
+    } else {
+        core_uint2str(BENCH_MDPARSE_RANGE_START, (char *)field, NULL);
+        field_len = 10;
+    }
+    for (idx = conn.packet_offset; idx + field_len < conn.packet_len; idx++) {
+        if (memcmp(conn.packet + idx, field, field_len) == 0) {
+            break;
+        }
+    }
+
+    memset(replay, 0, sizeof(bench_mdparse_replay_t));
+    replay->packet = conn.packet;
+    replay->packet_start = conn.packet_offset;
+    replay->packet_len = conn.packet_len;
+    replay->field_pos = idx;
+    replay->binary = binary;
+
+    return 0;
+}
+
+/*
+ * 通过aiot_mqtt_recv把回复交给下载实例, 统计每个回复的耗时.
+ * stale为0时每个回复都被接收, 包括CRC16校验、交付和请求下一块; 为1时回复的偏移不在等待中, 解析回复头后被丢弃
+ */
+static void bench_mdparse_run(const char *name, uint8_t binary, uint8_t stale)
+{
+    void *mqtt_handle = NULL, *md_handle = NULL;
+    aiot_download_task_desc_t task_desc;
+    uint32_t count = BENCH_MDPARSE_COUNT, idx = 0, fetched = 0;
+    uint32_t request_size = BENCH_CRC_BLOCK_LEN, block_timeout_ms = 60 * 1000;
+    uint32_t range_start = BENCH_MDPARSE_RANGE_START, range_end = BENCH_MDPARSE_RANGE_START + count * BENCH_CRC_BLOCK_LEN;
+    uint64_t time_start = 0, time_used = 0;
+
+    mqtt_handle = bench_mqtt_create();
+    if (mqtt_handle == NULL) {
+        return;
+    }
+    if (aiot_mqtt_connect(mqtt_handle) < STATE_SUCCESS || bench_mdparse_build(binary) < 0) {
+        aiot_mqtt_deinit(&mqtt_handle);
+        return;
+    }
+    g_bench_mdparse_replay.stale = stale;
+
+    memset(&task_desc, 0, sizeof(aiot_download_task_desc_t));
+    task_desc.size_total = range_end;
+    task_desc.mqtt_handle = mqtt_handle;
+
+    md_handle = aiot_mqtt_download_init();
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_TASK_DESC, &task_desc);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_RECV_HANDLE, (void *)bench_mdparse_recv_handler);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_USERDATA, &fetched);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_DATA_REQUEST_SIZE, &request_size);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BLOCK_TIMEOUT_MS, &block_timeout_ms);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BINARY_HEADER, &binary);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_RANGE_START, &range_start);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_RANGE_END, &range_end);
+
+    /* 开始下载, 发出第一个块的请求, 窗口为1时第二个块不在等待中 */
+    aiot_mqtt_download_process(md_handle);
+    if (stale) {
+        bench_mdparse_arm(range_start + BENCH_CRC_BLOCK_LEN);
+    }
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    for (idx = 0; idx < count; idx++) {
+        aiot_mqtt_recv(mqtt_handle);
+    }
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+
+    printf("  %-34s %6" PRIu64 " ns/reply%s\n", name, time_used * 1000000 / count,
+           (fetched == ((stale) ? 0 : count * BENCH_CRC_BLOCK_LEN)) ? "" : " (FAILED)");
+
+    free(g_bench_mdparse_replay.packet);
+    memset(&g_bench_mdparse_replay, 0, sizeof(bench_mdparse_replay_t));
+    aiot_mqtt_download_deinit(&md_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+}
+
+static int32_t bench_mdparse(void)
+{
+    printf("mqtt download reply parse bench, %d KB blocks, replies injected through aiot_mqtt_recv\n",
+           BENCH_CRC_BLOCK_LEN / 1024);
+
+    bench_mdparse_run("json header, dropped", 0, 1);
+    bench_mdparse_run("json header, delivered", 0, 0);
+    bench_mdparse_run("binary header, dropped", 1, 1);
+    bench_mdparse_run("binary header, delivered", 1, 0);
+
+    return 0;
+}
+
+static volatile uint8_t g_bench_dlpipe_running = 0;
+
+/* 用户的digest计算线程 */
+static void *bench_dlpipe_digest_thread(void *args)
+{
+    while (g_bench_dlpipe_running) {
+        if (aiot_download_digest_process(args) == 0) {
+            usleep(100);
+        }
+    }
+    return NULL;
+}
+
+static int32_t bench_dlpipe_run(const char *name, char *digest, uint32_t adaptive_max_len, uint8_t digest_async,
+                                uint8_t digest_thread)
+{
+    void *dl_handle = NULL;
+    bench_ota_context_t context;
+    aiot_download_stats_t stats;
+    pthread_t thread;
+    uint64_t time_start = 0, time_used = 0;
+
+    dl_handle = bench_ota_init(digest, &context);
+    if (dl_handle == NULL) {
+        return -1;
+    }
+    context.write_us_per_mb = BENCH_DLPIPE_WRITE_US_PER_MB;
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_BODY_BUFFER_ADAPTIVE_MAX_LEN, &adaptive_max_len);
+    aiot_download_setopt(dl_handle, AIOT_DLOPT_DIGEST_ASYNC, &digest_async);
+    if (digest_thread) {
+        g_bench_dlpipe_running = 1;
+        pthread_create(&thread, NULL, bench_dlpipe_digest_thread, dl_handle);
+    }
+
+    time_start = g_bench_portfile.core_sysdep_time();
+    bench_ota_download(dl_handle, &context);
+    time_used = g_bench_portfile.core_sysdep_time() - time_start;
+    if (time_used == 0) {
+        time_used = 1;
+    }
+    if (digest_thread) {
+        g_bench_dlpipe_running = 0;
+        pthread_join(thread, NULL);
+    }
+    aiot_download_get_stats(dl_handle, &stats);
+
+    printf("  %-32s time: %5" PRIu64 " ms, MB/s: %5" PRIu64 ", buffer: %2d KB, %s\n", name, time_used,
+           (uint64_t)context.offset * 1000 / 1024 / 1024 / time_used, stats.buffer_len / 1024,
+           (context.offset == g_bench_ota_firmware_len && context.mismatch == 0 && context.percent == 100) ? "digest ok" :
+           "FAILED");
+    printf("  %-32s recv %5" PRIu64 " ms, digest %5" PRIu64 " ms, user write %5" PRIu64 " ms\n", "", stats.recv_time_ms,
+           stats.digest_time_ms, stats.deliver_time_ms);
+
+    aiot_download_deinit(&dl_handle);
+
+    return 0;
+}
+
+static int32_t bench_dlpipe(void)
+{
+    char digest[33];
+
+    if (bench_ota_digest(BENCH_DLPIPE_FIRMWARE_LEN, digest) < 0) {
+        return -1;
+    }
+
+    printf("ota download pipeline bench, rtt %d ms, %d KB window, %d MB firmware, md5 digest, flash write %d ms/MB\n",
+           BENCH_DLPIPE_RTT_MS, BENCH_DLPIPE_WINDOW / 1024, BENCH_DLPIPE_FIRMWARE_LEN / 1024 / 1024,
+           BENCH_DLPIPE_WRITE_US_PER_MB / 1000);
+
+    g_bench_http_rtt_ms = BENCH_DLPIPE_RTT_MS;
+    g_bench_ota_window = BENCH_DLPIPE_WINDOW;
+    g_bench_ota_firmware_len = BENCH_DLPIPE_FIRMWARE_LEN;
+    bench_dlpipe_run("2 KB buffer, inline digest", digest, 0, 0, 0);
+    bench_dlpipe_run("adaptive buffer, inline digest", digest, 64 * 1024, 0, 0);
+    bench_dlpipe_run("adaptive buffer, digest thread", digest, 64 * 1024, 1, 1);
+    bench_dlpipe_run("async digest, no thread", digest, 64 * 1024, 1, 0);
+    g_bench_http_rtt_ms = BENCH_HTTP_RTT_MS;
+    g_bench_ota_window = BENCH_OTA_WINDOW;
+    g_bench_ota_firmware_len = BENCH_OTA_FIRMWARE_LEN;
+
+    return 0;
+}
+
+static void bench_storm_poll(void **handles, uint32_t handle_num, uint64_t duration_ms)
+{
+    uint64_t time_start = g_bench_portfile.core_sysdep_time();
+    uint32_t i = 0;
+
+    while (g_bench_portfile.core_sysdep_time() - time_start < duration_ms) {
+        for (i = 0; i < handle_num; i++) {
+            aiot_mqtt_recv(handles[i]);
+        }
+    }
+}
+
+static int32_t bench_storm(const char *name, aiot_mqtt_reconn_backoff_t backoff, uint32_t rate)
+{
+    void **handles = NULL;
+    uint32_t handle_num = 0, i = 0, j = 0, peak = 0, total = 0, bar = 0;
+    aiot_mqtt_reconn_rate_limit_t rate_limit = {rate, rate};
+    int32_t res = STATE_SUCCESS;
+
+    handles = malloc(sizeof(void *) * BENCH_STORM_HANDLES);
+    if (handles == NULL) {
+        return -1;
+    }
+    memset(handles, 0, sizeof(void *) * BENCH_STORM_HANDLES);
+
+    g_bench_broker_up = 1;
+    g_bench_broker_up_time = 0;
+    memset(g_bench_connect_hist, 0, sizeof(g_bench_connect_hist));
+
+    for (handle_num = 0; handle_num < BENCH_STORM_HANDLES; handle_num++) {
+        handles[handle_num] = bench_mqtt_create();
+        if (handles[handle_num] == NULL) {
+            printf("aiot_mqtt_init failed\n");
+            break;
+        }
+        aiot_mqtt_setopt(handles[handle_num], AIOT_MQTTOPT_RECONN_BACKOFF, (void *)&backoff);
+        res = aiot_mqtt_connect(handles[handle_num]);
+        if (res < STATE_SUCCESS) {
+            printf("aiot_mqtt_connect failed: -0x%04X\n", -res);
+            aiot_mqtt_deinit(&handles[handle_num]);
+            break;
+        }
+    }
+    if (handle_num > 0) {
+        aiot_mqtt_setopt(handles[0], AIOT_MQTTOPT_RECONN_RATE_LIMIT, (void *)&rate_limit);
+    }
+
+    /* 服务端中断, 所有实例检测到断线后开始重连 */
+    g_bench_broker_up = 0;
+    bench_storm_poll(handles, handle_num, BENCH_STORM_OUTAGE_MS);
+
+    /* 服务端恢复, 统计之后每秒的建连次数 */
+    g_bench_broker_up_time = g_bench_portfile.core_sysdep_time();
+    g_bench_broker_up = 1;
+    bench_storm_poll(handles, handle_num, BENCH_STORM_WINDOW_S * 1000);
+
+    for (i = 0; i < BENCH_STORM_WINDOW_S; i++) {
+        peak = (g_bench_connect_hist[i] > peak) ? (g_bench_connect_hist[i]) : (peak);
+        total += g_bench_connect_hist[i];
+    }
+    printf("reconnect storm [%s], %d handles, %d ms outage, connected %d, peak %d/s\n", name, handle_num,
+           BENCH_STORM_OUTAGE_MS, total, peak);
+    for (i = 0; i < BENCH_STORM_WINDOW_S; i++) {
+        bar = (peak == 0) ? (0) : (g_bench_connect_hist[i] * 50 / peak);
+        printf("  %2ds %6d |", i, g_bench_connect_hist[i]);
+        for (j = 0; j < bar; j++) {
+            printf("#");
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < handle_num; i++) {
+        aiot_mqtt_deinit(&handles[i]);
+    }
+    free(handles);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    /* 网络接口替换为模拟服务端, 其余沿用posix portfile */
+    memcpy(&g_bench_portfile, &g_aiot_sysdep_portfile, sizeof(aiot_sysdep_portfile_t));
+    g_bench_portfile.core_sysdep_network_init = bench_network_init;
+    g_bench_portfile.core_sysdep_network_setopt = bench_network_setopt;
+    g_bench_portfile.core_sysdep_network_establish = bench_network_establish;
+    g_bench_portfile.core_sysdep_network_recv = bench_network_recv;
+    g_bench_portfile.core_sysdep_network_send = bench_network_send;
+    g_bench_portfile.core_sysdep_network_deinit = bench_network_deinit;
+
+    /* 配置SDK的底层依赖 */
+    aiot_sysdep_set_portfile(&g_bench_portfile);
+
+    if (argc < 2 || strcmp(argv[1], "pub") == 0) {
+        if (bench_pub() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "log") == 0) {
+        if (bench_log() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "logbuf") == 0) {
+        if (bench_logbuf() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "dm") == 0) {
+        if (bench_dm() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "json") == 0) {
+        bench_json();
+    }
+
+    if (argc < 2 || strcmp(argv[1], "subdev") == 0) {
+        if (bench_subdev() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "sha") == 0) {
+        if (bench_sha() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "crc") == 0) {
+        if (bench_crc() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "string") == 0) {
+        bench_string();
+    }
+
+    if (argc < 2 || strcmp(argv[1], "http") == 0) {
+        if (bench_http() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "ota") == 0) {
+        if (bench_ota() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "dlpipe") == 0) {
+        if (bench_dlpipe() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "mqttdl") == 0) {
+        if (bench_mqttdl() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "mdparse") == 0) {
+        if (bench_mdparse() < 0) {
+            return -1;
+        }
+    }
+
+    if (argc < 2 || strcmp(argv[1], "storm") == 0) {
+        bench_storm("linear", AIOT_MQTT_RECONN_BACKOFF_LINEAR, 0);
+        bench_storm("exponential", AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL, 0);
+        bench_storm("exponential + 1000/s limit", AIOT_MQTT_RECONN_BACKOFF_EXPONENTIAL, 1000);
+    }
+
+    return 0;
+}
+
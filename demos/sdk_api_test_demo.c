@@ -0,0 +1,1316 @@
+/*
+ * 这个例程用于验证SDK内部各个功能模块的正确性, 与mqtt_bench_demo中的性能测试相互独立.
+ * 每个测试case使用固定的测试向量或者模拟的网络数据, 不依赖真实的服务端;
+ *  + 全部case通过后输出TOTAL TEST SUCCESS, 进程返回0
+ *  + 任意case失败时输出失败的检查项和TOTAL TEST FAILED, 进程返回-1
+ *
+ * 运行: ./output/sdk-api-test-demo
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "aiot_state_api.h"
+#include "aiot_sysdep_api.h"
+#include "aiot_mqtt_api.h"
+#include "aiot_ota_api.h"
+#include "aiot_mqtt_download_api.h"
+#include "core_rand.h"
+#include "core_string.h"
+#include "core_crc16.h"
+#include "core_log.h"
+#include "core_http.h"
+#include "core_md5.h"
+#include "core_sha256.h"
+
+#define DEBUG_INFO(...) do{ printf("Line[%d]: ",__LINE__); printf(__VA_ARGS__); printf("\r\n");}while(0);
+/* 检查不通过时打印失败的表达式并返回对应的错误码 */
+#define TEST_EXPECT(cond, err) do{ if (!(cond)) { DEBUG_INFO("check failed: %s", #cond); return (err); } }while(0);
+
+/**
+ * 功能测试结果
+ */
+typedef enum {
+    TEST_SUCCESS,
+    TEST_ERR_RANDOM,
+    TEST_ERR_JSON_INDEX,
+    TEST_ERR_JSON_WRITER,
+    TEST_ERR_CRC,
+    TEST_ERR_DIGEST,
+    TEST_ERR_STRING,
+    TEST_ERR_HTTP_CHUNK,
+    TEST_ERR_MQTT_DOWNLOAD,
+    TEST_ERR_BINARY_HEADER,
+} sdk_test_result_t;
+
+static const char *result_string[] = {
+    "TEST_SUCCESS",
+    "TEST_ERR_RANDOM",
+    "TEST_ERR_JSON_INDEX",
+    "TEST_ERR_JSON_WRITER",
+    "TEST_ERR_CRC",
+    "TEST_ERR_DIGEST",
+    "TEST_ERR_STRING",
+    "TEST_ERR_HTTP_CHUNK",
+    "TEST_ERR_MQTT_DOWNLOAD",
+    "TEST_ERR_BINARY_HEADER",
+};
+
+/**
+ * sysdep的接口实现，包含系统时间、内存管理、网络、锁、随机数、等接口实现
+ */
+extern aiot_sysdep_portfile_t g_aiot_sysdep_portfile;
+
+/**
+ * 功能测试入口原型定义
+ */
+typedef sdk_test_result_t (*sdk_test_func)(aiot_sysdep_portfile_t *sysdep);
+
+typedef struct {
+    char *name;
+    sdk_test_func func;
+} sdk_test_suite;
+
+/* 模拟熵源失效, 用于检查生成器不会停留在全零状态 */
+static void zero_rand(uint8_t *output, uint32_t output_len)
+{
+    memset(output, 0, output_len);
+}
+
+/* 随机数测试: xoshiro128**的参考向量, 种子兜底, 取值范围和portfile熵源 */
+static sdk_test_result_t random_test(aiot_sysdep_portfile_t *sysdep)
+{
+    /* 参考实现以{1, 2, 3, 4}为状态时的前6个输出 */
+    const uint32_t expect[] = {0x00002D00, 0x00000000, 0x005A7080, 0x04389D80, 0x79199D9B, 0x61963B24};
+    aiot_sysdep_portfile_t zero_sysdep;
+    core_rand_t state = {{1, 2, 3, 4}};
+    uint8_t buffer[2][64], hit[10];
+    uint32_t idx = 0, value = 0, nonzero = 0;
+
+    for (idx = 0; idx < sizeof(expect) / sizeof(expect[0]); idx++) {
+        TEST_EXPECT(core_rand_next(&state) == expect[idx], TEST_ERR_RANDOM);
+    }
+
+    memcpy(&zero_sysdep, sysdep, sizeof(aiot_sysdep_portfile_t));
+    zero_sysdep.core_sysdep_rand = zero_rand;
+    core_rand_seed(&zero_sysdep, &state);
+    TEST_EXPECT((state.s[0] | state.s[1] | state.s[2] | state.s[3]) != 0, TEST_ERR_RANDOM);
+    for (idx = 0; idx < 8; idx++) {
+        nonzero |= core_rand_next(&state);
+    }
+    TEST_EXPECT(nonzero != 0, TEST_ERR_RANDOM);
+
+    memset(hit, 0, sizeof(hit));
+    for (idx = 0; idx < 10000; idx++) {
+        value = core_rand_range(sysdep, sizeof(hit));
+        TEST_EXPECT(value < sizeof(hit), TEST_ERR_RANDOM);
+        hit[value] = 1;
+        TEST_EXPECT(core_rand_range(sysdep, 1) == 0, TEST_ERR_RANDOM);
+    }
+    for (idx = 0; idx < sizeof(hit); idx++) {
+        TEST_EXPECT(hit[idx] == 1, TEST_ERR_RANDOM);
+    }
+
+    /* 两次读取的64字节不应相同, 也不应全为0 */
+    memset(buffer, 0, sizeof(buffer));
+    sysdep->core_sysdep_rand(buffer[0], sizeof(buffer[0]));
+    sysdep->core_sysdep_rand(buffer[1], sizeof(buffer[1]));
+    TEST_EXPECT(memcmp(buffer[0], buffer[1], sizeof(buffer[0])) != 0, TEST_ERR_RANDOM);
+    for (idx = 0, nonzero = 0; idx < sizeof(buffer[0]); idx++) {
+        nonzero |= buffer[0][idx];
+    }
+    TEST_EXPECT(nonzero != 0, TEST_ERR_RANDOM);
+
+    return TEST_SUCCESS;
+}
+
+/* 查找key并与期望的value比较, expect为NULL时期望找不到 */
+static uint8_t json_index_expect(const core_json_index_t *index, const char *scope, uint32_t scope_len,
+                                 const char *key, const char *expect)
+{
+    char *value = NULL;
+    uint32_t value_len = 0;
+    int32_t res = 0;
+
+    if (scope == NULL) {
+        res = core_json_index_value(index, key, (uint32_t)strlen(key), &value, &value_len);
+    } else {
+        res = core_json_index_scope_value(index, scope, scope_len, key, (uint32_t)strlen(key), &value, &value_len);
+    }
+    if (expect == NULL) {
+        return (res == STATE_USER_INPUT_JSON_PARSE_FAILED) ? 1 : 0;
+    }
+
+    return (res == STATE_SUCCESS && value_len == strlen(expect) && memcmp(value, expect, value_len) == 0) ? 1 : 0;
+}
+
+/* JSON索引测试: 嵌套对象和数组, 转义字符串, 空白字符, token不足以及报文不完整时的退化查找 */
+static sdk_test_result_t json_index_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const char *payload = "{\"id\":\"123\",\"params\":{\"name\":\"a\\\"b\",\"id\":7,\"list\":[1,{\"deep\":true}],"
+                          "\"obj\":{}},\"code\":200,\"version\":\"1.0\"}";
+    const char *spaced = "{ \"code\" : 200 ,\r\n \"data\" : { \"size\" :\t1024 } , \"message\" : \"success\" }";
+    const char *truncated = "{\"a\":1,\"b\":";
+    core_json_token_t tokens[CORE_JSON_INDEX_TOKENS];
+    core_json_index_t index;
+    char *params = NULL;
+    uint32_t params_len = 0;
+
+    TEST_EXPECT(core_json_index(&index, payload, (uint32_t)strlen(payload), tokens, CORE_JSON_INDEX_TOKENS) == 9,
+                TEST_ERR_JSON_INDEX);
+    /* 同名key取报文中第一次出现的位置, 与core_json_value一致 */
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "id", "123"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "params",
+                                  "{\"name\":\"a\\\"b\",\"id\":7,\"list\":[1,{\"deep\":true}],\"obj\":{}}"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "name", "a\\\"b"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "list", "[1,{\"deep\":true}]"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "deep", "true"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "obj", "{}"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "code", "200"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "version", "1.0"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "missing", NULL), TEST_ERR_JSON_INDEX);
+    /* 限定在params对象内查找时取到内层的id */
+    TEST_EXPECT(core_json_index_value(&index, "params", (uint32_t)strlen("params"), &params, &params_len) == STATE_SUCCESS,
+                TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, params, params_len, "id", "7"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, params, params_len, "code", NULL), TEST_ERR_JSON_INDEX);
+
+    TEST_EXPECT(core_json_index(&index, spaced, (uint32_t)strlen(spaced), tokens, CORE_JSON_INDEX_TOKENS) == 4,
+                TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "code", "200"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "size", "1024"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "message", "success"), TEST_ERR_JSON_INDEX);
+
+    /* token只够记录前3个key, 之后的key按core_json_value逐字节扫描 */
+    TEST_EXPECT(core_json_index(&index, payload, (uint32_t)strlen(payload), tokens, 3) == 3, TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "id", "123"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "deep", "true"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "version", "1.0"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "missing", NULL), TEST_ERR_JSON_INDEX);
+
+    /* 报文不完整时无法建立索引, 查找结果与core_json_value一致 */
+    TEST_EXPECT(core_json_index(&index, truncated, (uint32_t)strlen(truncated), tokens,
+                                CORE_JSON_INDEX_TOKENS) == STATE_USER_INPUT_JSON_PARSE_FAILED, TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "a", "1"), TEST_ERR_JSON_INDEX);
+    TEST_EXPECT(json_index_expect(&index, NULL, 0, "b", NULL), TEST_ERR_JSON_INDEX);
+
+    return TEST_SUCCESS;
+}
+
+/* 只允许成功分配一次内存, 用于检查扩容失败后的错误处理 */
+static uint32_t g_malloc_allowed = 0;
+
+static void *limited_malloc(uint32_t size, char *name)
+{
+    if (g_malloc_allowed == 0) {
+        return NULL;
+    }
+    g_malloc_allowed--;
+    return g_aiot_sysdep_portfile.core_sysdep_malloc(size, name);
+}
+
+static uint8_t json_writer_equal(core_json_writer_t *writer, const char *expect)
+{
+    return (writer->error == STATE_SUCCESS && writer->len == strlen(expect) &&
+            memcmp(writer->buffer + writer->headroom, expect, writer->len) == 0) ? 1 : 0;
+}
+
+/* JSON输出测试: 字符串转义, 64位整数边界, 嵌套容器, 预留头部空间, 扩容以及扩容失败后的错误 */
+static sdk_test_result_t json_writer_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const char *expect = "{\"s\":\"q\\\"b\\\\s/\\n\\r\\t\\b\\f\\u0001\\u001f\xe4\xb8\xad\","
+                         "\"n\":-9223372036854775808,\"u\":18446744073709551615,\"z\":0,\"t\":true,\"f\":false,"
+                         "\"null\":null,\"a\":[1,-2,\"x\",{},[]],\"raw\":{\"k\":[1,2]},\"k\\\"ey\":\"\"}";
+    aiot_sysdep_portfile_t limited_sysdep;
+    core_json_writer_t writer;
+    char array[16 * 1024], number[24];
+    uint32_t idx = 0, array_len = 0, len = 0;
+
+    /* 初始容量很小, 写入过程中需要多次扩容 */
+    TEST_EXPECT(core_json_writer_init(&writer, sysdep, 5, 8, "test") == STATE_SUCCESS, TEST_ERR_JSON_WRITER);
+    core_json_writer_object_begin(&writer);
+    core_json_writer_key(&writer, "s");
+    core_json_writer_string(&writer, "q\"b\\s/\n\r\t\b\f\x01\x1f\xe4\xb8\xad");
+    core_json_writer_key(&writer, "n");
+    core_json_writer_int(&writer, (int64_t)(-9223372036854775807LL - 1));
+    core_json_writer_key(&writer, "u");
+    core_json_writer_uint(&writer, 18446744073709551615ULL);
+    core_json_writer_key(&writer, "z");
+    core_json_writer_int(&writer, 0);
+    core_json_writer_key(&writer, "t");
+    core_json_writer_bool(&writer, 1);
+    core_json_writer_key(&writer, "f");
+    core_json_writer_bool(&writer, 0);
+    core_json_writer_key(&writer, "null");
+    core_json_writer_string(&writer, NULL);
+    core_json_writer_key(&writer, "a");
+    core_json_writer_array_begin(&writer);
+    core_json_writer_uint(&writer, 1);
+    core_json_writer_int(&writer, -2);
+    core_json_writer_string(&writer, "x");
+    core_json_writer_object_begin(&writer);
+    core_json_writer_object_end(&writer);
+    core_json_writer_array_begin(&writer);
+    core_json_writer_array_end(&writer);
+    core_json_writer_array_end(&writer);
+    core_json_writer_key(&writer, "raw");
+    core_json_writer_raw(&writer, "{\"k\":[1,2]}", (uint32_t)strlen("{\"k\":[1,2]}"));
+    core_json_writer_key(&writer, "k\"ey");
+    core_json_writer_string(&writer, "");
+    core_json_writer_object_end(&writer);
+    TEST_EXPECT(json_writer_equal(&writer, expect), TEST_ERR_JSON_WRITER);
+    TEST_EXPECT(writer.buffer_len >= writer.headroom + writer.len, TEST_ERR_JSON_WRITER);
+    core_json_writer_deinit(&writer);
+
+    /* 较长的数组, 与snprintf逐个拼接的结果一致 */
+    TEST_EXPECT(core_json_writer_init(&writer, sysdep, 0, 0, "test") == STATE_SUCCESS, TEST_ERR_JSON_WRITER);
+    core_json_writer_array_begin(&writer);
+    array[array_len++] = '[';
+    for (idx = 0; idx < 1000; idx++) {
+        core_json_writer_uint(&writer, (uint64_t)idx * 1000003);
+        array_len += snprintf(array + array_len, sizeof(array) - array_len, "%s%" PRIu64, (idx == 0) ? "" : ",",
+                              (uint64_t)idx * 1000003);
+    }
+    core_json_writer_array_end(&writer);
+    array[array_len++] = ']';
+    array[array_len] = '\0';
+    TEST_EXPECT(json_writer_equal(&writer, array), TEST_ERR_JSON_WRITER);
+    core_json_writer_deinit(&writer);
+
+    /* 扩容失败后错误一直保留, 后续即使放得下的写入也不再生效 */
+    memcpy(&limited_sysdep, sysdep, sizeof(aiot_sysdep_portfile_t));
+    limited_sysdep.core_sysdep_malloc = limited_malloc;
+    g_malloc_allowed = 1;
+    TEST_EXPECT(core_json_writer_init(&writer, &limited_sysdep, 0, 16, "test") == STATE_SUCCESS, TEST_ERR_JSON_WRITER);
+    core_json_writer_array_begin(&writer);
+    core_json_writer_uint(&writer, 1);
+    for (idx = 0; idx < sizeof(number) - 1; idx++) {
+        number[idx] = 'a';
+    }
+    number[idx] = '\0';
+    core_json_writer_string(&writer, number);
+    TEST_EXPECT(writer.error == STATE_SYS_DEPEND_MALLOC_FAILED, TEST_ERR_JSON_WRITER);
+    len = writer.len;
+    core_json_writer_array_end(&writer);
+    TEST_EXPECT(writer.error == STATE_SYS_DEPEND_MALLOC_FAILED && writer.len == len, TEST_ERR_JSON_WRITER);
+    core_json_writer_deinit(&writer);
+
+    return TEST_SUCCESS;
+}
+
+/* 逐位计算的CRC-16/ARC, 作为查表实现的参照 */
+static uint16_t crc16_bitwise(const uint8_t *input, uint32_t ilen)
+{
+    uint16_t crc = 0;
+    uint32_t idx = 0, bit = 0;
+
+    for (idx = 0; idx < ilen; idx++) {
+        crc ^= input[idx];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+/* CRC16测试: 标准校验值, 不同长度和对齐方式下与逐位计算一致, 任意分段计算与一次计算一致 */
+static sdk_test_result_t crc_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const char *check = "123456789";
+    uint8_t buffer[8 + 300];
+    core_crc16_context_t ctx;
+    uint32_t idx = 0, align = 0, len = 0, offset = 0, chunk = 1;
+
+    TEST_EXPECT(core_crc16((const uint8_t *)check, (uint32_t)strlen(check)) == 0xBB3D, TEST_ERR_CRC);
+    TEST_EXPECT(core_crc16((const uint8_t *)check, 0) == 0x0000, TEST_ERR_CRC);
+
+    for (idx = 0; idx < sizeof(buffer); idx++) {
+        buffer[idx] = (uint8_t)(idx * 131 + 7);
+    }
+    /* 覆盖slicing-by-8的整8字节部分和剩余字节, 以及非8字节对齐的起始地址 */
+    for (align = 0; align < 8; align++) {
+        for (len = 0; len <= 300; len++) {
+            TEST_EXPECT(core_crc16(buffer + align, len) == crc16_bitwise(buffer + align, len), TEST_ERR_CRC);
+        }
+    }
+
+    core_crc16_init(&ctx);
+    for (offset = 0; offset < 300; offset += chunk, chunk = chunk * 3 % 17 + 1) {
+        core_crc16_update(&ctx, buffer + offset, (300 - offset < chunk) ? (300 - offset) : chunk);
+    }
+    TEST_EXPECT(core_crc16_finish(&ctx) == crc16_bitwise(buffer, 300), TEST_ERR_CRC);
+
+    return TEST_SUCCESS;
+}
+
+/* 比较摘要与小写十六进制的期望值 */
+static uint8_t digest_equal(const uint8_t *output, uint32_t output_len, const char *expect)
+{
+    char hex[2 * 32 + 1];
+
+    core_hex2str((uint8_t *)output, output_len, hex, 1);
+    hex[2 * output_len] = '\0';
+
+    return (strcmp(hex, expect) == 0) ? 1 : 0;
+}
+
+/*
+ * 按当前选择的实现检查SHA-256(FIPS 180-2)和HMAC-SHA256(RFC 4231)的参考向量.
+ * 多路计算使用长度各不相同的消息, 并超过一组的路数; HMAC包含超过一个块的密钥
+ */
+static sdk_test_result_t digest_sha256_cases(void)
+{
+    const char *sha_msg[] = {"", "abc", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+    const char *sha_expect[] = {
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+    };
+    const char *million_expect = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+    /* RFC 4231的test case 1~4, 6, 7, test case 5的输出是截断的, 不使用 */
+    const char *hmac_expect[] = {
+        "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+        "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+        "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+        "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+        "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+        "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+    };
+    const char *hmac_text[] = {
+        "Hi There", "what do ya want for nothing?", NULL, NULL,
+        "Test Using Larger Than Block-Size Key - Hash Key First",
+        "This is a test using a larger than block-size key and a larger than block-size data. "
+        "The key needs to be hashed before being used by the HMAC algorithm."
+    };
+    uint8_t key_0b[20], key_aa[131], key_seq[25], data_dd[50], data_cd[50], chunk[1000];
+    const uint8_t *hmac_key[6], *hmac_msg[6], *multi_input[6];
+    uint32_t hmac_key_len[6], hmac_msg_len[6], multi_len[6];
+    uint8_t output[6][32], single[32], *million = NULL;
+    core_sha256_context_t ctx;
+    uint32_t idx = 0;
+
+    for (idx = 0; idx < sizeof(sha_msg) / sizeof(sha_msg[0]); idx++) {
+        core_sha256((const uint8_t *)sha_msg[idx], (uint32_t)strlen(sha_msg[idx]), single);
+        TEST_EXPECT(digest_equal(single, 32, sha_expect[idx]), TEST_ERR_DIGEST);
+    }
+
+    /* 一百万个'a': 分段计算时每段不是块长度的整数倍, 一次计算时整块直接交给压缩函数 */
+    memset(chunk, 'a', sizeof(chunk));
+    core_sha256_init(&ctx);
+    core_sha256_starts(&ctx);
+    for (idx = 0; idx < 1000; idx++) {
+        core_sha256_update(&ctx, chunk, sizeof(chunk));
+    }
+    core_sha256_finish(&ctx, single);
+    core_sha256_free(&ctx);
+    TEST_EXPECT(digest_equal(single, 32, million_expect), TEST_ERR_DIGEST);
+    million = malloc(1000 * 1000);
+    TEST_EXPECT(million != NULL, TEST_ERR_DIGEST);
+    memset(million, 'a', 1000 * 1000);
+    core_sha256(million, 1000 * 1000, single);
+    free(million);
+    TEST_EXPECT(digest_equal(single, 32, million_expect), TEST_ERR_DIGEST);
+
+    /* 6路分为4路和2路两组, 填充后分别占1个或2个块, 以及更多的块 */
+    for (idx = 0; idx < 3; idx++) {
+        multi_input[idx] = (const uint8_t *)sha_msg[idx];
+        multi_len[idx] = (uint32_t)strlen(sha_msg[idx]);
+    }
+    multi_input[3] = chunk;
+    multi_len[3] = sizeof(chunk);
+    multi_input[4] = chunk;
+    multi_len[4] = 55;
+    multi_input[5] = chunk;
+    multi_len[5] = 64;
+    core_sha256_multi(multi_input, multi_len, output, 6);
+    for (idx = 0; idx < 6; idx++) {
+        core_sha256(multi_input[idx], multi_len[idx], single);
+        TEST_EXPECT(memcmp(output[idx], single, 32) == 0, TEST_ERR_DIGEST);
+        TEST_EXPECT(idx >= 3 || digest_equal(output[idx], 32, sha_expect[idx]), TEST_ERR_DIGEST);
+    }
+
+    memset(key_0b, 0x0b, sizeof(key_0b));
+    memset(key_aa, 0xaa, sizeof(key_aa));
+    memset(data_dd, 0xdd, sizeof(data_dd));
+    memset(data_cd, 0xcd, sizeof(data_cd));
+    for (idx = 0; idx < sizeof(key_seq); idx++) {
+        key_seq[idx] = (uint8_t)(idx + 1);
+    }
+    hmac_key[0] = key_0b;
+    hmac_key_len[0] = sizeof(key_0b);
+    hmac_key[1] = (const uint8_t *)"Jefe";
+    hmac_key_len[1] = 4;
+    hmac_key[2] = key_aa;
+    hmac_key_len[2] = 20;
+    hmac_key[3] = key_seq;
+    hmac_key_len[3] = sizeof(key_seq);
+    hmac_key[4] = hmac_key[5] = key_aa;
+    hmac_key_len[4] = hmac_key_len[5] = sizeof(key_aa);
+    for (idx = 0; idx < 6; idx++) {
+        hmac_msg[idx] = (const uint8_t *)hmac_text[idx];
+        hmac_msg_len[idx] = (hmac_text[idx] == NULL) ? 0 : (uint32_t)strlen(hmac_text[idx]);
+    }
+    hmac_msg[2] = data_dd;
+    hmac_msg_len[2] = sizeof(data_dd);
+    hmac_msg[3] = data_cd;
+    hmac_msg_len[3] = sizeof(data_cd);
+
+    for (idx = 0; idx < 6; idx++) {
+        memset(single, 0, sizeof(single));
+        core_hmac_sha256(hmac_msg[idx], hmac_msg_len[idx], hmac_key[idx], hmac_key_len[idx], single);
+        TEST_EXPECT(digest_equal(single, 32, hmac_expect[idx]), TEST_ERR_DIGEST);
+    }
+    memset(output, 0, sizeof(output));
+    core_hmac_sha256_multi(hmac_msg, hmac_msg_len, hmac_key, hmac_key_len, output, 6);
+    for (idx = 0; idx < 6; idx++) {
+        TEST_EXPECT(digest_equal(output[idx], 32, hmac_expect[idx]), TEST_ERR_DIGEST);
+    }
+
+    return TEST_SUCCESS;
+}
+
+/* 摘要测试: SHA-256和HMAC-SHA256在每一种可用的实现下检查参考向量, MD5检查RFC 1321的参考向量 */
+static sdk_test_result_t digest_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const core_sha256_impl_t impl[] = {CORE_SHA256_IMPL_C, CORE_SHA256_IMPL_HW, CORE_SHA256_IMPL_AUTO};
+    const char *md5_msg[] = {
+        "", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "12345678901234567890123456789012345678901234567890123456789012345678901234567890"
+    };
+    const char *md5_expect[] = {
+        "d41d8cd98f00b204e9800998ecf8427e", "0cc175b9c0f1b6a831c399e269772661", "900150983cd24fb0d6963f7d28e17f72",
+        "f96b697d7cb7938d525a2f31aaf161d0", "c3fcd3d76192e4007dfb496cca67e13b", "d174ab98d277d9f5a5611c2c9f419d9f",
+        "57edf4a22be3c955ac49da2e2107b67a"
+    };
+    sdk_test_result_t ret = TEST_SUCCESS;
+    core_md5_context_t ctx;
+    uint8_t output[16];
+    uint32_t idx = 0, offset = 0, chunk = 1, len = 0;
+
+    /* 当前CPU不支持硬件实现时跳过 */
+    for (idx = 0; idx < sizeof(impl) / sizeof(impl[0]); idx++) {
+        if (core_sha256_set_impl(impl[idx]) != STATE_SUCCESS) {
+            TEST_EXPECT(impl[idx] == CORE_SHA256_IMPL_HW, TEST_ERR_DIGEST);
+            continue;
+        }
+        ret = digest_sha256_cases();
+        if (ret != TEST_SUCCESS) {
+            DEBUG_INFO("sha256 implementation: %s", core_sha256_impl_name());
+            break;
+        }
+    }
+    core_sha256_set_impl(CORE_SHA256_IMPL_AUTO);
+    if (ret != TEST_SUCCESS) {
+        return ret;
+    }
+
+    for (idx = 0; idx < sizeof(md5_msg) / sizeof(md5_msg[0]); idx++) {
+        core_md5((const uint8_t *)md5_msg[idx], (uint32_t)strlen(md5_msg[idx]), output);
+        TEST_EXPECT(digest_equal(output, 16, md5_expect[idx]), TEST_ERR_DIGEST);
+    }
+    /* 分段长度不是块长度的整数倍 */
+    len = (uint32_t)strlen(md5_msg[6]);
+    core_md5_init(&ctx);
+    core_md5_starts(&ctx);
+    for (offset = 0; offset < len; offset += chunk, chunk = chunk * 3 % 17 + 1) {
+        core_md5_update(&ctx, (const unsigned char *)md5_msg[6] + offset,
+                        (len - offset < chunk) ? (len - offset) : chunk);
+    }
+    core_md5_finish(&ctx, output);
+    core_md5_free(&ctx);
+    TEST_EXPECT(digest_equal(output, 16, md5_expect[6]), TEST_ERR_DIGEST);
+
+    return TEST_SUCCESS;
+}
+
+/* 数字转换结果与期望的字符串比较, 转换函数不写入结束符 */
+static uint8_t string_number_equal(const char *output, uint8_t output_len, const char *expect)
+{
+    return (output_len == strlen(expect) && memcmp(output, expect, output_len) == 0) ? 1 : 0;
+}
+
+/* 将utc转换为日期后与期望值比较 */
+static uint8_t string_date_equal(uint64_t utc, int8_t zone, uint32_t year, uint32_t mon, uint32_t day,
+                                 uint32_t hour, uint32_t min, uint32_t sec, uint32_t msec)
+{
+    core_date_t date;
+
+    memset(&date, 0, sizeof(core_date_t));
+    core_utc2date(utc, zone, &date);
+
+    return (date.year == year && date.mon == mon && date.day == day && date.hour == hour &&
+            date.min == min && date.sec == sec && date.msec == msec) ? 1 : 0;
+}
+
+/* 字符串转换测试: 十六进制互转及非法输入, 整数边界值, 闰年和世纪年的日期, 日志时间前缀 */
+static sdk_test_result_t string_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const uint8_t hex[] = {0x00, 0xFF, 0x7F, 0xA0};
+    uint8_t output[8];
+    char buffer[32];
+    uint8_t len = 0;
+    uint32_t value = 0;
+
+    memset(output, 0, sizeof(output));
+    TEST_EXPECT(core_str2hex("00ff7Fa0", 8, output) == STATE_SUCCESS, TEST_ERR_STRING);
+    TEST_EXPECT(memcmp(output, hex, sizeof(hex)) == 0, TEST_ERR_STRING);
+    TEST_EXPECT(core_str2hex("00f", 3, output) == STATE_USER_INPUT_OUT_RANGE, TEST_ERR_STRING);
+    TEST_EXPECT(core_str2hex("0g", 2, output) == STATE_USER_INPUT_OUT_RANGE, TEST_ERR_STRING);
+    TEST_EXPECT(core_str2hex("g0", 2, output) == STATE_USER_INPUT_OUT_RANGE, TEST_ERR_STRING);
+    TEST_EXPECT(core_str2hex("0:", 2, output) == STATE_USER_INPUT_OUT_RANGE, TEST_ERR_STRING);
+
+    memset(buffer, 0, sizeof(buffer));
+    core_hex2str((uint8_t *)hex, sizeof(hex), buffer, 0);
+    TEST_EXPECT(strcmp(buffer, "00FF7FA0") == 0, TEST_ERR_STRING);
+    core_hex2str((uint8_t *)hex, sizeof(hex), buffer, 1);
+    TEST_EXPECT(strcmp(buffer, "00ff7fa0") == 0, TEST_ERR_STRING);
+
+    core_uint2str(0, buffer, &len);
+    TEST_EXPECT(string_number_equal(buffer, len, "0"), TEST_ERR_STRING);
+    core_uint2str(4294967295U, buffer, &len);
+    TEST_EXPECT(string_number_equal(buffer, len, "4294967295"), TEST_ERR_STRING);
+    core_int2str(-2147483647 - 1, buffer, &len);
+    TEST_EXPECT(string_number_equal(buffer, len, "-2147483648"), TEST_ERR_STRING);
+    core_int2str(-1, buffer, &len);
+    TEST_EXPECT(string_number_equal(buffer, len, "-1"), TEST_ERR_STRING);
+    core_uint642str(18446744073709551615ULL, buffer, &len);
+    TEST_EXPECT(string_number_equal(buffer, len, "18446744073709551615"), TEST_ERR_STRING);
+    TEST_EXPECT(core_str2uint("4294967295", 10, &value) == STATE_SUCCESS && value == 4294967295U, TEST_ERR_STRING);
+
+    TEST_EXPECT(core_strcase_equal("content-LENGTH", 14, "Content-Length") == 1, TEST_ERR_STRING);
+    TEST_EXPECT(core_strcase_equal("Content-Length", 7, "Content-Length") == 0, TEST_ERR_STRING);
+    TEST_EXPECT(core_strcase_equal("Content\rLength", 14, "Content-Length") == 0, TEST_ERR_STRING);
+    TEST_EXPECT(core_strcase_equal("[", 1, "{") == 0, TEST_ERR_STRING);
+
+    TEST_EXPECT(string_date_equal(0, 0, 1970, 1, 1, 0, 0, 0, 0), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(951782400000ULL, 0, 2000, 2, 29, 0, 0, 0, 0), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(951868799999ULL, 0, 2000, 2, 29, 23, 59, 59, 999), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(1600000000123ULL, 8, 2020, 9, 13, 20, 26, 40, 123), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(1709164800000ULL, 0, 2024, 2, 29, 0, 0, 0, 0), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(4107542400000ULL, 0, 2100, 3, 1, 0, 0, 0, 0), TEST_ERR_STRING);
+    TEST_EXPECT(string_date_equal(253402300799000ULL, 0, 9999, 12, 31, 23, 59, 59, 0), TEST_ERR_STRING);
+
+    /* 日志时间固定为东八区, 各字段不补零; 同一秒内复用缓存, 跨秒后重新格式化 */
+    buffer[0] = '[';
+    buffer[1] = '\0';
+    _core_log_append_date(sysdep, 1600000000000ULL, buffer);
+    TEST_EXPECT(strcmp(buffer, "[2020/9/13 20:26:40") == 0, TEST_ERR_STRING);
+    buffer[0] = '\0';
+    _core_log_append_date(sysdep, 1600000000999ULL, buffer);
+    TEST_EXPECT(strcmp(buffer, "2020/9/13 20:26:40") == 0, TEST_ERR_STRING);
+    buffer[0] = '\0';
+    _core_log_append_date(sysdep, 1600000001000ULL, buffer);
+    TEST_EXPECT(strcmp(buffer, "2020/9/13 20:26:41") == 0, TEST_ERR_STRING);
+
+    return TEST_SUCCESS;
+}
+
+/* 模拟的网络连接, 依次交付脚本中服务端的应答, 每次最多交付read_max字节, 脚本读完后超时或者关闭连接 */
+typedef struct {
+    const char *script;
+    uint32_t script_len;
+    uint32_t offset;
+    uint32_t read_max;
+    uint8_t close_at_end;
+} http_test_network_t;
+
+/* 一次应答中回调输出的状态码和body */
+typedef struct {
+    uint32_t code;
+    char body[256];
+    uint32_t body_len;
+    uint8_t overflow;
+} http_test_response_t;
+
+static http_test_network_t g_http_test_network;
+
+static void *http_test_network_init(void)
+{
+    return &g_http_test_network;
+}
+
+static int32_t http_test_network_setopt(void *handle, core_sysdep_network_option_t option, void *data)
+{
+    return STATE_SUCCESS;
+}
+
+static int32_t http_test_network_establish(void *handle)
+{
+    return STATE_SUCCESS;
+}
+
+static int32_t http_test_network_recv(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                      core_sysdep_addr_t *addr)
+{
+    http_test_network_t *network = (http_test_network_t *)handle;
+    uint32_t remain = network->script_len - network->offset;
+
+    if (remain == 0) {
+        return (network->close_at_end) ? STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED : 0;
+    }
+    len = (len < network->read_max) ? len : network->read_max;
+    len = (len < remain) ? len : remain;
+    memcpy(buffer, network->script + network->offset, len);
+    network->offset += len;
+
+    return (int32_t)len;
+}
+
+static int32_t http_test_network_send(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                      core_sysdep_addr_t *addr)
+{
+    return (int32_t)len;
+}
+
+static int32_t http_test_network_deinit(void **handle)
+{
+    *handle = NULL;
+    return STATE_SUCCESS;
+}
+
+static void http_test_recv_handler(void *handle, const aiot_http_recv_t *packet, void *userdata)
+{
+    http_test_response_t *response = (http_test_response_t *)userdata;
+
+    if (packet->type == AIOT_HTTPRECV_STATUS_CODE) {
+        response->code = packet->data.status_code.code;
+    } else if (packet->type == AIOT_HTTPRECV_BODY) {
+        if (response->body_len + packet->data.body.len > sizeof(response->body)) {
+            response->overflow = 1;
+            return;
+        }
+        memcpy(response->body + response->body_len, packet->data.body.buffer, packet->data.body.len);
+        response->body_len += packet->data.body.len;
+    }
+}
+
+/* 读取一个完整的应答, 返回最后一次core_http_recv的结果 */
+static int32_t http_test_read(void *handle, http_test_response_t *response)
+{
+    int32_t res = STATE_SUCCESS;
+    uint32_t count = 0;
+
+    memset(response, 0, sizeof(http_test_response_t));
+    do {
+        res = core_http_recv(handle);
+    } while (res >= STATE_SUCCESS && ++count < 1000);
+
+    return res;
+}
+
+static uint8_t http_test_response_equal(http_test_response_t *response, uint32_t code, const char *body)
+{
+    return (response->overflow == 0 && response->code == code && response->body_len == strlen(body) &&
+            memcmp(response->body, body, response->body_len) == 0) ? 1 : 0;
+}
+
+/* 按脚本建立连接并发送count个请求, 之后由调用者读取应答 */
+static void *http_test_open(const char *script, uint32_t read_max, uint8_t close_at_end, uint32_t count,
+                            http_test_response_t *response)
+{
+    core_http_request_t request = {.method = "GET", .path = "/chunk", .header = NULL, .content = NULL, .content_len = 0};
+    uint32_t recv_timeout_ms = 100, body_buffer_len = 8;
+    void *handle = NULL;
+
+    memset(&g_http_test_network, 0, sizeof(http_test_network_t));
+    g_http_test_network.script = script;
+    g_http_test_network.script_len = (uint32_t)strlen(script);
+    g_http_test_network.read_max = read_max;
+    g_http_test_network.close_at_end = close_at_end;
+
+    handle = core_http_init();
+    if (handle == NULL) {
+        return NULL;
+    }
+    core_http_setopt(handle, CORE_HTTPOPT_HOST, "chunk.test");
+    core_http_setopt(handle, CORE_HTTPOPT_RECV_TIMEOUT_MS, &recv_timeout_ms);
+    /* body缓冲区比chunk短, chunk数据需要分多次读取 */
+    core_http_setopt(handle, CORE_HTTPOPT_BODY_BUFFER_MAX_LEN, &body_buffer_len);
+    core_http_setopt(handle, CORE_HTTPOPT_RECV_HANDLER, (void *)http_test_recv_handler);
+    core_http_setopt(handle, CORE_HTTPOPT_USERDATA, response);
+    if (core_http_connect(handle) < STATE_SUCCESS) {
+        core_http_deinit(&handle);
+        return NULL;
+    }
+    while (count-- > 0) {
+        if (core_http_send(handle, &request) < STATE_SUCCESS) {
+            core_http_deinit(&handle);
+            return NULL;
+        }
+    }
+
+    return handle;
+}
+
+/* 单个应答的脚本, 检查解码后的body */
+static uint8_t http_test_single(const char *script, uint32_t read_max, uint8_t close_at_end, int32_t expect_res,
+                                const char *expect_body)
+{
+    http_test_response_t response;
+    void *handle = NULL;
+    int32_t res = STATE_SUCCESS;
+
+    handle = http_test_open(script, read_max, close_at_end, 1, &response);
+    if (handle == NULL) {
+        return 0;
+    }
+    res = http_test_read(handle, &response);
+    core_http_deinit(&handle);
+    if (res != expect_res) {
+        DEBUG_INFO("read_max %d, res -0x%04X", read_max, -res);
+        return 0;
+    }
+
+    return (expect_body == NULL || http_test_response_equal(&response, 200, expect_body)) ? 1 : 0;
+}
+
+static sdk_test_result_t http_chunk_cases(void)
+{
+    /* 大小写混用的十六进制长度 */
+    const char *split = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "A\r\n0123456789\r\n1a\r\nabcdefghijklmnopqrstuvwxyz\r\n1\r\n!\r\n0\r\n\r\n";
+    /* chunk扩展, header名称和取值不区分大小写 */
+    const char *ext = "HTTP/1.1 200 OK\r\ntransfer-encoding: Chunked\r\n\r\n"
+                      "5;name=value\r\nhello\r\n6;a=\"b;c\"\r\n world\r\n1 \r\n.\r\n2\t;x\r\n..\r\n0;last\r\n\r\n";
+    const char *trailer = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "4\r\nwiki\r\n5\r\npedia\r\n0\r\nExpires: never\r\nX-Checksum: 0\r\n\r\n"
+                          "HTTP/1.1 404 Not Found\r\nCONTENT-LENGTH: 5\r\n\r\nnotfd";
+    const char *until_close = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\nthe body ends when the server closes";
+    const char *invalid = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhelloX\r\n0\r\n\r\n";
+    const uint32_t read_max[] = {1, 2, 3, 4, 5, 7, 11, 1024};
+    http_test_response_t response;
+    uint32_t idx = 0, consumed = 0, first_len = (uint32_t)(strstr(trailer, "HTTP/1.1 404") - trailer);
+    uint8_t first_ok = 0;
+    void *handle = NULL;
+    int32_t res = STATE_SUCCESS;
+
+    for (idx = 0; idx < sizeof(read_max) / sizeof(read_max[0]); idx++) {
+        /* 长度行在任意位置被拆分到两次读取中 */
+        TEST_EXPECT(http_test_single(split, read_max[idx], 0, STATE_HTTP_READ_BODY_FINISHED,
+                                     "0123456789abcdefghijklmnopqrstuvwxyz!"), TEST_ERR_HTTP_CHUNK);
+        /* 长度之后的扩展字段被跳过, 不计入body */
+        TEST_EXPECT(http_test_single(ext, read_max[idx], 0, STATE_HTTP_READ_BODY_FINISHED, "hello world..."),
+                    TEST_ERR_HTTP_CHUNK);
+        /* 没有长度信息的body在对端关闭连接时结束 */
+        TEST_EXPECT(http_test_single(until_close, read_max[idx], 1, STATE_HTTP_READ_BODY_FINISHED,
+                                     "the body ends when the server closes"), TEST_ERR_HTTP_CHUNK);
+        TEST_EXPECT(http_test_single(invalid, read_max[idx], 0, STATE_HTTP_CHUNK_INVALID, NULL), TEST_ERR_HTTP_CHUNK);
+
+        /* trailer被完整读掉且不会多读, 同一连接上流水线的下一个应答可以正常解析 */
+        handle = http_test_open(trailer, read_max[idx], 0, 2, &response);
+        TEST_EXPECT(handle != NULL, TEST_ERR_HTTP_CHUNK);
+        res = http_test_read(handle, &response);
+        consumed = g_http_test_network.offset;
+        first_ok = (res == STATE_HTTP_READ_BODY_FINISHED && http_test_response_equal(&response, 200, "wikipedia"));
+        res = http_test_read(handle, &response);
+        core_http_deinit(&handle);
+        TEST_EXPECT(first_ok && consumed == first_len, TEST_ERR_HTTP_CHUNK);
+        TEST_EXPECT(res == STATE_HTTP_READ_BODY_FINISHED && http_test_response_equal(&response, 404, "notfd"),
+                    TEST_ERR_HTTP_CHUNK);
+        TEST_EXPECT(g_http_test_network.offset == g_http_test_network.script_len, TEST_ERR_HTTP_CHUNK);
+    }
+
+    return TEST_SUCCESS;
+}
+
+/* HTTP chunked解码测试: 使用模拟的网络连接, 按不同的粒度交付服务端应答, 检查解码后的body */
+static sdk_test_result_t http_chunk_test(aiot_sysdep_portfile_t *sysdep)
+{
+    aiot_sysdep_portfile_t http_sysdep;
+    sdk_test_result_t ret = TEST_SUCCESS;
+
+    memcpy(&http_sysdep, sysdep, sizeof(aiot_sysdep_portfile_t));
+    http_sysdep.core_sysdep_network_init = http_test_network_init;
+    http_sysdep.core_sysdep_network_setopt = http_test_network_setopt;
+    http_sysdep.core_sysdep_network_establish = http_test_network_establish;
+    http_sysdep.core_sysdep_network_recv = http_test_network_recv;
+    http_sysdep.core_sysdep_network_send = http_test_network_send;
+    http_sysdep.core_sysdep_network_deinit = http_test_network_deinit;
+
+    aiot_sysdep_set_portfile(&http_sysdep);
+    ret = http_chunk_cases();
+    aiot_sysdep_set_portfile(sysdep);
+
+    return ret;
+}
+
+#define MD_TEST_TOPIC           "/sys/test_pk/test_dn/thing/file/download"
+#define MD_TEST_REQUEST_MAX     (64)
+#define MD_TEST_INJECT_MAX      (8)
+
+/* 回复的类型, 除MD_TEST_REPLY_OK外都是在正常回复之前插入的异常回复 */
+typedef enum {
+    MD_TEST_REPLY_OK,
+    MD_TEST_REPLY_BAD_CRC,      /* 数据被篡改, CRC校验失败 */
+    MD_TEST_REPLY_BAD_SIZE,     /* 头中的bSize与数据长度不符 */
+    MD_TEST_REPLY_BAD_CODE,     /* code不是200 */
+    MD_TEST_REPLY_BAD_MAGIC,    /* 二进制头的magic错误 */
+    MD_TEST_REPLY_SHORT,        /* 二进制头不完整 */
+} md_test_reply_t;
+
+/* 对某个偏移的第一次请求, 在正常回复之前先回复一个异常回复 */
+typedef struct {
+    uint32_t offset;
+    md_test_reply_t kind;
+} md_test_inject_t;
+
+/*
+ * 模拟的MQTT服务端: 回复CONNACK, 记录文件下载的分块请求.
+ * 每一轮把新收到的请求按相反的顺序回复, 每轮最后再把最先回复的块重复回复一次
+ */
+typedef struct {
+    uint8_t rx[64 * 1024];      /* 待设备读取的报文 */
+    uint32_t rx_len;
+    uint32_t rx_offset;
+    uint32_t req_offset[MD_TEST_REQUEST_MAX];
+    uint32_t req_size[MD_TEST_REQUEST_MAX];
+    uint8_t req_binary[MD_TEST_REQUEST_MAX];
+    uint32_t req_num;
+    uint32_t req_answered;
+    uint32_t file_len;
+    md_test_inject_t inject[MD_TEST_INJECT_MAX];
+    uint32_t inject_num;
+} md_test_network_t;
+
+typedef struct {
+    uint32_t offset;            /* 下一个期望交付的偏移 */
+    uint32_t errors;
+    int32_t percent;
+} md_test_context_t;
+
+static md_test_network_t g_md_test_network;
+
+static uint8_t md_test_byte(uint32_t offset)
+{
+    return (uint8_t)(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+
+static void *md_test_network_init(void)
+{
+    return &g_md_test_network;
+}
+
+static int32_t md_test_network_setopt(void *handle, core_sysdep_network_option_t option, void *data)
+{
+    return STATE_SUCCESS;
+}
+
+static int32_t md_test_network_establish(void *handle)
+{
+    return STATE_SUCCESS;
+}
+
+static int32_t md_test_network_recv(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                    core_sysdep_addr_t *addr)
+{
+    md_test_network_t *network = (md_test_network_t *)handle;
+    uint32_t remain = network->rx_len - network->rx_offset;
+
+    len = (len < remain) ? len : remain;
+    memcpy(buffer, network->rx + network->rx_offset, len);
+    network->rx_offset += len;
+
+    return (int32_t)len;
+}
+
+/* 从分块请求的payload中取出某个数字字段的值 */
+static uint32_t md_test_field(const char *payload, const char *key)
+{
+    const char *value = strstr(payload, key);
+
+    return (value == NULL) ? 0 : (uint32_t)strtoul(value + strlen(key), NULL, 10);
+}
+
+static int32_t md_test_network_send(void *handle, uint8_t *buffer, uint32_t len, uint32_t timeout_ms,
+                                    core_sysdep_addr_t *addr)
+{
+    md_test_network_t *network = (md_test_network_t *)handle;
+    uint32_t pos = 1, multiplier = 1, remain_len = 0, topic_len = 0, payload_len = 0;
+    char payload[512];
+
+    /* CONNECT报文, 回复CONNACK(连接已接受) */
+    if ((buffer[0] & 0xF0) == 0x10) {
+        memcpy(network->rx + network->rx_len, "\x20\x02\x00\x00", 4);
+        network->rx_len += 4;
+        return (int32_t)len;
+    }
+    /* 只处理发往下载topic的QoS0 PUBLISH报文: 剩余长度, topic, payload */
+    if (buffer[0] != 0x30 || network->req_num == MD_TEST_REQUEST_MAX) {
+        return (int32_t)len;
+    }
+    do {
+        remain_len += (buffer[pos] & 0x7F) * multiplier;
+        multiplier *= 128;
+    } while ((buffer[pos++] & 0x80) != 0 && pos < len);
+    topic_len = buffer[pos] << 8 | buffer[pos + 1];
+    if (topic_len != strlen(MD_TEST_TOPIC) || memcmp(buffer + pos + 2, MD_TEST_TOPIC, topic_len) != 0) {
+        return (int32_t)len;
+    }
+    payload_len = remain_len - 2 - topic_len;
+    payload_len = (payload_len < sizeof(payload) - 1) ? payload_len : sizeof(payload) - 1;
+    memcpy(payload, buffer + pos + 2 + topic_len, payload_len);
+    payload[payload_len] = '\0';
+
+    network->req_offset[network->req_num] = md_test_field(payload, "\"offset\":");
+    network->req_size[network->req_num] = md_test_field(payload, "\"size\":");
+    network->req_binary[network->req_num] = (strstr(payload, "\"headerFormat\":\"binary\"") != NULL) ? 1 : 0;
+    network->req_num++;
+
+    return (int32_t)len;
+}
+
+static int32_t md_test_network_deinit(void **handle)
+{
+    *handle = NULL;
+    return STATE_SUCCESS;
+}
+
+/*
+ * 按JSON或二进制格式生成一个分块回复的payload, 返回payload长度
+ * JSON格式: 头长度(2) JSON头 文件数据 crc16(2, 小端)
+ * 二进制格式: magic(2) code(2) bOffset(4) bSize(4) fileLength(4) crc16(2) reserved(2) fileToken(16) 文件数据, 大端
+ */
+static uint32_t md_test_payload(uint8_t *buffer, uint32_t offset, uint32_t size, uint8_t binary, md_test_reply_t kind)
+{
+    uint32_t header_len = 0, idx = 0, code = 200, bsize = size;
+    uint16_t crc16 = 0;
+    uint8_t *data = NULL, mask = 0;
+
+    code = (kind == MD_TEST_REPLY_BAD_CODE) ? 404 : 200;
+    bsize = (kind == MD_TEST_REPLY_BAD_SIZE) ? size - 1 : size;
+    if (binary) {
+        header_len = 36;
+        memset(buffer, 0, header_len);
+        buffer[0] = 0xFF;
+        buffer[1] = (kind == MD_TEST_REPLY_BAD_MAGIC) ? 0xFE : 0xFF;
+        buffer[2] = (uint8_t)(code >> 8);
+        buffer[3] = (uint8_t)code;
+        for (idx = 0; idx < 4; idx++) {
+            buffer[4 + idx] = (uint8_t)(offset >> (24 - idx * 8));
+            buffer[8 + idx] = (uint8_t)(bsize >> (24 - idx * 8));
+            buffer[12 + idx] = (uint8_t)(g_md_test_network.file_len >> (24 - idx * 8));
+        }
+        memcpy(buffer + 20, "test", strlen("test"));
+    } else {
+        header_len = snprintf((char *)buffer + 2, 160,
+                              "{\"code\":%u,\"data\":{\"bSize\":%u,\"bOffset\":%u,\"fileLength\":%u,\"fileToken\":\"test\"}}",
+                              code, bsize, offset, g_md_test_network.file_len);
+        buffer[0] = (uint8_t)(header_len >> 8);
+        buffer[1] = (uint8_t)header_len;
+        header_len += 2;
+    }
+
+    /* code错误的回复携带不同的数据, 被误接收时交付的内容会出错 */
+    mask = (kind == MD_TEST_REPLY_BAD_CODE) ? 0xFF : 0x00;
+    data = buffer + header_len;
+    for (idx = 0; idx < size; idx++) {
+        data[idx] = md_test_byte(offset + idx) ^ mask;
+    }
+    crc16 = core_crc16(data, size);
+    if (kind == MD_TEST_REPLY_BAD_CRC) {
+        data[size / 2] ^= 0x01;
+    }
+    if (binary) {
+        buffer[16] = (uint8_t)(crc16 >> 8);
+        buffer[17] = (uint8_t)crc16;
+        return (kind == MD_TEST_REPLY_SHORT) ? 20 : header_len + size;
+    }
+    data[size] = (uint8_t)crc16;
+    data[size + 1] = (uint8_t)(crc16 >> 8);
+
+    return header_len + size + 2;
+}
+
+/* 把一个分块回复组装成发往download_reply的PUBLISH报文, 追加到待读取的数据之后 */
+static void md_test_reply(uint32_t offset, uint32_t size, uint8_t binary, md_test_reply_t kind)
+{
+    md_test_network_t *network = &g_md_test_network;
+    const char *topic = MD_TEST_TOPIC "_reply";
+    uint8_t *payload = NULL;
+    uint32_t topic_len = (uint32_t)strlen(topic), payload_len = 0, remain_len = 0;
+
+    /* 报文头最长5字节 */
+    if (network->rx_len + 5 + 2 + topic_len + 2 + 160 + size + 2 > sizeof(network->rx)) {
+        return;
+    }
+    payload = malloc(2 + 160 + size + 2);
+    if (payload == NULL) {
+        return;
+    }
+    payload_len = md_test_payload(payload, offset, size, binary, kind);
+    remain_len = 2 + topic_len + payload_len;
+
+    network->rx[network->rx_len++] = 0x30;
+    do {
+        network->rx[network->rx_len] = remain_len % 128;
+        remain_len /= 128;
+        network->rx[network->rx_len++] |= (remain_len > 0) ? 0x80 : 0x00;
+    } while (remain_len > 0);
+    network->rx[network->rx_len++] = (uint8_t)(topic_len >> 8);
+    network->rx[network->rx_len++] = (uint8_t)topic_len;
+    memcpy(network->rx + network->rx_len, topic, topic_len);
+    network->rx_len += topic_len;
+    memcpy(network->rx + network->rx_len, payload, payload_len);
+    network->rx_len += payload_len;
+    free(payload);
+}
+
+/* 回复上一轮之后收到的请求, 后发出的请求先回复 */
+static void md_test_answer(void)
+{
+    md_test_network_t *network = &g_md_test_network;
+    uint32_t idx = 0, inject = 0, first = network->req_answered;
+
+    if (network->rx_offset == network->rx_len) {
+        network->rx_offset = network->rx_len = 0;
+    }
+    for (idx = network->req_num; idx > first; idx--) {
+        for (inject = 0; inject < network->inject_num; inject++) {
+            if (network->inject[inject].offset == network->req_offset[idx - 1]) {
+                md_test_reply(network->req_offset[idx - 1], network->req_size[idx - 1], network->req_binary[idx - 1],
+                              network->inject[inject].kind);
+                network->inject[inject] = network->inject[--network->inject_num];
+                break;
+            }
+        }
+        md_test_reply(network->req_offset[idx - 1], network->req_size[idx - 1], network->req_binary[idx - 1],
+                      MD_TEST_REPLY_OK);
+    }
+    if (network->req_num > first) {
+        md_test_reply(network->req_offset[network->req_num - 1], network->req_size[network->req_num - 1],
+                      network->req_binary[network->req_num - 1], MD_TEST_REPLY_OK);
+    }
+    network->req_answered = network->req_num;
+}
+
+static void md_test_recv_handler(void *handle, const aiot_mqtt_download_recv_t *packet, void *userdata)
+{
+    md_test_context_t *context = (md_test_context_t *)userdata;
+    aiot_mqtt_download_stats_t stats;
+    uint32_t idx = 0, size = packet->data.data_resp.data_size;
+
+    if (packet->type != AIOT_MDRECV_DATA_RESP) {
+        return;
+    }
+    /* 乱序到达的块按文件顺序交付 */
+    if (packet->data.data_resp.offset != context->offset || strcmp(packet->data.data_resp.filename, "test") != 0) {
+        context->errors++;
+    }
+    for (idx = 0; idx < size; idx++) {
+        if ((uint8_t)packet->data.data_resp.data[idx] != md_test_byte(context->offset + idx)) {
+            context->errors++;
+            break;
+        }
+    }
+    /* 回调中可以获取统计信息, 已交付的长度包含本块 */
+    if (aiot_mqtt_download_get_stats(handle, &stats) != STATE_SUCCESS || stats.fetched_bytes != context->offset + size) {
+        context->errors++;
+    }
+    context->offset += size;
+    context->percent = packet->data.data_resp.percent;
+}
+
+/* 按文件内容计算期望的md5 */
+static void md_test_digest(uint32_t file_len, char digest[33])
+{
+    core_md5_context_t ctx;
+    uint8_t byte = 0, output[16];
+    uint32_t offset = 0;
+
+    core_md5_init(&ctx);
+    core_md5_starts(&ctx);
+    for (offset = 0; offset < file_len; offset++) {
+        byte = md_test_byte(offset);
+        core_md5_update(&ctx, &byte, 1);
+    }
+    core_md5_finish(&ctx, output);
+    core_md5_free(&ctx);
+    core_hex2str(output, sizeof(output), digest, 1);
+    digest[32] = '\0';
+}
+
+/* 使用模拟服务端完成一次下载, 检查回调交付的数据, md5校验结果以及重新请求的次数 */
+static sdk_test_result_t md_test_run(uint32_t file_len, uint32_t window_size, uint32_t request_size,
+                                     uint8_t binary, uint32_t expect_retry)
+{
+    void *mqtt_handle = NULL, *md_handle = NULL;
+    aiot_sysdep_network_cred_t cred;
+    aiot_download_task_desc_t task_desc;
+    aiot_mqtt_download_stats_t stats;
+    md_test_context_t context;
+    uint32_t block_timeout_ms = 60 * 1000, round = 0;
+    int32_t res = STATE_SUCCESS;
+    char digest[33];
+
+    g_md_test_network.file_len = file_len;
+    md_test_digest(file_len, digest);
+    memset(&cred, 0, sizeof(aiot_sysdep_network_cred_t));
+    cred.option = AIOT_SYSDEP_NETWORK_CRED_NONE;
+
+    mqtt_handle = aiot_mqtt_init();
+    TEST_EXPECT(mqtt_handle != NULL, TEST_ERR_MQTT_DOWNLOAD);
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_HOST, (void *)"127.0.0.1");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_PRODUCT_KEY, (void *)"test_pk");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_DEVICE_NAME, (void *)"test_dn");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_DEVICE_SECRET, (void *)"test_ds");
+    aiot_mqtt_setopt(mqtt_handle, AIOT_MQTTOPT_NETWORK_CRED, (void *)&cred);
+    res = aiot_mqtt_connect(mqtt_handle);
+    if (res < STATE_SUCCESS) {
+        aiot_mqtt_deinit(&mqtt_handle);
+    }
+    TEST_EXPECT(res >= STATE_SUCCESS, TEST_ERR_MQTT_DOWNLOAD);
+
+    memset(&task_desc, 0, sizeof(aiot_download_task_desc_t));
+    task_desc.size_total = file_len;
+    task_desc.digest_method = AIOT_OTA_DIGEST_MD5;
+    task_desc.expect_digest = digest;
+    task_desc.mqtt_handle = mqtt_handle;
+    memset(&context, 0, sizeof(md_test_context_t));
+
+    md_handle = aiot_mqtt_download_init();
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_TASK_DESC, &task_desc);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_RECV_HANDLE, (void *)md_test_recv_handler);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_USERDATA, &context);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_WINDOW_SIZE, &window_size);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_DATA_REQUEST_SIZE, &request_size);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BLOCK_TIMEOUT_MS, &block_timeout_ms);
+    aiot_mqtt_download_setopt(md_handle, AIOT_MDOPT_BINARY_HEADER, &binary);
+
+    /* 每一轮先回复新的请求, 再读完全部回复 */
+    for (round = 0; round < 1000 && res != STATE_MQTT_DOWNLOAD_SUCCESS && res != STATE_MQTT_DOWNLOAD_FAILED_TIMEOUT &&
+         res != STATE_MQTT_DOWNLOAD_FAILED_MISMATCH && res != STATE_MQTT_DOWNLOAD_FAILED_RECVERROR; round++) {
+        md_test_answer();
+        while (g_md_test_network.rx_offset < g_md_test_network.rx_len && aiot_mqtt_recv(mqtt_handle) >= STATE_SUCCESS);
+        res = aiot_mqtt_download_process(md_handle);
+    }
+    aiot_mqtt_download_get_stats(md_handle, &stats);
+    aiot_mqtt_download_deinit(&md_handle);
+    aiot_mqtt_deinit(&mqtt_handle);
+
+    TEST_EXPECT(res == STATE_MQTT_DOWNLOAD_SUCCESS, TEST_ERR_MQTT_DOWNLOAD);
+    TEST_EXPECT(context.errors == 0 && context.offset == file_len && context.percent == 100, TEST_ERR_MQTT_DOWNLOAD);
+    TEST_EXPECT(stats.fetched_bytes == file_len && stats.retry_count == expect_retry, TEST_ERR_MQTT_DOWNLOAD);
+    TEST_EXPECT(stats.request_count == (file_len + request_size - 1) / request_size + expect_retry,
+                TEST_ERR_MQTT_DOWNLOAD);
+
+    return TEST_SUCCESS;
+}
+
+/* 初始化模拟服务端, 设置需要插入的异常回复 */
+static void md_test_network_reset(const md_test_inject_t *inject, uint32_t inject_num)
+{
+    memset(&g_md_test_network, 0, sizeof(md_test_network_t));
+    memcpy(g_md_test_network.inject, inject, inject_num * sizeof(md_test_inject_t));
+    g_md_test_network.inject_num = inject_num;
+}
+
+/* 在portfile的基础上替换为模拟服务端的网络接口 */
+static void md_test_sysdep(aiot_sysdep_portfile_t *sysdep, aiot_sysdep_portfile_t *md_sysdep)
+{
+    memcpy(md_sysdep, sysdep, sizeof(aiot_sysdep_portfile_t));
+    md_sysdep->core_sysdep_network_init = md_test_network_init;
+    md_sysdep->core_sysdep_network_setopt = md_test_network_setopt;
+    md_sysdep->core_sysdep_network_establish = md_test_network_establish;
+    md_sysdep->core_sysdep_network_recv = md_test_network_recv;
+    md_sysdep->core_sysdep_network_send = md_test_network_send;
+    md_sysdep->core_sysdep_network_deinit = md_test_network_deinit;
+}
+
+/*
+ * MQTT文件下载测试: 回复乱序, 重复以及CRC错误时, 按文件顺序交付数据且md5校验通过.
+ * code不是200的回复直接丢弃, 不计入重新请求的次数
+ */
+static sdk_test_result_t mqtt_download_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const md_test_inject_t inject[] = {
+        {0, MD_TEST_REPLY_BAD_CODE}, {2 * 1024, MD_TEST_REPLY_BAD_CRC}, {9 * 1024, MD_TEST_REPLY_BAD_CRC}
+    };
+    aiot_sysdep_portfile_t md_sysdep;
+    sdk_test_result_t ret = TEST_SUCCESS;
+
+    md_test_sysdep(sysdep, &md_sysdep);
+    aiot_sysdep_set_portfile(&md_sysdep);
+
+    /* 4个1KB的请求窗口, 文件长度不是块长度的整数倍 */
+    md_test_network_reset(inject, sizeof(inject) / sizeof(inject[0]));
+    ret = md_test_run(10 * 1024 + 300, 4, 1024, 0, 2);
+    if (ret == TEST_SUCCESS) {
+        md_test_network_reset(NULL, 0);
+        ret = md_test_run(10 * 1024 + 300, 1, 1024, 0, 0);
+    }
+
+    aiot_sysdep_set_portfile(sysdep);
+
+    return ret;
+}
+
+/*
+ * 二进制回复头测试: 请求二进制格式的回复头, 并在正常回复之前插入格式错误的回复.
+ * magic错误, 头不完整以及code不是200的回复无法确定是哪个块, 直接丢弃; bSize不符或CRC错误的块重新请求
+ */
+static sdk_test_result_t binary_header_test(aiot_sysdep_portfile_t *sysdep)
+{
+    const md_test_inject_t inject[] = {
+        {1 * 1024, MD_TEST_REPLY_BAD_MAGIC}, {3 * 1024, MD_TEST_REPLY_SHORT}, {5 * 1024, MD_TEST_REPLY_BAD_CODE},
+        {7 * 1024, MD_TEST_REPLY_BAD_SIZE}, {10 * 1024, MD_TEST_REPLY_BAD_CRC}
+    };
+    aiot_sysdep_portfile_t md_sysdep;
+    sdk_test_result_t ret = TEST_SUCCESS;
+
+    md_test_sysdep(sysdep, &md_sysdep);
+    aiot_sysdep_set_portfile(&md_sysdep);
+
+    md_test_network_reset(inject, sizeof(inject) / sizeof(inject[0]));
+    ret = md_test_run(10 * 1024 + 300, 4, 1024, 1, 2);
+
+    aiot_sysdep_set_portfile(sysdep);
+
+    return (ret == TEST_SUCCESS) ? TEST_SUCCESS : TEST_ERR_BINARY_HEADER;
+}
+
+sdk_test_suite test_list[] = {
+    {"RANDOM_TEST       ", random_test},
+    {"JSON_INDEX_TEST   ", json_index_test},
+    {"JSON_WRITER_TEST  ", json_writer_test},
+    {"CRC_TEST          ", crc_test},
+    {"DIGEST_TEST       ", digest_test},
+    {"STRING_TEST       ", string_test},
+    {"HTTP_CHUNK_TEST   ", http_chunk_test},
+    {"MQTT_DOWNLOAD_TEST", mqtt_download_test},
+    {"BINARY_HEADER_TEST", binary_header_test},
+};
+
+int main(int argc, char *argv[])
+{
+    aiot_sysdep_portfile_t *sysdep = &g_aiot_sysdep_portfile;
+    int32_t size = sizeof(test_list) / sizeof(test_list[0]);
+    sdk_test_result_t ret = TEST_SUCCESS;
+    int32_t i = 0, failed = 0;
+
+    aiot_sysdep_set_portfile(sysdep);
+
+    DEBUG_INFO("TOTAL TEST START");
+    for (i = 0; i < size; i++) {
+        DEBUG_INFO("TEST [%d/%d] [%s] .....................................[START]", i + 1, size, test_list[i].name);
+        ret = (test_list[i].func)(sysdep);
+        if (TEST_SUCCESS != ret) {
+            DEBUG_INFO("TEST [%d/%d] [%s] .....................................[FAILED] [%s]", i + 1, size,
+                       test_list[i].name, result_string[ret]);
+            failed++;
+        } else {
+            DEBUG_INFO("TEST [%d/%d] [%s] .....................................[SUCCESS]", i + 1, size,
+                       test_list[i].name);
+        }
+    }
+    if (failed == 0) {
+        DEBUG_INFO("TOTAL TEST SUCCESS");
+        return 0;
+    }
+    DEBUG_INFO("TOTAL TEST FAILED, %d of %d", failed, size);
+    return -1;
+}
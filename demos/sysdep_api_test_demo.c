@@ -101,6 +101,18 @@ typedef struct
     uint32_t timeout_ms;
 } mutex_cfg_t;
 
+typedef struct
+{
+    void*    data_lock;     /* 保护读多写少的共享数据, 读写锁或互斥锁 */
+    void*    counter_lock;  /* 保护计数器, 自旋锁或互斥锁 */
+    void*    finish_mutex;
+    uint8_t  use_rwlock;
+    uint32_t loops;
+    uint32_t counter;
+    uint32_t finished;
+    uint32_t table[16];
+} lock_bench_cfg_t;
+
 typedef struct
 {
     char*       host;
@@ -172,17 +184,96 @@ end:
     return ret;
 }
 
+/**
+ * 对随机数做字节分布的卡方检验和比特频数检验, 并统计生成速率
+ */
+static sysdep_test_result_t random_statistic_test(aiot_sysdep_portfile_t* sysdep)
+{
+    /* 每轮生成的字节数及轮数 */
+    const uint32_t block_len = 4096;
+    const uint32_t rounds = 64;
+    uint8_t *buffer = NULL;
+    uint32_t *bins = NULL;
+    uint32_t i = 0, j = 0;
+    uint64_t ones = 0, total_bits = 0, sqrt_bits = 0, expected = 0, chi_square = 0;
+    uint64_t time_start = 0, time_used = 0;
+    sysdep_test_result_t ret = TEST_SUCCESS;
+
+    buffer = sysdep->core_sysdep_malloc(block_len, NULL);
+    bins = sysdep->core_sysdep_malloc(256 * sizeof(uint32_t), NULL);
+    if(buffer == NULL || bins == NULL) {
+        DEBUG_INFO("malloc fail");
+        ret = TEST_ERR_MALLOC;
+        goto end;
+    }
+    memset(bins, 0, 256 * sizeof(uint32_t));
+
+    time_start = sysdep->core_sysdep_time();
+    for(i = 0; i < rounds; i++) {
+        sysdep->core_sysdep_rand(buffer, block_len);
+        for(j = 0; j < block_len; j++) {
+            uint8_t value = buffer[j];
+            bins[value]++;
+            while(value) {
+                ones += value & 0x01;
+                value >>= 1;
+            }
+        }
+    }
+    time_used = sysdep->core_sysdep_time() - time_start;
+
+    /* 卡方统计量, 自由度255, 显著性0.001时的临界值约为330 */
+    expected = (uint64_t)block_len * rounds / 256;
+    for(i = 0; i < 256; i++) {
+        int64_t diff = (int64_t)bins[i] - (int64_t)expected;
+        chi_square += (uint64_t)(diff * diff);
+    }
+    chi_square /= expected;
+
+    /* 比特中1的数量应在均值的4倍标准差以内, 标准差为sqrt(n)/2, 即|2*ones - n| <= 4*sqrt(n) */
+    total_bits = (uint64_t)block_len * rounds * 8;
+    while(sqrt_bits * sqrt_bits < total_bits) {
+        sqrt_bits++;
+    }
+    DEBUG_INFO("random %"PRIu64" bytes in %"PRIu64" ms, chi-square %"PRIu64", ones %"PRIu64"/%"PRIu64,
+               (uint64_t)block_len * rounds, time_used, chi_square, ones, total_bits);
+    if(chi_square > 330) {
+        DEBUG_INFO("random byte distribution error");
+        ret = TEST_ERR_RANDOM;
+        goto end;
+    }
+    if(ones * 2 > total_bits + 4 * sqrt_bits || ones * 2 + 4 * sqrt_bits < total_bits) {
+        DEBUG_INFO("random bit frequency error");
+        ret = TEST_ERR_RANDOM;
+        goto end;
+    }
+
+end:
+    if(buffer != NULL) {
+        sysdep->core_sysdep_free(buffer);
+    }
+    if(bins != NULL) {
+        sysdep->core_sysdep_free(bins);
+    }
+    return ret;
+}
+
 /**
  * 随机数测试入口
  */
 sysdep_test_result_t random_test(aiot_sysdep_portfile_t* sysdep)
 {
     random_cfg_t rd;
+    sysdep_test_result_t ret = TEST_SUCCESS;
     /* 随机数接口要求生成的随机数按字节随机 */
     rd.count = 256;
     /* 随机数重复次数不能超过该值 */
     rd.repeat_cnt_max = 10;
-    return random_repeat_test(sysdep, &rd);
+    ret = random_repeat_test(sysdep, &rd);
+    if(ret != TEST_SUCCESS) {
+        return ret;
+    }
+    return random_statistic_test(sysdep);
 }
 
 static sysdep_test_result_t heap_malloc_max_test(aiot_sysdep_portfile_t* sysdep, heap_cfg_t* hp)
@@ -792,6 +883,143 @@ end:
     return TEST_SUCCESS;
 }
 
+/**
+ * 模拟并发发布: 每次先查询读多写少的共享数据, 再递增计数器
+*/
+static void* lock_bench_publisher(void* user_data)
+{
+    task_handler_input_t *input = (task_handler_input_t *)user_data;
+    aiot_sysdep_portfile_t *sysdep = input->sysdep;
+    lock_bench_cfg_t *cfg = (lock_bench_cfg_t *)input->user_data;
+    volatile uint32_t sum = 0;
+    uint32_t i = 0;
+
+    for(i = 0; i < cfg->loops; i++) {
+        if(cfg->use_rwlock) {
+            sysdep->core_sysdep_rwlock_rdlock(cfg->data_lock);
+            sum += cfg->table[i & 0x0F];
+            sysdep->core_sysdep_rwlock_unlock(cfg->data_lock);
+            sysdep->core_sysdep_spinlock_lock(cfg->counter_lock);
+            cfg->counter++;
+            sysdep->core_sysdep_spinlock_unlock(cfg->counter_lock);
+        } else {
+            sysdep->core_sysdep_mutex_lock(cfg->data_lock);
+            sum += cfg->table[i & 0x0F];
+            sysdep->core_sysdep_mutex_unlock(cfg->data_lock);
+            sysdep->core_sysdep_mutex_lock(cfg->counter_lock);
+            cfg->counter++;
+            sysdep->core_sysdep_mutex_unlock(cfg->counter_lock);
+        }
+    }
+
+    sysdep->core_sysdep_mutex_lock(cfg->finish_mutex);
+    cfg->finished++;
+    sysdep->core_sysdep_mutex_unlock(cfg->finish_mutex);
+    return NULL;
+}
+
+static sysdep_test_result_t lock_bench_run(aiot_sysdep_portfile_t* sysdep, uint8_t use_rwlock, uint32_t threads, uint64_t *elapsed_ms)
+{
+    lock_bench_cfg_t cfg;
+    task_handler_input_t input[8];
+    sysdep_test_result_t ret = TEST_SUCCESS;
+    uint64_t start = 0;
+    uint32_t finished = 0;
+    uint32_t i = 0;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.use_rwlock = use_rwlock;
+    cfg.loops = 200000;
+    for(i = 0; i < 16; i++) {
+        cfg.table[i] = i;
+    }
+    cfg.finish_mutex = sysdep->core_sysdep_mutex_init();
+    if(use_rwlock) {
+        cfg.data_lock = sysdep->core_sysdep_rwlock_init();
+        cfg.counter_lock = sysdep->core_sysdep_spinlock_init();
+    } else {
+        cfg.data_lock = sysdep->core_sysdep_mutex_init();
+        cfg.counter_lock = sysdep->core_sysdep_mutex_init();
+    }
+    if(cfg.finish_mutex == NULL || cfg.data_lock == NULL || cfg.counter_lock == NULL) {
+        DEBUG_INFO("[LOCK_TEST] lock init failed");
+        ret = TEST_ERR_MUTEX;
+        goto end;
+    }
+
+    start = sysdep->core_sysdep_time();
+    for(i = 0; i < threads; i++) {
+        input[i].name = "lock_bench_publisher";
+        input[i].sysdep = sysdep;
+        input[i].user_data = &cfg;
+        task_start(lock_bench_publisher, &input[i]);
+    }
+
+    do {
+        sysdep->core_sysdep_sleep(5);
+        sysdep->core_sysdep_mutex_lock(cfg.finish_mutex);
+        finished = cfg.finished;
+        sysdep->core_sysdep_mutex_unlock(cfg.finish_mutex);
+    } while(finished < threads && sysdep->core_sysdep_time() - start < 30 * 1000);
+    *elapsed_ms = sysdep->core_sysdep_time() - start;
+
+    if(finished < threads || cfg.counter != threads * cfg.loops) {
+        DEBUG_INFO("[LOCK_TEST] counter mismatch, expect %u, result %u", threads * cfg.loops, cfg.counter);
+        ret = TEST_ERR_MUTEX;
+        /* 线程可能仍在使用锁, 不做释放 */
+        return ret;
+    }
+
+end:
+    if(use_rwlock) {
+        if(cfg.data_lock != NULL) {
+            sysdep->core_sysdep_rwlock_deinit(&cfg.data_lock);
+        }
+        if(cfg.counter_lock != NULL) {
+            sysdep->core_sysdep_spinlock_deinit(&cfg.counter_lock);
+        }
+    } else {
+        if(cfg.data_lock != NULL) {
+            sysdep->core_sysdep_mutex_deinit(&cfg.data_lock);
+        }
+        if(cfg.counter_lock != NULL) {
+            sysdep->core_sysdep_mutex_deinit(&cfg.counter_lock);
+        }
+    }
+    if(cfg.finish_mutex != NULL) {
+        sysdep->core_sysdep_mutex_deinit(&cfg.finish_mutex);
+    }
+    return ret;
+}
+
+/**
+ * 读写锁与自旋锁测试, 并与纯互斥锁方案对比多线程竞争下的耗时
+ * 这两组接口为可选接口, 未实现时跳过
+*/
+sysdep_test_result_t lock_test(aiot_sysdep_portfile_t* sysdep)
+{
+    sysdep_test_result_t ret = TEST_SUCCESS;
+    uint64_t mutex_ms = 0, rwlock_ms = 0;
+    uint32_t threads = 4;
+
+    if(sysdep->core_sysdep_rwlock_init == NULL || sysdep->core_sysdep_spinlock_init == NULL) {
+        DEBUG_INFO("[LOCK_TEST] rwlock/spinlock not implemented, skip");
+        return TEST_SUCCESS;
+    }
+
+    ret = lock_bench_run(sysdep, 0, threads, &mutex_ms);
+    if(ret != TEST_SUCCESS) {
+        return ret;
+    }
+    ret = lock_bench_run(sysdep, 1, threads, &rwlock_ms);
+    if(ret != TEST_SUCCESS) {
+        return ret;
+    }
+
+    DEBUG_INFO("[LOCK_TEST] %u publishers, mutex: %" PRIu64 " ms, rwlock+spinlock: %" PRIu64 " ms", threads, mutex_ms, rwlock_ms);
+    return TEST_SUCCESS;
+}
+
 typedef struct {
     char*            name;
     sysdep_test_func func;
@@ -806,6 +1034,7 @@ sysdep_test_suite test_list[]= {
     {"TIME_TEST   ", time_sleep_test},
     {"NETWORK_TEST", network_test},
     {"MUTEX_TEST  ", mutex_test},
+    {"LOCK_TEST   ", lock_test},
 };
 
 /**
@@ -15,6 +15,7 @@
 #include <pthread.h>
 #include <fcntl.h>
 #include <sys/time.h>
+#include <sys/random.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -141,13 +142,181 @@ static void _port_uint2str(uint16_t input, char *output)
     } while (i > 0);
 }
 
-static int32_t _core_sysdep_network_connect(char *host, uint16_t port, int family, int socktype, int protocol,
-        uint32_t timeout_ms, int *fd_out)
+/*
+ * DNS解析结果缓存, 重连时直接使用上次连接成功的地址, 跳过DNS查询
+ * 使用缓存地址连接失败或缓存过期时, 重新进行DNS解析
+ */
+#define CORE_SYSDEP_DNS_CACHE_SIZE      (4)
+#define CORE_SYSDEP_DNS_CACHE_TTL_MS    (10 * 60 * 1000)
+
+typedef struct {
+    char host[128];
+    uint16_t port;
+    int socktype;
+    struct addrinfo info;
+    struct sockaddr_storage addr;
+    uint64_t expire_time;
+} core_sysdep_dns_cache_t;
+
+static core_sysdep_dns_cache_t g_dns_cache[CORE_SYSDEP_DNS_CACHE_SIZE];
+static pthread_mutex_t g_dns_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static core_sysdep_dns_cache_t *_core_sysdep_dns_cache_find(char *host, uint16_t port, int socktype)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < CORE_SYSDEP_DNS_CACHE_SIZE; i++) {
+        if (g_dns_cache[i].expire_time != 0 && g_dns_cache[i].port == port && g_dns_cache[i].socktype == socktype &&
+            strcmp(g_dns_cache[i].host, host) == 0) {
+            return &g_dns_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int32_t _core_sysdep_dns_cache_get(char *host, uint16_t port, int socktype, struct addrinfo *info,
+        struct sockaddr_storage *addr)
+{
+    int32_t res = -1;
+    core_sysdep_dns_cache_t *entry = NULL;
+
+    pthread_mutex_lock(&g_dns_cache_mutex);
+    entry = _core_sysdep_dns_cache_find(host, port, socktype);
+    if (entry != NULL) {
+        if (core_sysdep_time() < entry->expire_time) {
+            memcpy(info, &entry->info, sizeof(struct addrinfo));
+            memcpy(addr, &entry->addr, sizeof(struct sockaddr_storage));
+            info->ai_addr = (struct sockaddr *)addr;
+            info->ai_next = NULL;
+            res = 0;
+        } else {
+            entry->expire_time = 0;
+        }
+    }
+    pthread_mutex_unlock(&g_dns_cache_mutex);
+
+    return res;
+}
+
+static void _core_sysdep_dns_cache_put(char *host, uint16_t port, int socktype, struct addrinfo *info)
+{
+    uint32_t i = 0;
+    uint64_t time_now = core_sysdep_time();
+    core_sysdep_dns_cache_t *entry = NULL;
+
+    if (strlen(host) >= sizeof(entry->host) || info->ai_addrlen > sizeof(struct sockaddr_storage)) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_dns_cache_mutex);
+    entry = _core_sysdep_dns_cache_find(host, port, socktype);
+    if (entry == NULL) {
+        /* 优先使用空闲项, 否则替换最早过期的一项 */
+        entry = &g_dns_cache[0];
+        for (i = 0; i < CORE_SYSDEP_DNS_CACHE_SIZE; i++) {
+            if (g_dns_cache[i].expire_time < entry->expire_time) {
+                entry = &g_dns_cache[i];
+            }
+        }
+    }
+    memset(entry, 0, sizeof(core_sysdep_dns_cache_t));
+    memcpy(entry->host, host, strlen(host));
+    entry->port = port;
+    entry->socktype = socktype;
+    memcpy(&entry->info, info, sizeof(struct addrinfo));
+    memcpy(&entry->addr, info->ai_addr, info->ai_addrlen);
+    entry->info.ai_canonname = NULL;
+    entry->info.ai_next = NULL;
+    entry->expire_time = time_now + CORE_SYSDEP_DNS_CACHE_TTL_MS;
+    pthread_mutex_unlock(&g_dns_cache_mutex);
+}
+
+static void _core_sysdep_dns_cache_remove(char *host, uint16_t port, int socktype)
+{
+    core_sysdep_dns_cache_t *entry = NULL;
+
+    pthread_mutex_lock(&g_dns_cache_mutex);
+    entry = _core_sysdep_dns_cache_find(host, port, socktype);
+    if (entry != NULL) {
+        entry->expire_time = 0;
+    }
+    pthread_mutex_unlock(&g_dns_cache_mutex);
+}
+
+static int32_t _core_sysdep_network_connect_addr(struct addrinfo *pos, uint32_t timeout_ms, int *fd_out)
 {
     int32_t res = STATE_SUCCESS;
     int fd = 0, sock_option = 0;
+
+    fd = socket(pos->ai_family, pos->ai_socktype, pos->ai_protocol);
+    if (fd < 0) {
+        printf("create socket error\n");
+        return STATE_PORT_NETWORK_SOCKET_CREATE_FAILED;
+    }
+
+    res = fcntl(fd, F_GETFL);
+    if (res != -1) {
+        res = fcntl(fd, F_SETFL, sock_option | O_NONBLOCK);
+    }
+
+    if (res == -1) {
+        /* block connect */
+        if (connect(fd, pos->ai_addr, pos->ai_addrlen) == 0) {
+            *fd_out = fd;
+            return STATE_SUCCESS;
+        } else {
+            res = STATE_PORT_NETWORK_CONNECT_FAILED;
+        }
+    } else {
+        /* non-block connect */
+        fd_set write_sets;
+        struct timeval timeselect;
+
+        FD_ZERO(&write_sets);
+        FD_SET(fd, &write_sets);
+
+        timeselect.tv_sec = timeout_ms / 1000;
+        timeselect.tv_usec = timeout_ms % 1000 * 1000;
+
+        if (connect(fd, pos->ai_addr, pos->ai_addrlen) == 0) {
+            *fd_out = fd;
+            return STATE_SUCCESS;
+        } else if (errno != EINPROGRESS) {
+            res = STATE_PORT_NETWORK_CONNECT_FAILED;
+        } else {
+            res = select(fd + 1, NULL, &write_sets, NULL, &timeselect);
+            if (res == 0) {
+                res = STATE_MQTT_LOG_CONNECT_TIMEOUT;
+            } else if (res < 0) {
+                res = STATE_PORT_NETWORK_CONNECT_FAILED;
+            } else {
+                if (FD_ISSET(fd, &write_sets)) {
+                    res = connect(fd, pos->ai_addr, pos->ai_addrlen);
+                    if ((res != 0 && errno == EISCONN) || res == 0) {
+                        *fd_out = fd;
+                        return STATE_SUCCESS;
+                    } else {
+                        res = STATE_PORT_NETWORK_CONNECT_FAILED;
+                    }
+                }
+            }
+        }
+    }
+
+    close(fd);
+    printf("connect error, errno: %d\n", errno);
+
+    return res;
+}
+
+static int32_t _core_sysdep_network_connect(char *host, uint16_t port, int family, int socktype, int protocol,
+        uint32_t timeout_ms, int *fd_out)
+{
+    int32_t res = STATE_PORT_NETWORK_CONNECT_FAILED;
     char service[6] = {0};
-    struct addrinfo hints;
+    struct addrinfo hints, cached_info;
+    struct sockaddr_storage cached_addr;
     struct addrinfo *addrInfoList = NULL, *pos = NULL;
 
     memset(&hints, 0, sizeof(struct addrinfo));
@@ -159,73 +328,25 @@ static int32_t _core_sysdep_network_connect(char *host, uint16_t port, int famil
 
     signal( SIGPIPE, SIG_IGN );
 
-    res = getaddrinfo(host, service, &hints, &addrInfoList);
-    if (res == 0) {
-        for (pos = addrInfoList; pos != NULL; pos = pos->ai_next) {
-            fd = socket(pos->ai_family, pos->ai_socktype, pos->ai_protocol);
-            if (fd < 0) {
-                printf("create socket error\n");
-                res = STATE_PORT_NETWORK_SOCKET_CREATE_FAILED;
-                continue;
-            }
-
-            res = fcntl(fd, F_GETFL);
-            if (res != -1) {
-                res = fcntl(fd, F_SETFL, sock_option | O_NONBLOCK);
-            }
-
-            if (res == -1) {
-                /* block connect */
-                if (connect(fd, pos->ai_addr, pos->ai_addrlen) == 0) {
-                    *fd_out = fd;
-                    res = STATE_SUCCESS;
-                    break;
-                } else {
-                    res = STATE_PORT_NETWORK_CONNECT_FAILED;
-                }
-            } else {
-                /* non-block connect */
-                fd_set write_sets;
-                struct timeval timeselect;
-
-                FD_ZERO(&write_sets);
-                FD_SET(fd, &write_sets);
-
-                timeselect.tv_sec = timeout_ms / 1000;
-                timeselect.tv_usec = timeout_ms % 1000 * 1000;
+    if (_core_sysdep_dns_cache_get(host, port, socktype, &cached_info, &cached_addr) == 0) {
+        res = _core_sysdep_network_connect_addr(&cached_info, timeout_ms, fd_out);
+        if (res != STATE_SUCCESS) {
+            _core_sysdep_dns_cache_remove(host, port, socktype);
+        }
+    }
 
-                if (connect(fd, pos->ai_addr, pos->ai_addrlen) == 0) {
-                    *fd_out = fd;
-                    res = STATE_SUCCESS;
+    if (res != STATE_SUCCESS) {
+        if (getaddrinfo(host, service, &hints, &addrInfoList) == 0) {
+            for (pos = addrInfoList; pos != NULL; pos = pos->ai_next) {
+                res = _core_sysdep_network_connect_addr(pos, timeout_ms, fd_out);
+                if (res == STATE_SUCCESS) {
+                    _core_sysdep_dns_cache_put(host, port, socktype, pos);
                     break;
-                } else if (errno != EINPROGRESS) {
-                    res = STATE_PORT_NETWORK_CONNECT_FAILED;
-                } else {
-                    res = select(fd + 1, NULL, &write_sets, NULL, &timeselect);
-                    if (res == 0) {
-                        res = STATE_MQTT_LOG_CONNECT_TIMEOUT;
-                    } else if (res < 0) {
-                        res = STATE_PORT_NETWORK_CONNECT_FAILED;
-                    } else {
-                        if (FD_ISSET(fd, &write_sets)) {
-                            res = connect(fd, pos->ai_addr, pos->ai_addrlen);
-                            if ((res != 0 && errno == EISCONN) || res == 0) {
-                                *fd_out = fd;
-                                res = STATE_SUCCESS;
-                                break;
-                            } else {
-                                res = STATE_PORT_NETWORK_CONNECT_FAILED;
-                            }
-                        }
-                    }
                 }
             }
-
-            close(fd);
-            printf("connect error, errno: %d\n", errno);
+        } else {
+            res = STATE_PORT_NETWORK_DNS_FAILED;
         }
-    } else {
-        res = STATE_PORT_NETWORK_DNS_FAILED;
     }
 
     if (res < 0) {
@@ -384,6 +505,10 @@ static int32_t _core_sysdep_network_recv(core_network_handle_t *network_handle,
             if (FD_ISSET(network_handle->fd, &recv_sets)) {
                 recv_res = recv(network_handle->fd, buffer + recv_bytes, len - recv_bytes, 0);
                 if (recv_res == 0) {
+                    /* 对端关闭前已收到的数据先返回, 下一次读取时再报告连接关闭 */
+                    if (recv_bytes > 0) {
+                        break;
+                    }
                     printf("_core_sysdep_network_recv, nwk connection closed\n");
                     return STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
                 } else if (recv_res < 0) {
@@ -644,7 +769,7 @@ static int32_t core_sysdep_network_deinit(void **handle)
     return 0;
 }
 
-void core_sysdep_rand(uint8_t *output, uint32_t output_len)
+static void _core_sysdep_rand_fallback(uint8_t *output, uint32_t output_len)
 {
     uint32_t idx = 0, bytes = 0, rand_num = 0;
     struct timeval time;
@@ -667,6 +792,50 @@ void core_sysdep_rand(uint8_t *output, uint32_t output_len)
     }
 }
 
+/*
+ * 该接口同时作为TLS握手的随机数来源, 需要密码学安全的实现
+ * 优先使用getrandom(), 内核不支持时读取/dev/urandom
+ */
+void core_sysdep_rand(uint8_t *output, uint32_t output_len)
+{
+    uint32_t idx = 0;
+    ssize_t res = 0;
+    int fd = -1;
+
+    while (idx < output_len) {
+        res = getrandom(output + idx, output_len - idx, 0);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        idx += res;
+    }
+
+    if (idx < output_len) {
+        fd = open("/dev/urandom", O_RDONLY);
+        if (fd >= 0) {
+            while (idx < output_len) {
+                res = read(fd, output + idx, output_len - idx);
+                if (res <= 0) {
+                    if (res < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                idx += res;
+            }
+            close(fd);
+        }
+    }
+
+    if (idx < output_len) {
+        printf("secure random source unavailable\n");
+        _core_sysdep_rand_fallback(output + idx, output_len - idx);
+    }
+}
+
 void *core_sysdep_mutex_init(void)
 {
     int res = 0;
@@ -718,6 +887,105 @@ void core_sysdep_mutex_deinit(void **mutex)
     }
 }
 
+void *core_sysdep_rwlock_init(void)
+{
+    int res = 0;
+    pthread_rwlock_t *rwlock = (pthread_rwlock_t *)malloc(sizeof(pthread_rwlock_t));
+    if (NULL == rwlock) {
+        return NULL;
+    }
+
+    if (0 != (res = pthread_rwlock_init(rwlock, NULL))) {
+        perror("create rwlock failed\n");
+        free(rwlock);
+        return NULL;
+    }
+
+    return (void *)rwlock;
+}
+
+void core_sysdep_rwlock_rdlock(void *rwlock)
+{
+    int res = 0;
+    if (rwlock != NULL) {
+        if (0 != (res = pthread_rwlock_rdlock((pthread_rwlock_t *)rwlock))) {
+            printf("rdlock rwlock failed: - '%s' (%d)\n", strerror(res), res);
+        }
+    }
+}
+
+void core_sysdep_rwlock_wrlock(void *rwlock)
+{
+    int res = 0;
+    if (rwlock != NULL) {
+        if (0 != (res = pthread_rwlock_wrlock((pthread_rwlock_t *)rwlock))) {
+            printf("wrlock rwlock failed: - '%s' (%d)\n", strerror(res), res);
+        }
+    }
+}
+
+void core_sysdep_rwlock_unlock(void *rwlock)
+{
+    int res = 0;
+    if (rwlock != NULL) {
+        if (0 != (res = pthread_rwlock_unlock((pthread_rwlock_t *)rwlock))) {
+            printf("unlock rwlock failed - '%s' (%d)\n", strerror(res), res);
+        }
+    }
+}
+
+void core_sysdep_rwlock_deinit(void **rwlock)
+{
+    int err_num = 0;
+    if (rwlock != NULL && *rwlock != NULL) {
+        if (0 != (err_num = pthread_rwlock_destroy(*(pthread_rwlock_t **)rwlock))) {
+            perror("destroy rwlock failed\n");
+        }
+        free(*(pthread_rwlock_t **)rwlock);
+        *rwlock = NULL;
+    }
+}
+
+void *core_sysdep_spinlock_init(void)
+{
+    int res = 0;
+    pthread_spinlock_t *spinlock = (pthread_spinlock_t *)malloc(sizeof(pthread_spinlock_t));
+    if (NULL == spinlock) {
+        return NULL;
+    }
+
+    if (0 != (res = pthread_spin_init(spinlock, PTHREAD_PROCESS_PRIVATE))) {
+        perror("create spinlock failed\n");
+        free((void *)spinlock);
+        return NULL;
+    }
+
+    return (void *)spinlock;
+}
+
+void core_sysdep_spinlock_lock(void *spinlock)
+{
+    if (spinlock != NULL) {
+        pthread_spin_lock((pthread_spinlock_t *)spinlock);
+    }
+}
+
+void core_sysdep_spinlock_unlock(void *spinlock)
+{
+    if (spinlock != NULL) {
+        pthread_spin_unlock((pthread_spinlock_t *)spinlock);
+    }
+}
+
+void core_sysdep_spinlock_deinit(void **spinlock)
+{
+    if (spinlock != NULL && *spinlock != NULL) {
+        pthread_spin_destroy(*(pthread_spinlock_t **)spinlock);
+        free(*spinlock);
+        *spinlock = NULL;
+    }
+}
+
 aiot_sysdep_portfile_t g_aiot_sysdep_portfile = {
     .core_sysdep_malloc = core_sysdep_malloc,
     .core_sysdep_free = core_sysdep_free,
@@ -734,5 +1002,14 @@ aiot_sysdep_portfile_t g_aiot_sysdep_portfile = {
     .core_sysdep_mutex_lock = core_sysdep_mutex_lock,
     .core_sysdep_mutex_unlock = core_sysdep_mutex_unlock,
     .core_sysdep_mutex_deinit = core_sysdep_mutex_deinit,
+    .core_sysdep_rwlock_init = core_sysdep_rwlock_init,
+    .core_sysdep_rwlock_rdlock = core_sysdep_rwlock_rdlock,
+    .core_sysdep_rwlock_wrlock = core_sysdep_rwlock_wrlock,
+    .core_sysdep_rwlock_unlock = core_sysdep_rwlock_unlock,
+    .core_sysdep_rwlock_deinit = core_sysdep_rwlock_deinit,
+    .core_sysdep_spinlock_init = core_sysdep_spinlock_init,
+    .core_sysdep_spinlock_lock = core_sysdep_spinlock_lock,
+    .core_sysdep_spinlock_unlock = core_sysdep_spinlock_unlock,
+    .core_sysdep_spinlock_deinit = core_sysdep_spinlock_deinit,
 };
 